@@ -208,22 +208,30 @@ void ComprDataIO::UnpWrite(byte *Addr,uint Count)
   UnpWrSize=Count;
   if (UnpackToMemory)
   {
-    while(UnpackToMemorySize < (int)Count)
+    // the unpacker may flush up to a whole dictionary at once, so hand
+    // the data to the reader in pieces that fit its buffer
+    byte *WrAddr=Addr;
+    uint WrCount=Count;
+    while (WrCount>0)
     {
-      hBufferEmpty->Set();
-      while(! hBufferFilled->WaitMSec(1)) 
-        if (hQuit->WaitMSec(1))
-          return;
-    }
-    
-    if (! hSeek->WaitMSec(1)) // we are seeking
-    {
-      memcpy(UnpackToMemoryAddr,Addr,Count);
-      UnpackToMemoryAddr+=Count;
-      UnpackToMemorySize-=Count;
+      while(UnpackToMemorySize <= 0)
+      {
+        hBufferEmpty->Set();
+        while(! hBufferFilled->WaitMSec(1)) 
+          if (hQuit->WaitMSec(1))
+            return;
+      }
+
+      if (hSeek->WaitMSec(1)) // we are seeking
+        return;
+
+      uint CopySize=Min(WrCount,(uint)UnpackToMemorySize);
+      memcpy(UnpackToMemoryAddr,WrAddr,CopySize);
+      UnpackToMemoryAddr+=CopySize;
+      UnpackToMemorySize-=CopySize;
+      WrAddr+=CopySize;
+      WrCount-=CopySize;
     }
-    else
-      return;
   }
   else
     if (!TestMode)
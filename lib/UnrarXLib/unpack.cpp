@@ -31,10 +31,9 @@ void Unpack::Init(byte *Window)
 {
   if (Window==NULL)
   {
-    if (UnpIO->UnpackToMemorySize > -1)
-      Unpack::Window = new byte[MAXWINMEMSIZE];
-    else
-      Unpack::Window=new byte[MAXWINSIZE];
+    // unpacking to memory still needs the full dictionary, only the
+    // output handed to the reader is limited to MAXWINMEMSIZE chunks
+    Unpack::Window=new byte[MAXWINSIZE];
 #ifndef ALLOW_EXCEPTIONS
     if (Unpack::Window==NULL)
       ErrHandler.MemoryError();
@@ -894,10 +893,7 @@ void Unpack::UnpInitData(int Solid)
     memset(OldDist,0,sizeof(OldDist));
     OldDistPtr=0;
     LastDist=LastLength=0;
-    if (UnpIO->UnpackToMemorySize > -1)
-      memset(Window,0,MAXWINMEMSIZE);
-    else
-      memset(Window,0,MAXWINSIZE);
+    memset(Window,0,MAXWINSIZE);
     memset(UnpOldTable,0,sizeof(UnpOldTable));
     UnpPtr=WrPtr=0;
     PPMEscChar=2;
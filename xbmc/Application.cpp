@@ -274,6 +274,7 @@
 #include "dialogs/GUIDialogMediaFilter.h"
 #include "utils/XMLUtils.h"
 #include "addons/AddonInstaller.h"
+#include "utils/Trace.h"
 
 #ifdef HAS_PERFORMANCE_SAMPLE
 #include "utils/PerformanceSample.h"
@@ -724,6 +725,9 @@ bool CApplication::Create()
   }
   CSettings::Get().SetLoaded();
 
+  // listings stored by an earlier run, now that their size limit is known
+  g_directoryCache.PrunePersisted();
+
   CLog::Log(LOGINFO, "creating subdirectories");
   CLog::Log(LOGINFO, "userdata folder: %s", CProfilesManager::Get().GetProfileUserDataFolder().c_str());
   CLog::Log(LOGINFO, "recording folder: %s", CSettings::Get().GetString("audiocds.recordingpath").c_str());
@@ -2038,6 +2042,7 @@ void CApplication::Render()
     return;
 
   MEASURE_FUNCTION;
+  TRACE_FUNCTION("app");
 
   int vsync_mode = CSettings::Get().GetInt("videoscreen.vsync");
 
@@ -2723,6 +2728,7 @@ bool CApplication::OnAction(const CAction &action)
 void CApplication::FrameMove(bool processEvents, bool processGUI)
 {
   MEASURE_FUNCTION;
+  TRACE_FUNCTION("app");
 
   if (processEvents)
   {
@@ -3227,6 +3233,7 @@ bool CApplication::Cleanup()
     g_windowManager.Remove(WINDOW_DIALOG_VOLUME_BAR);
 
     CAddonMgr::Get().DeInit();
+    CDatabaseManager::Get().Deinitialize();
 
 #if defined(HAS_LIRC) || defined(HAS_IRSERVERSUITE)
     CLog::Log(LOGNOTICE, "closing down remote control service");
@@ -4909,6 +4916,7 @@ bool CApplication::ExecuteXBMCAction(std::string actionStr)
 void CApplication::Process()
 {
   MEASURE_FUNCTION;
+  TRACE_FUNCTION("app");
 
   // dispatch the messages generated by python or other threads to the current window
   g_windowManager.DispatchThreadMessages();
@@ -4947,6 +4955,7 @@ void CApplication::Process()
 // We get called every 500ms
 void CApplication::ProcessSlow()
 {
+  TRACE_FUNCTION("app");
   g_powerManager.ProcessEvents();
 
 #if defined(TARGET_DARWIN_OSX)
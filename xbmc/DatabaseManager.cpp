@@ -28,6 +28,7 @@
 #include "pvr/PVRDatabase.h"
 #include "epg/EpgDatabase.h"
 #include "settings/AdvancedSettings.h"
+#include "dbwrappers/DatabaseReadPool.h"
 
 using namespace std;
 using namespace EPG;
@@ -50,6 +51,7 @@ CDatabaseManager::~CDatabaseManager()
 void CDatabaseManager::Initialize(bool addonsOnly)
 {
   Deinitialize();
+  CDatabaseReadPool::Get().Initialize();
   { CAddonDatabase db; UpdateDatabase(db); }
   if (addonsOnly)
     return;
@@ -68,6 +70,8 @@ void CDatabaseManager::Initialize(bool addonsOnly)
 
 void CDatabaseManager::Deinitialize()
 {
+  CDatabaseReadPool::Get().Deinitialize();
+
   CSingleLock lock(m_section);
   m_dbStatus.clear();
 }
@@ -24,6 +24,8 @@
 #include "dbwrappers/dataset.h"
 #include "URL.h"
 
+using namespace dbiplus;
+
 CTextureDatabase::CTextureDatabase()
 {
 }
@@ -142,8 +144,11 @@ bool CTextureDatabase::UpdateOldVersion(int version)
 
 bool CTextureDatabase::IncrementUseCount(const CTextureDetails &details)
 {
-  CStdString sql = PrepareSQL("UPDATE sizes SET usecount=usecount+1, lastusetime=CURRENT_TIMESTAMP WHERE idtexture=%u AND width=%u AND height=%u", details.id, details.width, details.height);
-  return ExecuteQuery(sql);
+  query_params params;
+  params.push_back(details.id);
+  params.push_back(details.width);
+  params.push_back(details.height);
+  return ExecuteQuery("UPDATE sizes SET usecount=usecount+1, lastusetime=CURRENT_TIMESTAMP WHERE idtexture=? AND width=? AND height=?", params);
 }
 
 bool CTextureDatabase::GetCachedTexture(const CStdString &url, CTextureDetails &details)
@@ -153,8 +158,9 @@ bool CTextureDatabase::GetCachedTexture(const CStdString &url, CTextureDetails &
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString sql = PrepareSQL("SELECT id, cachedurl, lasthashcheck, imagehash, width, height FROM texture JOIN sizes ON (texture.id=sizes.idtexture AND sizes.size=1) WHERE url='%s'", url.c_str());
-    m_pDS->query(sql.c_str());
+    query_params params;
+    params.push_back(url);
+    m_pDS->query("SELECT id, cachedurl, lasthashcheck, imagehash, width, height FROM texture JOIN sizes ON (texture.id=sizes.idtexture AND sizes.size=1) WHERE url=?", params);
     if (!m_pDS->eof())
     { // have some information
       details.id = m_pDS->fv(0).get_asInt();
@@ -180,8 +186,10 @@ bool CTextureDatabase::GetCachedTexture(const CStdString &url, CTextureDetails &
 bool CTextureDatabase::SetCachedTextureValid(const CStdString &url, bool updateable)
 {
   CStdString date = updateable ? CDateTime::GetCurrentDateTime().GetAsDBDateTime() : "";
-  CStdString sql = PrepareSQL("UPDATE texture SET lasthashcheck='%s' WHERE url='%s'", date.c_str(), url.c_str());
-  return ExecuteQuery(sql);
+  query_params params;
+  params.push_back(date);
+  params.push_back(url);
+  return ExecuteQuery("UPDATE texture SET lasthashcheck=? WHERE url=?", params);
 }
 
 bool CTextureDatabase::AddCachedTexture(const CStdString &url, const CTextureDetails &details)
@@ -191,17 +199,23 @@ bool CTextureDatabase::AddCachedTexture(const CStdString &url, const CTextureDet
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString sql = PrepareSQL("DELETE FROM texture WHERE url='%s'", url.c_str());
-    m_pDS->exec(sql.c_str());
+    query_params params;
+    params.push_back(url);
+    m_pDS->exec("DELETE FROM texture WHERE url=?", params);
 
     CStdString date = details.updateable ? CDateTime::GetCurrentDateTime().GetAsDBDateTime() : "";
-    sql = PrepareSQL("INSERT INTO texture (id, url, cachedurl, imagehash, lasthashcheck) VALUES(NULL, '%s', '%s', '%s', '%s')", url.c_str(), details.file.c_str(), details.hash.c_str(), date.c_str());
-    m_pDS->exec(sql.c_str());
+    params.push_back(details.file);
+    params.push_back(details.hash);
+    params.push_back(date);
+    m_pDS->exec("INSERT INTO texture (id, url, cachedurl, imagehash, lasthashcheck) VALUES(NULL, ?, ?, ?, ?)", params);
     int textureID = (int)m_pDS->lastinsertid();
 
     // set the size information
-    sql = PrepareSQL("INSERT INTO sizes (idtexture, size, usecount, lastusetime, width, height) VALUES(%u, 1, 1, CURRENT_TIMESTAMP, %u, %u)", textureID, details.width, details.height);
-    m_pDS->exec(sql.c_str());
+    params.clear();
+    params.push_back(textureID);
+    params.push_back(details.width);
+    params.push_back(details.height);
+    m_pDS->exec("INSERT INTO sizes (idtexture, size, usecount, lastusetime, width, height) VALUES(?, 1, 1, CURRENT_TIMESTAMP, ?, ?)", params);
   }
   catch (...)
   {
@@ -242,8 +256,10 @@ bool CTextureDatabase::ClearCachedTexture(const CStdString &url, CStdString &cac
 bool CTextureDatabase::InvalidateCachedTexture(const CStdString &url)
 {
   CStdString date = (CDateTime::GetCurrentDateTime() - CDateTimeSpan(2, 0, 0, 0)).GetAsDBDateTime();
-  CStdString sql = PrepareSQL("UPDATE texture SET lasthashcheck='%s' WHERE url='%s'", date.c_str(), url.c_str());
-  return ExecuteQuery(sql);
+  query_params params;
+  params.push_back(date);
+  params.push_back(url);
+  return ExecuteQuery("UPDATE texture SET lasthashcheck=? WHERE url=?", params);
 }
 
 CStdString CTextureDatabase::GetTextureForPath(const CStdString &url, const CStdString &type)
@@ -256,8 +272,10 @@ CStdString CTextureDatabase::GetTextureForPath(const CStdString &url, const CStd
     if (url.empty())
       return "";
 
-    CStdString sql = PrepareSQL("select texture from path where url='%s' and type='%s'", url.c_str(), type.c_str());
-    m_pDS->query(sql.c_str());
+    query_params params;
+    params.push_back(url);
+    params.push_back(type);
+    m_pDS->query("select texture from path where url=? and type=?", params);
 
     if (!m_pDS->eof())
     { // have some information
@@ -0,0 +1,314 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <stdio.h>
+
+#include "Benchmark.h"
+#include "XBDateTime.h"
+#include "utils/CPUInfo.h"
+#include "utils/JSONVariantParser.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+
+#define BENCHMARK_DEFAULT_SAMPLES         15
+#define BENCHMARK_DEFAULT_MIN_SAMPLE_TIME 20  // ms
+#define BENCHMARK_MAX_ITERATIONS          ((uint64_t)1 << 40)
+
+using namespace std;
+
+// two sided 95% quantiles of Student's t distribution for 1..30 degrees of freedom
+static const double TDistribution95[] = {
+  12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+  2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+  2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+static int64_t NanosecondsNow()
+{
+  static const int64_t frequency = CurrentHostFrequency();
+  int64_t counter = CurrentHostCounter();
+  // split the conversion so it neither overflows nor loses precision
+  return (counter / frequency) * 1000000000 + (counter % frequency) * 1000000000 / frequency;
+}
+
+static double Median(vector<double> values)
+{
+  sort(values.begin(), values.end());
+  size_t middle = values.size() / 2;
+  if (values.size() % 2 == 0)
+    return (values[middle - 1] + values[middle]) / 2;
+  return values[middle];
+}
+
+CBenchmarkState::CBenchmarkState(uint64_t iterations)
+  : m_iterations(iterations), m_remaining(iterations), m_started(0), m_elapsed(0),
+    m_running(false), m_bytes(0), m_items(0)
+{ }
+
+void CBenchmarkState::PauseTiming()
+{
+  if (!m_running)
+    return;
+
+  m_elapsed += NanosecondsNow() - m_started;
+  m_running = false;
+}
+
+void CBenchmarkState::ResumeTiming()
+{
+  if (m_running)
+    return;
+
+  m_running = true;
+  m_started = NanosecondsNow();
+}
+
+uint64_t CBenchmarkState::ElapsedNanoseconds() const
+{
+  return m_elapsed > 0 ? (uint64_t)m_elapsed : 0;
+}
+
+vector<BenchmarkInfo> &CBenchmarkRegistry::GetBenchmarks()
+{
+  // function local so registration works regardless of the static initialisation order
+  static vector<BenchmarkInfo> benchmarks;
+  return benchmarks;
+}
+
+CBenchmarkRegistration::CBenchmarkRegistration(const char *group, const char *name, BenchmarkFunction function)
+{
+  BenchmarkInfo info;
+  info.group = group;
+  info.name = name;
+  info.function = function;
+  CBenchmarkRegistry::GetBenchmarks().push_back(info);
+}
+
+CBenchmarkRunner::CBenchmarkRunner()
+  : m_samples(BENCHMARK_DEFAULT_SAMPLES),
+    m_minSampleTime((uint64_t)BENCHMARK_DEFAULT_MIN_SAMPLE_TIME * 1000000)
+{ }
+
+bool CBenchmarkRunner::Matches(const BenchmarkInfo &benchmark) const
+{
+  if (m_filter.empty())
+    return true;
+
+  return (benchmark.group + "/" + benchmark.name).find(m_filter) != string::npos;
+}
+
+CBenchmarkState CBenchmarkRunner::RunSample(const BenchmarkInfo &benchmark, uint64_t iterations)
+{
+  CBenchmarkState state(iterations);
+  benchmark.function(state);
+  state.PauseTiming();
+  return state;
+}
+
+BenchmarkResult CBenchmarkRunner::Run(const BenchmarkInfo &benchmark)
+{
+  BenchmarkResult result;
+  result.name = benchmark.group + "/" + benchmark.name;
+  result.iterations = 0;
+  result.samples = 0;
+  result.min = result.median = result.mean = result.stddev = result.ci95 = result.mad = 0.0;
+  result.outliers = 0;
+  result.bytesPerSecond = result.itemsPerSecond = 0.0;
+
+  // calibrate, which also warms up caches and lazily initialised singletons
+  uint64_t iterations = 1;
+  while (true)
+  {
+    CBenchmarkState state = RunSample(benchmark, iterations);
+    if (!state.GetError().empty())
+    {
+      result.error = state.GetError();
+      return result;
+    }
+
+    uint64_t elapsed = state.ElapsedNanoseconds();
+    if (elapsed >= m_minSampleTime || iterations >= BENCHMARK_MAX_ITERATIONS)
+      break;
+
+    // aim a bit above the minimum, but never grow more than tenfold per round
+    uint64_t next = iterations * 10;
+    if (elapsed > 0 && (double)iterations * m_minSampleTime * 1.2 / elapsed < (double)next)
+      next = (uint64_t)((double)iterations * m_minSampleTime * 1.2 / elapsed) + 1;
+    iterations = std::max(next, iterations + 1);
+  }
+
+  vector<double> times;
+  uint64_t bytes = 0, items = 0;
+  for (unsigned int i = 0; i < m_samples; i++)
+  {
+    CBenchmarkState state = RunSample(benchmark, iterations);
+    if (!state.GetError().empty())
+    {
+      result.error = state.GetError();
+      return result;
+    }
+    times.push_back((double)state.ElapsedNanoseconds() / iterations);
+    bytes = state.BytesProcessed();
+    items = state.ItemsProcessed();
+  }
+
+  result.iterations = iterations;
+  result.samples = times.size();
+  result.min = *min_element(times.begin(), times.end());
+  result.median = Median(times);
+
+  double sum = 0.0;
+  for (vector<double>::const_iterator it = times.begin(); it != times.end(); ++it)
+    sum += *it;
+  result.mean = sum / times.size();
+
+  double squares = 0.0;
+  for (vector<double>::const_iterator it = times.begin(); it != times.end(); ++it)
+    squares += (*it - result.mean) * (*it - result.mean);
+  result.stddev = sqrt(squares / (times.size() - 1));
+
+  size_t degrees = times.size() - 1;
+  double t = degrees <= sizeof(TDistribution95) / sizeof(TDistribution95[0]) ? TDistribution95[degrees - 1] : 1.96;
+  result.ci95 = t * result.stddev / sqrt((double)times.size());
+
+  vector<double> deviations;
+  for (vector<double>::const_iterator it = times.begin(); it != times.end(); ++it)
+    deviations.push_back(fabs(*it - result.median));
+  result.mad = Median(deviations);
+
+  // samples further than 3 (normal consistent) MADs from the median,
+  // typically caused by preemption or frequency scaling
+  for (vector<double>::const_iterator it = times.begin(); it != times.end(); ++it)
+  {
+    if (fabs(*it - result.median) > 3 * 1.4826 * result.mad)
+      result.outliers++;
+  }
+
+  if (result.median > 0.0)
+  {
+    result.bytesPerSecond = bytes * 1e9 / result.median;
+    result.itemsPerSecond = items * 1e9 / result.median;
+  }
+
+  return result;
+}
+
+vector<BenchmarkResult> CBenchmarkRunner::RunAll()
+{
+  vector<BenchmarkResult> results;
+  const vector<BenchmarkInfo> &benchmarks = CBenchmarkRegistry::GetBenchmarks();
+  for (vector<BenchmarkInfo>::const_iterator it = benchmarks.begin(); it != benchmarks.end(); ++it)
+  {
+    if (!Matches(*it))
+      continue;
+
+    fprintf(stderr, "%-50s ", (it->group + "/" + it->name).c_str());
+    fflush(stderr);
+
+    BenchmarkResult result = Run(*it);
+    if (!result.error.empty())
+      fprintf(stderr, "FAILED: %s\n", result.error.c_str());
+    else
+      fprintf(stderr, "%14.1f ns  +- %5.1f%%  (%u samples of %llu iterations)\n", result.median,
+              result.median > 0.0 ? result.ci95 * 100 / result.median : 0.0,
+              result.samples, (unsigned long long)result.iterations);
+
+    results.push_back(result);
+  }
+
+  return results;
+}
+
+string CBenchmarkRunner::ToJSON(const vector<BenchmarkResult> &results, const string &baseline, double threshold, unsigned int &regressions) const
+{
+  regressions = 0;
+
+  map<string, CVariant> previous;
+  if (!baseline.empty())
+  {
+    CVariant old = CJSONVariantParser::Parse((const unsigned char *)baseline.c_str(), baseline.size());
+    for (CVariant::const_iterator_array it = old["benchmarks"].begin_array(); it != old["benchmarks"].end_array(); ++it)
+      previous[(*it)["name"].asString()] = *it;
+  }
+
+  CVariant output(CVariant::VariantTypeObject);
+  output["version"] = 1;
+  output["date"] = CDateTime::GetUTCDateTime().GetAsDBDateTime();
+  output["cpu"]["model"] = g_cpuInfo.getCPUModel();
+  output["cpu"]["count"] = g_cpuInfo.getCPUCount();
+  output["settings"]["samples"] = m_samples;
+  output["settings"]["minsampletime"] = (uint64_t)(m_minSampleTime / 1000000);
+  output["benchmarks"] = CVariant(CVariant::VariantTypeArray);
+
+  for (vector<BenchmarkResult>::const_iterator it = results.begin(); it != results.end(); ++it)
+  {
+    CVariant benchmark(CVariant::VariantTypeObject);
+    benchmark["name"] = it->name;
+    if (!it->error.empty())
+    {
+      benchmark["error"] = it->error;
+      output["benchmarks"].push_back(benchmark);
+      continue;
+    }
+
+    benchmark["iterations"] = it->iterations;
+    benchmark["samples"] = it->samples;
+    benchmark["time"]["unit"] = "ns";
+    benchmark["time"]["min"] = it->min;
+    benchmark["time"]["median"] = it->median;
+    benchmark["time"]["mean"] = it->mean;
+    benchmark["time"]["stddev"] = it->stddev;
+    benchmark["time"]["ci95"] = it->ci95;
+    benchmark["time"]["mad"] = it->mad;
+    benchmark["outliers"] = it->outliers;
+    if (it->bytesPerSecond > 0.0)
+      benchmark["bytespersecond"] = it->bytesPerSecond;
+    if (it->itemsPerSecond > 0.0)
+      benchmark["itemspersecond"] = it->itemsPerSecond;
+
+    map<string, CVariant>::const_iterator old = previous.find(it->name);
+    if (old != previous.end() && old->second.isMember("time"))
+    {
+      const CVariant &time = old->second["time"];
+      double oldMedian = time["median"].asDouble();
+      double oldMean = time["mean"].asDouble();
+      double oldCI = time["ci95"].asDouble();
+
+      // only call it a regression if it is both slower by more than the
+      // threshold and the confidence intervals of the two runs don't overlap
+      bool regression = oldMedian > 0.0 && it->median > oldMedian * (1.0 + threshold) &&
+                        it->mean - it->ci95 > oldMean + oldCI;
+      benchmark["baseline"]["median"] = oldMedian;
+      benchmark["baseline"]["change"] = oldMedian > 0.0 ? (it->median - oldMedian) / oldMedian : 0.0;
+      benchmark["baseline"]["regression"] = regression;
+      if (regression)
+        regressions++;
+    }
+
+    output["benchmarks"].push_back(benchmark);
+  }
+
+  output["regressions"] = regressions;
+  return CJSONVariantWriter::Write(output, false);
+}
@@ -0,0 +1,209 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*!
+ \brief Per run state handed to a benchmark function
+
+ A benchmark does its setup, then loops while KeepRunning() returns true.
+ Only the time spent inside that loop is measured, the runner decides how
+ many iterations a sample needs.
+
+ \code
+ BENCHMARK(StringUtils, ToLower)
+ {
+   std::string input = "SOME MIXED Case String";
+   while (state.KeepRunning())
+   {
+     std::string copy(input);
+     StringUtils::ToLower(copy);
+   }
+   state.SetBytesProcessed(input.size());
+ }
+ \endcode
+ */
+class CBenchmarkState
+{
+public:
+  CBenchmarkState(uint64_t iterations);
+
+  /*!
+   \brief Advance to the next iteration, starts the clock on the first call
+   \return false once all iterations of this sample have been run
+   */
+  bool KeepRunning()
+  {
+    if (m_remaining == (int64_t)m_iterations)
+      ResumeTiming();
+    if (m_remaining-- > 0)
+      return true;
+    PauseTiming();
+    m_remaining = 0;
+    return false;
+  }
+
+  /*!
+   \brief Exclude the following code from the measurement, e.g. to reset state
+   */
+  void PauseTiming();
+  void ResumeTiming();
+
+  /*!
+   \brief Bytes handled by one iteration, reported as throughput
+   */
+  void SetBytesProcessed(uint64_t bytes) { m_bytes = bytes; }
+
+  /*!
+   \brief Items (jobs, entries, ...) handled by one iteration, reported as throughput
+   */
+  void SetItemsProcessed(uint64_t items) { m_items = items; }
+
+  /*!
+   \brief Mark the run as failed, e.g. because the result of an operation was wrong
+   */
+  void SetError(const std::string &error) { m_error = error; }
+
+  uint64_t Iterations() const { return m_iterations; }
+  uint64_t ElapsedNanoseconds() const;
+  uint64_t BytesProcessed() const { return m_bytes; }
+  uint64_t ItemsProcessed() const { return m_items; }
+  const std::string &GetError() const { return m_error; }
+
+private:
+  uint64_t m_iterations;
+  int64_t m_remaining;
+  int64_t m_started;
+  int64_t m_elapsed;
+  bool m_running;
+  uint64_t m_bytes;
+  uint64_t m_items;
+  std::string m_error;
+};
+
+typedef void (*BenchmarkFunction)(CBenchmarkState &state);
+
+struct BenchmarkInfo
+{
+  std::string group;
+  std::string name;
+  BenchmarkFunction function;
+};
+
+/*!
+ \brief Global list of benchmarks, filled by BENCHMARK() during static initialisation
+ */
+class CBenchmarkRegistry
+{
+public:
+  static std::vector<BenchmarkInfo> &GetBenchmarks();
+};
+
+class CBenchmarkRegistration
+{
+public:
+  CBenchmarkRegistration(const char *group, const char *name, BenchmarkFunction function);
+};
+
+/*!
+ \brief Define and register a benchmark, the body gets a CBenchmarkState &state
+ */
+#define BENCHMARK(group, name) \
+  static void Benchmark_##group##_##name(CBenchmarkState &state); \
+  static CBenchmarkRegistration BenchmarkRegistration_##group##_##name(#group, #name, Benchmark_##group##_##name); \
+  static void Benchmark_##group##_##name(CBenchmarkState &state)
+
+/*!
+ \brief Keep the compiler from optimising away a result that is otherwise unused
+ */
+template<typename T> inline void BenchmarkUse(const T &value)
+{
+#if defined(__GNUC__)
+  __asm__ __volatile__("" : : "r"(&value) : "memory");
+#else
+  static volatile char sink;
+  sink = *(const volatile char *)&value;
+#endif
+}
+
+/*!
+ \brief Result of running one benchmark, all times are per iteration
+ */
+struct BenchmarkResult
+{
+  std::string name;
+  std::string error;
+  uint64_t iterations; ///< iterations per sample
+  unsigned int samples;
+  double min;
+  double median;
+  double mean;
+  double stddev;
+  double ci95;         ///< half width of the 95% confidence interval of the mean
+  double mad;          ///< median absolute deviation
+  unsigned int outliers;
+  double bytesPerSecond;
+  double itemsPerSecond;
+};
+
+/*!
+ \brief Runs registered benchmarks with enough repetitions for stable numbers
+
+ Every benchmark is first calibrated, i.e. the number of iterations is
+ raised until one sample takes at least the minimum sample time. Then a
+ fixed number of samples is taken, reporting robust (median, MAD) as well
+ as classic (mean, standard deviation, confidence interval) statistics.
+ */
+class CBenchmarkRunner
+{
+public:
+  CBenchmarkRunner();
+
+  void SetFilter(const std::string &filter) { m_filter = filter; }
+  void SetSamples(unsigned int samples) { m_samples = samples < 2 ? 2 : samples; }
+  void SetMinSampleTime(unsigned int milliseconds) { m_minSampleTime = (uint64_t)milliseconds * 1000000; }
+
+  /*!
+   \brief Whether the benchmark called group/name is selected by the filter
+   */
+  bool Matches(const BenchmarkInfo &benchmark) const;
+
+  BenchmarkResult Run(const BenchmarkInfo &benchmark);
+  std::vector<BenchmarkResult> RunAll();
+
+  /*!
+   \brief Serialize results (and the comparison against a baseline) to JSON
+   \param results Results of RunAll()
+   \param baseline JSON written by an earlier run, may be empty
+   \param threshold Relative slowdown (e.g. 0.05) counted as a regression
+   \param regressions Number of benchmarks that got significantly slower
+   */
+  std::string ToJSON(const std::vector<BenchmarkResult> &results, const std::string &baseline, double threshold, unsigned int &regressions) const;
+
+private:
+  CBenchmarkState RunSample(const BenchmarkInfo &benchmark, uint64_t iterations);
+
+  std::string m_filter;
+  unsigned int m_samples;
+  uint64_t m_minSampleTime;
+};
@@ -0,0 +1,156 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Benchmark.h"
+
+#include "threads/Thread.h"
+#include "utils/JobManager.h"
+#include "commons/ilog.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+class NullLogger : public XbmcCommons::ILogger
+{
+public:
+  void log(int loglevel, const char* message) {}
+};
+
+static void Usage(const char *program)
+{
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --list                 list the available benchmarks\n"
+          "  --filter=<substring>   only run benchmarks whose group/name contains substring\n"
+          "  --samples=<n>          number of samples per benchmark (default 15)\n"
+          "  --min-time=<ms>        minimum duration of a single sample (default 20)\n"
+          "  --output=<file>        write the JSON results to file instead of stdout\n"
+          "  --baseline=<file>      compare against the JSON results of an earlier run\n"
+          "  --threshold=<percent>  slowdown counted as a regression (default 5)\n",
+          program);
+}
+
+static bool ReadFile(const char *path, std::string &content)
+{
+  FILE *file = fopen(path, "rb");
+  if (file == NULL)
+    return false;
+
+  char buffer[4096];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    content.append(buffer, read);
+  fclose(file);
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  CBenchmarkRunner runner;
+  const char *output = NULL;
+  const char *baselineFile = NULL;
+  double threshold = 0.05;
+  bool list = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    if (strcmp(arg, "--list") == 0)
+      list = true;
+    else if (strncmp(arg, "--filter=", 9) == 0)
+      runner.SetFilter(arg + 9);
+    else if (strncmp(arg, "--samples=", 10) == 0)
+      runner.SetSamples(atoi(arg + 10));
+    else if (strncmp(arg, "--min-time=", 11) == 0)
+      runner.SetMinSampleTime(atoi(arg + 11));
+    else if (strncmp(arg, "--output=", 9) == 0)
+      output = arg + 9;
+    else if (strncmp(arg, "--baseline=", 11) == 0)
+      baselineFile = arg + 11;
+    else if (strncmp(arg, "--threshold=", 12) == 0)
+      threshold = atof(arg + 12) / 100;
+    else
+    {
+      Usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (list)
+  {
+    const std::vector<BenchmarkInfo> &benchmarks = CBenchmarkRegistry::GetBenchmarks();
+    for (std::vector<BenchmarkInfo>::const_iterator it = benchmarks.begin(); it != benchmarks.end(); ++it)
+    {
+      if (runner.Matches(*it))
+        printf("%s/%s\n", it->group.c_str(), it->name.c_str());
+    }
+    return EXIT_SUCCESS;
+  }
+
+  std::string baseline;
+  if (baselineFile != NULL && !ReadFile(baselineFile, baseline))
+  {
+    fprintf(stderr, "Unable to read baseline %s\n", baselineFile);
+    return EXIT_FAILURE;
+  }
+
+  // we need to configure CThread to use a dummy logger
+  NullLogger* nullLogger = new NullLogger();
+  CThread::SetLogger(nullLogger);
+
+  std::vector<BenchmarkResult> results = runner.RunAll();
+
+  // don't leave workers of the job benchmarks running into static destruction
+  CJobManager::GetInstance().CancelJobs();
+
+  unsigned int regressions = 0;
+  std::string json = runner.ToJSON(results, baseline, threshold, regressions);
+
+  int ret = EXIT_SUCCESS;
+  if (output != NULL)
+  {
+    FILE *file = fopen(output, "wb");
+    if (file == NULL || fwrite(json.c_str(), 1, json.size(), file) != json.size())
+    {
+      fprintf(stderr, "Unable to write %s\n", output);
+      ret = EXIT_FAILURE;
+    }
+    if (file != NULL)
+      fclose(file);
+  }
+  else
+    printf("%s\n", json.c_str());
+
+  for (std::vector<BenchmarkResult>::const_iterator it = results.begin(); it != results.end(); ++it)
+  {
+    if (!it->error.empty())
+      ret = EXIT_FAILURE;
+  }
+  if (regressions > 0)
+  {
+    fprintf(stderr, "%u benchmark(s) regressed against %s\n", regressions, baselineFile);
+    ret = EXIT_FAILURE;
+  }
+
+  delete nullLogger;
+
+  return ret;
+}
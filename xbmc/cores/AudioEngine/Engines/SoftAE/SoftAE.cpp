@@ -26,6 +26,7 @@
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
 #include "utils/MathUtils.h"
+#include "utils/Trace.h"
 #include "utils/EndianSwap.h"
 #include "threads/SingleLock.h"
 #include "settings/AdvancedSettings.h"
@@ -1063,12 +1064,17 @@ void CSoftAE::Run()
     bool restart = false;
 
     /* with the new non blocking implementation - we just reOpen here, when it tells reOpen */
-    if ((this->*m_outputStageFn)(hasAudio) > 0)
-      hasAudio = false; /* taken some audio - reset our silence flag */
+    {
+      TRACE_SCOPE("audio", "SoftAE output stage");
+      if ((this->*m_outputStageFn)(hasAudio) > 0)
+        hasAudio = false; /* taken some audio - reset our silence flag */
+    }
 
     /* if we have enough room in the buffer */
     if (m_buffer.Free() >= m_frameSize)
     {
+      TRACE_SCOPE("audio", "SoftAE stream stage");
+
       /* take some data for our use from the buffer */
       uint8_t *out = (uint8_t*)m_buffer.Take(m_frameSize);
       memset(out, 0, m_frameSize);
@@ -30,6 +30,7 @@
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
 #include "utils/MathUtils.h"
+#include "utils/Trace.h"
 #include "cores/AudioEngine/AEFactory.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 
@@ -533,9 +534,12 @@ void CDVDPlayerAudio::Process()
 
   while (!m_bStop)
   {
-    //Don't let anybody mess with our global variables
-    result = DecodeFrame(audioframe, m_speed > DVD_PLAYSPEED_NORMAL || m_speed < 0 ||
-                         CAEFactory::IsSuspended()); // blocks if no audio is available, but leaves critical section before doing so
+    {
+      TRACE_SCOPE("dvdplayer", "audio DecodeFrame");
+      //Don't let anybody mess with our global variables
+      result = DecodeFrame(audioframe, m_speed > DVD_PLAYSPEED_NORMAL || m_speed < 0 ||
+                           CAEFactory::IsSuspended()); // blocks if no audio is available, but leaves critical section before doing so
+    }
 
     UpdatePlayerInfo();
 
@@ -601,6 +605,7 @@ void CDVDPlayerAudio::Process()
       //frame should be dropped. Don't let audio move ahead of the current time thou
       //we need to be able to start playing at any time
       //when playing backwords, we try to keep as small buffers as possible
+      TRACE_INSTANT("dvdplayer", "audio frame dropped");
 
       if(m_droptime == 0.0)
         m_droptime = m_pClock->GetAbsoluteClock();
@@ -617,6 +622,7 @@ void CDVDPlayerAudio::Process()
       SetSyncType(audioframe.passthrough);
 
       // add any packets play
+      TRACE_SCOPE("dvdplayer", "audio OutputPacket");
       packetadded = OutputPacket(audioframe);
 
       // we are not running until something is cached in output device
@@ -45,6 +45,7 @@
 #include <iterator>
 #include "guilib/GraphicContext.h"
 #include "utils/log.h"
+#include "utils/Trace.h"
 
 using namespace std;
 
@@ -549,7 +550,11 @@ void CDVDPlayerVideo::Process()
 
       mFilters = m_pVideoCodec->SetFilters(mFilters);
 
-      int iDecoderState = m_pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+      int iDecoderState;
+      {
+        TRACE_SCOPE("dvdplayer", "video Decode");
+        iDecoderState = m_pVideoCodec->Decode(pPacket->pData, pPacket->iSize, pPacket->dts, pPacket->pts);
+      }
 
       // buffer packets so we can recover should decoder flush for some reason
       if(m_pVideoCodec->GetConvergeCount() > 0)
@@ -684,7 +689,11 @@ void CDVDPlayerVideo::Process()
             if (picture.iRepeatPicture)
               picture.iDuration *= picture.iRepeatPicture + 1;
 
-            int iResult = OutputPicture(&picture, pts);
+            int iResult;
+            {
+              TRACE_SCOPE("dvdplayer", "video OutputPicture");
+              iResult = OutputPicture(&picture, pts);
+            }
 
             if(m_started == false)
             {
@@ -709,6 +718,7 @@ void CDVDPlayerVideo::Process()
 
             if( (iResult & EOS_DROPPED) && !bPacketDrop )
             {
+              TRACE_INSTANT("dvdplayer", "video frame dropped");
               m_iDroppedFrames++;
               iDropped++;
             }
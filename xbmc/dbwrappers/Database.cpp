@@ -25,11 +25,14 @@
 #include "filesystem/File.h"
 #include "profiles/ProfilesManager.h"
 #include "utils/AutoPtrHandle.h"
+#include "utils/DatabaseUtils.h"
 #include "utils/log.h"
 #include "utils/SortUtils.h"
 #include "utils/URIUtils.h"
+#include "utils/StringUtils.h"
 #include "sqlitedataset.h"
 #include "DatabaseManager.h"
+#include "DatabaseReadPool.h"
 #include "DbUrl.h"
 
 #ifdef HAS_MYSQL
@@ -40,6 +43,7 @@ using namespace AUTOPTR;
 using namespace dbiplus;
 
 #define MAX_COMPRESS_COUNT 20
+#define WAL_AUTOCHECKPOINT "10000" // pages the log may grow to before a commit checkpoints it, see CDatabaseReadPool
 
 void CDatabase::Filter::AppendField(const std::string &strField)
 {
@@ -104,9 +108,34 @@ CDatabase::CDatabase(void)
 {
   m_openCount = 0;
   m_sqlite = true;
+  m_wal = false;
   m_bMultiWrite = false;
 }
 
+CDatabase::CReadDataset::CReadDataset(CDatabase &db)
+  : m_leased(NULL), m_ds(db.m_pDS.get())
+{
+  if (!db.m_wal || db.InTransaction())
+    return;
+
+  m_leased = CDatabaseReadPool::Get().Acquire(*db.m_pDB);
+  if (m_leased)
+  {
+    m_leasedDS.reset(m_leased->CreateDataset());
+    m_ds = m_leasedDS.get();
+  }
+}
+
+CDatabase::CReadDataset::~CReadDataset()
+{
+  if (m_leased)
+  {
+    m_leasedDS->close();
+    m_leasedDS.reset();
+    CDatabaseReadPool::Get().Release(m_leased);
+  }
+}
+
 CDatabase::~CDatabase(void)
 {
   Close();
@@ -204,6 +233,23 @@ CStdString CDatabase::GetSingleValue(const CStdString &strTable, const CStdStrin
   return GetSingleValue(query, m_pDS);
 }
 
+std::string CDatabase::GetFullTextHits(const std::string &index, const std::string &search, const std::string &column /* = "" */, const std::string &weights /* = "" */)
+{
+  if (!m_sqlite)
+    return "";
+
+  std::string match = DatabaseUtils::BuildFullTextQuery(search, column);
+  if (match.empty())
+    return "";
+
+  // the index is missing if this sqlite was built without full-text search
+  if (GetSingleValue(PrepareSQL("SELECT name FROM sqlite_master WHERE type='table' AND name='%s'", index.c_str())).empty())
+    return "";
+
+  return PrepareSQL("(SELECT docid, fts_rank(matchinfo(%s)%s%s) AS score FROM %s WHERE %s MATCH '%s') AS hits",
+                    index.c_str(), weights.empty() ? "" : ", ", weights.c_str(), index.c_str(), index.c_str(), match.c_str());
+}
+
 CStdString CDatabase::GetSingleValue(const CStdString &query)
 {
   return GetSingleValue(query, m_pDS);
@@ -244,6 +290,26 @@ bool CDatabase::ExecuteQuery(const CStdString &strQuery)
   return bReturn;
 }
 
+bool CDatabase::ExecuteQuery(const CStdString &strQuery, const query_params &params)
+{
+  bool bReturn = false;
+
+  try
+  {
+    if (NULL == m_pDB.get()) return bReturn;
+    if (NULL == m_pDS.get()) return bReturn;
+    m_pDS->exec(strQuery, params);
+    bReturn = true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to execute query '%s'",
+        __FUNCTION__, strQuery.c_str());
+  }
+
+  return bReturn;
+}
+
 bool CDatabase::ResultQuery(const CStdString &strQuery)
 {
   bool bReturn = false;
@@ -266,6 +332,26 @@ bool CDatabase::ResultQuery(const CStdString &strQuery)
   return bReturn;
 }
 
+bool CDatabase::ResultQuery(const CStdString &strQuery, const query_params &params)
+{
+  bool bReturn = false;
+
+  try
+  {
+    if (NULL == m_pDB.get()) return bReturn;
+    if (NULL == m_pDS.get()) return bReturn;
+
+    bReturn = m_pDS->query(strQuery, params);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to execute query '%s'",
+        __FUNCTION__, strQuery.c_str());
+  }
+
+  return bReturn;
+}
+
 bool CDatabase::QueueInsertQuery(const CStdString &strQuery)
 {
   if (strQuery.IsEmpty())
@@ -498,6 +584,14 @@ bool CDatabase::Connect(const CStdString &dbName, const DatabaseSettings &dbSett
       m_pDS->exec("PRAGMA cache_size=4096\n");
       m_pDS->exec("PRAGMA synchronous='NORMAL'\n");
       m_pDS->exec("PRAGMA count_changes='OFF'\n");
+
+      // the journal mode is stored in the database file, so only switch it when the setting
+      // changed. Leaving the log needs exclusive access and may only succeed on a later open.
+      m_wal = StringUtils::EqualsNoCase(GetSingleValue("PRAGMA journal_mode", m_pDS), "wal");
+      if (m_wal != g_advancedSettings.m_sqliteWAL)
+        m_wal = StringUtils::EqualsNoCase(GetSingleValue(g_advancedSettings.m_sqliteWAL ? "PRAGMA journal_mode=WAL" : "PRAGMA journal_mode=DELETE", m_pDS), "wal");
+      if (m_wal)
+        m_pDS->exec("PRAGMA wal_autocheckpoint=" WAL_AUTOCHECKPOINT "\n");
     }
   }
   catch (DbErrors &error)
@@ -575,6 +669,7 @@ void CDatabase::Close()
   }
 
   m_openCount = 0;
+  m_wal = false;
 
   if (NULL == m_pDB.get() ) return ;
   if (NULL != m_pDS.get()) m_pDS->close();
@@ -643,7 +738,11 @@ bool CDatabase::CommitTransaction()
   try
   {
     if (NULL != m_pDB.get())
+    {
       m_pDB->commit_transaction();
+      if (m_wal)
+        CDatabaseReadPool::Get().ScheduleCheckpoint(*m_pDB);
+    }
   }
   catch (...)
   {
@@ -668,7 +767,7 @@ void CDatabase::RollbackTransaction()
 
 bool CDatabase::InTransaction()
 {
-  if (NULL != m_pDB.get()) return false;
+  if (NULL == m_pDB.get()) return false;
   return m_pDB->in_transaction();
 }
 
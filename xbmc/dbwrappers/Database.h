@@ -21,6 +21,7 @@
  */
 
 #include "utils/StdString.h"
+#include "qry_dat.h"
 
 namespace dbiplus {
   class Database;
@@ -57,6 +58,31 @@ public:
     std::string limit;
   };
 
+  /*! \brief A dataset for queries that should not wait on a writer, such as listings.
+
+   With the sqlite write-ahead log enabled it runs on a connection leased from the
+   CDatabaseReadPool for the lifetime of the object, so it only sees committed data.
+   Otherwise, while in a transaction, or when the pool is exhausted it is m_pDS.
+   */
+  class CReadDataset
+  {
+  public:
+    CReadDataset(CDatabase &db);
+    ~CReadDataset();
+
+    dbiplus::Dataset *get() const { return m_ds; }
+    dbiplus::Dataset *operator->() const { return m_ds; }
+
+  private:
+    CReadDataset(const CReadDataset&);
+    CReadDataset const& operator=(CReadDataset const&);
+
+    dbiplus::Database *m_leased;
+    std::auto_ptr<dbiplus::Dataset> m_leasedDS;
+    dbiplus::Dataset *m_ds;
+  };
+  friend class CReadDataset;
+
   CDatabase(void);
   virtual ~CDatabase(void);
   bool IsOpen();
@@ -93,6 +119,17 @@ public:
    */
   std::string GetSingleValue(const std::string &query, std::auto_ptr<dbiplus::Dataset> &ds);
 
+  /*!
+   * @brief Get the rows of a full-text index matching a search as a "hits" subquery.
+   * @remarks Join it on hits.docid and order by hits.score DESC to get the best matches first.
+   * @param index The full-text table to search.
+   * @param search The search string of the user, each word has to match the start of a word in the index.
+   * @param column If set, only search this column of the index.
+   * @param weights If set, comma separated weights of the columns of the index used for ranking.
+   * @return The subquery, empty if the index doesn't exist (e.g. on MySQL) or there is nothing to search for.
+   */
+  std::string GetFullTextHits(const std::string &index, const std::string &search, const std::string &column = "", const std::string &weights = "");
+
   /*!
    * @brief Delete values from a table.
    * @remarks The value of the strWhereClause parameter has to be FormatSQL'ed when used.
@@ -109,6 +146,15 @@ public:
    */
   bool ExecuteQuery(const CStdString &strQuery);
 
+  /*!
+   * @brief Execute a statement that does not return any result, binding values to its ? placeholders.
+   * @remarks Unlike FormatSQL'ed queries, the statement text stays the same for all values and is only prepared once.
+   * @param strQuery The statement to execute.
+   * @param params The values of the placeholders, in order. Strings must not be escaped.
+   * @return True if the statement was executed successfully, false otherwise.
+   */
+  bool ExecuteQuery(const CStdString &strQuery, const dbiplus::query_params &params);
+
   /*!
    * @brief Execute a query that returns a result.
    * @remarks Call m_pDS->close(); to clean up the dataset when done.
@@ -117,6 +163,15 @@ public:
    */
   bool ResultQuery(const CStdString &strQuery);
 
+  /*!
+   * @brief Execute a query that returns a result, binding values to its ? placeholders.
+   * @remarks Call m_pDS->close(); to clean up the dataset when done.
+   * @param strQuery The query to execute.
+   * @param params The values of the placeholders, in order. Strings must not be escaped.
+   * @return True if the query was executed successfully, false otherwise.
+   */
+  bool ResultQuery(const CStdString &strQuery, const dbiplus::query_params &params);
+
   /*!
    * @brief Open a new dataset.
    * @return True if the dataset was created successfully, false otherwise.
@@ -161,6 +216,7 @@ protected:
   bool BuildSQL(const CStdString &strQuery, const Filter &filter, CStdString &strSQL);
 
   bool m_sqlite; ///< \brief whether we use sqlite (defaults to true)
+  bool m_wal;    ///< \brief whether the sqlite database is in write-ahead-log mode
 
   std::auto_ptr<dbiplus::Database> m_pDB;
   std::auto_ptr<dbiplus::Dataset> m_pDS;
@@ -0,0 +1,213 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DatabaseReadPool.h"
+#include "sqlitedataset.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+
+#include <memory>
+
+using namespace dbiplus;
+
+#define CHECKPOINT_IDLE_MS 2000 // quiet time after the last commit before the log is checkpointed
+
+CDatabaseReadPool::CDatabaseReadPool()
+  : CThread("DatabaseCheckpoint"), m_enabled(true)
+{
+}
+
+CDatabaseReadPool::~CDatabaseReadPool()
+{
+  Deinitialize();
+}
+
+CDatabaseReadPool &CDatabaseReadPool::Get()
+{
+  static CDatabaseReadPool s_pool;
+  return s_pool;
+}
+
+void CDatabaseReadPool::Initialize()
+{
+  CSingleLock lock(m_section);
+  m_enabled = true;
+}
+
+void CDatabaseReadPool::Deinitialize()
+{
+  {
+    // keeps ScheduleCheckpoint from starting the thread again
+    CSingleLock lock(m_section);
+    m_enabled = false;
+  }
+  m_bStop = true;
+  m_commitEvent.Set();
+  StopThread(true);
+
+  CSingleLock lock(m_section);
+  for (std::map<std::string, Pool>::iterator it = m_pools.begin(); it != m_pools.end(); ++it)
+  {
+    for (std::vector<Database*>::iterator db = it->second.idle.begin(); db != it->second.idle.end(); ++db)
+      delete *db;
+    it->second.idle.clear();
+    it->second.checkpoint = false;
+  }
+}
+
+std::string CDatabaseReadPool::GetKey(const Database &db)
+{
+  return std::string(db.getHostName()) + db.getDatabase();
+}
+
+Database *CDatabaseReadPool::Acquire(const Database &writer)
+{
+  std::string key = GetKey(writer);
+  {
+    CSingleLock lock(m_section);
+    if (!m_enabled)
+      return NULL;
+    Pool &pool = m_pools[key];
+    if (!pool.idle.empty())
+    {
+      Database *db = pool.idle.back();
+      pool.idle.pop_back();
+      pool.leased++;
+      return db;
+    }
+    if (pool.leased >= g_advancedSettings.m_sqliteReadConnections)
+      return NULL;
+    pool.leased++;
+  }
+
+  // opening a connection touches the disk, don't hold up the other leases meanwhile
+  std::auto_ptr<SqliteDatabase> db(new SqliteDatabase());
+  db->setReadOnly(true);
+  db->setHostName(writer.getHostName());
+  db->setDatabase(writer.getDatabase());
+  if (db->connect(false) == DB_CONNECTION_OK)
+  {
+    try
+    {
+      std::auto_ptr<Dataset> ds(db->CreateDataset());
+      ds->exec("PRAGMA cache_size=4096\n");
+      return db.release();
+    }
+    catch (DbErrors &error)
+    {
+      CLog::Log(LOGERROR, "%s failed with '%s'", __FUNCTION__, error.getMsg());
+    }
+  }
+  else
+    CLog::Log(LOGERROR, "%s - unable to open %s read-only", __FUNCTION__, key.c_str());
+
+  CSingleLock lock(m_section);
+  m_pools[key].leased--;
+  return NULL;
+}
+
+void CDatabaseReadPool::Release(Database *db)
+{
+  if (db == NULL)
+    return;
+
+  CSingleLock lock(m_section);
+  Pool &pool = m_pools[GetKey(*db)];
+  if (pool.leased > 0)
+    pool.leased--;
+  if (m_enabled)
+    pool.idle.push_back(db);
+  else
+    delete db;
+}
+
+void CDatabaseReadPool::ScheduleCheckpoint(const Database &writer)
+{
+  CSingleLock lock(m_section);
+  if (!m_enabled)
+    return;
+  Pool &pool = m_pools[GetKey(writer)];
+  pool.host = writer.getHostName();
+  pool.name = writer.getDatabase();
+  pool.lastCommit = XbmcThreads::SystemClockMillis();
+  if (!pool.checkpoint)
+  {
+    pool.checkpoint = true;
+    m_commitEvent.Set();
+  }
+
+  if (!IsRunning())
+    Create();
+}
+
+void CDatabaseReadPool::Process()
+{
+  while (!m_bStop)
+  {
+    std::vector< std::pair<std::string, std::string> > due; // host and name of the idle databases
+    unsigned int wait = 0; // until the next pool is due, 0 if none is pending
+    {
+      CSingleLock lock(m_section);
+      unsigned int now = XbmcThreads::SystemClockMillis();
+      for (std::map<std::string, Pool>::iterator it = m_pools.begin(); it != m_pools.end(); ++it)
+      {
+        Pool &pool = it->second;
+        if (!pool.checkpoint)
+          continue;
+
+        unsigned int idle = now - pool.lastCommit;
+        if (idle >= CHECKPOINT_IDLE_MS)
+        {
+          pool.checkpoint = false;
+          due.push_back(std::make_pair(pool.host, pool.name));
+        }
+        else if (wait == 0 || CHECKPOINT_IDLE_MS - idle < wait)
+          wait = CHECKPOINT_IDLE_MS - idle;
+      }
+    }
+
+    for (std::vector< std::pair<std::string, std::string> >::const_iterator it = due.begin(); it != due.end() && !m_bStop; ++it)
+      Checkpoint(it->first, it->second);
+
+    if (!due.empty())
+      continue;
+
+    if (wait > 0)
+      m_commitEvent.WaitMSec(wait);
+    else
+      m_commitEvent.Wait();
+  }
+}
+
+void CDatabaseReadPool::Checkpoint(const std::string &host, const std::string &name)
+{
+  // a passive checkpoint on a connection of its own, it never waits on the readers or the writer
+  SqliteDatabase db;
+  db.setHostName(host.c_str());
+  db.setDatabase(name.c_str());
+  if (db.connect(false) != DB_CONNECTION_OK)
+    return;
+
+  if (db.checkpoint() != SQLITE_OK)
+    CLog::Log(LOGWARNING, "%s - unable to checkpoint %s: %s", __FUNCTION__, name.c_str(), db.getErrorMsg());
+  db.disconnect();
+}
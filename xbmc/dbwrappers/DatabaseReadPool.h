@@ -0,0 +1,109 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+namespace dbiplus {
+  class Database;
+}
+
+/*!
+ \ingroup database
+ \brief Pool of read-only connections to sqlite databases in write-ahead-log mode.
+
+ With the write-ahead log a reader sees the last committed state of the database
+ and neither waits on nor blocks a writer, so a listing can run while a scan is
+ committing. Released connections stay open, keeping their parsed schema and
+ cached statements for the next lease.
+
+ The pool also checkpoints the log once the writers of a database have been quiet
+ for a while, so that commits during a scan rarely pay for copying it back.
+ */
+class CDatabaseReadPool : private CThread
+{
+public:
+  /*!
+   \brief The only way through which the global instance of the CDatabaseReadPool should be accessed.
+   \return the global instance.
+   */
+  static CDatabaseReadPool &Get();
+
+  /*! \brief Enable the pool, after Deinitialize */
+  void Initialize();
+
+  /*! \brief Close all idle connections and stop checkpointing.
+   Until the next Initialize no connections are leased, connections still leased are
+   closed when released and commits don't schedule checkpoints.
+   */
+  void Deinitialize();
+
+  /*! \brief Lease a read-only connection to the database of a writer.
+   \param writer the connection of the writer, only its host and database name are used.
+   \return a connected database, or NULL if all connections of the pool are leased or the pool is deinitialized.
+   \sa Release
+   */
+  dbiplus::Database *Acquire(const dbiplus::Database &writer);
+
+  /*! \brief Return a connection obtained from Acquire to the pool.
+   All datasets created on it must have been destroyed.
+   \param db the leased connection.
+   */
+  void Release(dbiplus::Database *db);
+
+  /*! \brief Checkpoint the log of a database once it has been idle for a while.
+   \param writer the connection that committed to the database.
+   */
+  void ScheduleCheckpoint(const dbiplus::Database &writer);
+
+private:
+  // private construction, and no assignements; use the provided singleton methods
+  CDatabaseReadPool();
+  CDatabaseReadPool(const CDatabaseReadPool&);
+  CDatabaseReadPool const& operator=(CDatabaseReadPool const&);
+  virtual ~CDatabaseReadPool();
+
+  virtual void Process();
+  void Checkpoint(const std::string &host, const std::string &name);
+
+  static std::string GetKey(const dbiplus::Database &db);
+
+  struct Pool
+  {
+    Pool() : leased(0), lastCommit(0), checkpoint(false) {}
+    std::string host;
+    std::string name;
+    std::vector<dbiplus::Database*> idle;
+    unsigned int leased;
+    unsigned int lastCommit; ///< time of the last commit in ms, see XbmcThreads::SystemClockMillis()
+    bool checkpoint;         ///< whether the log needs a checkpoint once the database is idle
+  };
+
+  CCriticalSection m_section;          ///< Critical section protecting m_pools.
+  std::map<std::string, Pool> m_pools; ///< Pools by database file.
+  CEvent m_commitEvent;                ///< Wakes the checkpoint thread on the first commit after a checkpoint.
+  bool m_enabled;                      ///< Whether connections are leased and checkpoints scheduled, see Deinitialize.
+};
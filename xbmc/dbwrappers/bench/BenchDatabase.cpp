@@ -0,0 +1,507 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "bench/Benchmark.h"
+#include "dbwrappers/sqlitedataset.h"
+#include "threads/Thread.h"
+#include "utils/StringUtils.h"
+
+#include <memory>
+#include <stdio.h>
+#include <unistd.h>
+
+using namespace dbiplus;
+
+#define LIBRARY_PATHS 1000
+#define LIBRARY_FILES 100000
+#define LIBRARY_MOVIES 10000
+#define LIBRARY_SONGS 50000
+
+/*! \brief A video library with the tables a scan touches, filled with LIBRARY_FILES files */
+static SqliteDatabase *GetLibrary()
+{
+  static SqliteDatabase *library = NULL;
+  static bool created = false;
+  if (created)
+    return library;
+  created = true;
+
+  std::string host = StringUtils::Format("%s/", P_tmpdir);
+  unlink((host + "xbmc-bench-library.db").c_str());
+
+  std::auto_ptr<SqliteDatabase> db(new SqliteDatabase());
+  db->setHostName(host.c_str());
+  db->setDatabase("xbmc-bench-library");
+  if (db->connect(true) != DB_CONNECTION_OK)
+    return NULL;
+
+  try
+  {
+    std::auto_ptr<Dataset> ds(db->CreateDataset());
+    ds->exec("CREATE TABLE path ( idPath integer primary key, strPath text, strContent text, strScraper text, strHash text, scanRecursive integer, useFolderNames bool, strSettings text, noUpdate bool, exclude bool, dateAdded text)");
+    ds->exec("CREATE INDEX ix_path ON path ( strPath(255) )");
+    ds->exec("CREATE TABLE files ( idFile integer primary key, idPath integer, strFilename text, playCount integer, lastPlayed text, dateAdded text)");
+    ds->exec("CREATE INDEX ix_files ON files ( idPath, strFilename(255) )");
+    ds->exec("CREATE TABLE streamdetails (idFile integer, iStreamType integer, "
+      "strVideoCodec text, fVideoAspect float, iVideoWidth integer, iVideoHeight integer, "
+      "strAudioCodec text, iAudioChannels integer, strAudioLanguage text, strSubtitleLanguage text, iVideoDuration integer)");
+    ds->exec("CREATE INDEX ix_streamdetails ON streamdetails (idFile)");
+    std::string columns = "CREATE TABLE movie ( idMovie integer primary key, idFile integer";
+    for (unsigned int i = 0; i < 24; i++)
+      columns += StringUtils::Format(", c%02u text", i);
+    ds->exec(columns + ")");
+    ds->exec("CREATE TABLE song ( idSong integer primary key, idAlbum integer, idPath integer, strArtists text, strGenres text, "
+      "strTitle varchar(512), iTrack integer, iDuration integer, iYear integer, dwFileNameCRC text, strFileName text, "
+      "strMusicBrainzTrackID text, iTimesPlayed integer, iStartOffset integer, iEndOffset integer, idThumb integer, "
+      "lastplayed varchar(20) default NULL, rating char default '0', comment text)");
+
+    db->start_transaction();
+    query_params params(1);
+    for (unsigned int path = 0; path < LIBRARY_PATHS; path++)
+    {
+      params[0] = StringUtils::Format("smb://server/movies/Collection %u/", path);
+      ds->exec("INSERT INTO path (idPath, strPath, strContent, strScraper) VALUES (NULL,?,'','')", params);
+    }
+    params.resize(2);
+    for (unsigned int file = 0; file < LIBRARY_FILES; file++)
+    {
+      params[0] = (int)(file % LIBRARY_PATHS + 1);
+      params[1] = StringUtils::Format("The Movie %u (%u).mkv", file, 1950 + file % 64);
+      ds->exec("INSERT INTO files (idFile, idPath, strFileName) VALUES (NULL,?,?)", params);
+    }
+    params.resize(25);
+    for (unsigned int movie = 0; movie < LIBRARY_MOVIES; movie++)
+    {
+      params[0] = (int)(movie * (LIBRARY_FILES / LIBRARY_MOVIES) + 1);
+      params[1] = StringUtils::Format("The Movie %u", movie);
+      params[2] = std::string(300, 'p'); // plot
+      params[3] = std::string(60, 'o'); // outline
+      params[4] = StringUtils::Format("Tagline of movie %u", movie);
+      params[5] = (int)(100 + movie % 900); // votes
+      params[6] = 7.4; // rating
+      params[7] = "Some Writer / Another Writer";
+      params[8] = StringUtils::Format("%u", 1950 + movie % 64);
+      params[9] = std::string(150, 't'); // thumbs
+      params[10] = StringUtils::Format("tt%07u", movie);
+      params[11] = StringUtils::Format("The Movie %u", movie);
+      for (unsigned int i = 12; i < 25; i++)
+      {
+        field_value empty("");
+        if (i % 3 == 0)
+          empty.set_isNull();
+        params[i] = empty;
+      }
+      std::string insert = "INSERT INTO movie VALUES (NULL";
+      for (unsigned int i = 0; i < params.size(); i++)
+        insert += ",?";
+      ds->exec(insert + ")", params);
+    }
+    params.resize(16);
+    for (unsigned int song = 0; song < LIBRARY_SONGS; song++)
+    {
+      params[0] = (int)(song / 12 + 1);
+      params[1] = (int)(song % LIBRARY_PATHS + 1);
+      params[2] = StringUtils::Format("Artist %u", song / 120);
+      params[3] = "Rock / Pop";
+      params[4] = StringUtils::Format("Song title number %u", song);
+      params[5] = (int)(song % 12 + 1);
+      params[6] = (int)(180 + song % 120);
+      params[7] = (int)(1960 + song % 50);
+      params[8] = StringUtils::Format("%u", song * 2654435761u);
+      params[9] = StringUtils::Format("%02u - Song title number %u.flac", song % 12 + 1, song);
+      params[10] = "c2d3b1e6-4b0a-4bb5-8b4a-2f5a2b6c1d3e";
+      params[11] = (int)(song % 7);
+      params[12] = 0;
+      params[13] = 0;
+      params[14] = (int)(song % 5);
+      params[15] = "2013-01-01 12:00:00";
+      ds->exec("INSERT INTO song (idSong, idAlbum, idPath, strArtists, strGenres, strTitle, iTrack, iDuration, iYear, "
+        "dwFileNameCRC, strFileName, strMusicBrainzTrackID, iTimesPlayed, iStartOffset, iEndOffset, idThumb, lastplayed) "
+        "VALUES (NULL,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)", params);
+    }
+    db->commit_transaction();
+  }
+  catch (...)
+  {
+    return NULL;
+  }
+
+  library = db.release();
+  return library;
+}
+
+/*!
+ \brief Rescan files already in the library: look up path and file, replace the stream details
+ \param bind true to bind the values, false to format them into the statements
+ */
+static void ScanBenchmark(CBenchmarkState &state, bool bind)
+{
+  SqliteDatabase *db = GetLibrary();
+  if (db == NULL)
+  {
+    state.SetError("failed to create the library");
+    return;
+  }
+
+  std::auto_ptr<Dataset> ds(db->CreateDataset());
+  unsigned int file = 0;
+  db->start_transaction();
+  try
+  {
+    while (state.KeepRunning())
+    {
+      file = (file + 7919) % LIBRARY_FILES; // prime stride, visits every file
+      std::string path = StringUtils::Format("smb://server/movies/Collection %u/", file % LIBRARY_PATHS);
+      std::string name = StringUtils::Format("The Movie %u (%u).mkv", file, 1950 + file % 64);
+
+      int idPath, idFile;
+      if (bind)
+      {
+        query_params params(1, path);
+        ds->query("select idPath from path where strPath=?", params);
+        idPath = ds->fv(0).get_asInt();
+
+        params[0] = name;
+        params.push_back(idPath);
+        ds->query("select idFile from files where strFileName=? and idPath=?", params);
+        idFile = ds->fv(0).get_asInt();
+
+        params.assign(1, idFile);
+        ds->exec("DELETE FROM streamdetails WHERE idFile = ?", params);
+        params.push_back(0);
+        params.push_back("h264");
+        params.push_back(1.78f);
+        params.push_back(1920);
+        params.push_back(1080);
+        params.push_back(5400);
+        ds->exec("INSERT INTO streamdetails "
+          "(idFile, iStreamType, strVideoCodec, fVideoAspect, iVideoWidth, iVideoHeight, iVideoDuration) "
+          "VALUES (?,?,?,?,?,?,?)", params);
+      }
+      else
+      {
+        ds->query(db->prepare("select idPath from path where strPath='%s'", path.c_str()).c_str());
+        idPath = ds->fv(0).get_asInt();
+
+        ds->query(db->prepare("select idFile from files where strFileName='%s' and idPath=%i", name.c_str(), idPath).c_str());
+        idFile = ds->fv(0).get_asInt();
+
+        ds->exec(db->prepare("DELETE FROM streamdetails WHERE idFile = %i", idFile));
+        ds->exec(db->prepare("INSERT INTO streamdetails "
+          "(idFile, iStreamType, strVideoCodec, fVideoAspect, iVideoWidth, iVideoHeight, iVideoDuration) "
+          "VALUES (%i,%i,'%s',%f,%i,%i,%i)", idFile, 0, "h264", 1.78f, 1920, 1080, 5400));
+      }
+
+      if (idFile != (int)file + 1)
+      {
+        state.SetError(StringUtils::Format("found file %i instead of %u", idFile, file + 1));
+        break;
+      }
+    }
+  }
+  catch (...)
+  {
+    state.SetError(db->getErrorMsg());
+  }
+  ds->close();
+  db->commit_transaction();
+  state.SetItemsProcessed(1);
+}
+
+BENCHMARK(Database, ScanFormatted)
+{
+  ScanBenchmark(state, false);
+}
+
+BENCHMARK(Database, ScanBound)
+{
+  ScanBenchmark(state, true);
+}
+
+/*!
+ \brief Fetch a whole listing and read every value of every row, like the GetDetailsFor* helpers do
+ \param sql the listing query
+ \param cursor true to step through the rows with a forward-only cursor
+ */
+static void ListBenchmark(CBenchmarkState &state, const char *sql, bool cursor)
+{
+  SqliteDatabase *db = GetLibrary();
+  if (db == NULL)
+  {
+    state.SetError("failed to create the library");
+    return;
+  }
+
+  std::auto_ptr<Dataset> ds(db->CreateDataset());
+  uint64_t rows = 0;
+  try
+  {
+    while (state.KeepRunning())
+    {
+      rows = 0;
+      if (cursor)
+        ds->query_cursor(sql);
+      else
+        ds->query(sql);
+      while (!ds->eof())
+      {
+        const sql_record* const record = ds->get_sql_record();
+        for (unsigned int i = 0; i < record->size(); i++)
+          BenchmarkUse(record->at(i).get_asString());
+        rows++;
+        ds->next();
+      }
+      ds->close();
+    }
+  }
+  catch (...)
+  {
+    state.SetError(db->getErrorMsg());
+  }
+  state.SetItemsProcessed(rows);
+}
+
+#define LIST_MOVIES "SELECT movie.*, files.strFileName, path.strPath, files.playCount, files.lastPlayed " \
+  "FROM movie JOIN files ON files.idFile=movie.idFile JOIN path ON path.idPath=files.idPath"
+#define LIST_SONGS "SELECT song.*, path.strPath FROM song JOIN path ON path.idPath=song.idPath"
+
+BENCHMARK(Database, ListMovies)
+{
+  ListBenchmark(state, LIST_MOVIES, false);
+}
+
+BENCHMARK(Database, ListMoviesCursor)
+{
+  ListBenchmark(state, LIST_MOVIES, true);
+}
+
+BENCHMARK(Database, ListSongs)
+{
+  ListBenchmark(state, LIST_SONGS, false);
+}
+
+BENCHMARK(Database, ListSongsCursor)
+{
+  ListBenchmark(state, LIST_SONGS, true);
+}
+
+/*! \brief Keeps adding files in transactions of 50 like a scan does, until stopped */
+class CScanWriter : public IRunnable
+{
+public:
+  CScanWriter(SqliteDatabase &db, volatile bool &stop) : m_db(db), m_stop(stop) {}
+  virtual void Run()
+  {
+    std::auto_ptr<Dataset> ds(m_db.CreateDataset());
+    query_params params(2);
+    unsigned int file = 0;
+    try
+    {
+      while (!m_stop)
+      {
+        m_db.start_transaction();
+        for (unsigned int i = 0; i < 50; i++, file++)
+        {
+          params[0] = (int)(file % LIBRARY_PATHS + 1);
+          params[1] = StringUtils::Format("Scanned %u.mkv", file);
+          ds->exec("INSERT INTO files (idFile, idPath, strFileName) VALUES (NULL,?,?)", params);
+        }
+        m_db.commit_transaction();
+      }
+    }
+    catch (...)
+    {
+      m_db.rollback_transaction();
+    }
+  }
+private:
+  SqliteDatabase &m_db;
+  volatile bool &m_stop;
+};
+
+/*!
+ \brief List the files of a path while another connection keeps committing, the time per iteration is the reader latency
+ \param wal true for the write-ahead log and a read-only reader, false for the rollback journal
+ */
+static void ReadWhileScanningBenchmark(CBenchmarkState &state, bool wal)
+{
+  std::string host = StringUtils::Format("%s/", P_tmpdir);
+  std::string name = wal ? "xbmc-bench-wal" : "xbmc-bench-rollback";
+  const char *suffixes[] = { ".db", ".db-wal", ".db-shm", ".db-journal" };
+  for (unsigned int i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++)
+    unlink((host + name + suffixes[i]).c_str());
+
+  SqliteDatabase writer;
+  writer.setHostName(host.c_str());
+  writer.setDatabase(name.c_str());
+  SqliteDatabase reader;
+  reader.setReadOnly(wal);
+  reader.setHostName(host.c_str());
+  reader.setDatabase(name.c_str());
+  if (writer.connect(true) != DB_CONNECTION_OK)
+  {
+    state.SetError("failed to create the database");
+    return;
+  }
+
+  try
+  {
+    std::auto_ptr<Dataset> ds(writer.CreateDataset());
+    ds->exec(wal ? "PRAGMA journal_mode=WAL" : "PRAGMA journal_mode=DELETE");
+    ds->exec("PRAGMA synchronous='NORMAL'");
+    ds->exec("CREATE TABLE path ( idPath integer primary key, strPath text)");
+    ds->exec("CREATE TABLE files ( idFile integer primary key, idPath integer, strFilename text, playCount integer, lastPlayed text, dateAdded text)");
+    ds->exec("CREATE INDEX ix_files ON files ( idPath, strFilename(255) )");
+    writer.start_transaction();
+    query_params params(2);
+    for (unsigned int file = 0; file < LIBRARY_FILES / 10; file++)
+    {
+      params[0] = (int)(file % LIBRARY_PATHS + 1);
+      params[1] = StringUtils::Format("The Movie %u (%u).mkv", file, 1950 + file % 64);
+      ds->exec("INSERT INTO files (idFile, idPath, strFileName) VALUES (NULL,?,?)", params);
+    }
+    writer.commit_transaction();
+  }
+  catch (...)
+  {
+    state.SetError(writer.getErrorMsg());
+    return;
+  }
+
+  if (reader.connect(false) != DB_CONNECTION_OK)
+  {
+    state.SetError("failed to open the database for reading");
+    return;
+  }
+
+  volatile bool stop = false;
+  CScanWriter scan(writer, stop);
+  CThread thread(&scan, "BenchmarkScan");
+  thread.Create();
+
+  std::auto_ptr<Dataset> ds(reader.CreateDataset());
+  unsigned int path = 0;
+  try
+  {
+    query_params params(1);
+    while (state.KeepRunning())
+    {
+      path = (path + 7) % LIBRARY_PATHS;
+      params[0] = (int)(path + 1);
+      ds->query("SELECT idFile, strFileName FROM files WHERE idPath=? ORDER BY strFileName", params);
+      while (!ds->eof())
+      {
+        BenchmarkUse(ds->fv(1).get_asString());
+        ds->next();
+      }
+      ds->close();
+    }
+  }
+  catch (...)
+  {
+    state.SetError(reader.getErrorMsg());
+  }
+  ds.reset();
+
+  stop = true;
+  thread.StopThread();
+  reader.disconnect();
+  writer.disconnect();
+}
+
+BENCHMARK(Database, ReadWhileScanningRollback)
+{
+  ReadWhileScanningBenchmark(state, false);
+}
+
+BENCHMARK(Database, ReadWhileScanningWAL)
+{
+  ReadWhileScanningBenchmark(state, true);
+}
+
+/*!
+ \brief Search the song titles of the library for a word, the time per iteration is the search latency
+ \param fullText true to search a full-text index of the titles, false to scan them with LIKE
+ */
+static void SearchBenchmark(CBenchmarkState &state, bool fullText)
+{
+  SqliteDatabase *db = GetLibrary();
+  if (db == NULL)
+  {
+    state.SetError("failed to create the library");
+    return;
+  }
+
+  std::auto_ptr<Dataset> ds(db->CreateDataset());
+  static bool indexed = false;
+  if (fullText && !indexed)
+  {
+    try
+    {
+      ds->exec("CREATE VIRTUAL TABLE songsearch USING fts4(title, artist, prefix=\"2,3\")");
+      ds->exec("INSERT INTO songsearch(docid, title, artist) SELECT idSong, strTitle, strArtists FROM song");
+      indexed = true;
+    }
+    catch (...)
+    {
+      state.SetError(db->getErrorMsg());
+      return;
+    }
+  }
+
+  uint64_t rows = 0;
+  unsigned int search = 0;
+  try
+  {
+    while (state.KeepRunning())
+    {
+      search = (search + 7919) % LIBRARY_SONGS;
+      std::string sql;
+      if (fullText)
+        sql = StringUtils::Format("SELECT song.* FROM (SELECT docid, fts_rank(matchinfo(songsearch), 4, 1) AS score FROM songsearch "
+                                  "WHERE songsearch MATCH 'title:%u*') AS hits JOIN song ON song.idSong=hits.docid ORDER BY hits.score DESC", search);
+      else
+        sql = StringUtils::Format("SELECT song.* FROM song WHERE strTitle LIKE '%u%%' OR strTitle LIKE '%% %u%%'", search, search);
+      ds->query(sql.c_str());
+      while (!ds->eof())
+      {
+        BenchmarkUse(ds->fv(0).get_asInt());
+        rows++;
+        ds->next();
+      }
+      ds->close();
+    }
+  }
+  catch (...)
+  {
+    state.SetError(db->getErrorMsg());
+  }
+  state.SetItemsProcessed(rows);
+}
+
+BENCHMARK(Database, SearchLike)
+{
+  SearchBenchmark(state, false);
+}
+
+BENCHMARK(Database, SearchFullText)
+{
+  SearchBenchmark(state, true);
+}
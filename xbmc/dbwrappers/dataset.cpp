@@ -193,6 +193,60 @@ void Dataset::parse_sql(string &sql) {
 }
 
 
+string Dataset::bind_params(const string &sql, const query_params &params) {
+  string result;
+  unsigned int param = 0;
+  bool literal = false;
+  for (size_t pos = 0; pos < sql.size(); pos++)
+  {
+    if (sql[pos] == '\'')
+      literal = !literal;
+    if (sql[pos] != '?' || literal)
+    {
+      result += sql[pos];
+      continue;
+    }
+
+    if (param == params.size())
+      throw DbErrors("Missing value for parameter %u of %s", param + 1, sql.c_str());
+    const field_value &value = params[param++];
+    if (value.get_isNull())
+      result += "NULL";
+    else switch (value.get_fType())
+    {
+      case ft_Boolean:
+        result += value.get_asBool() ? "1" : "0";
+        break;
+      case ft_Short:
+      case ft_UShort:
+      case ft_Int:
+      case ft_UInt:
+      case ft_Int64:
+        result += value.get_asString();
+        break;
+      case ft_Float:
+      case ft_Double:
+        result += db->prepare("%f", value.get_asDouble());
+        break;
+      default:
+        result += db->prepare("'%s'", value.get_asString().c_str());
+        break;
+    }
+  }
+  if (param != params.size())
+    throw DbErrors("Too many values for %s", sql.c_str());
+  return result;
+}
+
+int Dataset::exec(const string &sql, const query_params &params) {
+  return exec(bind_params(sql, params));
+}
+
+bool Dataset::query(const string &sql, const query_params &params) {
+  return query(bind_params(sql, params).c_str());
+}
+
+
 void Dataset::close(void) {
   haveError  = false;
   frecno = 0;
@@ -359,10 +413,10 @@ const field_value Dataset::get_field_value(int index) {
 
 const sql_record* const Dataset::get_sql_record()
 {
-  if (result.records.size() == 0 || frecno >= (int)result.records.size())
+  if (frecno < 0 || frecno >= (int)result.records.size())
     return NULL;
 
-  return result.records[frecno];
+  return &result.records[frecno];
 }
 
 const field_value Dataset::f_old(const char *f_name) {
@@ -251,6 +251,9 @@ protected:
 /* Returns old field value (for :OLD) */
   virtual const field_value f_old(const char *f);
 
+/* Replaces the ? placeholders outside of string literals by the escaped values */
+  std::string bind_params(const std::string &sql, const query_params &params);
+
 public:
 
  virtual int str_compare(const char * s1, const char * s2);
@@ -296,6 +299,25 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exept Sql */
   virtual bool query(const char *sql) = 0;
+
+  /*! \brief Execute a statement without results, binding values to its ? placeholders
+   Statements differing only in their values share the same SQL text, so a
+   database supporting it prepares them once. Bound strings need no escaping.
+   The default implementation formats the values into the SQL text.
+   \param sql the statement with one ? placeholder per value
+   \param params the values, in placeholder order
+   */
+  virtual int  exec(const std::string &sql, const query_params &params);
+  /*! \brief As exec(sql, params), for a query returning rows */
+  virtual bool query(const std::string &sql, const query_params &params);
+  /*! \brief Run a query as a forward-only cursor
+   Rows are read from the database one at a time as next() is called, so
+   only the current row is held in memory. Only next() and eof() move
+   through the rows, num_rows() and the result set cover the current row.
+   The default implementation runs an ordinary query.
+   \param sql the select statement
+   */
+  virtual bool query_cursor(const std::string &sql) { return query(sql.c_str()); }
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
@@ -25,6 +25,7 @@
 #include "utils/log.h"
 #include "system.h" // for GetLastError()
 #include "network/WakeOnAccess.h"
+#include "utils/Trace.h"
 
 #ifdef HAS_MYSQL
 #include "mysqldataset.h"
@@ -1294,20 +1295,14 @@ void MysqlDataset::fill_fields() {
   }
 
   //Filling result
-  if (result.records.size() != 0)
-  {
-    const sql_record *row = result.records[frecno];
-    if (row)
-    {
-      const unsigned int ncols = row->size();
-      fields_object->resize(ncols);
-      for (unsigned int i = 0; i < ncols; i++)
-        (*fields_object)[i].val = row->at(i);
-      return;
-    }
-  }
   const unsigned int ncols = result.record_header.size();
   fields_object->resize(ncols);
+  if (frecno >= 0 && (unsigned int)frecno < result.num_rows())
+  {
+    for (unsigned int i = 0; i < ncols; i++)
+      result.get_value(frecno, i, (*fields_object)[i].val);
+    return;
+  }
   for (unsigned int i = 0; i < ncols; i++)
     (*fields_object)[i].val = "";
 }
@@ -1352,6 +1347,7 @@ static size_t ci_find(const string& where, const string& what)
 }
 
 int MysqlDataset::exec(const string &sql) {
+  TRACE_SCOPE("database", "mysql exec");
   if (!handle()) throw DbErrors("No Database Connection");
   string qry = sql;
   int res = 0;
@@ -1394,6 +1390,7 @@ const void* MysqlDataset::getExecRes() {
 
 
 bool MysqlDataset::query(const char *query) {
+  TRACE_SCOPE("database", "mysql query");
   if(!handle()) throw DbErrors("No Database Connection");
   std::string qry = query;
   int fs = qry.find("select");
@@ -1422,11 +1419,9 @@ bool MysqlDataset::query(const char *query) {
   // returned rows
   while ((row = mysql_fetch_row(stmt)))
   { // have a row of data
-    sql_record *res = new sql_record;
-    res->resize(numColumns);
+    result.add_row();
     for (unsigned int i = 0; i < numColumns; i++)
     {
-      field_value &v = res->at(i);
       switch (fields[i].type)
       {
         case MYSQL_TYPE_LONGLONG:
@@ -1438,44 +1433,42 @@ bool MysqlDataset::query(const char *query) {
         case MYSQL_TYPE_LONG:
           if (row[i] != NULL)
           {
-            v.set_asInt(atoi(row[i]));
+            result.add_int64(atoi(row[i]));
           }
           else
           {
-            v.set_asInt(0);
+            result.add_int64(0);
           }
           break;
         case MYSQL_TYPE_FLOAT:
         case MYSQL_TYPE_DOUBLE:
           if (row[i] != NULL)
           {
-            v.set_asDouble(atof(row[i]));
+            result.add_double(atof(row[i]));
           }
           else
           {
-            v.set_asDouble(0);
+            result.add_double(0);
           }
           break;
         case MYSQL_TYPE_STRING:
         case MYSQL_TYPE_VAR_STRING:
         case MYSQL_TYPE_VARCHAR:
-          if (row[i] != NULL) v.set_asString((const char *)row[i] );
+          result.add_text(row[i] != NULL ? (const char *)row[i] : "");
           break;
         case MYSQL_TYPE_TINY_BLOB:
         case MYSQL_TYPE_MEDIUM_BLOB:
         case MYSQL_TYPE_LONG_BLOB:
         case MYSQL_TYPE_BLOB:
-          if (row[i] != NULL) v.set_asString((const char *)row[i]);
+          result.add_text(row[i] != NULL ? (const char *)row[i] : "");
           break;
         case MYSQL_TYPE_NULL:
         default:
           CLog::Log(LOGDEBUG,"MYSQL: Unknown field type: %u", fields[i].type);
-          v.set_asString("");
-          v.set_isNull();
+          result.add_null();
           break;
       }
     }
-    result.records.push_back(res);
   }
   mysql_free_result(stmt);
   active = true;
@@ -1563,15 +1556,7 @@ void MysqlDataset::next(void) {
 
 void MysqlDataset::free_row(void)
 {
-  if (frecno < 0 || (unsigned int)frecno >= result.records.size())
-    return;
-
-  sql_record *row = result.records[frecno];
-  if (row)
-  {
-    delete row;
-    result.records[frecno] = NULL;
-  }
+  // rows live in the column storage of the result and are released with it
 }
 
 bool MysqlDataset::seek(int pos) {
@@ -123,7 +123,7 @@ protected:
   Filling the fields information from select statement */
   virtual void fill_fields();
 /* Changing field values during dataset navigation */
-  virtual void free_row();  // free the memory allocated for the current row
+  virtual void free_row();  // no-op, rows are held by the column storage of the result
 
 public:
 /* constructor */
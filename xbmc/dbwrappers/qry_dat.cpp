@@ -33,8 +33,10 @@
 #include "qry_dat.h"
 #include "system.h" // for PRId64
 
+#include <stdexcept>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifndef __GNUC__
 #pragma warning (disable:4800)
@@ -57,6 +59,12 @@ field_value::field_value(const char *s) {
   field_type = ft_String;
   is_null = false;
 }
+
+field_value::field_value(const std::string &s) {
+  str_value = s;
+  field_type = ft_String;
+  is_null = false;
+}
   
 field_value::field_value(const bool b) {
   bool_value = b; 
@@ -744,4 +752,237 @@ string field_value::gft() {
   return tmp;
   }
 
+//field_ref: reads in place from the column storage of a result_set
+fType field_ref::get_fType() const {
+  return result->get_type(row, col);
+}
+
+bool field_ref::get_isNull() const {
+  return result->is_null(row, col);
+}
+
+const char *field_ref::get_asCString(size_t *length) const {
+  if (result->is_null(row, col)) {
+    if (length)
+      *length = 0;
+    return "";
+  }
+  if (result->get_type(row, col) == ft_String)
+    return result->get_text(row, col, length);
+  if (length)
+    *length = 0;
+  return NULL;
+}
+
+field_value field_ref::get_number() const {
+  if (result->get_type(row, col) == ft_Double)
+    return field_value(result->get_double(row, col));
+  return field_value(result->get_int64(row, col));
+}
+
+string field_ref::get_asString() const {
+  size_t length;
+  const char *text = get_asCString(&length);
+  if (text)
+    return string(text, length);
+  return get_number().get_asString();
+}
+
+bool field_ref::get_asBool() const {
+  const char *text = get_asCString();
+  if (text)
+    return strcmp(text, "True") == 0 || strcmp(text, "true") == 0 || strcmp(text, "1") == 0;
+  return get_number().get_asBool();
+}
+
+char field_ref::get_asChar() const {
+  const char *text = get_asCString();
+  if (text)
+    return text[0];
+  return get_number().get_asChar();
+}
+
+short field_ref::get_asShort() const {
+  const char *text = get_asCString();
+  if (text)
+    return (short)atoi(text);
+  return get_number().get_asShort();
+}
+
+unsigned short field_ref::get_asUShort() const {
+  const char *text = get_asCString();
+  if (text)
+    return (unsigned short)atoi(text);
+  return get_number().get_asUShort();
+}
+
+int field_ref::get_asInt() const {
+  const char *text = get_asCString();
+  if (text)
+    return atoi(text);
+  return get_number().get_asInt();
+}
+
+unsigned int field_ref::get_asUInt() const {
+  const char *text = get_asCString();
+  if (text)
+    return (unsigned int)atoi(text);
+  return get_number().get_asUInt();
+}
+
+float field_ref::get_asFloat() const {
+  const char *text = get_asCString();
+  if (text)
+    return (float)atof(text);
+  return get_number().get_asFloat();
+}
+
+double field_ref::get_asDouble() const {
+  const char *text = get_asCString();
+  if (text)
+    return atof(text);
+  return get_number().get_asDouble();
+}
+
+int64_t field_ref::get_asInt64() const {
+  const char *text = get_asCString();
+  if (text)
+    return _atoi64(text);
+  return get_number().get_asInt64();
+}
+
+field_value field_ref::get_value() const {
+  field_value value;
+  result->get_value(row, col, value);
+  return value;
+}
+
+
+//sql_record
+unsigned int sql_record::size() const {
+  return result->num_cols();
+}
+
+field_ref sql_record::at(unsigned int col) const {
+  if (col >= result->num_cols())
+    throw std::out_of_range("sql_record::at");
+  return field_ref(result, row, col);
+}
+
+
+//result_set
+void result_set::clear() {
+  // release the storage, datasets live long and a big listing should not pin its memory
+  query_data().swap(records);
+  record_header.clear();
+  columns.clear();
+  std::vector<char>().swap(arena);
+  next_col = 0;
+}
+
+void result_set::clear_rows() {
+  records.clear();
+  for (unsigned int i = 0; i < columns.size(); i++) {
+    columns[i].types.clear();
+    columns[i].cells.clear();
+  }
+  arena.clear();
+  next_col = 0;
+}
+
+void result_set::add_row() {
+  if (records.empty())
+    columns.resize(record_header.size());
+  else {
+    while (next_col < columns.size())
+      add_null();
+  }
+  next_col = 0;
+  records.push_back(sql_record(this, records.size()));
+}
+
+result_set::cell* result_set::add_cell(cell_type type) {
+  if (next_col >= columns.size())
+    return NULL; // more values than headers, drop them
+  column &c = columns[next_col++];
+  c.types.push_back(type);
+  c.cells.push_back(cell());
+  return &c.cells.back();
+}
+
+void result_set::add_null() {
+  cell *c = add_cell(cell_null);
+  if (c)
+    c->int64_value = 0;
+}
+
+void result_set::add_int64(int64_t value) {
+  cell *c = add_cell(cell_int64);
+  if (c)
+    c->int64_value = value;
+}
+
+void result_set::add_double(double value) {
+  cell *c = add_cell(cell_double);
+  if (c)
+    c->double_value = value;
+}
+
+void result_set::add_text(const char *text, size_t length) {
+  cell *c = add_cell(cell_text);
+  if (!c)
+    return;
+  c->text.offset = arena.size();
+  c->text.length = length;
+  arena.insert(arena.end(), text, text + length);
+  arena.push_back('\0');
+}
+
+void result_set::add_text(const char *text) {
+  add_text(text, strlen(text));
+}
+
+fType result_set::get_type(unsigned int row, unsigned int col) const {
+  switch (columns[col].types[row]) {
+    case cell_int64:
+      return ft_Int64;
+    case cell_double:
+      return ft_Double;
+    default:
+      return ft_String;
+  }
+}
+
+const char *result_set::get_text(unsigned int row, unsigned int col, size_t *length) const {
+  const cell &c = columns[col].cells[row];
+  if (length)
+    *length = c.text.length;
+  return &arena[c.text.offset];
+}
+
+void result_set::get_value(unsigned int row, unsigned int col, field_value &value) const {
+  switch (columns[col].types[row]) {
+    case cell_int64:
+      value.set_asInt64(get_int64(row, col));
+      break;
+    case cell_double:
+      value.set_asDouble(get_double(row, col));
+      break;
+    case cell_text:
+      value.set_asString(get_text(row, col));
+      break;
+    default:
+      value.set_asString("");
+      break;
+  }
+  value.set_isNull(columns[col].types[row] == cell_null);
+}
+
+size_t result_set::memory_used() const {
+  size_t bytes = records.capacity() * sizeof(sql_record) + arena.capacity();
+  for (unsigned int i = 0; i < columns.size(); i++)
+    bytes += columns[i].types.capacity() + columns[i].cells.capacity() * sizeof(cell);
+  return bytes;
+}
+
 } //namespace 
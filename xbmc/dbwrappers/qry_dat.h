@@ -78,6 +78,7 @@ private:
 public:
   field_value();
   field_value(const char *s);
+  field_value(const std::string &s);
   field_value(const bool b);
   field_value(const char c);
   field_value(const short s);
@@ -176,6 +177,7 @@ public:
   }
 
   void set_isNull(){is_null=true;}
+  void set_isNull(const bool n){is_null=n;}
   void set_asString(const char *s);
   void set_asString(const std::string & s);
   void set_asBool(const bool b);
@@ -209,37 +211,146 @@ struct field {
 
 
 typedef std::vector<field> Fields;
-typedef std::vector<field_value> sql_record;
+typedef std::vector<field_value> query_params; // values bound to the ? placeholders of a statement
 typedef std::vector<field_prop> record_prop;
-typedef std::vector<sql_record*> query_data;
 typedef field_value variant;
 
+class result_set;
+
+/*!
+ \brief A value of a result_set, read in place from the column storage of the result.
+
+ Behaves like the field_value it replaces for reading. Text values are not
+ copied: get_asCString() points into the string arena of the result and stays
+ valid until the result is cleared.
+ */
+class field_ref {
+public:
+  field_ref(const result_set *result, unsigned int row, unsigned int col)
+    : result(result), row(row), col(col) {}
+
+  fType get_fType() const;
+  bool get_isNull() const;
+  /*!
+   \brief Zero-copy access to a text value
+   \param length if not NULL, receives the length of the text in bytes
+   \return the NUL terminated text, "" for NULL and NULL for numeric values
+   */
+  const char *get_asCString(size_t *length = NULL) const;
+  std::string get_asString() const;
+  bool get_asBool() const;
+  char get_asChar() const;
+  short get_asShort() const;
+  unsigned short get_asUShort() const;
+  int get_asInt() const;
+  unsigned int get_asUInt() const;
+  float get_asFloat() const;
+  double get_asDouble() const;
+  int64_t get_asInt64() const;
+  /*! \brief Copy the value into a standalone field_value */
+  field_value get_value() const;
+
+private:
+  field_value get_number() const;
+
+  const result_set *result;
+  unsigned int row;
+  unsigned int col;
+};
+
+/*! \brief A row of a result_set, handing out field_refs to its values */
+class sql_record {
+public:
+  sql_record(const result_set *result, unsigned int row) : result(result), row(row) {}
+
+  unsigned int size() const;
+  field_ref at(unsigned int col) const;
+  field_ref operator[](unsigned int col) const { return field_ref(result, row, col); }
+
+private:
+  const result_set *result;
+  unsigned int row;
+};
+
+typedef std::vector<sql_record> query_data;
+
 //typedef Fields::iterator fld_itor;
-typedef sql_record::iterator rec_itor;
 typedef record_prop::iterator recprop_itor;
 typedef query_data::iterator qry_itor;
 
+/*!
+ \brief The rows returned by a query, stored by column.
+
+ Every column keeps one typed cell per row, text of all cells is appended to a
+ single arena. Filling a result therefore costs a few amortised allocations
+ instead of one vector per row and one string per value. Rows are added with
+ add_row() followed by one add_*() call per column, in column order.
+ */
 class result_set
 {
 public:
-  result_set()
-  {
-  };
+  result_set() : next_col(0) {};
   ~result_set()
   {
     clear();
   };
-  void clear()
-  {
-    for (unsigned int i = 0; i < records.size(); i++)
-      if (records[i])
-        delete records[i];
-    records.clear();
-    record_header.clear();
-  };
+  void clear();
+  /*! \brief Drop the rows but keep the header and the allocated storage for new rows */
+  void clear_rows();
+
+  /*! \brief Start a new row, columns left unset on the previous row are NULL */
+  void add_row();
+  void add_null();
+  void add_int64(int64_t value);
+  void add_double(double value);
+  void add_text(const char *text, size_t length);
+  void add_text(const char *text);
+
+  unsigned int num_rows() const { return records.size(); }
+  unsigned int num_cols() const { return columns.size(); }
+
+  bool is_null(unsigned int row, unsigned int col) const { return columns[col].types[row] == cell_null; }
+  fType get_type(unsigned int row, unsigned int col) const;
+  int64_t get_int64(unsigned int row, unsigned int col) const { return columns[col].cells[row].int64_value; }
+  double get_double(unsigned int row, unsigned int col) const { return columns[col].cells[row].double_value; }
+  const char *get_text(unsigned int row, unsigned int col, size_t *length = NULL) const;
+  /*! \brief Store a value into an existing field_value, reusing its string buffer */
+  void get_value(unsigned int row, unsigned int col, field_value &value) const;
+
+  /*! \brief Bytes held by the cells and the string arena */
+  size_t memory_used() const;
 
   record_prop record_header;
   query_data records;
+
+private:
+  result_set(const result_set&);
+  result_set& operator=(const result_set&);
+
+  enum cell_type {
+    cell_null,
+    cell_int64,
+    cell_double,
+    cell_text
+  };
+  union cell {
+    int64_t int64_value;
+    double double_value;
+    struct {
+      uint32_t offset;
+      uint32_t length;
+    } text;
+  };
+  struct column {
+    std::vector<unsigned char> types;
+    std::vector<cell> cells;
+  };
+
+  cell* add_cell(cell_type type);
+
+  std::vector<column> columns;
+  std::vector<char> arena;
+  unsigned int next_col;
 };
 
 } // namespace
@@ -33,11 +33,14 @@
 #include "utils/log.h"
 #include "system.h" // for Sleep(), OutputDebugString() and GetLastError()
 #include "utils/URIUtils.h"
+#include "utils/Trace.h"
 
 #ifdef TARGET_WINDOWS
 #pragma comment(lib, "sqlite3.lib")
 #endif
 
+#define DB_STATEMENT_CACHE_MAX 64 // prepared statements kept per connection
+
 using namespace std;
 
 namespace dbiplus {
@@ -59,26 +62,71 @@ int callback(void* res_ptr,int ncol, char** reslt,char** cols)
 
   if (reslt != NULL)
   {
-    sql_record *rec = new sql_record;
-    rec->resize(ncol);
+    r->add_row();
     for (int i=0; i<ncol; i++)
     { 
-      field_value &v = rec->at(i);
       if (reslt[i] == NULL)
-      {
-        v.set_asString("");
-        v.set_isNull();
-      }
+        r->add_null();
       else
-      {
-        v.set_asString(reslt[i]);
-      }
+        r->add_text(reslt[i]);
     }
-    r->records.push_back(rec);
   }
   return 0;  
 }
 
+// reads the column names of a statement
+static void fetch_header(sqlite3_stmt *stmt, result_set &result)
+{
+  const unsigned int numColumns = sqlite3_column_count(stmt);
+  result.record_header.resize(numColumns);
+  for (unsigned int i = 0; i < numColumns; i++)
+    result.record_header[i].name = sqlite3_column_name(stmt, i);
+}
+
+// appends the row a statement is positioned on
+static void fetch_row(sqlite3_stmt *stmt, result_set &result)
+{
+  const unsigned int numColumns = result.record_header.size();
+  result.add_row();
+  for (unsigned int i = 0; i < numColumns; i++)
+  {
+    switch (sqlite3_column_type(stmt, i))
+    {
+    case SQLITE_INTEGER:
+      result.add_int64(sqlite3_column_int64(stmt, i));
+      break;
+    case SQLITE_FLOAT:
+      result.add_double(sqlite3_column_double(stmt, i));
+      break;
+    case SQLITE_TEXT:
+    case SQLITE_BLOB:
+    {
+      const char *text = (const char *)sqlite3_column_text(stmt, i);
+      if (text)
+        result.add_text(text, sqlite3_column_bytes(stmt, i));
+      else
+        result.add_text("", 0);
+      break;
+    }
+    case SQLITE_NULL:
+    default:
+      result.add_null();
+      break;
+    }
+  }
+}
+
+// reads the remaining rows of a statement, returns the result of the last step
+static int fetch_rows(sqlite3_stmt *stmt, result_set &result)
+{
+  fetch_header(stmt, result);
+
+  int rc;
+  while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    fetch_row(stmt, result);
+  return rc;
+}
+
 static int busy_callback(void*, int busyCount)
 {
 	Sleep(100);
@@ -86,12 +134,49 @@ static int busy_callback(void*, int busyCount)
 	return 1;
 }
 
+/* fts_rank(matchinfo(index), weight, ...) ranks a row of a full-text match.
+   Every phrase scores its hits in a column of the row relative to its hits in that
+   column over all rows, so rare words count more. Columns are weighted by the extra
+   arguments in order, columns without a weight count once. */
+static void fts_rank(sqlite3_context *context, int argc, sqlite3_value **argv)
+{
+  if (argc < 1 || sqlite3_value_type(argv[0]) != SQLITE_BLOB)
+  {
+    sqlite3_result_error(context, "fts_rank() needs the result of matchinfo()", -1);
+    return;
+  }
+
+  const unsigned int *info = (const unsigned int *)sqlite3_value_blob(argv[0]);
+  size_t values = sqlite3_value_bytes(argv[0]) / sizeof(unsigned int);
+  if (values < 2 || values < 2 + 3 * (size_t)info[0] * info[1])
+  {
+    sqlite3_result_error(context, "fts_rank() needs matchinfo() in its default format", -1);
+    return;
+  }
+
+  unsigned int phrases = info[0], columns = info[1];
+  double score = 0.0;
+  for (unsigned int p = 0; p < phrases; p++)
+  {
+    for (unsigned int c = 0; c < columns; c++)
+    {
+      const unsigned int *hits = &info[2 + 3 * (p * columns + c)];
+      if (hits[0] == 0)
+        continue;
+      double weight = (int)c + 1 < argc ? sqlite3_value_double(argv[c + 1]) : 1.0;
+      score += weight * hits[0] / hits[1];
+    }
+  }
+  sqlite3_result_double(context, score);
+}
+
 //************* SqliteDatabase implementation ***************
 
 SqliteDatabase::SqliteDatabase() {
 
   active = false;	
   _in_transaction = false;		// for transaction
+  read_only = false;
 
   error = "Unknown database error";//S_NO_CONNECTION;
   host = "localhost";
@@ -216,12 +301,13 @@ int SqliteDatabase::connect(bool create) {
   try
   {
     disconnect();
-    int flags = SQLITE_OPEN_READWRITE;
-    if (create)
+    int flags = read_only ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE;
+    if (create && !read_only)
       flags |= SQLITE_OPEN_CREATE;
     if (sqlite3_open_v2(db_fullpath.c_str(), &conn, flags, NULL)==SQLITE_OK)
     {
       sqlite3_busy_handler(conn, busy_callback, NULL);
+      sqlite3_create_function(conn, "fts_rank", -1, SQLITE_UTF8, NULL, fts_rank, NULL, NULL);
       char* err=NULL;
       if (setErr(sqlite3_exec(getHandle(),"PRAGMA empty_result_callbacks=ON",NULL,NULL,&err),"PRAGMA empty_result_callbacks=ON") != SQLITE_OK)
       {
@@ -259,10 +345,48 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  clearStatements();
   sqlite3_close(conn);
   active = false;
 }
 
+sqlite3_stmt *SqliteDatabase::getStatement(const string &sql) {
+  map<string, sqlite3_stmt*>::const_iterator it = statements.find(sql);
+  if (it != statements.end())
+    return it->second;
+
+  // the hot paths only use a few dozen statements, start over rather than track their use
+  if (statements.size() >= DB_STATEMENT_CACHE_MAX)
+    clearStatements();
+
+  sqlite3_stmt *stmt = NULL;
+  if (setErr(sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK)
+    throw DbErrors(getErrorMsg());
+
+  statements.insert(make_pair(sql, stmt));
+  return stmt;
+}
+
+void SqliteDatabase::clearStatements() {
+  for (map<string, sqlite3_stmt*>::iterator it = statements.begin(); it != statements.end(); ++it)
+    sqlite3_finalize(it->second);
+  statements.clear();
+}
+
+int SqliteDatabase::checkpoint() {
+  if (!active) return SQLITE_MISUSE;
+  // a connection only opens the log once it has read from the database
+  int rc = setErr(sqlite3_exec(conn, "SELECT COUNT(*) FROM sqlite_master", NULL, NULL, NULL), "checkpoint");
+  if (rc != SQLITE_OK)
+    return rc;
+
+  int logPages = 0, checkpointedPages = 0;
+  rc = sqlite3_wal_checkpoint_v2(conn, NULL, SQLITE_CHECKPOINT_PASSIVE, &logPages, &checkpointedPages);
+  if (rc == SQLITE_OK)
+    CLog::Log(LOGDEBUG, "Checkpointed %i of %i log pages of %s", checkpointedPages, logPages, db.c_str());
+  return setErr(rc, "checkpoint");
+}
+
 int SqliteDatabase::create() {
   return connect(true);
 }
@@ -339,7 +463,7 @@ long SqliteDatabase::nextid(const char* sname) {
     return id;
   }
   else {
-    id = res.records[0]->at(0).get_asInt()+1;
+    id = res.records[0].at(0).get_asInt()+1;
     sprintf(sqlcmd,"update %s set nextid=%d where seq_name = '%s'",sequence_table.c_str(),id,sname);
     if ((last_err = sqlite3_exec(conn,sqlcmd,NULL,NULL,NULL) != SQLITE_OK)) return DB_UNEXPECTED_RESULT;
     return id;
@@ -411,6 +535,7 @@ SqliteDataset::SqliteDataset():Dataset() {
   db = NULL;
   errmsg = NULL;
   autorefresh = false;
+  cursor = NULL;
 }
 
 
@@ -419,9 +544,11 @@ SqliteDataset::SqliteDataset(SqliteDatabase *newDb):Dataset(newDb) {
   db = newDb;
   errmsg = NULL;
   autorefresh = false;
+  cursor = NULL;
 }
 
  SqliteDataset::~SqliteDataset(){
+   close_cursor();
    if (errmsg) sqlite3_free(errmsg);
  }
 
@@ -476,6 +603,51 @@ void SqliteDataset::make_query(StringList &_sql) {
 }
 
 
+sqlite3_stmt *SqliteDataset::bind_statement(const string &sql, const query_params &params) {
+  if (!handle()) throw DbErrors("No Database Connection");
+
+  sqlite3_stmt *stmt = static_cast<SqliteDatabase*>(db)->getStatement(sql);
+  if ((int)params.size() != sqlite3_bind_parameter_count(stmt))
+    throw DbErrors("Expected %i values instead of %u for %s", sqlite3_bind_parameter_count(stmt), (unsigned int)params.size(), sql.c_str());
+
+  for (unsigned int i = 0; i < params.size(); i++)
+  {
+    const field_value &value = params[i];
+    int rc;
+    if (value.get_isNull())
+      rc = sqlite3_bind_null(stmt, i + 1);
+    else switch (value.get_fType())
+    {
+      case ft_Boolean:
+        rc = sqlite3_bind_int(stmt, i + 1, value.get_asBool() ? 1 : 0);
+        break;
+      case ft_Short:
+      case ft_UShort:
+      case ft_Int:
+      case ft_UInt:
+      case ft_Int64:
+        rc = sqlite3_bind_int64(stmt, i + 1, value.get_asInt64());
+        break;
+      case ft_Float:
+      case ft_Double:
+        rc = sqlite3_bind_double(stmt, i + 1, value.get_asDouble());
+        break;
+      default:
+      {
+        const string str = value.get_asString();
+        rc = sqlite3_bind_text(stmt, i + 1, str.c_str(), str.size(), SQLITE_TRANSIENT);
+        break;
+      }
+    }
+    if (db->setErr(rc, sql.c_str()) != SQLITE_OK)
+    {
+      sqlite3_clear_bindings(stmt);
+      throw DbErrors(db->getErrorMsg());
+    }
+  }
+  return stmt;
+}
+
 void SqliteDataset::make_insert() {
   make_query(insert_sql);
   last();
@@ -505,20 +677,14 @@ void SqliteDataset::fill_fields() {
   }
 
   //Filling result
-  if (result.records.size() != 0)
-  {
-    const sql_record *row = result.records[frecno];
-    if (row)
-    {
-      const unsigned int ncols = row->size();
-      fields_object->resize(ncols);
-      for (unsigned int i = 0; i < ncols; i++)
-        (*fields_object)[i].val = row->at(i);
-      return;
-    }
-  }
   const unsigned int ncols = result.record_header.size();
   fields_object->resize(ncols);
+  if (frecno >= 0 && (unsigned int)frecno < result.num_rows())
+  {
+    for (unsigned int i = 0; i < ncols; i++)
+      result.get_value(frecno, i, (*fields_object)[i].val);
+    return;
+  }
   for (unsigned int i = 0; i < ncols; i++)
     (*fields_object)[i].val = "";
 }
@@ -536,6 +702,7 @@ bool SqliteDataset::dropIndex(const char *table, const char *index)
 
 
 int SqliteDataset::exec(const string &sql) {
+  TRACE_SCOPE("database", "sqlite exec");
   if (!handle()) throw DbErrors("No Database Connection");
   string qry = sql;
   int res;
@@ -591,12 +758,28 @@ int SqliteDataset::exec() {
 	return exec(sql);
 }
 
+int SqliteDataset::exec(const string &sql, const query_params &params) {
+  TRACE_SCOPE("database", "sqlite exec");
+  exec_res.clear();
+
+  sqlite3_stmt *stmt = bind_statement(sql, params);
+  int rc;
+  while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    ;
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  if (db->setErr(rc == SQLITE_DONE ? SQLITE_OK : rc, sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+  return SQLITE_OK;
+}
+
 const void* SqliteDataset::getExecRes() {
   return &exec_res;
 }
 
 
 bool SqliteDataset::query(const char *query) {
+  TRACE_SCOPE("database", "sqlite query");
     if(!handle()) throw DbErrors("No Database Connection");
     std::string qry = query;
     int fs = qry.find("select");
@@ -610,43 +793,7 @@ bool SqliteDataset::query(const char *query) {
   if (db->setErr(sqlite3_prepare_v2(handle(),query,-1,&stmt, NULL),query) != SQLITE_OK)
     throw DbErrors(db->getErrorMsg());
 
-  // column headers
-  const unsigned int numColumns = sqlite3_column_count(stmt);
-  result.record_header.resize(numColumns);
-  for (unsigned int i = 0; i < numColumns; i++)
-    result.record_header[i].name = sqlite3_column_name(stmt, i);
-
-  // returned rows
-  while (sqlite3_step(stmt) == SQLITE_ROW)
-  { // have a row of data
-    sql_record *res = new sql_record;
-    res->resize(numColumns);
-    for (unsigned int i = 0; i < numColumns; i++)
-    {
-      field_value &v = res->at(i);
-      switch (sqlite3_column_type(stmt, i))
-      {
-      case SQLITE_INTEGER:
-        v.set_asInt64(sqlite3_column_int64(stmt, i));
-        break;
-      case SQLITE_FLOAT:
-        v.set_asDouble(sqlite3_column_double(stmt, i));
-        break;
-      case SQLITE_TEXT:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_BLOB:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_NULL:
-      default:
-        v.set_asString("");
-        v.set_isNull();
-        break;
-      }
-    }
-    result.records.push_back(res);
-  }
+  fetch_rows(stmt, result);
   if (db->setErr(sqlite3_finalize(stmt),query) == SQLITE_OK)
   {
     active = true;
@@ -664,6 +811,74 @@ bool SqliteDataset::query(const string &q){
   return query(q.c_str());
 }
 
+bool SqliteDataset::query(const string &sql, const query_params &params) {
+  TRACE_SCOPE("database", "sqlite query");
+  close();
+
+  sqlite3_stmt *stmt = bind_statement(sql, params);
+  int rc = fetch_rows(stmt, result);
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  if (db->setErr(rc == SQLITE_DONE ? SQLITE_OK : rc, sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+
+  active = true;
+  ds_state = dsSelect;
+  this->first();
+  return true;
+}
+
+bool SqliteDataset::query_cursor(const string &sql) {
+  TRACE_SCOPE("database", "sqlite cursor");
+  if (!handle()) throw DbErrors("No Database Connection");
+  close();
+
+  if (db->setErr(sqlite3_prepare_v2(handle(), sql.c_str(), -1, &cursor, NULL), sql.c_str()) != SQLITE_OK)
+  {
+    close_cursor();
+    throw DbErrors(db->getErrorMsg());
+  }
+
+  fetch_header(cursor, result);
+  active = true;
+  ds_state = dsSelect;
+  step_cursor();
+  return true;
+}
+
+void SqliteDataset::step_cursor() {
+  // only the current row is kept, its storage is reused for the next one
+  result.clear_rows();
+  frecno = 0;
+  fbof = false;
+
+  int rc = sqlite3_step(cursor);
+  if (rc == SQLITE_ROW)
+  {
+    fetch_row(cursor, result);
+    feof = false;
+    fill_fields();
+    return;
+  }
+
+  feof = true;
+  if (rc != SQLITE_DONE)
+  {
+    db->setErr(rc, sqlite3_sql(cursor));
+    close_cursor();
+    throw DbErrors(db->getErrorMsg());
+  }
+  close_cursor();
+}
+
+void SqliteDataset::close_cursor() {
+  if (cursor)
+  {
+    sqlite3_finalize(cursor);
+    cursor = NULL;
+  }
+}
+
 void SqliteDataset::open(const string &sql) {
 	set_select_sql(sql);
 	open();
@@ -681,6 +896,7 @@ void SqliteDataset::open() {
 
 void SqliteDataset::close() {
   Dataset::close();
+  close_cursor();
   result.clear();
   edit_object->clear();
   fields_object->clear();
@@ -730,6 +946,11 @@ void SqliteDataset::prev(void) {
 }
 
 void SqliteDataset::next(void) {
+  if (cursor)
+  {
+    step_cursor();
+    return;
+  }
   Dataset::next();
   if (!eof()) 
       fill_fields();
@@ -737,15 +958,7 @@ void SqliteDataset::next(void) {
 
 void SqliteDataset::free_row(void)
 {
-  if (frecno < 0 || (unsigned int)frecno >= result.records.size())
-    return;
-
-  sql_record *row = result.records[frecno];
-  if (row)
-  {
-    delete row;
-    result.records[frecno] = NULL;
-  }
+  // rows live in the column storage of the result and are released with it
 }
 
 bool SqliteDataset::seek(int pos) {
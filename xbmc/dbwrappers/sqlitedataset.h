@@ -30,6 +30,7 @@
 #define _SQLITEDATASET_H
 
 #include <stdio.h>
+#include <map>
 #include "dataset.h"
 #include <sqlite3.h>
 
@@ -44,7 +45,10 @@ protected:
 /* connect descriptor */
   sqlite3 *conn;
   bool _in_transaction;
+  bool read_only;
   int last_err;
+/* prepared statements by SQL text, reset after use and finalised on disconnect */
+  std::map<std::string, sqlite3_stmt*> statements;
 
 public:
 /* default constructor */
@@ -56,6 +60,14 @@ public:
 
 /* func. returns connection handle with SQLite-server */
   sqlite3 *getHandle() {  return conn; }
+/* func. returns the cached statement for sql, preparing it on first use */
+  sqlite3_stmt *getStatement(const std::string &sql);
+/* func. finalises all cached statements */
+  void clearStatements();
+/* opens the next connection read-only, it never takes the write lock */
+  void setReadOnly(bool readOnly) { read_only = readOnly; }
+/* func. copies what it can of the write-ahead log into the database without waiting on readers or writers */
+  int checkpoint();
 /* func. returns current status about SQLite-server connection */
   virtual int status();
   virtual int setErr(int err_code,const char * qry);
@@ -123,7 +135,14 @@ protected:
   Filling the fields information from select statement */
   virtual void fill_fields();
 /* Changing field values during dataset navigation */
-  virtual void free_row();  // free the memory allocated for the current row
+  virtual void free_row();  // no-op, rows are held by the column storage of the result
+/* Binds params to the placeholders of a cached statement */
+  sqlite3_stmt *bind_statement(const std::string &sql, const query_params &params);
+/* Replaces the row of a forward-only cursor by the next one */
+  void step_cursor();
+  void close_cursor();
+
+  sqlite3_stmt *cursor;  // statement of a query_cursor() still being stepped
 
 public:
 /* constructor */
@@ -143,10 +162,13 @@ or insert() operations default = false) */
 /* func. executes a query without results to return */
   virtual int  exec ();
   virtual int  exec (const std::string &sql);
+  virtual int  exec (const std::string &sql, const query_params &params);
   virtual const void* getExecRes();
 /* as open, but with our query exept Sql */
   virtual bool query(const char *query);
   virtual bool query(const std::string &query);
+  virtual bool query(const std::string &sql, const query_params &params);
+  virtual bool query_cursor(const std::string &sql);
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
@@ -43,6 +43,10 @@ CCacheStrategy::~CCacheStrategy()
 {
 }
 
+void CCacheStrategy::SetSource(const std::string &path, int64_t length, time_t mtime)
+{
+}
+
 void CCacheStrategy::EndOfInput() {
   m_bEndOfInput = true;
 }
@@ -303,6 +307,11 @@ void CSimpleDoubleCache::Close()
   }
 }
 
+void CSimpleDoubleCache::SetSource(const std::string &path, int64_t length, time_t mtime)
+{
+  m_pCache->SetSource(path, length, mtime);
+}
+
 int CSimpleDoubleCache::WriteToCache(const char *pBuffer, size_t iSize)
 {
   return m_pCache->WriteToCache(pBuffer, iSize);
@@ -23,6 +23,8 @@
 #define XFILECACHESTRATEGY_H
 
 #include <stdint.h>
+#include <string>
+#include <time.h>
 #ifdef TARGET_POSIX
 #include "PlatformDefs.h"
 #include "XHandlePublic.h"
@@ -46,6 +48,13 @@ public:
   virtual int Open() = 0;
   virtual void Close() = 0;
 
+  /*!
+   \brief Identify the source after Open(), for strategies keeping data across opens
+   \param length Length of the source, 0 if unknown
+   \param mtime Modification time of the source, 0 if unknown. The data isn't kept if either is unknown.
+   */
+  virtual void SetSource(const std::string &path, int64_t length, time_t mtime);
+
   virtual int WriteToCache(const char *pBuffer, size_t iSize) = 0;
   virtual int ReadFromCache(char *pBuffer, size_t iMaxSize) = 0;
   virtual int64_t WaitForData(unsigned int iMinAvail, unsigned int iMillis) = 0;
@@ -110,6 +119,7 @@ public:
 
   virtual int Open() ;
   virtual void Close() ;
+  virtual void SetSource(const std::string &path, int64_t length, time_t mtime);
 
   virtual int WriteToCache(const char *pBuffer, size_t iSize) ;
   virtual int ReadFromCache(char *pBuffer, size_t iMaxSize) ;
@@ -28,6 +28,7 @@
 
 #include <vector>
 #include <climits>
+#include <algorithm>
 
 #ifdef TARGET_POSIX
 #include <errno.h>
@@ -38,6 +39,7 @@
 #endif
 
 #include "DllLibCurl.h"
+#include "CurlRangeReader.h"
 #include "ShoutcastFile.h"
 #include "SpecialProtocol.h"
 #include "utils/CharsetConverter.h"
@@ -49,6 +51,14 @@ using namespace XCURL;
 #define XMIN(a,b) ((a)<(b)?(a):(b))
 #define FITS_INT(a) (((a) <= INT_MAX) && ((a) >= INT_MIN))
 
+/* gaps between ranges of a ReadV up to this size are downloaded and      *
+ * dropped, which is cheaper than the new request a seek would need       */
+#define READV_MAX_GAP (256 * 1024)
+
+/* smaller files are read over a single connection, even if parallel *
+ * ranges are enabled                                                 */
+#define PARALLEL_RANGES_MIN_SIZE (8 * 1024 * 1024)
+
 #define dllselect select
 
 
@@ -381,6 +391,23 @@ void CCurlFile::CReadState::Disconnect()
   m_curlAliasList = NULL;
 }
 
+void CCurlFile::CReadState::Stop()
+{
+  // unlike Disconnect() the handle and its header lists stay as they are,
+  // handles duplicated from it still point to them
+  if(m_multiHandle && m_easyHandle)
+    g_curlInterface.multi_remove_handle(m_multiHandle, m_easyHandle);
+
+  m_buffer.Clear();
+  free(m_overflowBuffer);
+  m_overflowBuffer = NULL;
+  m_overflowSize = 0;
+  m_stillRunning = 0;
+
+  // nothing can be read from this state anymore
+  m_filePos = -1;
+}
+
 
 CCurlFile::~CCurlFile()
 {
@@ -414,6 +441,7 @@ CCurlFile::CCurlFile()
   m_proxytype = PROXY_HTTP;
   m_state = new CReadState();
   m_oldState = NULL;
+  m_rangeReader = NULL;
   m_skipshout = false;
   m_httpresponse = -1;
 }
@@ -429,6 +457,7 @@ void CCurlFile::Close()
   if (m_opened && m_forWrite && !m_inError)
       Write(NULL, 0);
 
+  StopRangeReader();
   m_state->Disconnect();
   delete m_oldState;
   m_oldState = NULL;
@@ -500,6 +529,15 @@ void CCurlFile::SetCommonOptions(CReadState* state)
   // resolves. Unfortunately, c-ares does not yet support IPv6.
   g_curlInterface.easy_setopt(h, CURLOPT_NOSIGNAL, TRUE);
 
+  // share resolved names and ssl sessions with all other handles
+  if (g_curlInterface.GetShare())
+    g_curlInterface.easy_setopt(h, CURLOPT_SHARE, g_curlInterface.GetShare());
+
+#if LIBCURL_VERSION_NUM >= 0x071900
+  // keep idle connections of the pool from being dropped by routers
+  g_curlInterface.easy_setopt(h, CURLOPT_TCP_KEEPALIVE, 1L);
+#endif
+
   // not interested in failed requests
   g_curlInterface.easy_setopt(h, CURLOPT_FAILONERROR, 1);
 
@@ -959,6 +997,8 @@ bool CCurlFile::Open(const CURL& url)
     }
   }
 
+  StartRangeReader(url2);
+
   char* efurl;
   if (CURLE_OK == g_curlInterface.easy_getinfo(m_state->m_easyHandle, CURLINFO_EFFECTIVE_URL,&efurl) && efurl)
     m_url = efurl;
@@ -1128,7 +1168,7 @@ bool CCurlFile::Exists(const CURL& url)
 
 int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
 {
-  int64_t nextPos = m_state->m_filePos;
+  int64_t nextPos = GetPosition();
   switch(iWhence)
   {
     case SEEK_SET:
@@ -1150,6 +1190,14 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
   // We can't seek beyond EOF
   if (m_state->m_fileSize && nextPos > m_state->m_fileSize) return -1;
 
+  if (m_rangeReader)
+  {
+    if (m_rangeReader->Seek(nextPos))
+      return nextPos;
+    StopRangeReader();
+    return Reconnect(nextPos);
+  }
+
   if(m_state->Seek(nextPos))
     return nextPos;
 
@@ -1164,6 +1212,11 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
   if(!m_seekable)
     return -1;
 
+  return Reconnect(nextPos);
+}
+
+int64_t CCurlFile::Reconnect(int64_t nextPos)
+{
   CReadState* oldstate = NULL;
   if(m_multisession)
   {
@@ -1207,6 +1260,58 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
   return m_state->m_filePos;
 }
 
+static bool ReadRangeBefore(const SReadRange* a, const SReadRange* b)
+{
+  return a->offset < b->offset;
+}
+
+int64_t CCurlFile::ReadV(SReadRange* ranges, unsigned int count)
+{
+  if (!m_opened) return -1;
+
+  // the range reader keeps its chunks on seeks, just seek and read
+  if (m_rangeReader)
+    return IFile::ReadV(ranges, count);
+
+  // serve the ranges in file order, so they are fetched by as few requests as possible
+  std::vector<SReadRange*> order;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    ranges[i].read = 0;
+    order.push_back(&ranges[i]);
+  }
+  std::stable_sort(order.begin(), order.end(), ReadRangeBefore);
+
+  int64_t total = 0;
+  char skip[4096];
+  for (std::vector<SReadRange*>::iterator it = order.begin(); it != order.end(); ++it)
+  {
+    SReadRange& range = **it;
+
+    int64_t gap = range.offset - m_state->m_filePos;
+    while (gap > 0 && gap <= READV_MAX_GAP)
+    {
+      unsigned int read = m_state->Read(skip, XMIN(gap, (int64_t)sizeof(skip)));
+      if (read == 0)
+        break;
+      gap -= read;
+    }
+
+    if (m_state->m_filePos != range.offset && Seek(range.offset, SEEK_SET) != range.offset)
+      continue;
+
+    while (range.read < range.size)
+    {
+      unsigned int read = m_state->Read((char*)range.buffer + range.read, range.size - range.read);
+      if (read == 0)
+        break;
+      range.read += read;
+    }
+    total += range.read;
+  }
+  return total;
+}
+
 int64_t CCurlFile::GetLength()
 {
   if (!m_opened) return 0;
@@ -1216,9 +1321,84 @@ int64_t CCurlFile::GetLength()
 int64_t CCurlFile::GetPosition()
 {
   if (!m_opened) return 0;
+  if (m_rangeReader) return m_rangeReader->GetPosition();
   return m_state->m_filePos;
 }
 
+unsigned int CCurlFile::Read(void* lpBuf, int64_t uiBufSize)
+{
+  if (m_rangeReader)
+  {
+    int read = m_rangeReader->Read(lpBuf, (unsigned int)XMIN(uiBufSize, INT_MAX));
+    if (read >= 0)
+      return read;
+
+    // e.g. the server ignored the range, continue over a single connection
+    int64_t pos = m_rangeReader->GetPosition();
+    CLog::Log(LOGWARNING, "%s - parallel range requests failed at %"PRId64", continuing over a single connection", __FUNCTION__, pos);
+    StopRangeReader();
+    if (Reconnect(pos) != pos)
+      return 0;
+  }
+
+  return m_state->Read(lpBuf, uiBufSize);
+}
+
+bool CCurlFile::ReadString(char *szLine, int iLineLength)
+{
+  if (m_rangeReader)
+  {
+    char* pLine = szLine;
+    while (pLine - szLine < iLineLength - 1)
+    {
+      if (Read(pLine, 1) != 1)
+        break;
+
+      pLine++;
+      if ((pLine - 1)[0] == '\n')
+        break;
+    }
+    pLine[0] = 0;
+    return pLine > szLine;
+  }
+
+  return m_state->ReadString(szLine, iLineLength);
+}
+
+void CCurlFile::StartRangeReader(const CURL& url)
+{
+  unsigned int connections = g_advancedSettings.m_curlParallelRanges;
+  if (g_advancedSettings.m_curlMaxHostSessions > 0)
+    connections = std::min(connections, g_advancedSettings.m_curlMaxHostSessions);
+
+  if (connections < 2 || !m_seekable || m_state->m_fileSize < PARALLEL_RANGES_MIN_SIZE)
+    return;
+
+  if (!url.GetProtocol().Equals("http") && !url.GetProtocol().Equals("https"))
+    return;
+
+  // only rely on ranges when the server says it supports them, and the data isn't encoded
+  if (!m_state->m_httpheader.GetValue("Accept-Ranges").Equals("bytes") || !m_contentencoding.IsEmpty() || m_postdataset)
+    return;
+
+  CCurlRangeReader* reader = new CCurlRangeReader(m_state->m_easyHandle, m_state->m_fileSize, connections);
+  if (!reader->Start(m_state->m_filePos))
+  {
+    delete reader;
+    return;
+  }
+
+  CLog::Log(LOGDEBUG, "CCurlFile::StartRangeReader - reading %s over %u connections", m_url.c_str(), connections);
+  m_state->Stop();
+  m_rangeReader = reader;
+}
+
+void CCurlFile::StopRangeReader()
+{
+  delete m_rangeReader;
+  m_rangeReader = NULL;
+}
+
 int CCurlFile::Stat(const CURL& url, struct __stat64* buffer)
 {
   // if file is already running, get info from it
@@ -35,6 +35,8 @@ class CHttpHeader;
 
 namespace XFILE
 {
+  class CCurlRangeReader;
+
   class CCurlFile : public IFile
   {
     public:
@@ -57,8 +59,9 @@ namespace XFILE
       virtual int64_t  GetLength();
       virtual int  Stat(const CURL& url, struct __stat64* buffer);
       virtual void Close();
-      virtual bool ReadString(char *szLine, int iLineLength)     { return m_state->ReadString(szLine, iLineLength); }
-      virtual unsigned int Read(void* lpBuf, int64_t uiBufSize)  { return m_state->Read(lpBuf, uiBufSize); }
+      virtual bool ReadString(char *szLine, int iLineLength);
+      virtual unsigned int Read(void* lpBuf, int64_t uiBufSize);
+      virtual int64_t ReadV(SReadRange* ranges, unsigned int count);
       virtual int Write(const void* lpBuf, int64_t uiBufSize);
       virtual CStdString GetMimeType()                           { return m_state->m_httpheader.GetMimeType(); }
       virtual int IoControl(EIoControl request, void* param);
@@ -138,6 +141,7 @@ namespace XFILE
           void         SetResume(void);
           long         Connect(unsigned int size);
           void         Disconnect();
+          void         Stop();
       };
 
     protected:
@@ -146,10 +150,14 @@ namespace XFILE
       void SetRequestHeaders(CReadState* state);
       void SetCorrectHeaders(CReadState* state);
       bool Service(const CStdString& strURL, CStdString& strHTML);
+      int64_t Reconnect(int64_t nextPos);
+      void StartRangeReader(const CURL& url);
+      void StopRangeReader();
 
     protected:
       CReadState*     m_state;
       CReadState*     m_oldState;
+      CCurlRangeReader* m_rangeReader;    // reads over several connections, if enabled
       unsigned int    m_bufferSize;
       int64_t         m_writeOffset;
 
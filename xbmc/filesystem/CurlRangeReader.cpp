@@ -0,0 +1,332 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#ifdef TARGET_POSIX
+#include <inttypes.h>
+#endif
+
+#include "CurlRangeReader.h"
+#include "DllLibCurl.h"
+#include "utils/log.h"
+
+using namespace XFILE;
+using namespace XCURL;
+
+CCurlRangeReader::CCurlRangeReader(CURL_HANDLE* easy, int64_t fileSize, unsigned int connections, unsigned int chunkSize)
+  : m_multi(NULL)
+  , m_fileSize(fileSize)
+  , m_position(0)
+  , m_chunkSize(chunkSize)
+  , m_failed(false)
+{
+  // no point in more connections than there are chunks
+  int64_t chunks = (fileSize + chunkSize - 1) / chunkSize;
+  if ((int64_t)connections > chunks)
+    connections = (unsigned int)chunks;
+  if (connections == 0)
+    connections = 1;
+
+  m_multi = g_curlInterface.multi_init();
+  for (unsigned int i = 0; i < connections; i++)
+  {
+    SChunk* chunk = new SChunk();
+    chunk->owner = this;
+    chunk->easy = NULL;
+    chunk->begin = chunk->end = 0;
+    chunk->size = 0;
+    chunk->active = chunk->checked = chunk->done = chunk->failed = false;
+
+    // the duplicates are sessions of the pool, their connections are reused once released
+    g_curlInterface.easy_duplicate(easy, NULL, &chunk->easy, NULL);
+    if (chunk->easy == NULL)
+    {
+      delete chunk;
+      break;
+    }
+    chunk->data.resize(chunkSize);
+    m_all.push_back(chunk);
+    m_idle.push_back(chunk);
+  }
+}
+
+CCurlRangeReader::~CCurlRangeReader()
+{
+  for (std::vector<SChunk*>::iterator it = m_all.begin(); it != m_all.end(); ++it)
+  {
+    Stop(*it);
+    g_curlInterface.easy_release(&(*it)->easy, NULL);
+    delete *it;
+  }
+
+  if (m_multi)
+    g_curlInterface.multi_cleanup(m_multi);
+}
+
+size_t CCurlRangeReader::WriteCallback(char *buffer, size_t size, size_t nitems, void *userp)
+{
+  SChunk* chunk = (SChunk*)userp;
+  size_t amount = size * nitems;
+
+  if (!chunk->checked)
+  {
+    // anything but partial content means the server sends something else than the range
+    long response = 0;
+    g_curlInterface.easy_getinfo(chunk->easy, CURLINFO_RESPONSE_CODE, &response);
+    chunk->checked = true;
+    if (response != 206)
+    {
+      CLog::Log(LOGDEBUG, "CCurlRangeReader - range %"PRId64"-%"PRId64" got response %ld", chunk->begin, chunk->end - 1, response);
+      chunk->failed = true;
+      return 0;
+    }
+  }
+
+  if (chunk->size + amount > (size_t)(chunk->end - chunk->begin))
+  {
+    CLog::Log(LOGDEBUG, "CCurlRangeReader - range %"PRId64"-%"PRId64" got more data than requested", chunk->begin, chunk->end - 1);
+    chunk->failed = true;
+    return 0;
+  }
+
+  memcpy(&chunk->data[chunk->size], buffer, amount);
+  chunk->size += amount;
+  return amount;
+}
+
+size_t CCurlRangeReader::HeaderCallback(void *ptr, size_t size, size_t nmemb, void *userp)
+{
+  // the headers were parsed with the first request already
+  return size * nmemb;
+}
+
+void CCurlRangeReader::Stop(SChunk* chunk)
+{
+  if (chunk->active)
+    g_curlInterface.multi_remove_handle(m_multi, chunk->easy);
+  chunk->active = false;
+}
+
+bool CCurlRangeReader::Schedule(SChunk* chunk, int64_t begin)
+{
+  Stop(chunk);
+
+  chunk->begin = begin;
+  chunk->end = std::min(begin + m_chunkSize, m_fileSize);
+  chunk->size = 0;
+  chunk->checked = chunk->done = chunk->failed = false;
+
+  char range[64];
+  snprintf(range, sizeof(range), "%"PRId64"-%"PRId64, chunk->begin, chunk->end - 1);
+
+  g_curlInterface.easy_setopt(chunk->easy, CURLOPT_RANGE, range);
+  g_curlInterface.easy_setopt(chunk->easy, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)0);
+  g_curlInterface.easy_setopt(chunk->easy, CURLOPT_WRITEFUNCTION, WriteCallback);
+  g_curlInterface.easy_setopt(chunk->easy, CURLOPT_WRITEDATA, chunk);
+  g_curlInterface.easy_setopt(chunk->easy, CURLOPT_HEADERFUNCTION, HeaderCallback);
+  g_curlInterface.easy_setopt(chunk->easy, CURLOPT_WRITEHEADER, chunk);
+
+  if (g_curlInterface.multi_add_handle(m_multi, chunk->easy) != CURLM_OK)
+    return false;
+
+  chunk->active = true;
+  return true;
+}
+
+bool CCurlRangeReader::Start(int64_t position)
+{
+  for (std::deque<SChunk*>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+  {
+    Stop(*it);
+    m_idle.push_back(*it);
+  }
+  m_chunks.clear();
+
+  m_failed = false;
+  m_position = position;
+  if (m_multi == NULL || m_all.empty())
+    return false;
+
+  int64_t next = position;
+  while (!m_idle.empty() && next < m_fileSize)
+  {
+    SChunk* chunk = m_idle.back();
+    m_idle.pop_back();
+    if (!Schedule(chunk, next))
+    {
+      m_idle.push_back(chunk);
+      return false;
+    }
+    m_chunks.push_back(chunk);
+    next = chunk->end;
+  }
+
+  return true;
+}
+
+void CCurlRangeReader::Recycle()
+{
+  SChunk* chunk = m_chunks.front();
+  m_chunks.pop_front();
+
+  int64_t next = m_chunks.empty() ? chunk->end : m_chunks.back()->end;
+  if (next < m_fileSize && Schedule(chunk, next))
+    m_chunks.push_back(chunk);
+  else
+  {
+    Stop(chunk);
+    m_idle.push_back(chunk);
+  }
+}
+
+bool CCurlRangeReader::Perform(bool wait)
+{
+  int running = 0;
+  CURLMcode result = g_curlInterface.multi_perform(m_multi, &running);
+  if (result != CURLM_OK && result != CURLM_CALL_MULTI_PERFORM)
+  {
+    CLog::Log(LOGERROR, "CCurlRangeReader::Perform - Multi perform failed with code %d", result);
+    return false;
+  }
+
+  bool finished = false;
+  int msgs;
+  CURLMsg* msg;
+  while ((msg = g_curlInterface.multi_info_read(m_multi, &msgs)))
+  {
+    if (msg->msg != CURLMSG_DONE)
+      continue;
+
+    for (std::vector<SChunk*>::iterator it = m_all.begin(); it != m_all.end(); ++it)
+    {
+      SChunk* chunk = *it;
+      if (chunk->easy != msg->easy_handle || !chunk->active)
+        continue;
+
+      chunk->done = true;
+      if (msg->data.result != CURLE_OK || chunk->size != (size_t)(chunk->end - chunk->begin))
+      {
+        if (!chunk->failed)
+          CLog::Log(LOGDEBUG, "CCurlRangeReader - range %"PRId64"-%"PRId64" failed: %s(%d)", chunk->begin, chunk->end - 1,
+                    g_curlInterface.easy_strerror(msg->data.result), msg->data.result);
+        chunk->failed = true;
+      }
+      finished = true;
+    }
+  }
+
+  if (!wait || finished || result == CURLM_CALL_MULTI_PERFORM)
+    return true;
+
+  fd_set fdread;
+  fd_set fdwrite;
+  fd_set fdexcep;
+  int maxfd = -1;
+  FD_ZERO(&fdread);
+  FD_ZERO(&fdwrite);
+  FD_ZERO(&fdexcep);
+  g_curlInterface.multi_fdset(m_multi, &fdread, &fdwrite, &fdexcep, &maxfd);
+
+  long timeout = 0;
+  if (CURLM_OK != g_curlInterface.multi_timeout(m_multi, &timeout) || timeout == -1 || timeout > 200)
+    timeout = 200;
+
+  // stalled transfers are aborted by curl itself, through the low speed limit of the handle
+  struct timeval t = { timeout / 1000, (timeout % 1000) * 1000 };
+  if (select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &t) < 0)
+  {
+    CLog::Log(LOGERROR, "CCurlRangeReader::Perform - Failed with socket error");
+    return false;
+  }
+  return true;
+}
+
+int CCurlRangeReader::Read(void* buffer, unsigned int size)
+{
+  if (m_failed)
+    return -1;
+
+  while (m_position < m_fileSize && !m_chunks.empty())
+  {
+    SChunk* chunk = m_chunks.front();
+    if (m_position >= chunk->end)
+    {
+      Recycle();
+      continue;
+    }
+
+    size_t offset = (size_t)(m_position - chunk->begin);
+    if (chunk->size > offset)
+    {
+      // keep the other transfers going while the caller is busy with the data
+      if (chunk->size < (size_t)(chunk->end - chunk->begin) || m_chunks.size() > 1)
+        Perform(false);
+
+      size_t amount = std::min((size_t)size, chunk->size - offset);
+      memcpy(buffer, &chunk->data[offset], amount);
+      m_position += amount;
+
+      // hand the connection to the next chunk as soon as possible
+      if (m_position >= chunk->end)
+        Recycle();
+      return (int)amount;
+    }
+
+    if (chunk->failed || chunk->done)
+    {
+      m_failed = true;
+      return -1;
+    }
+
+    if (!Perform(true))
+    {
+      m_failed = true;
+      return -1;
+    }
+  }
+
+  if (m_position < m_fileSize)
+  {
+    m_failed = true;
+    return -1;
+  }
+  return 0;
+}
+
+bool CCurlRangeReader::Seek(int64_t position)
+{
+  if (position < 0 || position > m_fileSize)
+    return false;
+
+  // keep what has been requested already, if position is in it
+  if (!m_failed && !m_chunks.empty() && position >= m_chunks.front()->begin && position < m_chunks.back()->end)
+  {
+    m_position = position;
+    while (m_position >= m_chunks.front()->end)
+      Recycle();
+    return true;
+  }
+
+  return Start(position);
+}
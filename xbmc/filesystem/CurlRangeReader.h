@@ -0,0 +1,107 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+namespace XCURL
+{
+  typedef void CURL_HANDLE;
+  typedef void CURLM;
+}
+
+namespace XFILE
+{
+  /*!
+   \brief Sequential reader fetching a http file over several connections
+
+   The file is split into chunks that are requested with a range each,
+   one request per connection. The chunks are handed out in file order,
+   so for the caller it reads like a single connection. A chunk that has
+   been read is reused for the chunk after the last one requested.
+   */
+  class CCurlRangeReader
+  {
+  public:
+    /*!
+     \param easy handle set up for the file, duplicated for every connection
+     \param fileSize size of the file
+     \param connections number of requests running at the same time
+     \param chunkSize bytes requested per range
+     */
+    CCurlRangeReader(XCURL::CURL_HANDLE* easy, int64_t fileSize, unsigned int connections, unsigned int chunkSize = 1024 * 1024);
+    ~CCurlRangeReader();
+
+    /*!
+     \brief (Re)start reading at position
+     \return false if the requests couldn't be set up
+     */
+    bool Start(int64_t position);
+
+    /*!
+     \brief Read the data at the current position, waiting for it if needed
+     \return bytes read, 0 at the end of the file, -1 if a request failed
+     (e.g. the server ignored the range) and reading has to continue some other way
+     */
+    int Read(void* buffer, unsigned int size);
+
+    /*!
+     \brief Seek, keeping the requested chunks if position is in them
+     */
+    bool Seek(int64_t position);
+
+    int64_t GetPosition() const { return m_position; }
+    int64_t GetLength() const   { return m_fileSize; }
+
+  private:
+    struct SChunk
+    {
+      CCurlRangeReader*   owner;
+      XCURL::CURL_HANDLE* easy;
+      int64_t             begin;
+      int64_t             end;
+      std::vector<char>   data;
+      size_t              size;
+      bool                active;
+      bool                checked;
+      bool                done;
+      bool                failed;
+    };
+
+    static size_t WriteCallback(char *buffer, size_t size, size_t nitems, void *userp);
+    static size_t HeaderCallback(void *ptr, size_t size, size_t nmemb, void *userp);
+
+    bool Schedule(SChunk* chunk, int64_t begin);
+    void Stop(SChunk* chunk);
+    void Recycle();
+    bool Perform(bool wait);
+
+    XCURL::CURLM*       m_multi;
+    std::vector<SChunk*> m_all;
+    std::deque<SChunk*> m_chunks;  ///< requested chunks, in file order
+    std::vector<SChunk*> m_idle;
+    int64_t             m_fileSize;
+    int64_t             m_position;
+    unsigned int        m_chunkSize;
+    bool                m_failed;
+  };
+}
@@ -39,6 +39,132 @@ using namespace XFILE;
 
 #define TIME_TO_BUSY_DIALOG 500
 
+/*! \brief Remove the items that shouldn't be listed with the given hints
+ \param items The item list to filter
+ \param directory The directory implementation, with the mask of the hints set
+ \param hints The hints passed to CDirectory::GetDirectory */
+static void FilterItems(CFileItemList &items, IDirectory &directory, const CDirectory::CHints &hints)
+{
+  for (int i = 0; i < items.Size(); ++i)
+  {
+    CFileItemPtr item = items[i];
+    // TODO: we shouldn't be checking the gui setting here;
+    // callers should use getHidden instead
+    if ((!item->m_bIsFolder && !directory.IsAllowed(item->GetPath())) ||
+        (item->GetProperty("file:hidden").asBoolean() && !(hints.flags & DIR_FLAG_GET_HIDDEN) && !CSettings::Get().GetBool("filelists.showhidden")))
+    {
+      items.Remove(i);
+      i--; // don't confuse loop
+    }
+  }
+
+  //  Should any of the files we read be treated as a directory?
+  //  Disable for database folders, as they already contain the extracted items
+  if (!(hints.flags & DIR_FLAG_NO_FILE_DIRS) && !items.IsMusicDb() && !items.IsVideoDb() && !items.IsSmartPlayList())
+    CDirectory::FilterFileDirectories(items, hints.mask);
+}
+
+/*! \brief Filters the batches a directory delivers like the final listing before passing them on.
+ The items are copied first, the originals end up in the directory cache unfiltered. The filtered
+ copies are kept, so the final listing needn't be filtered again. */
+class CFilterItems : public IDirectoryCallback
+{
+public:
+  CFilterItems(const CStdString &path, const CStdString &realPath, const CDirectory::CHints &hints, IDirectoryCallback *callback)
+    : m_path(path), m_hints(hints), m_callback(callback), m_cancelled(false), m_received(0)
+  {
+    // the fetching directory can't take the mask until it's done, so filter with our own
+    m_directory.reset(CDirectoryFactory::Create(realPath));
+    if (m_directory.get())
+      m_directory->SetMask(hints.mask);
+  }
+
+  virtual bool OnDirectoryItems(const CFileItemList &items)
+  {
+    if (!m_directory.get())
+      return true;
+
+    CFileItemList batch(m_path);
+    for (int i = 0; i < items.Size(); ++i)
+      batch.Add(CFileItemPtr(new CFileItem(*items[i])));
+    FilterItems(batch, *m_directory, m_hints);
+    m_received += items.Size();
+    m_filtered.Append(batch);
+
+    if (batch.IsEmpty())
+      return true;
+    if (!m_callback->OnDirectoryItems(batch))
+      m_cancelled = true;
+    return !m_cancelled;
+  }
+
+  bool IsCancelled() const { return m_cancelled; }
+
+  /*! \brief Replace the items of the finished listing with the filtered batches
+   \return false if the batches didn't cover the whole listing, it then still needs filtering */
+  bool GetFilteredItems(CFileItemList &items) const
+  {
+    if (!m_directory.get() || m_received != items.Size())
+      return false;
+    items.ClearItems();
+    items.Append(m_filtered);
+    return true;
+  }
+
+private:
+  CStdString                m_path;
+  CDirectory::CHints        m_hints;
+  IDirectoryCallback       *m_callback;
+  auto_ptr<IDirectory>      m_directory;
+  bool                      m_cancelled;
+  int                       m_received;
+  CFileItemList             m_filtered;
+};
+
+/*! \brief Collects the batches delivered on a job thread until the GUI thread picks them up. */
+class CQueueItems : public IDirectoryCallback
+{
+public:
+  CQueueItems() : m_cancelled(false) {}
+
+  virtual bool OnDirectoryItems(const CFileItemList &items)
+  {
+    CSingleLock lock(m_section);
+    if (m_cancelled)
+      return false;
+    m_items.SetPath(items.GetPath());
+    m_items.Append(items);
+    return true;
+  }
+
+  /*! \brief Pass the queued items to callback on the calling thread
+   \return false if the callback cancelled the fetch */
+  bool Deliver(IDirectoryCallback *callback)
+  {
+    CFileItemList items;
+    {
+      CSingleLock lock(m_section);
+      if (m_items.IsEmpty())
+        return !m_cancelled;
+      items.SetPath(m_items.GetPath());
+      items.Append(m_items);
+      m_items.ClearItems();
+    }
+
+    if (callback->OnDirectoryItems(items))
+      return true;
+
+    CSingleLock lock(m_section);
+    m_cancelled = true;
+    return false;
+  }
+
+private:
+  CCriticalSection m_section;
+  CFileItemList    m_items;
+  bool             m_cancelled;
+};
+
 class CGetDirectory
 {
 private:
@@ -50,6 +176,8 @@ private:
     CFileItemList m_list;
     CStdString    m_dir;
     bool          m_result;
+    CQueueItems   m_queue;
+    boost::shared_ptr<CFilterItems> m_filter;
   };
 
   struct CGetJob
@@ -65,6 +193,8 @@ private:
     {
       m_result->m_list.SetPath(m_result->m_dir);
       m_result->m_result         = m_imp->GetDirectory(m_result->m_dir, m_result->m_list);
+      if (m_result->m_result)
+        m_imp->DeliverItems(m_result->m_list, true);
       m_result->m_event.Set();
       return m_result->m_result;
     }
@@ -75,9 +205,14 @@ private:
 
 public:
 
-  CGetDirectory(boost::shared_ptr<IDirectory>& imp, const CStdString& dir) 
+  CGetDirectory(boost::shared_ptr<IDirectory>& imp, const CStdString& dir, const CStdString& path, const CDirectory::CHints& hints)
     : m_result(new CResult(dir))
   {
+    // the filter and queue live in the result, which the job keeps alive even once we're gone
+    if (hints.callback)
+      m_result->m_filter.reset(new CFilterItems(path, dir, hints, &m_result->m_queue));
+    imp->SetCallback(m_result->m_filter.get());
+
     m_id = CJobManager::GetInstance().AddJob(new CGetJob(imp, m_result)
                                            , NULL
                                            , CJob::PRIORITY_HIGH);
@@ -104,6 +239,11 @@ public:
     list.Copy(m_result->m_list);
     return true;
   }
+
+  bool Deliver(IDirectoryCallback *callback)
+  {
+    return m_result->m_queue.Deliver(callback);
+  }
   boost::shared_ptr<CResult> m_result;
   unsigned int               m_id;
 };
@@ -133,7 +273,9 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, c
       return false;
 
     // check our cache for this path
-    if (g_directoryCache.GetDirectory(realPath, items, (hints.flags & DIR_FLAG_READ_CACHE) == DIR_FLAG_READ_CACHE))
+    boost::shared_ptr<CFilterItems> filter;
+    bool cached = g_directoryCache.GetDirectory(realPath, items, (hints.flags & DIR_FLAG_READ_CACHE) == DIR_FLAG_READ_CACHE);
+    if (cached)
       items.SetPath(strPath);
     else
     {
@@ -147,11 +289,12 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, c
       bool result = false, cancel = false;
       while (!result && !cancel)
       {
+        filter.reset();
         if (g_application.IsCurrentThread() && allowThreads && !URIUtils::IsSpecial(strPath))
         {
           CSingleExit ex(g_graphicsContext);
 
-          CGetDirectory get(pDirectory, realPath);
+          CGetDirectory get(pDirectory, realPath, strPath, hints);
           if(!get.Wait(TIME_TO_BUSY_DIALOG))
           {
             CGUIDialogBusy* dialog = (CGUIDialogBusy*)g_windowManager.GetWindow(WINDOW_DIALOG_BUSY);
@@ -166,7 +309,11 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, c
               if (progress > 0)
                 dialog->SetProgress(progress);
 
-              if(dialog->IsCanceled())
+              // let the caller show what we have so far, on this thread and
+              // with the graphics lock taken again above
+              bool stopped = hints.callback && !get.Deliver(hints.callback);
+
+              if(stopped || dialog->IsCanceled())
               {
                 cancel = true;
                 pDirectory->CancelDirectory();
@@ -179,12 +326,21 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, c
             if(dialog)
               dialog->Close();
           }
+          // batches still queued are in the listing the caller gets next
           result = get.GetDirectory(items);
+          filter = get.m_result->m_filter;
         }
         else
         {
           items.SetPath(strPath);
+          if (hints.callback)
+            filter.reset(new CFilterItems(strPath, realPath, hints, hints.callback));
+          pDirectory->SetCallback(filter.get());
           result = pDirectory->GetDirectory(realPath, items);
+          if (result)
+            pDirectory->DeliverItems(items, true);
+          pDirectory->SetCallback(NULL);
+          cancel = filter && filter->IsCancelled();
         }
 
         if (!result)
@@ -201,25 +357,10 @@ bool CDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items, c
         g_directoryCache.SetDirectory(realPath, items, pDirectory->GetCacheType(strPath));
     }
 
-    // now filter for allowed files
+    // now filter for allowed files, unless the delivered batches already were
     pDirectory->SetMask(hints.mask);
-    for (int i = 0; i < items.Size(); ++i)
-    {
-      CFileItemPtr item = items[i];
-      // TODO: we shouldn't be checking the gui setting here;
-      // callers should use getHidden instead
-      if ((!item->m_bIsFolder && !pDirectory->IsAllowed(item->GetPath())) ||
-          (item->GetProperty("file:hidden").asBoolean() && !(hints.flags & DIR_FLAG_GET_HIDDEN) && !CSettings::Get().GetBool("filelists.showhidden")))
-      {
-        items.Remove(i);
-        i--; // don't confuse loop
-      }
-    }
-
-    //  Should any of the files we read be treated as a directory?
-    //  Disable for database folders, as they already contain the extracted items
-    if (!(hints.flags & DIR_FLAG_NO_FILE_DIRS) && !items.IsMusicDb() && !items.IsVideoDb() && !items.IsSmartPlayList())
-      FilterFileDirectories(items, hints.mask);
+    if (!filter || !filter->GetFilteredItems(items))
+      FilterItems(items, *pDirectory, hints);
 
     return true;
   }
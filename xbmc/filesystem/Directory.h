@@ -36,11 +36,12 @@ public:
   class CHints
   {
   public:
-    CHints() : flags(DIR_FLAG_DEFAULTS)
+    CHints() : flags(DIR_FLAG_DEFAULTS), callback(NULL)
     {
     };
     CStdString mask;
     int flags;
+    IDirectoryCallback *callback; ///< receives filtered items while the directory is fetched, see IDirectoryCallback
   };
 
   static bool GetDirectory(const CStdString& strPath
@@ -19,26 +19,81 @@
  */
 
 #include "DirectoryCache.h"
+#include "File.h"
 #include "FileItem.h"
+#include "URL.h"
+#include "settings/AdvancedSettings.h"
+#include "XBDateTime.h"
+#include "threads/Atomics.h"
 #include "threads/SingleLock.h"
+#include "utils/Archive.h"
+#include "utils/Crc32.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "climits"
+#include <algorithm>
+#include <time.h>
+
+// bookkeeping of an item besides its strings (fast lookup node, art and property maps, ...)
+#define DIRCACHE_ITEM_OVERHEAD 256
+#define DIRCACHE_DEFAULT_MEMORY 16  // MB
+
+#define DIRCACHE_PERSIST_FOLDER  "special://temp/dircache/"
+#define DIRCACHE_PERSIST_VERSION 1
+#define DIRCACHE_PERSIST_MAXAGE  30  // days
 
 using namespace std;
 using namespace XFILE;
 
+class CDirectoryCache::CPersistJob : public CJob
+{
+public:
+  CPersistJob(CDirectoryCache &cache, const CStdString &path, const ItemsPtr &items)
+    : m_cache(cache), m_path(path), m_items(items)
+  {
+  }
+
+  virtual const char *GetType() const { return "dircachepersist"; }
+
+  virtual bool DoWork()
+  {
+    return m_cache.Persist(m_path, m_items);
+  }
+
+private:
+  CDirectoryCache &m_cache;
+  CStdString m_path;
+  ItemsPtr m_items; ///< published lists are never modified, safe to archive unlocked
+};
+
+class CDirectoryCache::CPruneJob : public CJob
+{
+public:
+  CPruneJob(CDirectoryCache &cache) : m_cache(cache) { }
+
+  virtual const char *GetType() const { return "dircacheprune"; }
+
+  virtual bool DoWork()
+  {
+    m_cache.Prune();
+    return true;
+  }
+
+private:
+  CDirectoryCache &m_cache;
+};
+
 CDirectoryCache::CDir::CDir(DIR_CACHE_TYPE cacheType)
 {
   m_cacheType = cacheType;
   m_lastAccess = 0;
-  m_Items = new CFileItemList;
-  m_Items->SetFastLookup(true);
+  m_size = 0;
 }
 
 CDirectoryCache::CDir::~CDir()
 {
-  delete m_Items;
 }
 
 void CDirectoryCache::CDir::SetLastAccess(unsigned int &accessCounter)
@@ -49,6 +104,10 @@ void CDirectoryCache::CDir::SetLastAccess(unsigned int &accessCounter)
 CDirectoryCache::CDirectoryCache(void)
 {
   m_accessCounter = 0;
+  m_memory = 0;
+  m_maxMemory = 0;
+  m_persisted = 0;
+  m_nextTemp = 0;
 #ifdef _DEBUG
   m_cacheHits = 0;
   m_cacheMisses = 0;
@@ -61,27 +120,61 @@ CDirectoryCache::~CDirectoryCache(void)
 
 bool CDirectoryCache::GetDirectory(const CStdString& strPath, CFileItemList &items, bool retrieveAll)
 {
-  CSingleLock lock (m_cs);
-
   CStdString storedPath = strPath;
   URIUtils::RemoveSlashAtEnd(storedPath);
 
-  ciCache i = m_cache.find(storedPath);
-  if (i != m_cache.end())
+  ItemsPtr cached;
   {
-    CDir* dir = i->second;
-    if (dir->m_cacheType == XFILE::DIR_CACHE_ALWAYS ||
-       (dir->m_cacheType == XFILE::DIR_CACHE_ONCE && retrieveAll))
+    CSingleLock lock (m_cs);
+
+    ciCache i = m_cache.find(storedPath);
+    if (i != m_cache.end())
     {
-      items.Copy(*dir->m_Items);
+      CDir* dir = i->second;
+      if (dir->m_cacheType != XFILE::DIR_CACHE_ALWAYS &&
+         (dir->m_cacheType != XFILE::DIR_CACHE_ONCE || !retrieveAll))
+        return false;
+
+      cached = dir->m_Items;
       dir->SetLastAccess(m_accessCounter);
-#ifdef _DEBUG
-      m_cacheHits+=items.Size();
-#endif
-      return true;
     }
   }
-  return false;
+
+  // not in memory, maybe we listed it in an earlier run
+  if (!cached && IsPersistEnabled())
+  {
+    ItemsPtr loaded = LoadPersisted(storedPath);
+    if (loaded)
+    {
+      CSingleLock lock (m_cs);
+      ciCache i = m_cache.find(storedPath);
+      if (i != m_cache.end())
+        cached = i->second->m_Items;
+      else
+      {
+        size_t size = EstimateSize(*loaded);
+        CheckIfFull(size);
+        CDir* dir = new CDir(DIR_CACHE_ALWAYS);
+        dir->m_Items = loaded;
+        dir->m_size = size;
+        dir->SetLastAccess(m_accessCounter);
+        m_cache.insert(pair<CStdString, CDir*>(storedPath, dir));
+        m_memory += size;
+        cached = loaded;
+      }
+    }
+  }
+
+  if (!cached)
+    return false;
+
+  // published lists are never modified, so they can be copied without holding the lock
+  items.Copy(*cached);
+#ifdef _DEBUG
+  CSingleLock lock (m_cs);
+  m_cacheHits+=items.Size();
+#endif
+  return true;
 }
 
 void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType)
@@ -100,21 +193,35 @@ void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemLis
   // IDEALLY, any further processing on the item would actually create a new item
   // instead of altering it, but we can't really enforce that in an easy way, so
   // this is the best solution for now.
-  CSingleLock lock (m_cs);
+  ItemsPtr list(new CFileItemList);
+  list->SetFastLookup(true);
+  list->Copy(items);
+  size_t size = EstimateSize(*list);
 
   CStdString storedPath = strPath;
   URIUtils::RemoveSlashAtEnd(storedPath);
 
-  ClearDirectory(storedPath);
+  {
+    CSingleLock lock (m_cs);
 
-  CheckIfFull();
+    iCache i = m_cache.find(storedPath);
+    if (i != m_cache.end())
+      Delete(i);
 
-  CDir* dir = new CDir(cacheType);
-  dir->m_Items->Copy(items);
-  dir->SetLastAccess(m_accessCounter);
-  m_cache.insert(pair<CStdString, CDir*>(storedPath, dir));
-}
+    CheckIfFull(size);
 
+    CDir* dir = new CDir(cacheType);
+    dir->m_Items = list;
+    dir->m_size = size;
+    dir->SetLastAccess(m_accessCounter);
+    m_cache.insert(pair<CStdString, CDir*>(storedPath, dir));
+    m_memory += size;
+  }
+
+  // stat'ing the source and writing the listing may be slow, keep it off the caller's thread
+  if (cacheType == DIR_CACHE_ALWAYS && IsPersistEnabled())
+    CJobManager::GetInstance().AddJob(new CPersistJob(*this, storedPath, list), NULL, CJob::PRIORITY_LOW);
+}
 void CDirectoryCache::ClearFile(const CStdString& strFile)
 {
   CStdString strPath;
@@ -164,8 +271,19 @@ void CDirectoryCache::AddFile(const CStdString& strFile)
   if (i != m_cache.end())
   {
     CDir *dir = i->second;
+    // readers may still be copying the published list, change a copy of it
+    if (!dir->m_Items.unique())
+    {
+      ItemsPtr list(new CFileItemList);
+      list->SetFastLookup(true);
+      list->Copy(*dir->m_Items);
+      dir->m_Items = list;
+    }
     CFileItemPtr item(new CFileItem(strFile, false));
     dir->m_Items->Add(item);
+    m_memory -= dir->m_size;
+    dir->m_size = EstimateSize(*dir->m_Items);
+    m_memory += dir->m_size;
     dir->SetLastAccess(m_accessCounter);
   }
 }
@@ -232,35 +350,231 @@ void CDirectoryCache::ClearCache(set<CStdString>& dirs)
   }
 }
 
-void CDirectoryCache::CheckIfFull()
+void CDirectoryCache::CheckIfFull(size_t needed)
 {
   CSingleLock lock (m_cs);
-  static const unsigned int max_cached_dirs = 10;
+  size_t maxMemory = GetMaxMemory();
 
-  // find the last accessed folder, and remove if the number of cached folders is too many
-  iCache lastAccessed = m_cache.end();
-  unsigned int numCached = 0;
-  for (iCache i = m_cache.begin(); i != m_cache.end(); i++)
+  // drop the least recently used folders until the new one fits,
+  // folders that are always cached are only dropped once nothing else is left
+  while (!m_cache.empty() && m_memory + needed > maxMemory)
   {
-    // ensure dirs that are always cached aren't cleared
-    if (i->second->m_cacheType != DIR_CACHE_ALWAYS)
+    iCache lastAccessed = m_cache.begin();
+    for (iCache i = m_cache.begin(); i != m_cache.end(); i++)
     {
-      if (lastAccessed == m_cache.end() || i->second->GetLastAccess() < lastAccessed->second->GetLastAccess())
+      bool always = i->second->m_cacheType == DIR_CACHE_ALWAYS;
+      bool lastAlways = lastAccessed->second->m_cacheType == DIR_CACHE_ALWAYS;
+      if ((lastAlways && !always) ||
+          (lastAlways == always && i->second->GetLastAccess() < lastAccessed->second->GetLastAccess()))
         lastAccessed = i;
-      numCached++;
     }
-  }
-  if (lastAccessed != m_cache.end() && numCached >= max_cached_dirs)
     Delete(lastAccessed);
+  }
 }
 
 void CDirectoryCache::Delete(iCache it)
 {
   CDir* dir = it->second;
+  m_memory -= dir->m_size;
   delete dir;
   m_cache.erase(it);
 }
 
+void CDirectoryCache::SetMaxMemory(size_t bytes)
+{
+  CSingleLock lock (m_cs);
+  m_maxMemory = bytes;
+  CheckIfFull(0);
+}
+
+size_t CDirectoryCache::GetMaxMemory() const
+{
+  if (m_maxMemory)
+    return m_maxMemory;
+
+  // listings may be cached before the advanced settings are loaded
+  size_t megabytes = g_advancedSettings.m_dirCacheMemorySize;
+  return (megabytes ? megabytes : DIRCACHE_DEFAULT_MEMORY) * 1024 * 1024;
+}
+
+size_t CDirectoryCache::GetMemoryUsage() const
+{
+  CSingleLock lock (m_cs);
+  return m_memory;
+}
+
+size_t CDirectoryCache::EstimateSize(const CFileItemList &items)
+{
+  // the path is stored twice, in the item and as fast lookup key
+  size_t size = sizeof(CFileItemList) + items.GetPath().size();
+  for (int i = 0; i < items.Size(); i++)
+  {
+    const CFileItemPtr item = items[i];
+    size += sizeof(CFileItem) + DIRCACHE_ITEM_OVERHEAD + 2 * item->GetPath().size() + item->GetLabel().size();
+  }
+  return size;
+}
+
+bool CDirectoryCache::IsPersistEnabled()
+{
+  return g_advancedSettings.m_dirCachePersist;
+}
+
+CStdString CDirectoryCache::GetPersistPath(const CStdString& strPath)
+{
+  Crc32 crc;
+  crc.ComputeFromLowerCase(strPath);
+
+  CStdString file;
+  file.Format(DIRCACHE_PERSIST_FOLDER "%08x.fi", (unsigned __int32)crc);
+  return file;
+}
+
+int64_t CDirectoryCache::GetListingTime(const CStdString& strPath)
+{
+  // the listing of an archive changes with the archive itself
+  CURL url(strPath);
+  CStdString source = strPath;
+  if ((url.GetProtocol().Equals("zip") || url.GetProtocol().Equals("rar") || url.GetProtocol().Equals("apk")) &&
+      !url.GetHostName().IsEmpty())
+    source = url.GetHostName();
+
+  struct __stat64 buffer;
+  if (CFile::Stat(source, &buffer) != 0)
+    return 0;
+  return buffer.st_mtime;
+}
+
+bool CDirectoryCache::Persist(const CStdString& strPath, const ItemsPtr &items)
+{
+  // without a modification time the listing can't be revalidated. a folder changed
+  // within the last seconds might change again within the resolution of its time
+  int64_t listingTime = GetListingTime(strPath);
+  if (listingTime == 0 || listingTime >= (int64_t)time(NULL) - 2)
+    return false;
+
+  // written to a temporary file first, so a half written listing is never loaded
+  CStdString file = GetPersistPath(strPath);
+  CStdString temp;
+  temp.Format("%s.%li.tmp", file.c_str(), AtomicIncrement(&m_nextTemp));
+  CFile output;
+  if (!output.OpenForWrite(temp, true))
+  {
+    CDirectory::Create(DIRCACHE_PERSIST_FOLDER);
+    if (!output.OpenForWrite(temp, true))
+    {
+      CLog::Log(LOGWARNING, "%s - unable to write %s", __FUNCTION__, temp.c_str());
+      return false;
+    }
+  }
+
+  CArchive ar(&output, CArchive::store);
+  ar << (int)DIRCACHE_PERSIST_VERSION;
+  ar << strPath;
+  ar << listingTime;
+  ar << *items;
+  ar.Close();
+  int64_t written = output.GetLength();
+  output.Close();
+
+  if (CFile::Exists(file, false))
+    CFile::Delete(file);
+  if (!CFile::Rename(temp, file))
+  {
+    CFile::Delete(temp);
+    return false;
+  }
+
+  // a replaced listing is counted twice, which only makes the next prune come early
+  CSingleLock lock(m_cs);
+  m_persisted += written;
+  bool full = m_persisted > (int64_t)g_advancedSettings.m_dirCachePersistSize * 1024 * 1024;
+  lock.Leave();
+
+  if (full)
+    Prune();
+  return true;
+}
+
+void CDirectoryCache::PrunePersisted()
+{
+  if (IsPersistEnabled())
+    CJobManager::GetInstance().AddJob(new CPruneJob(*this), NULL, CJob::PRIORITY_LOW);
+}
+
+static bool NewestFirst(const CFileItemPtr &left, const CFileItemPtr &right)
+{
+  return left->m_dateTime > right->m_dateTime;
+}
+
+void CDirectoryCache::Prune()
+{
+  CFileItemList items;
+  if (!CDirectory::GetDirectory(DIRCACHE_PERSIST_FOLDER, items, "", DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_BYPASS_CACHE))
+    return;
+
+  // keep the most recently written listings that fit, temporary files left
+  // by an interrupted write go once they expire
+  vector<CFileItemPtr> files;
+  for (int i = 0; i < items.Size(); i++)
+  {
+    if (!items[i]->m_bIsFolder)
+      files.push_back(items[i]);
+  }
+  sort(files.begin(), files.end(), NewestFirst);
+
+  CDateTime expired = CDateTime::GetCurrentDateTime() - CDateTimeSpan(DIRCACHE_PERSIST_MAXAGE, 0, 0, 0);
+  int64_t maxSize = (int64_t)g_advancedSettings.m_dirCachePersistSize * 1024 * 1024;
+  int64_t size = 0;
+  int removed = 0;
+  for (vector<CFileItemPtr>::const_iterator it = files.begin(); it != files.end(); ++it)
+  {
+    const CFileItemPtr &item = *it;
+    if (item->m_dateTime < expired || size + item->m_dwSize > maxSize)
+    {
+      CFile::Delete(item->GetPath());
+      removed++;
+    }
+    else
+      size += item->m_dwSize;
+  }
+  if (removed)
+    CLog::Log(LOGDEBUG, "%s - removed %i stored listings, %"PRId64" bytes left", __FUNCTION__, removed, size);
+
+  CSingleLock lock(m_cs);
+  m_persisted = size;
+}
+
+CDirectoryCache::ItemsPtr CDirectoryCache::LoadPersisted(const CStdString& strPath)
+{
+  CStdString file = GetPersistPath(strPath);
+  CFile input;
+  if (!input.Open(file))
+    return ItemsPtr();
+
+  int version = 0;
+  CStdString path;
+  int64_t listingTime = 0;
+  CArchive ar(&input, CArchive::load);
+  ar >> version;
+  if (version != DIRCACHE_PERSIST_VERSION)
+    return ItemsPtr();
+  ar >> path;
+  ar >> listingTime;
+
+  // checksum collision or an outdated listing
+  if (!path.Equals(strPath) || listingTime != GetListingTime(strPath))
+    return ItemsPtr();
+
+  ItemsPtr items(new CFileItemList);
+  items->SetFastLookup(true);
+  ar >> *items;
+  ar.Close();
+
+  CLog::Log(LOGDEBUG, "%s - using stored listing of %s with %i items", __FUNCTION__, strPath.c_str(), items->Size());
+  return items;
+}
+
 #ifdef _DEBUG
 void CDirectoryCache::PrintStats() const
 {
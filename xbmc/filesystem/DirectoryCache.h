@@ -25,13 +25,33 @@
 
 #include <map>
 #include <set>
+#include "boost/shared_ptr.hpp"
 
 class CFileItem;
 
 namespace XFILE
 {
+  /*!
+   \brief Cache of directory listings, bounded by the memory the listings take
+
+   The cached lists are never modified once published, readers take a
+   reference under the lock and copy the items without holding it. When the
+   memory budget is exceeded the least recently used listings are dropped,
+   those cached with DIR_CACHE_ALWAYS only after all others.
+
+   With <directorycache><persist> enabled, DIR_CACHE_ALWAYS listings are also
+   written to special://temp/dircache/ by a low priority job and reused after a
+   restart as long as the modification time of the directory (or of the archive
+   it is in) is unchanged. Listings of sources without a modification time aren't
+   persisted. The stored listings are limited to <directorycache><persistsize> MB,
+   the oldest are removed first, and those written over 30 days ago are removed too.
+   */
   class CDirectoryCache
   {
+    typedef boost::shared_ptr<CFileItemList> ItemsPtr;
+    class CPersistJob;
+    class CPruneJob;
+
     class CDir
     {
     public:
@@ -41,8 +61,9 @@ namespace XFILE
       void SetLastAccess(unsigned int &accessCounter);
       unsigned int GetLastAccess() const { return m_lastAccess; };
 
-      CFileItemList* m_Items;
+      ItemsPtr m_Items;
       DIR_CACHE_TYPE m_cacheType;
+      size_t m_size; ///< estimated memory used by m_Items
     private:
       unsigned int m_lastAccess;
     };
@@ -57,13 +78,39 @@ namespace XFILE
     void Clear();
     void AddFile(const CStdString& strFile);
     bool FileExists(const CStdString& strPath, bool& bInCache);
+
+    /*!
+     \brief Set the memory budget in bytes, 0 to use <directorycache><memorysize>
+     */
+    void SetMaxMemory(size_t bytes);
+    size_t GetMemoryUsage() const;
+
+    /*!
+     \brief Rough number of bytes a list takes in memory
+     */
+    static size_t EstimateSize(const CFileItemList &items);
+
+    /*!
+     \brief Remove outdated stored listings and those exceeding <directorycache><persistsize>
+
+     Queued as a job, called at startup once the advanced settings are loaded.
+     */
+    void PrunePersisted();
 #ifdef _DEBUG
     void PrintStats() const;
 #endif
   protected:
     void InitCache(std::set<CStdString>& dirs);
     void ClearCache(std::set<CStdString>& dirs);
-    void CheckIfFull();
+    void CheckIfFull(size_t needed);
+    size_t GetMaxMemory() const;
+
+    bool Persist(const CStdString& strPath, const ItemsPtr &items);
+    ItemsPtr LoadPersisted(const CStdString& strPath);
+    void Prune();
+    static bool IsPersistEnabled();
+    static CStdString GetPersistPath(const CStdString& strPath);
+    static int64_t GetListingTime(const CStdString& strPath);
 
     std::map<CStdString, CDir*> m_cache;
     typedef std::map<CStdString, CDir*>::iterator iCache;
@@ -73,6 +120,10 @@ namespace XFILE
     CCriticalSection m_cs;
 
     unsigned int m_accessCounter;
+    size_t m_memory;
+    size_t m_maxMemory;
+    int64_t m_persisted;       ///< bytes of stored listings, as of the last prune plus those written since
+    volatile long m_nextTemp;  ///< suffix of the next temporary file, so concurrent writers don't collide
 
 #ifdef _DEBUG
     unsigned int m_cacheHits;
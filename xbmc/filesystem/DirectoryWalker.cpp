@@ -0,0 +1,394 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DirectoryWalker.h"
+#include "Directory.h"
+#include "FileItem.h"
+#include "URL.h"
+#include "Util.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/Settings.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/log.h"
+#include "utils/URIUtils.h"
+#include <algorithm>
+#include <deque>
+#include <map>
+
+using namespace XFILE;
+
+#define WALK_LOOKAHEAD  64  // directories fetched ahead of the callback at most
+#define WALK_SCAN_NODES 512 // directories looked at when scheduling fetches
+#define WALK_MAX_JOBS   16  // fetches running at once, whatever the number of hosts
+#define WALK_STOP_POLL  100 // ms between checks of the callback's stop flag
+
+enum NODE_STATE
+{
+  NODE_QUEUED = 0,
+  NODE_FETCHING,
+  NODE_DONE
+};
+
+class CDirectoryWalker::CNode
+{
+public:
+  CNode(const CStdString &path, const CStdString &host, unsigned int depth)
+    : m_path(path), m_host(host), m_depth(depth), m_state(NODE_QUEUED), m_expanded(false), m_ignored(false)
+  {
+  }
+
+  CStdString    m_path;
+  CStdString    m_host;
+  unsigned int  m_depth;
+  NODE_STATE    m_state;    ///< guarded by CState::m_section
+  bool          m_expanded; ///< subfolders have been added to the plan
+  bool          m_ignored;  ///< a .nomedia file was found, valid once done
+  CFileItemList m_items;    ///< the listing, valid once done
+};
+
+/*! \brief State shared with the fetch jobs and workers, which may outlive the walker */
+class CDirectoryWalker::CState
+{
+public:
+  CState() : m_running(0), m_workers(0) {}
+
+  CCriticalSection                  m_section;
+  CEvent                            m_done;     ///< set whenever a fetch finishes
+  std::map<CStdString, unsigned int> m_requests; ///< fetches running per host
+  unsigned int                      m_running;  ///< fetches queued or running in all
+  std::deque<CFetchJob*>            m_queue;    ///< fetches waiting for a worker
+  unsigned int                      m_workers;  ///< workers running
+};
+
+/*! \brief Lists one directory on a worker */
+class CDirectoryWalker::CFetchJob
+{
+public:
+  CFetchJob(const boost::shared_ptr<CState> &state, const NodePtr &node, const CStdString &mask, int flags)
+    : m_state(state), m_node(node), m_mask(mask), m_flags(flags), m_finished(false)
+  {
+  }
+
+  ~CFetchJob()
+  {
+    // a job dropped before it ran leaves its node with an empty listing
+    if (!m_finished)
+      Finish();
+  }
+
+  bool DoWork()
+  {
+    // hidden files are needed to find .nomedia, they're removed below unless asked for
+    CDirectory::CHints hints;
+    hints.mask  = m_mask.empty() ? m_mask : m_mask + "|.nomedia";
+    hints.flags = m_flags | DIR_FLAG_GET_HIDDEN;
+    CFileItemList &items = m_node->m_items;
+    bool result = CDirectory::GetDirectory(m_node->m_path, items, hints);
+    items.SetPath(m_node->m_path);
+
+    bool showHidden = (m_flags & DIR_FLAG_GET_HIDDEN) || CSettings::Get().GetBool("filelists.showhidden");
+    for (int i = 0; i < items.Size(); ++i)
+    {
+      CFileItemPtr item = items[i];
+      if (!item->m_bIsFolder && URIUtils::HasExtension(item->GetPath(), ".nomedia"))
+      {
+        if (URIUtils::GetFileName(item->GetPath()).Equals(".nomedia"))
+          m_node->m_ignored = true;
+        else if (m_mask.empty() || URIUtils::HasExtension(item->GetPath(), m_mask))
+          continue;
+      }
+      else if (showHidden || !item->GetProperty("file:hidden").asBoolean())
+        continue;
+      items.Remove(i);
+      i--; // don't confuse loop
+    }
+
+    Finish();
+    return result;
+  }
+
+private:
+  void Finish()
+  {
+    CSingleLock lock(m_state->m_section);
+    m_state->m_requests[m_node->m_host]--;
+    m_state->m_running--;
+    m_node->m_state = NODE_DONE;
+    m_state->m_done.Set();
+    m_finished = true;
+  }
+
+  boost::shared_ptr<CState> m_state;
+  NodePtr                   m_node;
+  CStdString                m_mask;
+  int                       m_flags;
+  bool                      m_finished;
+};
+
+/*! \brief Runs queued fetches until there are none left, then ends and deletes itself.
+ Listings are mostly spent waiting for the network, so the workers are
+ threads of their own rather than taking the job manager's few workers. */
+class CDirectoryWalker::CWorker : public CThread
+{
+public:
+  CWorker(const boost::shared_ptr<CState> &state)
+    : CThread("DirectoryWalker"), m_state(state)
+  {
+  }
+
+protected:
+  virtual void Process()
+  {
+    for (;;)
+    {
+      CFetchJob *job;
+      {
+        CSingleLock lock(m_state->m_section);
+        if (m_state->m_queue.empty())
+        {
+          m_state->m_workers--;
+          return;
+        }
+        job = m_state->m_queue.front();
+        m_state->m_queue.pop_front();
+      }
+      job->DoWork();
+      delete job;
+    }
+  }
+
+private:
+  boost::shared_ptr<CState> m_state;
+};
+
+static bool IsWalkable(const CFileItem &item)
+{
+  return item.m_bIsFolder && !item.IsParentFolder() && !item.IsPlayList();
+}
+
+CDirectoryWalker::CDirectoryWalker(const CStdString &mask /* = "" */, int flags /* = DIR_FLAG_DEFAULTS */)
+  : m_mask(mask), m_flags(flags), m_state(new CState)
+{
+  m_hostRequests = g_advancedSettings.m_dirWalkHostRequests;
+}
+
+CDirectoryWalker::~CDirectoryWalker()
+{
+}
+
+void CDirectoryWalker::SetExcludes(const CStdStringArray &regexps)
+{
+  m_excludes = regexps;
+}
+
+void CDirectoryWalker::SetHostRequests(unsigned int requests)
+{
+  m_hostRequests = std::max(requests, 1U);
+}
+
+bool CDirectoryWalker::Walk(const CStdString &path, IDirectoryWalkerCallback &callback)
+{
+  if (IsExcluded(path))
+    return true;
+
+  // the directories to visit in walk order, each directly followed by its subfolders
+  Plan plan;
+  plan.push_back(CreateNode(path, 0));
+
+  Plan::iterator current = plan.begin();
+  while (current != plan.end())
+  {
+    NodePtr node = *current;
+    for (;;)
+    {
+      Schedule(plan, current, callback);
+
+      bool done;
+      {
+        CSingleLock lock(m_state->m_section);
+        done = node->m_state == NODE_DONE;
+      }
+      if (done)
+        break;
+      if (callback.IsStopped())
+      {
+        Cancel();
+        return false;
+      }
+      m_state->m_done.WaitMSec(WALK_STOP_POLL);
+    }
+
+    if (node->m_ignored)
+    {
+      CLog::Log(LOGDEBUG, "%s: Skipping '%s' (.nomedia)", __FUNCTION__, node->m_path.c_str());
+      Reconcile(plan, current, NULL);
+    }
+    else
+    {
+      DIRECTORY_WALK walk = callback.OnDirectory(node->m_path, node->m_items);
+      if (walk == WALK_STOP)
+      {
+        Cancel();
+        return false;
+      }
+      Reconcile(plan, current, walk == WALK_RECURSE ? &node->m_items : NULL);
+    }
+    current = plan.erase(current);
+  }
+  return true;
+}
+
+CDirectoryWalker::NodePtr CDirectoryWalker::CreateNode(const CStdString &path, unsigned int depth) const
+{
+  CURL url(path);
+  return NodePtr(new CNode(path, url.GetProtocol() + "://" + url.GetHostName(), depth));
+}
+
+void CDirectoryWalker::Cancel()
+{
+  // the fetches still running finish on their own, their listings are dropped with the state
+  std::deque<CFetchJob*> queue;
+  {
+    CSingleLock lock(m_state->m_section);
+    queue.swap(m_state->m_queue);
+  }
+  for (std::deque<CFetchJob*>::iterator it = queue.begin(); it != queue.end(); ++it)
+    delete *it;
+}
+
+bool CDirectoryWalker::IsExcluded(const CStdString &path) const
+{
+  return !m_excludes.empty() && CUtil::ExcludeFileOrFolder(path, m_excludes);
+}
+
+void CDirectoryWalker::Schedule(Plan &plan, Plan::iterator current, IDirectoryWalkerCallback &callback)
+{
+  unsigned int outstanding = 0;
+  unsigned int scanned = 0;
+  for (Plan::iterator it = current; it != plan.end() && scanned < WALK_SCAN_NODES; ++it, ++scanned)
+  {
+    NodePtr node = *it;
+    NODE_STATE state;
+    {
+      CSingleLock lock(m_state->m_section);
+      state = node->m_state;
+    }
+
+    if (state == NODE_DONE && !node->m_expanded)
+      Expand(plan, it);
+    else if (state == NODE_QUEUED)
+    {
+      if (outstanding >= WALK_LOOKAHEAD)
+        break;
+
+      if (!callback.NeedsListing(node->m_path))
+      {
+        CSingleLock lock(m_state->m_section);
+        node->m_state = NODE_DONE;
+        continue;
+      }
+
+      CSingleLock lock(m_state->m_section);
+      if (m_state->m_running >= WALK_MAX_JOBS)
+        break;
+      unsigned int &requests = m_state->m_requests[node->m_host];
+      if (requests >= m_hostRequests)
+        continue;
+      requests++;
+      m_state->m_running++;
+      node->m_state = NODE_FETCHING;
+
+      // a worker per fetch at most, idle ones end right away
+      m_state->m_queue.push_back(new CFetchJob(m_state, node, m_mask, m_flags));
+      if (m_state->m_workers < m_state->m_running)
+      {
+        m_state->m_workers++;
+        CWorker *worker = new CWorker(m_state);
+        worker->Create(true);
+      }
+    }
+    outstanding++;
+  }
+}
+
+void CDirectoryWalker::Expand(Plan &plan, Plan::iterator node)
+{
+  // fetch the subfolders before the callback decides on them, Reconcile() drops the unwanted
+  const CNode &parent = **node;
+  Plan children;
+  if (!parent.m_ignored)
+  {
+    for (int i = 0; i < parent.m_items.Size(); i++)
+    {
+      const CFileItemPtr item = parent.m_items[i];
+      if (IsWalkable(*item) && !IsExcluded(item->GetPath()))
+        children.push_back(CreateNode(item->GetPath(), parent.m_depth + 1));
+    }
+  }
+  (*node)->m_expanded = true;
+
+  Plan::iterator next = node;
+  plan.splice(++next, children);
+}
+
+void CDirectoryWalker::Reconcile(Plan &plan, Plan::iterator node, const CFileItemList *items)
+{
+  // take the subtrees of the subfolders added by Expand() out of the plan
+  unsigned int depth = (*node)->m_depth;
+  std::map<CStdString, Plan> subtrees;
+  Plan::iterator end = node;
+  ++end;
+  while (end != plan.end() && (*end)->m_depth > depth)
+  {
+    Plan::iterator start = end;
+    do
+      ++end;
+    while (end != plan.end() && (*end)->m_depth > depth + 1);
+
+    Plan &subtree = subtrees[(*start)->m_path];
+    subtree.splice(subtree.end(), plan, start, end);
+  }
+
+  if (!items)
+    return;
+
+  // and put back those of the folders the callback left, in their order
+  Plan children;
+  for (int i = 0; i < items->Size(); i++)
+  {
+    const CFileItemPtr item = (*items)[i];
+    if (!IsWalkable(*item))
+      continue;
+
+    std::map<CStdString, Plan>::iterator subtree = subtrees.find(item->GetPath());
+    if (subtree != subtrees.end())
+    {
+      children.splice(children.end(), subtree->second);
+      subtrees.erase(subtree);
+    }
+    else if (!IsExcluded(item->GetPath()))
+      children.push_back(CreateNode(item->GetPath(), depth + 1));
+  }
+
+  Plan::iterator next = node;
+  plan.splice(++next, children);
+}
@@ -0,0 +1,134 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <list>
+#include <boost/shared_ptr.hpp>
+#include "IDirectory.h"
+#include "utils/StdString.h"
+
+class CFileItemList;
+
+namespace XFILE
+{
+  /*! \brief What CDirectoryWalker does after a directory has been handed to its callback */
+  enum DIRECTORY_WALK
+  {
+    WALK_RECURSE = 0, ///< walk the folders that are left in the listing
+    WALK_SKIP,        ///< don't walk any folder below this directory
+    WALK_STOP         ///< end the walk
+  };
+
+  /*!
+   \brief Receives the directories found by CDirectoryWalker
+   \sa CDirectoryWalker
+   */
+  class IDirectoryWalkerCallback
+  {
+  public:
+    virtual ~IDirectoryWalkerCallback() {}
+
+    /*!
+     \brief Called for every directory of the walk, on the thread calling CDirectoryWalker::Walk
+     The directories come in the order a sequential depth first walk visits them.
+     \param path the directory.
+     \param items its listing, empty if it couldn't be retrieved. Folders (other than parent
+                  folders and playlists) still in it on return are walked next, in list order.
+     \return what to do next, see DIRECTORY_WALK.
+     */
+    virtual DIRECTORY_WALK OnDirectory(const CStdString &path, CFileItemList &items) = 0;
+
+    /*!
+     \brief Called before a directory is listed, on the thread calling CDirectoryWalker::Walk
+     A directory that isn't listed is handed to OnDirectory() with an empty listing, so
+     nothing below it is walked either. This may be called well ahead of OnDirectory().
+     \param path the directory.
+     \return true to list the directory, false if the callback doesn't need its listing.
+     */
+    virtual bool NeedsListing(const CStdString &path) { return true; }
+
+    /*!
+     \brief Polled while the walk waits for a listing
+     \return true to end the walk.
+     */
+    virtual bool IsStopped() { return false; }
+  };
+
+  /*!
+   \brief Walks a directory tree, listing several directories at once
+
+   Directories are fetched ahead of the callback by worker threads of the
+   walk, at most network/dirwalkhostrequests (advancedsettings, 4 by default)
+   per host and 16 in all, so a walk over a network share is limited by
+   bandwidth rather than by the round trip time of each listing. The job
+   manager's workers are left alone. Subfolders are fetched as soon as their
+   parent is listed, before the callback has decided whether to walk them.
+
+   Folders matching one of the exclude expressions and folders containing a
+   ".nomedia" file are skipped without calling the callback.
+   */
+  class CDirectoryWalker
+  {
+  public:
+    /*!
+     \param mask the mask of files to list, see IDirectory::SetMask.
+     \param flags the flags to list with, see DIR_FLAG.
+     */
+    CDirectoryWalker(const CStdString &mask = "", int flags = DIR_FLAG_DEFAULTS);
+    ~CDirectoryWalker();
+
+    /*! \brief Set the regular expressions of folders to skip, see CUtil::ExcludeFileOrFolder */
+    void SetExcludes(const CStdStringArray &regexps);
+
+    /*! \brief Set the number of directories listed at once from a single host */
+    void SetHostRequests(unsigned int requests);
+
+    /*!
+     \brief Walk the tree below path, including path itself
+     \param path the directory to start at.
+     \param callback receives every directory walked.
+     \return false if the callback stopped the walk, true otherwise.
+     \sa IDirectoryWalkerCallback::IsStopped
+     */
+    bool Walk(const CStdString &path, IDirectoryWalkerCallback &callback);
+
+  private:
+    class CNode;
+    class CState;
+    class CFetchJob;
+    class CWorker;
+    typedef boost::shared_ptr<CNode> NodePtr;
+    typedef std::list<NodePtr> Plan;
+
+    NodePtr CreateNode(const CStdString &path, unsigned int depth) const;
+    bool IsExcluded(const CStdString &path) const;
+    /*! \brief Drop the fetches no worker has started yet */
+    void Cancel();
+    void Schedule(Plan &plan, Plan::iterator current, IDirectoryWalkerCallback &callback);
+    void Expand(Plan &plan, Plan::iterator node);
+    void Reconcile(Plan &plan, Plan::iterator node, const CFileItemList *items);
+
+    CStdString       m_mask;
+    int              m_flags;
+    CStdStringArray  m_excludes;
+    unsigned int     m_hostRequests;
+    boost::shared_ptr<CState> m_state;
+  };
+}
@@ -21,6 +21,7 @@
 #include "threads/SystemClock.h"
 #include "system.h"
 #include "DllLibCurl.h"
+#include "settings/AdvancedSettings.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
@@ -29,12 +30,20 @@
 
 using namespace XCURL;
 
+/* how long to wait for a session to a host that has reached its limit, before going over it */
+#define CURL_SESSION_WAIT 2000
+
 /* okey this is damn ugly. our dll loader doesn't allow for postload, preunload functions */
 static long g_curlReferences = 0;
 #if(0)
 static unsigned int g_curlTimeout = 0;
 #endif
 
+DllLibCurlGlobal::DllLibCurlGlobal()
+  : m_share(NULL)
+{
+}
+
 bool DllLibCurlGlobal::Load()
 {
   CSingleLock lock(m_critSection);
@@ -56,6 +65,21 @@ bool DllLibCurlGlobal::Load()
     return false;
   }
 
+  /* share resolved names and ssl sessions, so not every handle has to look them up or renegotiate */
+  m_share = share_init();
+  if (m_share)
+  {
+    share_setopt(m_share, CURLSHOPT_LOCKFUNC, ShareLock);
+    share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, ShareUnlock);
+    share_setopt(m_share, CURLSHOPT_USERDATA, this);
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+    /* one connection pool for all multi handles, so connections are kept alive between sessions */
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+  }
+
   /* check idle will clean up the last one */
   g_curlReferences = 2;
 
@@ -70,6 +94,10 @@ void DllLibCurlGlobal::Unload()
     if (!IsLoaded())
       return;
 
+    if (m_share)
+      share_cleanup(m_share);
+    m_share = NULL;
+
     // close libcurl
     global_cleanup();
 
@@ -122,12 +150,53 @@ void DllLibCurlGlobal::CheckIdle()
 #endif
 }
 
+void DllLibCurlGlobal::ShareLock(CURL_HANDLE *handle, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+  DllLibCurlGlobal *global = (DllLibCurlGlobal *)userptr;
+  if (data >= 0 && data < CURL_LOCK_DATA_LAST)
+    global->m_shareLocks[data].lock();
+}
+
+void DllLibCurlGlobal::ShareUnlock(CURL_HANDLE *handle, curl_lock_data data, void *userptr)
+{
+  DllLibCurlGlobal *global = (DllLibCurlGlobal *)userptr;
+  if (data >= 0 && data < CURL_LOCK_DATA_LAST)
+    global->m_shareLocks[data].unlock();
+}
+
+unsigned int DllLibCurlGlobal::BusySessions(const char *protocol, const char *hostname) const
+{
+  unsigned int busy = 0;
+  for (VEC_CURLSESSIONS::const_iterator it = m_sessions.begin(); it != m_sessions.end(); ++it)
+  {
+    if (it->m_busy && it->m_protocol.compare(protocol) == 0 && it->m_hostname.compare(hostname) == 0)
+      busy++;
+  }
+  return busy;
+}
+
 void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, CURL_HANDLE** easy_handle, CURLM** multi_handle)
 {
   assert(easy_handle != NULL);
 
   CSingleLock lock(m_critSection);
 
+  /* limit the connections to a single host. we never wait forever, the */
+  /* caller might hold one of the busy sessions itself (multisession)   */
+  unsigned int limit = g_advancedSettings.m_curlMaxHostSessions;
+  if (limit > 0 && BusySessions(protocol, hostname) >= limit)
+  {
+    XbmcThreads::EndTime timeout(CURL_SESSION_WAIT);
+    while (BusySessions(protocol, hostname) >= limit && !timeout.IsTimePast())
+    {
+      lock.Leave();
+      m_sessionReleased.WaitMSec(50);
+      lock.Enter();
+    }
+    if (BusySessions(protocol, hostname) >= limit)
+      CLog::Log(LOGDEBUG, "%s - going over the limit of %u sessions to %s://%s", __FUNCTION__, limit, protocol, hostname);
+  }
+
   VEC_CURLSESSIONS::iterator it;
   for(it = m_sessions.begin(); it != m_sessions.end(); it++)
   {
@@ -217,6 +286,7 @@ void DllLibCurlGlobal::easy_release(CURL_HANDLE** easy_handle, CURLM** multi_han
       easy_reset(easy);
       it->m_busy = false;
       it->m_idletimestamp = XbmcThreads::SystemClockMillis();
+      m_sessionReleased.Set();
       return;
     }
   }
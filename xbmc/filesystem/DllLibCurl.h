@@ -21,6 +21,7 @@
 
 #include "DynamicDll.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
 
 /* put types of curl in namespace to avoid namespace pollution */
 namespace XCURL
@@ -79,6 +80,9 @@ namespace XCURL
     DEFINE_METHOD2(struct curl_slist*, slist_append, (struct curl_slist * p1, const char * p2))
     DEFINE_METHOD1(void, slist_free_all, (struct curl_slist * p1))
     DEFINE_METHOD1(const char *, easy_strerror, (CURLcode p1))
+    DEFINE_METHOD0(CURLSH *, share_init)
+    DEFINE_METHOD_FP(CURLSHcode, share_setopt, (CURLSH *p1, CURLSHoption p2, ...))
+    DEFINE_METHOD1(CURLSHcode, share_cleanup, (CURLSH *p1))
     BEGIN_METHOD_RESOLVE()
       RESOLVE_METHOD_RENAME(curl_global_init, global_init)
       RESOLVE_METHOD_RENAME(curl_global_cleanup, global_cleanup)
@@ -101,6 +105,9 @@ namespace XCURL
       RESOLVE_METHOD_RENAME(curl_multi_cleanup, multi_cleanup)
       RESOLVE_METHOD_RENAME(curl_slist_append, slist_append)
       RESOLVE_METHOD_RENAME(curl_slist_free_all, slist_free_all)
+      RESOLVE_METHOD_RENAME(curl_share_init, share_init)
+      RESOLVE_METHOD_RENAME_FP(curl_share_setopt, share_setopt)
+      RESOLVE_METHOD_RENAME(curl_share_cleanup, share_cleanup)
     END_METHOD_RESOLVE()
 
   };
@@ -108,13 +115,19 @@ namespace XCURL
   class DllLibCurlGlobal : public DllLibCurl
   {
   public:
+    DllLibCurlGlobal();
+
     /* extend interface with buffered functions */
+    /* waits a while for a session to the host to become free, if the per host limit is reached */
     void easy_aquire(const char *protocol, const char *hostname, CURL_HANDLE** easy_handle, CURLM** multi_handle);
     void easy_release(CURL_HANDLE** easy_handle, CURLM** multi_handle);
     void easy_duplicate(CURL_HANDLE* easy, CURLM* multi, CURL_HANDLE** easy_out, CURLM** multi_out);
     CURL_HANDLE* easy_duphandle(CURL_HANDLE* easy_handle);
     void CheckIdle();
 
+    /* dns and ssl session cache shared by all handles, NULL if not supported */
+    CURLSH* GetShare() const { return m_share; }
+
     /* overloaded load and unload with reference counter */
     virtual bool Load();
     virtual void Unload();
@@ -134,6 +147,16 @@ namespace XCURL
 
     VEC_CURLSESSIONS m_sessions;
     CCriticalSection m_critSection;
+
+  protected:
+    static void ShareLock(CURL_HANDLE *handle, curl_lock_data data, curl_lock_access access, void *userptr);
+    static void ShareUnlock(CURL_HANDLE *handle, curl_lock_data data, void *userptr);
+
+    unsigned int BusySessions(const char *protocol, const char *hostname) const;
+
+    CURLSH*          m_share;
+    CCriticalSection m_shareLocks[CURL_LOCK_DATA_LAST];
+    CEvent           m_sessionReleased;
   };
 }
 
@@ -25,9 +25,14 @@
 #include "DirectoryCache.h"
 #include "Directory.h"
 #include "FileCache.h"
+#include "FileStats.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "utils/BitstreamStats.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
+#include "utils/TimeUtils.h"
+#include "threads/Event.h"
 #include "Util.h"
 #include "URL.h"
 
@@ -43,6 +48,41 @@ using namespace std;
 #pragma warning (disable:4244)
 #endif
 
+/*! \brief Counts a call in CFileStats when it goes out of scope, as failed unless Succeeded() is called */
+class CFileStatsScope
+{
+public:
+  CFileStatsScope(int slot, FILESTATS_OP op)
+    : m_slot(slot), m_op(op), m_start(slot >= 0 ? CurrentHostCounter() : 0), m_success(false), m_bytes(0)
+  {
+  }
+
+  ~CFileStatsScope()
+  {
+    if (m_slot >= 0)
+      CFileStats::Record(m_slot, m_op, m_start, m_success, m_bytes);
+  }
+
+  void Succeeded(uint64_t bytes = 0)
+  {
+    m_success = true;
+    m_bytes = bytes;
+  }
+
+private:
+  int m_slot;
+  FILESTATS_OP m_op;
+  int64_t m_start;
+  bool m_success;
+  uint64_t m_bytes;
+};
+
+static int GetStatsSlot(const CURL &url)
+{
+  const CStdString &protocol = url.GetProtocol();
+  return CFileStats::GetSlot(protocol.IsEmpty() ? "file" : protocol.c_str());
+}
+
 //*********************************************************************************************
 CFile::CFile()
 {
@@ -50,11 +90,15 @@ CFile::CFile()
   m_pBuffer = NULL;
   m_flags = 0;
   m_bitStreamStats = NULL;
+  m_readDone = NULL;
+  m_statsSlot = -1;
 }
 
 //*********************************************************************************************
 CFile::~CFile()
 {
+  WaitForRead();
+  delete m_readDone;
   if (m_pFile)
     SAFE_DELETE(m_pFile);
   if (m_pBuffer)
@@ -231,11 +275,18 @@ bool CFile::Open(const CStdString& strFileName, unsigned int flags)
     if ( (flags & READ_NO_CACHE) == 0 && isInternetStream && !CUtil::IsPicture(strFileName) )
       m_flags |= READ_CACHED;
 
+    // cached files are counted as seen through the cache, the cache counts its source itself
+    m_statsSlot = (m_flags & READ_CACHED) ? CFileStats::GetSlot("filecache") : GetStatsSlot(url);
+    CFileStatsScope stats(m_statsSlot, FILESTATS_OPEN);
+
     if (m_flags & READ_CACHED)
     {
       // for internet stream, if it contains multiple stream, file cache need handle it specially.
       m_pFile = new CFileCache((m_flags & READ_MULTI_STREAM)!=0 && isInternetStream);
-      return m_pFile->Open(url);
+      if (!m_pFile->Open(url))
+        return false;
+      stats.Succeeded();
+      return true;
     }
 
     m_pFile = CFileFactory::CreateLoader(url);
@@ -299,6 +350,7 @@ bool CFile::Open(const CStdString& strFileName, unsigned int flags)
       m_bitStreamStats->Start();
     }
 
+    stats.Succeeded();
     return true;
   }
   XBMCCOMMONS_HANDLE_UNCHECKED
@@ -357,7 +409,10 @@ bool CFile::Exists(const CStdString& strFileName, bool bUseCache /* = true */)
     if (!pFile.get())
       return false;
 
-    return pFile->Exists(url);
+    CFileStatsScope stats(GetStatsSlot(url), FILESTATS_STAT);
+    bool exists = pFile->Exists(url);
+    stats.Succeeded();
+    return exists;
   }
   XBMCCOMMONS_HANDLE_UNCHECKED
   catch (CRedirectException *pRedirectEx)
@@ -397,7 +452,11 @@ bool CFile::Exists(const CStdString& strFileName, bool bUseCache /* = true */)
 
 int CFile::Stat(struct __stat64 *buffer)
 {
-  return m_pFile->Stat(buffer);
+  CFileStatsScope stats(m_statsSlot, FILESTATS_STAT);
+  int result = m_pFile->Stat(buffer);
+  if (result == 0)
+    stats.Succeeded();
+  return result;
 }
 
 bool CFile::SkipNext()
@@ -418,7 +477,12 @@ int CFile::Stat(const CStdString& strFileName, struct __stat64* buffer)
     auto_ptr<IFile> pFile(CFileFactory::CreateLoader(url));
     if (!pFile.get())
       return -1;
-    return pFile->Stat(url, buffer);
+
+    CFileStatsScope stats(GetStatsSlot(url), FILESTATS_STAT);
+    int result = pFile->Stat(url, buffer);
+    if (result == 0)
+      stats.Succeeded();
+    return result;
   }
   XBMCCOMMONS_HANDLE_UNCHECKED
   catch (CRedirectException *pRedirectEx)
@@ -461,6 +525,7 @@ unsigned int CFile::Read(void *lpBuf, int64_t uiBufSize)
   if (!m_pFile)
     return 0;
 
+  CFileStatsScope stats(m_statsSlot, FILESTATS_READ);
   if(m_pBuffer)
   {
     if(m_flags & READ_TRUNCATED)
@@ -470,6 +535,7 @@ unsigned int CFile::Read(void *lpBuf, int64_t uiBufSize)
                                                   m_pBuffer->in_avail()));
       if (m_bitStreamStats && nBytes>0)
         m_bitStreamStats->AddSampleBytes(nBytes);
+      stats.Succeeded(nBytes);
       return nBytes;
     }
     else
@@ -477,6 +543,7 @@ unsigned int CFile::Read(void *lpBuf, int64_t uiBufSize)
       unsigned int nBytes = m_pBuffer->sgetn((char*)lpBuf, uiBufSize);
       if (m_bitStreamStats && nBytes>0)
         m_bitStreamStats->AddSampleBytes(nBytes);
+      stats.Succeeded(nBytes);
       return nBytes;
     }
   }
@@ -488,6 +555,7 @@ unsigned int CFile::Read(void *lpBuf, int64_t uiBufSize)
       unsigned int nBytes = m_pFile->Read(lpBuf, uiBufSize);
       if (m_bitStreamStats && nBytes>0)
         m_bitStreamStats->AddSampleBytes(nBytes);
+      stats.Succeeded(nBytes);
       return nBytes;
     }
     else
@@ -503,6 +571,7 @@ unsigned int CFile::Read(void *lpBuf, int64_t uiBufSize)
       }
       if (m_bitStreamStats && done > 0)
         m_bitStreamStats->AddSampleBytes(done);
+      stats.Succeeded(done);
       return done;
     }
   }
@@ -514,9 +583,130 @@ unsigned int CFile::Read(void *lpBuf, int64_t uiBufSize)
   return 0;
 }
 
+class CFileReadJob : public CJob
+{
+public:
+  CFileReadJob(CFile* file, SReadRange* ranges, unsigned int count, IFileReadCallback* callback, CEvent* done)
+    : m_file(file), m_ranges(ranges), m_count(count), m_callback(callback), m_done(done), m_finished(false)
+  {
+  }
+
+  // a job cancelled before it ran still has to release WaitForRead()
+  virtual ~CFileReadJob()
+  {
+    if (!m_finished)
+    {
+      for (unsigned int i = 0; i < m_count; i++)
+        m_ranges[i].read = 0;
+      Finish(-1);
+    }
+  }
+
+  virtual const char *GetType() const { return "fileread"; }
+
+  virtual bool DoWork()
+  {
+    int64_t result = m_file->ReadV(m_ranges, m_count);
+    Finish(result);
+    return result >= 0;
+  }
+
+  /*! \brief Drop the job without reporting to the callback, for a job that was never queued */
+  void Discard()
+  {
+    m_callback = NULL;
+  }
+
+private:
+  void Finish(int64_t result)
+  {
+    m_finished = true;
+    if (m_callback)
+      m_callback->OnReadComplete(m_file, m_ranges, m_count, result);
+    m_done->Set();
+  }
+
+  CFile* m_file;
+  SReadRange* m_ranges;
+  unsigned int m_count;
+  IFileReadCallback* m_callback;
+  CEvent* m_done;
+  bool m_finished;
+};
+
+int64_t CFile::ReadV(SReadRange* ranges, unsigned int count)
+{
+  if (!m_pFile)
+    return -1;
+
+  // the stream buffer keeps a position of its own, go through it
+  if (m_pBuffer)
+  {
+    int64_t total = 0;
+    for (unsigned int i = 0; i < count; i++)
+    {
+      ranges[i].read = 0;
+      if (Seek(ranges[i].offset, SEEK_SET) == ranges[i].offset)
+        ranges[i].read = Read(ranges[i].buffer, ranges[i].size);
+      total += ranges[i].read;
+    }
+    return total;
+  }
+
+  try
+  {
+    CFileStatsScope stats(m_statsSlot, FILESTATS_READ);
+    int64_t total = m_pFile->ReadV(ranges, count);
+    if (m_bitStreamStats && total > 0)
+      m_bitStreamStats->AddSampleBytes(total);
+    if (total >= 0)
+      stats.Succeeded(total);
+    return total;
+  }
+  XBMCCOMMONS_HANDLE_UNCHECKED
+  catch(...)
+  {
+    CLog::Log(LOGERROR, "%s - Unhandled exception", __FUNCTION__);
+  }
+  return -1;
+}
+
+bool CFile::ReadAsync(SReadRange* ranges, unsigned int count, IFileReadCallback* callback)
+{
+  if (!m_pFile || IsReadPending())
+    return false;
+
+  if (!m_readDone)
+    m_readDone = new CEvent(true, true);
+  m_readDone->Reset();
+
+  CFileReadJob* job = new CFileReadJob(this, ranges, count, callback, m_readDone);
+  if (!CJobManager::GetInstance().AddJob(job, NULL, CJob::PRIORITY_NORMAL))
+  {
+    // the job manager is shutting down, it didn't take the job
+    job->Discard();
+    delete job;
+    return false;
+  }
+  return true;
+}
+
+bool CFile::IsReadPending()
+{
+  return m_readDone && !m_readDone->WaitMSec(0);
+}
+
+void CFile::WaitForRead()
+{
+  if (m_readDone)
+    m_readDone->Wait();
+}
+
 //*********************************************************************************************
 void CFile::Close()
 {
+  WaitForRead();
+
   try
   {
     if (m_pFile)
@@ -524,6 +714,7 @@ void CFile::Close()
 
     SAFE_DELETE(m_pBuffer);
     SAFE_DELETE(m_pFile);
+    m_statsSlot = -1;
   }
   XBMCCOMMONS_HANDLE_UNCHECKED
   catch(...)
@@ -554,19 +745,27 @@ int64_t CFile::Seek(int64_t iFilePosition, int iWhence)
   if (!m_pFile)
     return -1;
 
+  CFileStatsScope stats(m_statsSlot, FILESTATS_SEEK);
+  int64_t result = -1;
   if (m_pBuffer)
   {
     if(iWhence == SEEK_CUR)
-      return m_pBuffer->pubseekoff(iFilePosition,ios_base::cur);
+      result = m_pBuffer->pubseekoff(iFilePosition,ios_base::cur);
     else if(iWhence == SEEK_END)
-      return m_pBuffer->pubseekoff(iFilePosition,ios_base::end);
+      result = m_pBuffer->pubseekoff(iFilePosition,ios_base::end);
     else if(iWhence == SEEK_SET)
-      return m_pBuffer->pubseekoff(iFilePosition,ios_base::beg);
+      result = m_pBuffer->pubseekoff(iFilePosition,ios_base::beg);
+    if (result >= 0)
+      stats.Succeeded();
+    return result;
   }
 
   try
   {
-    return m_pFile->Seek(iFilePosition, iWhence);
+    result = m_pFile->Seek(iFilePosition, iWhence);
+    if (result >= 0)
+      stats.Succeeded();
+    return result;
   }
   XBMCCOMMONS_HANDLE_UNCHECKED
   catch(...)
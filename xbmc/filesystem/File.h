@@ -33,12 +33,14 @@
 #include "PlatformDefs.h"
 
 class BitstreamStats;
+class CEvent;
 class CURL;
 
 namespace XFILE
 {
 
 class IFile;
+class CFile;
 
 class IFileCallback
 {
@@ -47,6 +49,23 @@ public:
   virtual ~IFileCallback() {};
 };
 
+class IFileReadCallback
+{
+public:
+  /*!
+   \brief Called from a worker thread once an asynchronous read has finished
+   Also called with a result of -1 if the read was cancelled because the job
+   manager shut down. The file must not be closed or deleted from here, that
+   waits for the read which only completes once this returned.
+   \param file the file the read was submitted on, usable again once this returned
+   \param ranges the submitted ranges, with their read members filled in
+   \param count number of ranges
+   \param result total number of bytes read, -1 on error
+   */
+  virtual void OnReadComplete(CFile* file, SReadRange* ranges, unsigned int count, int64_t result) = 0;
+  virtual ~IFileReadCallback() {};
+};
+
 /* indicate that caller can handle truncated reads, where function returns before entire buffer has been filled */
 #define READ_TRUNCATED 0x01
 
@@ -76,6 +95,20 @@ public:
   bool Open(const CStdString& strFileName, unsigned int flags = 0);
   bool OpenForWrite(const CStdString& strFileName, bool bOverWrite = false);
   unsigned int Read(void* lpBuf, int64_t uiBufSize);
+  int64_t ReadV(SReadRange* ranges, unsigned int count);
+
+  /*!
+   \brief Read ranges in the background, see IFile::ReadV
+   Only one read can be outstanding, the file, ranges and buffers must not be
+   touched until the callback has run. Close() waits for an outstanding read,
+   so it must not be called from the callback.
+   \return false if a read is already outstanding, the file isn't open or the
+           job manager isn't running
+   */
+  bool ReadAsync(SReadRange* ranges, unsigned int count, IFileReadCallback* callback);
+  bool IsReadPending();
+  void WaitForRead();
+
   bool ReadString(char *szLine, int iLineLength);
   int Write(const void* lpBuf, int64_t uiBufSize);
   void Flush();
@@ -116,6 +149,8 @@ private:
   IFile* m_pFile;
   CFileStreamBuffer* m_pBuffer;
   BitstreamStats* m_bitStreamStats;
+  CEvent* m_readDone;
+  int m_statsSlot;
 };
 
 // streambuf for file io, only supports buffered input currently
@@ -23,9 +23,11 @@
 #include "FileCache.h"
 #include "threads/Thread.h"
 #include "File.h"
+#include "FileStats.h"
 #include "URL.h"
 
-#include "CircularCache.h"
+#include "SegmentCache.h"
+#include "SparseCache.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
@@ -85,7 +87,13 @@ CFileCache::CFileCache(bool useDoubleCache) : CThread("FileCache")
    m_seekPos = 0;
    m_readPos = 0;
    m_writePos = 0;
-   if (g_advancedSettings.m_cacheMemBufferSize == 0)
+   if (g_advancedSettings.m_persistentCacheSize > 0)
+   {
+     // keeps everything it reads, a second cache adds nothing
+     m_pCache = new CSegmentCache(CSegmentStore::GetInstance());
+     useDoubleCache = false;
+   }
+   else if (g_advancedSettings.m_cacheMemBufferSize == 0)
      m_pCache = new CSimpleFileCache();
    else
    {
@@ -96,7 +104,7 @@ CFileCache::CFileCache(bool useDoubleCache) : CThread("FileCache")
        front = front / 2;
        back = back / 2;
      }
-     m_pCache = new CCircularCache(front, back);
+     m_pCache = new CSparseCache(front, back);
    }
    if (useDoubleCache)
    {
@@ -104,6 +112,7 @@ CFileCache::CFileCache(bool useDoubleCache) : CThread("FileCache")
    }
    m_seekPossible = 0;
    m_cacheFull = false;
+   m_underruns = 0;
 }
 
 CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache) : CThread("FileCacheStrategy")
@@ -115,6 +124,7 @@ CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache) : CThread("Fil
   m_writePos = 0;
   m_nSeekResult = 0;
   m_chunkSize = 0;
+  m_underruns = 0;
 }
 
 CFileCache::~CFileCache()
@@ -184,11 +194,32 @@ bool CFileCache::Open(const CURL& url)
   m_writeRate = 1024 * 1024;
   m_writeRateActual = 0;
   m_cacheFull = false;
+  m_underruns = 0;
   m_seekEvent.Reset();
   m_seekEnded.Reset();
 
+  // let the cache recognise data it kept from an earlier open of the same file. not
+  // every opened file can stat itself (http), stating the url gets its Last-Modified
+  // but costs a request, only the persistent cache has any use for it
+  struct __stat64 st;
+  time_t mtime = m_source.Stat(&st) == 0 ? (time_t)st.st_mtime : 0;
+  if (mtime == 0 && g_advancedSettings.m_persistentCacheSize > 0 && CFile::Stat(m_sourcePath, &st) == 0)
+    mtime = (time_t)st.st_mtime;
+  m_pCache->SetSource(m_sourcePath, m_source.GetLength(), mtime);
+  bool cached = m_seekPossible != 0 && m_pCache->CachedDataEndPosIfSeekTo(0) > 0;
+  if (cached)
+  {
+    // let the cache thread continue downloading behind the cached data
+    m_seekPos = 0;
+    m_seekEvent.Set();
+  }
+
   CThread::Create(false);
 
+  if (cached)
+    m_seekEnded.Wait();
+
+  CFileStats::AddCache(m_sourcePath, this);
   return true;
 }
 
@@ -357,6 +388,7 @@ unsigned int CFileCache::Read(void* lpBuf, int64_t uiBufSize)
     return 0;
   }
   int64_t iRc;
+  bool underrun = false;
 
 retry:
   // attempt to read
@@ -369,6 +401,25 @@ retry:
 
   if (iRc == CACHE_RC_WOULD_BLOCK)
   {
+    if (!underrun)
+    {
+      underrun = true;
+      m_underruns++;
+    }
+
+    // the reader used up a cached range the cache thread isn't filling, move it here
+    if (m_seekPossible != 0 && m_pCache->CachedDataEndPosIfSeekTo(m_readPos) != m_pCache->CachedDataEndPos())
+    {
+      m_seekPos = m_readPos;
+      m_seekEvent.Set();
+      if (!m_seekEnded.Wait())
+      {
+        CLog::Log(LOGWARNING, "%s - seek to %"PRId64" failed.", __FUNCTION__, m_seekPos);
+        return 0;
+      }
+      m_seekEvent.Reset();
+    }
+
     // just wait for some data to show up
     iRc = m_pCache->WaitForData(1, 10000);
     if (iRc > 0)
@@ -448,6 +499,7 @@ int64_t CFileCache::Seek(int64_t iFilePosition, int iWhence)
 
 void CFileCache::Close()
 {
+  CFileStats::RemoveCache(this);
   StopThread();
 
   CSingleLock lock(m_sync);
@@ -492,6 +544,7 @@ int CFileCache::IoControl(EIoControl request, void* param)
     status->maxrate = m_writeRate;
     status->currate = m_writeRateActual;
     status->full    = m_cacheFull;
+    status->underruns = m_underruns;
     return 0;
   }
 
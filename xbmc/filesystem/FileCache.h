@@ -76,6 +76,7 @@ namespace XFILE
     unsigned     m_writeRate;
     unsigned     m_writeRateActual;
     bool         m_cacheFull;
+    unsigned     m_underruns;
     CCriticalSection m_sync;
   };
 
@@ -0,0 +1,299 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "FileStats.h"
+#include "IFile.h"
+#include "threads/Atomics.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "threads/ThreadLocal.h"
+#include "utils/TimeUtils.h"
+
+using namespace XFILE;
+using namespace std;
+
+// protocols that can be counted
+#define FILESTATS_MAX_PROTOCOLS 24
+// threads that can count at the same time, calls of further threads are dropped
+#define FILESTATS_MAX_BLOCKS    256
+// upper latency limit of the first bucket in microseconds
+#define FILESTATS_FIRST_LIMIT   64
+
+SFileStatsCounters::SFileStatsCounters()
+{
+  memset(this, 0, sizeof(*this));
+}
+
+void SFileStatsCounters::Add(const SFileStatsCounters &counters)
+{
+  for (unsigned int op = 0; op < FILESTATS_OPS; op++)
+  {
+    calls[op]    += counters.calls[op];
+    failures[op] += counters.failures[op];
+    time[op]     += counters.time[op];
+    for (unsigned int bucket = 0; bucket < FILESTATS_BUCKETS; bucket++)
+      latency[op][bucket] += counters.latency[op][bucket];
+  }
+  bytesRead += counters.bytesRead;
+}
+
+static void Subtract(SFileStatsCounters &counters, const SFileStatsCounters &base)
+{
+  for (unsigned int op = 0; op < FILESTATS_OPS; op++)
+  {
+    counters.calls[op]    -= base.calls[op];
+    counters.failures[op] -= base.failures[op];
+    counters.time[op]     -= base.time[op];
+    for (unsigned int bucket = 0; bucket < FILESTATS_BUCKETS; bucket++)
+      counters.latency[op][bucket] -= base.latency[op][bucket];
+  }
+  counters.bytesRead -= base.bytesRead;
+}
+
+/*! \brief Counters written by a single thread only */
+struct SFileStatsBlock
+{
+  SFileStatsCounters counters[FILESTATS_MAX_PROTOCOLS];
+};
+
+static void ReleaseBlock(SFileStatsBlock *block);
+
+/*!
+ \brief Global state, never destroyed as threads may still exit during static destruction
+ */
+struct FileStatsState
+{
+  FileStatsState() : current(ReleaseBlock), protocols(0), querying(0) { }
+
+  CCriticalSection critSection;
+  XbmcThreads::ThreadLocal<SFileStatsBlock> current;
+  vector<SFileStatsBlock*> blocks;
+  vector<SFileStatsBlock*> unused;
+  string names[FILESTATS_MAX_PROTOCOLS];           ///< written once before protocols is incremented
+  volatile long protocols;
+  SFileStatsCounters base[FILESTATS_MAX_PROTOCOLS]; ///< totals at the last Reset()
+  vector< pair<string, IFile*> > caches;
+  unsigned int querying;                            ///< GetCaches() calls using caches without the lock
+  CEvent queried;
+};
+
+static FileStatsState &GetState()
+{
+  static FileStatsState *state = new FileStatsState();
+  return *state;
+}
+
+static void ReleaseBlock(SFileStatsBlock *block)
+{
+  // the counts stay in the block, the next thread using it adds to them
+  FileStatsState &state = GetState();
+  CSingleLock lock(state.critSection);
+  state.unused.push_back(block);
+}
+
+static SFileStatsBlock *GetBlock()
+{
+  FileStatsState &state = GetState();
+  SFileStatsBlock *block = state.current.get();
+  if (block != NULL)
+    return block;
+
+  CSingleLock lock(state.critSection);
+  if (!state.unused.empty())
+  {
+    block = state.unused.back();
+    state.unused.pop_back();
+  }
+  else if (state.blocks.size() < FILESTATS_MAX_BLOCKS)
+  {
+    block = new SFileStatsBlock();
+    state.blocks.push_back(block);
+  }
+  else
+    return NULL;
+
+  state.current.set(block);
+  return block;
+}
+
+static void GetTotals(FileStatsState &state, SFileStatsCounters totals[FILESTATS_MAX_PROTOCOLS])
+{
+  for (vector<SFileStatsBlock*>::const_iterator it = state.blocks.begin(); it != state.blocks.end(); ++it)
+  {
+    for (unsigned int slot = 0; slot < FILESTATS_MAX_PROTOCOLS; slot++)
+      totals[slot].Add((*it)->counters[slot]);
+  }
+}
+
+int CFileStats::GetSlot(const string &protocol)
+{
+  FileStatsState &state = GetState();
+  long protocols = AtomicAdd(&state.protocols, 0);
+  for (long slot = 0; slot < protocols; slot++)
+  {
+    if (state.names[slot] == protocol)
+      return slot;
+  }
+
+  CSingleLock lock(state.critSection);
+  for (long slot = 0; slot < state.protocols; slot++)
+  {
+    if (state.names[slot] == protocol)
+      return slot;
+  }
+  if (state.protocols == FILESTATS_MAX_PROTOCOLS)
+    return -1;
+
+  // full barrier, the name is complete before it becomes visible
+  state.names[state.protocols] = protocol;
+  return AtomicIncrement(&state.protocols) - 1;
+}
+
+void CFileStats::Record(int slot, FILESTATS_OP op, int64_t start, bool success, uint64_t bytes /* = 0 */)
+{
+  if (slot < 0 || slot >= FILESTATS_MAX_PROTOCOLS)
+    return;
+
+  SFileStatsBlock *block = GetBlock();
+  if (block == NULL)
+    return;
+
+  uint64_t elapsed = (uint64_t)(CurrentHostCounter() - start) * 1000000 / CurrentHostFrequency();
+  unsigned int bucket = 0;
+  for (uint64_t limit = FILESTATS_FIRST_LIMIT; bucket < FILESTATS_BUCKETS - 1 && elapsed >= limit; limit <<= 1)
+    bucket++;
+
+  SFileStatsCounters &counters = block->counters[slot];
+  counters.calls[op]++;
+  if (!success)
+    counters.failures[op]++;
+  counters.time[op] += elapsed;
+  counters.latency[op][bucket]++;
+  counters.bytesRead += bytes;
+}
+
+void CFileStats::GetCounters(map<string, SFileStatsCounters> &counters)
+{
+  FileStatsState &state = GetState();
+  SFileStatsCounters totals[FILESTATS_MAX_PROTOCOLS];
+
+  CSingleLock lock(state.critSection);
+  GetTotals(state, totals);
+  for (long slot = 0; slot < state.protocols; slot++)
+  {
+    Subtract(totals[slot], state.base[slot]);
+    counters[state.names[slot]] = totals[slot];
+  }
+}
+
+void CFileStats::Reset()
+{
+  // the blocks are only written by their threads, remember where we are instead
+  FileStatsState &state = GetState();
+  SFileStatsCounters totals[FILESTATS_MAX_PROTOCOLS];
+
+  CSingleLock lock(state.critSection);
+  GetTotals(state, totals);
+  for (unsigned int slot = 0; slot < FILESTATS_MAX_PROTOCOLS; slot++)
+    state.base[slot] = totals[slot];
+}
+
+void CFileStats::AddCache(const string &path, IFile *cache)
+{
+  FileStatsState &state = GetState();
+  CSingleLock lock(state.critSection);
+  state.caches.push_back(make_pair(path, cache));
+}
+
+void CFileStats::RemoveCache(IFile *cache)
+{
+  FileStatsState &state = GetState();
+  CSingleLock lock(state.critSection);
+  for (vector< pair<string, IFile*> >::iterator it = state.caches.begin(); it != state.caches.end(); ++it)
+  {
+    if (it->second == cache)
+    {
+      state.caches.erase(it);
+      // GetCaches() may still be asking it for its status
+      while (state.querying > 0)
+      {
+        lock.Leave();
+        state.queried.WaitMSec(10);
+        lock.Enter();
+      }
+      break;
+    }
+  }
+}
+
+void CFileStats::GetCaches(vector<SFileCacheStats> &caches)
+{
+  // the status is asked for without our lock, the caches take locks of their own which
+  // are held while they call back into us. RemoveCache() waits until we're done, so
+  // the caches stay usable meanwhile
+  FileStatsState &state = GetState();
+  vector< pair<string, IFile*> > registered;
+  {
+    CSingleLock lock(state.critSection);
+    registered = state.caches;
+    state.querying++;
+  }
+
+  for (vector< pair<string, IFile*> >::const_iterator it = registered.begin(); it != registered.end(); ++it)
+  {
+    SFileCacheStats cache;
+    cache.path = it->first;
+    if (it->second->IoControl(IOCTRL_CACHE_STATUS, &cache.status) >= 0)
+      caches.push_back(cache);
+  }
+
+  CSingleLock lock(state.critSection);
+  state.querying--;
+  state.queried.Set();
+}
+
+unsigned int CFileStats::GetBucketLimit(unsigned int bucket)
+{
+  if (bucket >= FILESTATS_BUCKETS - 1)
+    return 0;
+  return FILESTATS_FIRST_LIMIT << bucket;
+}
+
+unsigned int CFileStats::GetPercentile(const uint64_t latency[FILESTATS_BUCKETS], float share)
+{
+  uint64_t total = 0;
+  for (unsigned int bucket = 0; bucket < FILESTATS_BUCKETS; bucket++)
+    total += latency[bucket];
+  if (total == 0)
+    return 0;
+
+  uint64_t count = 0;
+  for (unsigned int bucket = 0; bucket < FILESTATS_BUCKETS - 1; bucket++)
+  {
+    count += latency[bucket];
+    if (count >= share * total)
+      return GetBucketLimit(bucket);
+  }
+  // the last bucket has no upper limit, report where it starts
+  return GetBucketLimit(FILESTATS_BUCKETS - 2);
+}
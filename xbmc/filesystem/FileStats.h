@@ -0,0 +1,119 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "IFileTypes.h"
+
+namespace XFILE
+{
+  class IFile;
+
+  /*! \brief The operations CFileStats keeps counts and latencies of */
+  enum FILESTATS_OP
+  {
+    FILESTATS_OPEN = 0,
+    FILESTATS_READ,
+    FILESTATS_SEEK,
+    FILESTATS_STAT,
+    FILESTATS_OPS
+  };
+
+  /*! \brief Latency buckets, bucket i counts calls taking less than 64us << i, the last one all slower calls */
+  #define FILESTATS_BUCKETS 12
+
+  /*! \brief Counters of the VFS calls made to a single protocol */
+  struct SFileStatsCounters
+  {
+    SFileStatsCounters();
+    void Add(const SFileStatsCounters &counters);
+
+    uint64_t calls[FILESTATS_OPS];
+    uint64_t failures[FILESTATS_OPS];
+    uint64_t time[FILESTATS_OPS];                        ///< total microseconds spent in the calls
+    uint64_t latency[FILESTATS_OPS][FILESTATS_BUCKETS];  ///< calls per latency bucket
+    uint64_t bytesRead;
+  };
+
+  /*! \brief State of an open CFileCache */
+  struct SFileCacheStats
+  {
+    std::string  path;
+    SCacheStatus status;
+  };
+
+  /*!
+   \brief Counts the calls CFile makes into its IFile implementations, per protocol
+
+   Every thread counts into a block of its own, so recording a call takes no
+   lock. GetCounters() adds up the blocks of all threads. The blocks of exited
+   threads are handed to new threads, their counts are kept.
+
+   Opened CFileCache instances register themselves, GetCaches() reports their
+   fill level and the number of reads that had to wait for data.
+   */
+  class CFileStats
+  {
+  public:
+    /*!
+     \brief Look up the slot counting a protocol
+     \return the slot, -1 if all slots are taken by other protocols
+     */
+    static int GetSlot(const std::string &protocol);
+
+    /*!
+     \brief Count a call
+     \param slot the protocol slot, see GetSlot()
+     \param op the operation
+     \param start CurrentHostCounter() at the start of the call
+     \param success whether the call succeeded
+     \param bytes bytes read by the call
+     */
+    static void Record(int slot, FILESTATS_OP op, int64_t start, bool success, uint64_t bytes = 0);
+
+    /*! \brief Get the counters of every protocol used so far */
+    static void GetCounters(std::map<std::string, SFileStatsCounters> &counters);
+
+    /*! \brief Zero all counters */
+    static void Reset();
+
+    static void AddCache(const std::string &path, IFile *cache);
+    static void RemoveCache(IFile *cache);
+    static void GetCaches(std::vector<SFileCacheStats> &caches);
+
+    /*! \brief Upper latency limit of a bucket in microseconds, 0 for the last (unbounded) one.
+     GetPercentile() reports the lower limit of the last bucket instead */
+    static unsigned int GetBucketLimit(unsigned int bucket);
+
+    /*!
+     \brief Latency below which the given share of the calls finished
+     \param latency the latency buckets of an operation
+     \param share the share of calls, 0.5 for the median
+     \return the upper limit of the bucket in microseconds, 0 if there are no calls.
+             If the share falls into the last (unbounded) bucket this is its lower
+             limit, i.e. the limit of the bucket before it
+     */
+    static unsigned int GetPercentile(const uint64_t latency[FILESTATS_BUCKETS], float share);
+  };
+}
@@ -137,6 +137,9 @@ bool CHDDirectory::GetDirectory(const CStdString& strPath1, CFileItemList &items
 
           items.Add(pItem);
         }
+
+        if (!DeliverItems(items))
+          return false;
       }
     }
     while (LocalFindNextFile((HANDLE)hFind, &wfd));
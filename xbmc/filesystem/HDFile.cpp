@@ -29,8 +29,10 @@
 
 #include <sys/stat.h>
 #ifdef TARGET_POSIX
+#include <errno.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <unistd.h>
 #else
 #include <io.h>
 #include "utils/CharsetConverter.h"
@@ -236,6 +238,49 @@ unsigned int CHDFile::Read(void *lpBuf, int64_t uiBufSize)
   return 0;
 }
 
+//*********************************************************************************************
+int64_t CHDFile::ReadV(SReadRange* ranges, unsigned int count)
+{
+  if (!m_hFile.isValid()) return -1;
+
+  // positional reads, neither the file pointer nor the cache drop heuristic is touched
+  int64_t total = 0;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    SReadRange& range = ranges[i];
+    range.read = 0;
+    while (range.read < range.size)
+    {
+      int64_t offset = range.offset + range.read;
+#ifdef TARGET_POSIX
+      ssize_t nBytesRead = pread((*m_hFile).fd, (char*)range.buffer + range.read, range.size - range.read, offset);
+      if (nBytesRead < 0 && errno == EINTR)
+        continue;
+      if (nBytesRead <= 0)
+        break;
+#else
+      OVERLAPPED overlapped = {};
+      overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+      overlapped.OffsetHigh = (DWORD)(offset >> 32);
+      DWORD nBytesRead;
+      if (!ReadFile((HANDLE)m_hFile, (char*)range.buffer + range.read, range.size - range.read, &nBytesRead, &overlapped) || nBytesRead == 0)
+        break;
+#endif
+      range.read += (unsigned int)nBytesRead;
+    }
+    total += range.read;
+  }
+
+#ifndef TARGET_POSIX
+  // reading at an offset moves the file pointer of a synchronous handle
+  LARGE_INTEGER lPos;
+  lPos.QuadPart = m_i64FilePos;
+  SetFilePointerEx((HANDLE)m_hFile, lPos, NULL, FILE_BEGIN);
+#endif
+
+  return total;
+}
+
 //*********************************************************************************************
 int CHDFile::Write(const void *lpBuf, int64_t uiBufSize)
 {
@@ -26,13 +26,19 @@
 #include "URL.h"
 #include "PasswordManager.h"
 #include "utils/URIUtils.h"
+#include "FileItem.h"
 
 using namespace XFILE;
 
+#define DIR_DELIVER_ITEMS    200 // deliver at least this many items at once
+#define DIR_DELIVER_INTERVAL 250 // unless this many ms passed since the last delivery
+
 IDirectory::IDirectory(void)
 {
   m_strFileMask = "";
   m_flags = DIR_FLAG_DEFAULTS;
+  m_callback = NULL;
+  m_itemsDelivered = 0;
 }
 
 IDirectory::~IDirectory(void)
@@ -108,6 +114,38 @@ void IDirectory::SetFlags(int flags)
   m_flags = flags;
 }
 
+void IDirectory::SetCallback(IDirectoryCallback *callback)
+{
+  m_callback = callback;
+  m_itemsDelivered = 0;
+  m_nextDelivery.SetExpired();
+}
+
+bool IDirectory::DeliverItems(const CFileItemList &items, bool flush)
+{
+  if (!m_callback)
+    return true;
+
+  int pending = items.Size() - m_itemsDelivered;
+  if (pending <= 0)
+    return true;
+
+  // a listing that wasn't delivered while fetching is only in the result
+  if (flush && m_itemsDelivered == 0)
+    return true;
+
+  if (!flush && pending < DIR_DELIVER_ITEMS && !m_nextDelivery.IsTimePast())
+    return true;
+
+  CFileItemList batch(items.GetPath());
+  for (int i = m_itemsDelivered; i < items.Size(); i++)
+    batch.Add(items[i]);
+  m_itemsDelivered = items.Size();
+  m_nextDelivery.Set(DIR_DELIVER_INTERVAL);
+
+  return m_callback->OnDirectoryItems(batch);
+}
+
 bool IDirectory::ProcessRequirements()
 {
   CStdString type = m_requirements["type"].asString();
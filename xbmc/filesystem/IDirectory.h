@@ -21,6 +21,7 @@
 
 #include "utils/StdString.h"
 #include "utils/Variant.h"
+#include "threads/SystemClock.h"
 
 class CFileItemList;
 
@@ -47,6 +48,29 @@ namespace XFILE
     DIR_FLAG_READ_CACHE    = (2 << 4), ///< Force reading from the directory cache (if available)
     DIR_FLAG_BYPASS_CACHE  = (2 << 5)  ///< Completely bypass the directory cache (no reading, no writing)
   };
+
+/*!
+ \ingroup filesystem
+ \brief Receives the items of a directory while it is being fetched.
+
+ Set on an IDirectory (or passed to CDirectory::GetDirectory via CHints) to see
+ the listing grow instead of waiting for the complete CFileItemList. Listings that
+ arrive in one go, from the directory cache or from implementations that don't
+ deliver while fetching, aren't passed to the callback.
+ \sa IDirectory::SetCallback, IDirectory::DeliverItems
+ */
+class IDirectoryCallback
+{
+public:
+  virtual ~IDirectoryCallback() {}
+  /*!
+   \brief Called with the items that arrived since the previous call.
+   \param items the new items, the list path is the directory being fetched.
+   \return false to cancel the rest of the fetch.
+   */
+  virtual bool OnDirectoryItems(const CFileItemList &items) = 0;
+};
+
 /*!
  \ingroup filesystem
  \brief Interface to the directory on a file system.
@@ -117,6 +141,23 @@ public:
   void SetMask(const CStdString& strMask);
   void SetFlags(int flags);
 
+  /*! \brief Set the callback receiving items as the next GetDirectory call produces them.
+   \param callback the callback, or NULL to stop delivering items.
+   \sa DeliverItems
+   */
+  void SetCallback(IDirectoryCallback *callback);
+
+  /*! \brief Pass the items added to \e items since the last delivery to the callback.
+   Implementations that build their listing incrementally call this after adding items,
+   it only calls the callback once enough items or time have accumulated. CDirectory
+   calls it with \e flush set once GetDirectory has returned, to deliver the rest.
+   \param items the list being filled by GetDirectory.
+   \param flush deliver whatever is pending, if anything was delivered before.
+   \return false if the callback cancelled the fetch, GetDirectory should then return false.
+   \sa SetCallback
+   */
+  bool DeliverItems(const CFileItemList &items, bool flush = false);
+
   /*! \brief Process additional requirements before the directory fetch is performed.
    Some directory fetches may require authentication, keyboard input etc.  The IDirectory subclass
    should call GetKeyboardInput, SetErrorDialog or RequireAuthentication and then return false 
@@ -161,6 +202,10 @@ protected:
 
   int m_flags; ///< Directory flags - see DIR_FLAG
 
+  IDirectoryCallback *m_callback; ///< Receives items while fetching - see SetCallback
+  int m_itemsDelivered;           ///< Number of items already passed to m_callback
+  XbmcThreads::EndTime m_nextDelivery;
+
   CVariant m_requirements;
 };
 }
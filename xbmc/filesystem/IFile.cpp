@@ -43,6 +43,28 @@ int IFile::Stat(struct __stat64* buffer)
   errno = ENOENT;
   return -1;
 }
+int64_t IFile::ReadV(SReadRange* ranges, unsigned int count)
+{
+  int64_t total = 0;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    SReadRange& range = ranges[i];
+    range.read = 0;
+    if (Seek(range.offset, SEEK_SET) != range.offset)
+      continue;
+
+    while (range.read < range.size)
+    {
+      unsigned int read = Read((char*)range.buffer + range.read, range.size - range.read);
+      if (read == 0 || read > range.size - range.read)
+        break;
+      range.read += read;
+    }
+    total += range.read;
+  }
+  return total;
+}
+
 bool IFile::ReadString(char *szLine, int iLineLength)
 {
   if(Seek(0, SEEK_CUR) < 0) return false;
@@ -71,6 +71,13 @@ public:
    * but accepts any read size, have it return the value 1         */
   virtual int  GetChunkSize() {return 0;}
 
+  /* Reads several (possibly scattered) ranges in one call, setting the  *
+   * read member of every range. Returns the total number of bytes read, *
+   * or -1 on error. The file position afterwards is undefined.          *
+   * The default seeks and reads range by range, implementations for     *
+   * which a seek is expensive can reorder the ranges or read the gaps.  */
+  virtual int64_t ReadV(SReadRange* ranges, unsigned int count);
+
   virtual bool SkipNext(){return false;}
 
   virtual bool Delete(const CURL& url) { return false; }
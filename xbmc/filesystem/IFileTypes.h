@@ -35,6 +35,15 @@ struct SCacheStatus
   unsigned maxrate;  /**< maximum number of bytes per second cache is allowed to fill */
   unsigned currate;  /**< average read rate from source file since last position change */
   bool     full;     /**< is the cache full */
+  unsigned underruns; /**< number of reads that had to wait for data */
+};
+
+struct SReadRange
+{
+  int64_t      offset; /**< position in the file to read from */
+  void*        buffer; /**< destination of at least size bytes */
+  unsigned int size;   /**< number of bytes wanted */
+  unsigned int read;   /**< number of bytes actually read, filled in by ReadV */
 };
 
 typedef enum {
@@ -40,6 +40,8 @@ using namespace XFILE;
 using namespace std;
 
 #define SEEKTIMOUT 30000
+// decoded bytes kept around for backward seeks in compressed entries
+#define RAR_STREAM_WINDOW 0x400000
 
 #ifdef HAS_FILESYSTEM_RAR
 CRarFileExtractThread::CRarFileExtractThread() : CThread("RarFileExtract"), hRunning(true), hQuit(true)
@@ -129,6 +131,10 @@ CRarFile::CRarFile()
   m_bUseFile = false;
   m_bOpen = false;
   m_bSeekable = true;
+  m_bStreamed = false;
+  m_szWindow = NULL;
+  m_iWindowStart = 0;
+  m_iStreamPosition = 0;
 }
 
 CRarFile::~CRarFile()
@@ -150,6 +156,8 @@ CRarFile::~CRarFile()
       delete m_pExtractThread;
       m_pExtractThread = NULL;
     }
+    delete[] m_szWindow;
+    m_szWindow = NULL;
   }
 #endif
 }
@@ -196,8 +204,19 @@ bool CRarFile::Open(const CURL& url)
     else
     {
       CFileInfo* info = g_RarManager.GetFileInRar(m_strRarPath,m_strPathInRar);
-      if ((!info || !CFile::Exists(info->m_strCachedPath)) && m_bFileOptions & EXFILE_NOCACHE)
-        return false;
+      if (!info || !CFile::Exists(info->m_strCachedPath))
+      {
+        // decode on the fly rather than extracting the whole entry first
+        if (OpenInArchive(true))
+        {
+          m_iFileSize = items[i]->m_dwSize;
+          m_bStreamed = true;
+          m_bOpen = true;
+          return true;
+        }
+        if (m_bFileOptions & EXFILE_NOCACHE)
+          return false;
+      }
       m_bUseFile = true;
       CStdString strPathInCache;
 
@@ -280,6 +299,18 @@ unsigned int CRarFile::Read(void *lpBuf, int64_t uiBufSize)
   if (m_iFilePosition >= GetLength()) // we are done
     return 0;
 
+  if (m_bStreamed)
+    return ReadStreamed(lpBuf,uiBufSize);
+
+  return ReadInArchive(lpBuf,uiBufSize);
+#else
+  return 0;
+#endif
+}
+
+unsigned int CRarFile::ReadInArchive(void *lpBuf, int64_t uiBufSize)
+{
+#ifdef HAS_FILESYSTEM_RAR
   if( !m_pExtract->GetDataIO().hBufferEmpty->WaitMSec(5000) )
   {
     CLog::Log(LOGERROR, "%s - Timeout waiting for buffer to empty", __FUNCTION__);
@@ -356,6 +387,65 @@ unsigned int CRarFile::Read(void *lpBuf, int64_t uiBufSize)
 #endif
 }
 
+unsigned int CRarFile::ReadStreamed(void *lpBuf, int64_t uiBufSize)
+{
+#ifdef HAS_FILESYSTEM_RAR
+  uint8_t* pBuf = (uint8_t*)lpBuf;
+  int64_t iRead = 0;
+  while (iRead < uiBufSize && m_iFilePosition < m_iFileSize)
+  {
+    if (m_iFilePosition < m_iStreamPosition) // replay from the window
+    {
+      int64_t iOffset = m_iFilePosition % RAR_STREAM_WINDOW;
+      int64_t iCopy = m_iStreamPosition - m_iFilePosition;
+      if (iCopy > uiBufSize - iRead)
+        iCopy = uiBufSize - iRead;
+      if (iCopy > RAR_STREAM_WINDOW - iOffset)
+        iCopy = RAR_STREAM_WINDOW - iOffset;
+      memcpy(pBuf+iRead,m_szWindow+iOffset,size_t(iCopy));
+      m_iFilePosition += iCopy;
+      iRead += iCopy;
+    }
+    else
+    {
+      if (!m_pExtract) // a restart failed
+        break;
+      unsigned int iDecoded = ReadInArchive(pBuf+iRead,uiBufSize-iRead);
+      if (iDecoded == 0)
+        break;
+      AddToWindow(pBuf+iRead,iDecoded);
+      iRead += iDecoded;
+    }
+  }
+  return static_cast<unsigned int>(iRead);
+#else
+  return 0;
+#endif
+}
+
+void CRarFile::AddToWindow(const uint8_t* pData, int64_t iSize)
+{
+  if (iSize > RAR_STREAM_WINDOW)
+  {
+    pData += iSize-RAR_STREAM_WINDOW;
+    m_iStreamPosition += iSize-RAR_STREAM_WINDOW;
+    iSize = RAR_STREAM_WINDOW;
+  }
+
+  while (iSize > 0)
+  {
+    int64_t iOffset = m_iStreamPosition % RAR_STREAM_WINDOW;
+    int64_t iCopy = iSize < RAR_STREAM_WINDOW-iOffset ? iSize : RAR_STREAM_WINDOW-iOffset;
+    memcpy(m_szWindow+iOffset,pData,size_t(iCopy));
+    pData += iCopy;
+    iSize -= iCopy;
+    m_iStreamPosition += iCopy;
+  }
+
+  if (m_iStreamPosition-m_iWindowStart > RAR_STREAM_WINDOW)
+    m_iWindowStart = m_iStreamPosition-RAR_STREAM_WINDOW;
+}
+
 unsigned int CRarFile::Write(void *lpBuf, int64_t uiBufSize)
 {
   return 0;
@@ -381,6 +471,9 @@ void CRarFile::Close()
       delete m_pExtractThread;
       m_pExtractThread = NULL;
     }
+    delete[] m_szWindow;
+    m_szWindow = NULL;
+    m_bStreamed = false;
     m_bOpen = false;
   }
 #endif
@@ -398,6 +491,24 @@ int64_t CRarFile::Seek(int64_t iFilePosition, int iWhence)
   if (m_bUseFile)
     return m_File.Seek(iFilePosition,iWhence);
 
+  if (m_bStreamed)
+  {
+    switch (iWhence)
+    {
+      case SEEK_CUR:
+        iFilePosition += m_iFilePosition;
+        break;
+      case SEEK_END:
+        iFilePosition += m_iFileSize;
+        break;
+      case SEEK_SET:
+        break;
+      default:
+        return -1;
+    }
+    return SeekStreamed(iFilePosition);
+  }
+
   if( !m_pExtract->GetDataIO().hBufferEmpty->WaitMSec(SEEKTIMOUT) )
   {
     CLog::Log(LOGERROR, "%s - Timeout waiting for buffer to empty", __FUNCTION__);
@@ -504,6 +615,56 @@ int64_t CRarFile::Seek(int64_t iFilePosition, int iWhence)
 #endif
 }
 
+int64_t CRarFile::SeekStreamed(int64_t iFilePosition)
+{
+#ifdef HAS_FILESYSTEM_RAR
+  if (iFilePosition < 0)
+    return -1;
+
+  // nothing to decode past the end, reads there just return 0
+  if (iFilePosition >= m_iFileSize ||
+     (iFilePosition >= m_iWindowStart && iFilePosition <= m_iStreamPosition))
+  {
+    m_iFilePosition = iFilePosition;
+    return m_iFilePosition;
+  }
+
+  if (iFilePosition < m_iWindowStart)
+  {
+    // fell out of the window, the unpacker can only go forward so start over
+    CLog::Log(LOGDEBUG,"filerar::seek restarting %s to reach %"PRId64, m_strPathInRar.c_str(), iFilePosition);
+    CleanUp();
+    if (!OpenInArchive(true))
+      return -1;
+  }
+
+  if (!SkipStreamed(iFilePosition))
+    return -1;
+
+  return m_iFilePosition;
+#else
+  return -1;
+#endif
+}
+
+bool CRarFile::SkipStreamed(int64_t iFilePosition)
+{
+  uint8_t buffer[0x8000];
+  m_iFilePosition = m_iStreamPosition;
+  while (m_iFilePosition < iFilePosition)
+  {
+    int64_t iSkip = iFilePosition-m_iFilePosition;
+    if (iSkip > (int64_t)sizeof(buffer))
+      iSkip = sizeof(buffer);
+    if (ReadStreamed(buffer,iSkip) == 0)
+    {
+      CLog::Log(LOGERROR,"filerar::seek failed to decode up to %"PRId64" in %s", iFilePosition, m_strPathInRar.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
 int64_t CRarFile::GetLength()
 {
   if (!m_bOpen)
@@ -619,7 +780,7 @@ void CRarFile::CleanUp()
 #endif
 }
 
-bool CRarFile::OpenInArchive()
+bool CRarFile::OpenInArchive(bool bStream)
 {
 #ifdef HAS_FILESYSTEM_RAR
   try
@@ -718,6 +879,16 @@ bool CRarFile::OpenInArchive()
       m_pArc->SeekToNext();
     }
 
+    // solid entries depend on the files before them and encrypted ones need
+    // the password up front, neither can be decoded on their own
+    if (bStream && ((m_pArc->NewLhd.Flags & LHD_SOLID) ||
+                    ((m_pArc->NewLhd.Flags & LHD_PASSWORD) && m_strPassword.IsEmpty())))
+    {
+      CLog::Log(LOGDEBUG,"filerar::open %s can't be streamed, falling back to extraction",m_strPathInRar.c_str());
+      CleanUp();
+      return false;
+    }
+
     m_szBuffer = new uint8_t[MAXWINMEMSIZE];
     m_szStartOfBuffer = m_szBuffer;
     m_pExtract->GetDataIO().SetUnpackToMemory(m_szBuffer,0);
@@ -725,6 +896,14 @@ bool CRarFile::OpenInArchive()
     m_iFilePosition = 0;
     m_iBufferStart = 0;
 
+    if (bStream)
+    {
+      if (!m_szWindow)
+        m_szWindow = new uint8_t[RAR_STREAM_WINDOW];
+      m_iWindowStart = 0;
+      m_iStreamPosition = 0;
+    }
+
     delete m_pExtractThread;
     m_pExtractThread = new CRarFileExtractThread();
     m_pExtractThread->Start(m_pArc,m_pCmd,m_pExtract,iHeaderSize);
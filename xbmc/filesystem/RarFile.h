@@ -88,8 +88,13 @@ namespace XFILE
     BYTE m_bFileOptions;
     void Init();
     void InitFromUrl(const CURL& url);
-    bool OpenInArchive();
+    bool OpenInArchive(bool bStream = false);
     void CleanUp();
+    unsigned int ReadInArchive(void* lpBuf, int64_t uiBufSize);
+    unsigned int ReadStreamed(void* lpBuf, int64_t uiBufSize);
+    int64_t SeekStreamed(int64_t iFilePosition);
+    bool SkipStreamed(int64_t iFilePosition);
+    void AddToWindow(const uint8_t* pData, int64_t iSize);
 
     int64_t m_iFilePosition;
     int64_t m_iFileSize;
@@ -97,6 +102,7 @@ namespace XFILE
     bool m_bUseFile;
     bool m_bOpen;
     bool m_bSeekable;
+    bool m_bStreamed; // compressed entry decoded on the fly
     CFile m_File; // for packed source
 #ifdef HAS_FILESYSTEM_RAR
     Archive* m_pArc;
@@ -108,6 +114,15 @@ namespace XFILE
     uint8_t* m_szStartOfBuffer;
     int64_t m_iDataInBuffer;
     int64_t m_iBufferStart;
+
+    /*! \brief Ring buffer holding the most recently decoded bytes of a
+     streamed entry, so that short backward seeks don't restart the unpacker.
+     Byte n of the entry lives at m_szWindow[n % RAR_STREAM_WINDOW] while
+     m_iWindowStart <= n < m_iStreamPosition.
+     */
+    uint8_t* m_szWindow;
+    int64_t m_iWindowStart;
+    int64_t m_iStreamPosition; ///< position of the unpacker in the entry
   };
 
 }
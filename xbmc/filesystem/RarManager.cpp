@@ -237,14 +237,35 @@ bool CRarManager::GetFilesInRar(CFileItemList& vecpItems, const CStdString& strR
   map<CStdString,pair<ArchiveList_struct*,vector<CFileInfo> > >::iterator it = m_ExFiles.find(strRarPath);
   if (it == m_ExFiles.end())
   {
+    int64_t mtime = GetArchiveTime(strRarPath);
     if( urarlib_list((char*) strRarPath.c_str(), &pFileList, NULL) )
+    {
       m_ExFiles.insert(make_pair(strRarPath,make_pair(pFileList,vector<CFileInfo>())));
+      m_ListTimes[strRarPath] = mtime;
+    }
     else
     {
       if( pFileList ) urarlib_freelist(pFileList);
       return false;
     }
   }
+  else if (m_ListTimes[strRarPath] != GetArchiveTime(strRarPath))
+  {
+    // archive was replaced, rescan but keep track of files extracted from it
+    if( !urarlib_list((char*) strRarPath.c_str(), &pFileList, NULL) )
+    {
+      if( pFileList ) urarlib_freelist(pFileList);
+      return false;
+    }
+    urarlib_freelist(it->second.first);
+    it->second.first = pFileList;
+    m_ListTimes[strRarPath] = GetArchiveTime(strRarPath);
+    for (vector<CFileInfo>::iterator it2 = it->second.second.begin(); it2 != it->second.second.end(); ++it2)
+    {
+      it2->m_iOffset = -1;
+      it2->m_iIsSeekable = -1;
+    }
+  }
   else
     pFileList = it->second.first;
 
@@ -328,6 +349,16 @@ bool CRarManager::GetFilesInRar(CFileItemList& vecpItems, const CStdString& strR
 #endif
 }
 
+int64_t CRarManager::GetArchiveTime(const CStdString& strRarPath)
+{
+  // only the first volume is checked, it holds the main archive header
+  struct __stat64 buffer;
+  if (CFile::Stat(strRarPath, &buffer) == 0)
+    return buffer.st_mtime;
+
+  return 0;
+}
+
 bool CRarManager::ListArchive(const CStdString& strRarPath, ArchiveList_struct* &pArchiveList)
 {
 #ifdef HAS_FILESYSTEM_RAR
@@ -403,10 +434,16 @@ void CRarManager::ClearCache(bool force)
       if (pFile->m_bAutoDel && (pFile->m_iUsed < 1 || force))
         CFile::Delete( pFile->m_strCachedPath );
     }
-    urarlib_freelist(j->second.first);
+    if (force)
+      urarlib_freelist(j->second.first);
   }
 
-  m_ExFiles.clear();
+  // listings are only dropped on shutdown, freeing disk space doesn't need a rescan
+  if (force)
+  {
+    m_ExFiles.clear();
+    m_ListTimes.clear();
+  }
 #endif
 }
 
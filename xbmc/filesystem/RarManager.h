@@ -82,7 +82,9 @@ public:
 protected:
 
   bool ListArchive(const CStdString& strRarPath, ArchiveList_struct* &pArchiveList);
+  int64_t GetArchiveTime(const CStdString& strRarPath);
   std::map<CStdString, std::pair<ArchiveList_struct*,std::vector<CFileInfo> > > m_ExFiles;
+  std::map<CStdString, int64_t> m_ListTimes; ///< mtime of the archive when its listing was read
   CCriticalSection m_CritSection;
 
   int64_t CheckFreeSpace(const CStdString& strDrive);
@@ -229,6 +229,10 @@ bool CSMBDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items
           pItem->SetProperty("file:hidden", true);
         items.Add(pItem);
       }
+
+      // every entry may have cost a stat round trip, let the caller see them
+      if (!DeliverItems(items))
+        return false;
     }
   }
 
@@ -0,0 +1,765 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "system.h"
+#include "SegmentCache.h"
+#include "Directory.h"
+#include "File.h"
+#include "FileItem.h"
+#include "SpecialProtocol.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/Atomics.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/log.h"
+#include "utils/md5.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#ifdef TARGET_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#define SEGMENT_STORE_PATH          "special://temp/segmentcache/"
+#define SEGMENT_STORE_SEGMENT_SIZE  (1024 * 1024)
+#define SEGMENT_STORE_EXTENSION     ".seg"
+#define SEGMENT_STORE_TEMP          ".tmp"
+
+using namespace XFILE;
+
+CSegmentView::CSegmentView()
+  : m_data(NULL)
+  , m_size(0)
+#ifdef TARGET_POSIX
+  , m_mapping(NULL)
+#endif
+{
+}
+
+CSegmentView::~CSegmentView()
+{
+#ifdef TARGET_POSIX
+  if (m_mapping)
+    munmap(m_mapping, m_size);
+#endif
+}
+
+CSegmentStore::CSegmentStore(const std::string &path, uint64_t capacity, size_t segmentSize)
+  : m_path(path)
+  , m_capacity(capacity)
+  , m_segmentSize(segmentSize)
+  , m_usage(0)
+  , m_initialized(false)
+  , m_nextPin(1)
+  , m_nextTemp(0)
+{
+}
+
+CSegmentStore::~CSegmentStore()
+{
+}
+
+CSegmentStore &CSegmentStore::GetInstance()
+{
+  static CSegmentStore store(CSpecialProtocol::TranslatePath(SEGMENT_STORE_PATH),
+                             (uint64_t)g_advancedSettings.m_persistentCacheSize * 1024 * 1024,
+                             SEGMENT_STORE_SEGMENT_SIZE);
+  return store;
+}
+
+std::string CSegmentStore::MakeKey(const std::string &url, int64_t length, time_t mtime)
+{
+  CStdString identity = StringUtils::Format("%s|%"PRId64"|%"PRId64, url.c_str(), length, (int64_t)mtime);
+  CStdString key = XBMC::XBMC_MD5::GetMD5(identity);
+  StringUtils::ToLower(key);
+  return key;
+}
+
+void CSegmentStore::Initialize()
+{
+  if (m_initialized)
+    return;
+  m_initialized = true;
+
+  CDirectory::Create(m_path);
+
+  CFileItemList items;
+  if (!CDirectory::GetDirectory(m_path, items, SEGMENT_STORE_EXTENSION "|" SEGMENT_STORE_TEMP, DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_BYPASS_CACHE))
+  {
+    CLog::Log(LOGERROR, "%s - unable to read %s", __FUNCTION__, m_path.c_str());
+    return;
+  }
+
+  // rebuild the LRU order from the modification times, Map() touches the files
+  std::vector< std::pair<CDateTime, CFileItemPtr> > segments;
+  for (int i = 0; i < items.Size(); i++)
+  {
+    CFileItemPtr item = items[i];
+    if (item->m_bIsFolder)
+      continue;
+
+    std::string name = URIUtils::GetFileName(item->GetPath());
+    unsigned int index;
+    char separator;
+    if (name.size() != 32 + 1 + 8 + strlen(SEGMENT_STORE_EXTENSION) ||
+        !StringUtils::EndsWith(name, SEGMENT_STORE_EXTENSION) ||
+        sscanf(name.c_str() + 32, "%c%8x", &separator, &index) != 2 || separator != '-' ||
+        item->m_dwSize <= 0 || item->m_dwSize > (int64_t)m_segmentSize)
+    {
+      // interrupted writes and anything else that doesn't belong here
+      CFile::Delete(item->GetPath());
+      continue;
+    }
+    segments.push_back(std::make_pair(item->m_dateTime, item));
+  }
+  std::sort(segments.begin(), segments.end());
+
+  for (size_t i = 0; i < segments.size(); i++)
+  {
+    const CFileItemPtr &item = segments[i].second;
+    std::string name = URIUtils::GetFileName(item->GetPath());
+    SegmentId id(name.substr(0, 32), (uint32_t)strtoul(name.substr(33, 8).c_str(), NULL, 16));
+
+    Segment segment;
+    segment.size = (size_t)item->m_dwSize;
+    segment.lru = m_lru.insert(m_lru.end(), id);
+    m_segments.insert(std::make_pair(id, segment));
+    m_usage += segment.size;
+  }
+
+  // the capacity may have been lowered since the last run
+  Evict(0);
+
+  CLog::Log(LOGDEBUG, "%s - %u segments, %"PRIu64" of %"PRIu64" bytes used", __FUNCTION__,
+            (unsigned int)m_segments.size(), m_usage, m_capacity);
+}
+
+std::string CSegmentStore::GetSegmentPath(const SegmentId &id) const
+{
+  return URIUtils::AddFileToFolder(m_path, StringUtils::Format("%s-%08x" SEGMENT_STORE_EXTENSION, id.key.c_str(), id.index));
+}
+
+uint64_t CSegmentStore::GetUsage()
+{
+  CSingleLock lock(m_critSection);
+  Initialize();
+  return m_usage;
+}
+
+bool CSegmentStore::Has(const std::string &key, uint32_t index, size_t *size /* = NULL */)
+{
+  CSingleLock lock(m_critSection);
+  Initialize();
+
+  SegmentMap::const_iterator segment = m_segments.find(SegmentId(key, index));
+  if (segment == m_segments.end())
+    return false;
+
+  if (size)
+    *size = segment->second.size;
+  return true;
+}
+
+bool CSegmentStore::Add(const std::string &key, uint32_t index, const char *data, size_t size)
+{
+  if (size == 0 || size > m_segmentSize || size > m_capacity)
+    return false;
+
+  CSingleLock lock(m_critSection);
+  Initialize();
+  lock.Leave();
+
+  // only complete segments are renamed into place, an interrupted write
+  // leaves a temporary file behind which is removed by the next scan. the
+  // data is written without holding the lock, other caches keep going
+  SegmentId id(key, index);
+  std::string path = GetSegmentPath(id);
+  std::string temp = StringUtils::Format("%s.%u" SEGMENT_STORE_TEMP, path.c_str(), AtomicIncrement(&m_nextTemp));
+  CFile file;
+  if (!file.OpenForWrite(temp, true))
+  {
+    CLog::Log(LOGERROR, "%s - unable to create %s", __FUNCTION__, temp.c_str());
+    return false;
+  }
+  bool written = file.Write(data, size) == (int)size;
+  file.Close();
+  if (!written)
+  {
+    CLog::Log(LOGERROR, "%s - unable to write %s", __FUNCTION__, temp.c_str());
+    CFile::Delete(temp);
+    return false;
+  }
+
+  lock.Enter();
+  SegmentMap::iterator existing = m_segments.find(id);
+  if (existing != m_segments.end())
+    Erase(existing, true);
+
+  Evict(size);
+
+  if (!CFile::Rename(temp, path))
+  {
+    CLog::Log(LOGERROR, "%s - unable to rename %s", __FUNCTION__, temp.c_str());
+    CFile::Delete(temp);
+    return false;
+  }
+
+  Segment segment;
+  segment.size = size;
+  segment.lru = m_lru.insert(m_lru.end(), id);
+  m_segments.insert(std::make_pair(id, segment));
+  m_usage += size;
+  return true;
+}
+
+CSegmentView *CSegmentStore::Map(const std::string &key, uint32_t index)
+{
+  CSingleLock lock(m_critSection);
+  Initialize();
+
+  SegmentId id(key, index);
+  SegmentMap::iterator segment = m_segments.find(id);
+  if (segment == m_segments.end())
+    return NULL;
+
+  // mark it used right away so it isn't evicted while it's being mapped
+  m_lru.splice(m_lru.end(), m_lru, segment->second.lru);
+  std::string path = GetSegmentPath(id);
+  size_t size = segment->second.size;
+  lock.Leave();
+
+  CSegmentView *view = new CSegmentView();
+#ifdef TARGET_POSIX
+  int fd = open(path.c_str(), O_RDONLY);
+  void *mapping = MAP_FAILED;
+  if (fd >= 0)
+  {
+    mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+  }
+  if (mapping != MAP_FAILED)
+  {
+    view->m_mapping = mapping;
+    view->m_data = (const uint8_t *)mapping;
+    view->m_size = size;
+  }
+#else
+  CFile file;
+  view->m_buffer.resize(size);
+  if (file.Open(path) && file.Read(&view->m_buffer[0], size) == size)
+  {
+    view->m_data = &view->m_buffer[0];
+    view->m_size = size;
+  }
+#endif
+
+  if (view->m_data == NULL)
+  {
+    // deleted behind our back
+    CLog::Log(LOGWARNING, "%s - unable to map %s", __FUNCTION__, path.c_str());
+    delete view;
+    lock.Enter();
+    segment = m_segments.find(id);
+    if (segment != m_segments.end())
+      Erase(segment, true);
+    return NULL;
+  }
+
+#ifdef TARGET_POSIX
+  // keep the order across restarts
+  utime(path.c_str(), NULL);
+#endif
+  return view;
+}
+
+void CSegmentStore::Remove(const std::string &key)
+{
+  CSingleLock lock(m_critSection);
+  Initialize();
+
+  SegmentMap::iterator segment = m_segments.lower_bound(SegmentId(key, 0));
+  while (segment != m_segments.end() && segment->first.key == key)
+    Erase(segment++, true);
+}
+
+unsigned int CSegmentStore::Pin(const std::string &key, uint32_t first, uint32_t last)
+{
+  CSingleLock lock(m_critSection);
+  SegmentPin pin;
+  pin.key = key;
+  pin.first = first;
+  pin.last = last;
+  m_pins[m_nextPin] = pin;
+  return m_nextPin++;
+}
+
+void CSegmentStore::Repin(unsigned int pin, uint32_t first, uint32_t last)
+{
+  CSingleLock lock(m_critSection);
+  std::map<unsigned int, SegmentPin>::iterator it = m_pins.find(pin);
+  if (it != m_pins.end())
+  {
+    it->second.first = first;
+    it->second.last = last;
+  }
+}
+
+void CSegmentStore::Unpin(unsigned int pin)
+{
+  CSingleLock lock(m_critSection);
+  m_pins.erase(pin);
+}
+
+bool CSegmentStore::IsPinned(const SegmentId &id) const
+{
+  for (std::map<unsigned int, SegmentPin>::const_iterator it = m_pins.begin(); it != m_pins.end(); ++it)
+  {
+    if (id.index >= it->second.first && id.index <= it->second.last && id.key == it->second.key)
+      return true;
+  }
+  return false;
+}
+
+void CSegmentStore::Evict(size_t needed)
+{
+  SegmentList::iterator it = m_lru.begin();
+  while (m_usage + needed > m_capacity && it != m_lru.end())
+  {
+    const SegmentId &id = *it++;
+    if (!IsPinned(id))
+      Erase(m_segments.find(id), true);
+  }
+}
+
+void CSegmentStore::Erase(SegmentMap::iterator segment, bool deleteFile)
+{
+  if (deleteFile)
+    CFile::Delete(GetSegmentPath(segment->first));
+  m_usage -= segment->second.size;
+  m_lru.erase(segment->second.lru);
+  m_segments.erase(segment);
+}
+
+CSegmentCache::CSegmentCache(CSegmentStore &store)
+ : CCacheStrategy()
+ , m_store(store)
+ , m_persistent(false)
+ , m_length(0)
+ , m_cur(0)
+ , m_end(0)
+ , m_pendingStart(0)
+ , m_committingStart(0)
+ , m_committingSize(0)
+ , m_view(NULL)
+ , m_viewIndex(0)
+ , m_pin(0)
+ , m_pinned(false)
+ , m_pinFirst(0)
+ , m_pinLast(0)
+{
+}
+
+CSegmentCache::~CSegmentCache()
+{
+  Close();
+}
+
+int CSegmentCache::Open()
+{
+  CSingleLock lock(m_sync);
+  Close();
+
+  // until SetSource() identifies the source the data belongs to this
+  // instance only, a leftover of an earlier run with the same key is dropped
+  m_key = CSegmentStore::MakeKey(StringUtils::Format("transient://%p/%u", (void *)this, XbmcThreads::SystemClockMillis()), 0, 0);
+  m_store.Remove(m_key);
+
+  m_pending.resize(m_store.GetSegmentSize());
+  m_cur = 0;
+  m_end = 0;
+  m_pendingStart = 0;
+  ClearEndOfInput();
+  UpdatePin(m_cur, m_end);
+  return CACHE_RC_OK;
+}
+
+void CSegmentCache::Close()
+{
+  CSingleLock lock(m_sync);
+  delete m_view;
+  m_view = NULL;
+
+  if (m_pinned)
+    m_store.Unpin(m_pin);
+  m_pinned = false;
+
+  if (!m_key.empty() && !m_persistent)
+    m_store.Remove(m_key);
+  m_key.clear();
+  m_persistent = false;
+  m_length = 0;
+
+  std::vector<char>().swap(m_pending);
+  std::vector<char>().swap(m_committing);
+  m_committingSize = 0;
+}
+
+void CSegmentCache::SetSource(const std::string &path, int64_t length, time_t mtime)
+{
+  // a source without length or modification time can't be told apart from a changed one
+  if (length <= 0 || mtime == 0)
+    return;
+
+  CSingleLock lock(m_sync);
+  if (!m_persistent)
+    m_store.Remove(m_key);
+  if (m_pinned)
+    m_store.Unpin(m_pin);
+  m_pinned = false;
+  delete m_view;
+  m_view = NULL;
+
+  m_key = CSegmentStore::MakeKey(path, length, mtime);
+  m_persistent = true;
+  m_length = length;
+  UpdatePin(m_cur, m_end);
+}
+
+void CSegmentCache::UpdatePin(int64_t from, int64_t to)
+{
+  uint32_t firstIndex = (uint32_t)(std::min(from, to) / m_store.GetSegmentSize());
+  uint32_t lastIndex = (uint32_t)(std::max(from, to) / m_store.GetSegmentSize());
+  if (!m_pinned)
+  {
+    m_pin = m_store.Pin(m_key, firstIndex, lastIndex);
+    m_pinned = true;
+  }
+  else if (firstIndex != m_pinFirst || lastIndex != m_pinLast)
+    m_store.Repin(m_pin, firstIndex, lastIndex);
+
+  m_pinFirst = firstIndex;
+  m_pinLast = lastIndex;
+}
+
+/**
+ * Hands the pending segment to the store. Only ever called by the writer,
+ * with lock held on m_sync. The lock is left while the store writes the
+ * segment, readers meanwhile read it from m_committing.
+ */
+bool CSegmentCache::CommitPending(CSingleLock &lock)
+{
+  size_t size = (size_t)(m_end - m_pendingStart);
+  if (size == 0)
+    return true;
+
+  m_committing.swap(m_pending);
+  m_pending.resize(m_store.GetSegmentSize());
+  m_committingStart = m_pendingStart;
+  m_committingSize = size;
+  m_pendingStart = m_end;
+
+  uint32_t index = (uint32_t)(m_committingStart / m_store.GetSegmentSize());
+  std::string key = m_key;
+  lock.Leave();
+  bool stored = m_store.Add(key, index, &m_committing[0], size);
+  lock.Enter();
+
+  if (!stored)
+  {
+    // keep the data readable where it was
+    m_pending.swap(m_committing);
+    m_pendingStart = m_committingStart;
+  }
+  else if (m_view && m_viewIndex == index)
+  {
+    delete m_view;
+    m_view = NULL;
+  }
+  m_committingSize = 0;
+  return stored;
+}
+
+/**
+ * Data is written into the pending segment, which is handed to the
+ * store once it is full (or at the end of the source). It never gets
+ * further ahead of the reader than half the capacity of the store, so
+ * unread data isn't evicted to make room for more.
+ */
+int CSegmentCache::WriteToCache(const char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+  if (m_pending.empty())
+    return CACHE_RC_ERROR;
+
+  const size_t segmentSize = m_store.GetSegmentSize();
+  int64_t limit = std::max<int64_t>(m_store.GetCapacity() / 2, segmentSize);
+  if (m_end - m_cur >= limit)
+    return 0;
+
+  size_t used = (size_t)(m_end - m_pendingStart);
+  if (len > segmentSize - used)
+    len = segmentSize - used;
+
+  memcpy(&m_pending[used], buf, len);
+  m_end += len;
+
+  if (used + len == segmentSize && !CommitPending(lock))
+  {
+    CLog::Log(LOGERROR, "%s - unable to store segment at %"PRId64, __FUNCTION__, m_pendingStart);
+    return CACHE_RC_ERROR;
+  }
+
+  UpdatePin(m_cur, m_end);
+  m_written.Set();
+
+  return len;
+}
+
+int CSegmentCache::ReadFromCache(char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+  if (m_length > 0 && m_cur >= m_length)
+    return 0;
+
+  const char *data = NULL;
+  size_t avail = 0;
+  if (m_cur >= m_pendingStart && m_cur < m_end)
+  {
+    data = &m_pending[(size_t)(m_cur - m_pendingStart)];
+    avail = (size_t)(m_end - m_cur);
+  }
+  else if (m_committingSize > 0 && m_cur >= m_committingStart && m_cur < m_committingStart + (int64_t)m_committingSize)
+  {
+    data = &m_committing[(size_t)(m_cur - m_committingStart)];
+    avail = (size_t)(m_committingStart + m_committingSize - m_cur);
+  }
+  else if (!m_key.empty())
+  {
+    uint32_t index = (uint32_t)(m_cur / m_store.GetSegmentSize());
+    size_t offset = (size_t)(m_cur % m_store.GetSegmentSize());
+    if (m_view == NULL || m_viewIndex != index)
+    {
+      // map the segment without holding up the writer
+      delete m_view;
+      m_view = NULL;
+      std::string key = m_key;
+      int64_t cur = m_cur;
+      lock.Leave();
+      CSegmentView *view = m_store.Map(key, index);
+      lock.Enter();
+      if (m_view || key != m_key || cur != m_cur)
+      {
+        // moved on meanwhile, let the caller try again
+        delete view;
+        return CACHE_RC_WOULD_BLOCK;
+      }
+      m_view = view;
+      m_viewIndex = index;
+    }
+    if (m_view && offset < m_view->GetSize())
+    {
+      data = (const char *)m_view->GetData() + offset;
+      avail = m_view->GetSize() - offset;
+    }
+  }
+
+  if (data == NULL)
+  {
+    if (IsEndOfInput())
+      return 0;
+    else
+      return CACHE_RC_WOULD_BLOCK;
+  }
+
+  if (len > avail)
+    len = avail;
+
+  memcpy(buf, data, len);
+  m_cur += len;
+  UpdatePin(m_cur, m_end);
+
+  m_space.Set();
+
+  return len;
+}
+
+/**
+ * End of the data readable from pos without a gap, the walk ends once
+ * stop is passed.
+ */
+int64_t CSegmentCache::ContiguousEnd(int64_t pos, int64_t stop)
+{
+  const size_t segmentSize = m_store.GetSegmentSize();
+  int64_t end = pos;
+  while (end < stop)
+  {
+    if (end >= m_pendingStart && end < m_end)
+    {
+      end = m_end;
+      continue;
+    }
+    if (m_committingSize > 0 && end >= m_committingStart && end < m_committingStart + (int64_t)m_committingSize)
+    {
+      end = m_committingStart + m_committingSize;
+      continue;
+    }
+    if (m_length > 0 && end >= m_length)
+      return end;
+
+    uint32_t index = (uint32_t)(end / segmentSize);
+    size_t size;
+    if (!m_store.Has(m_key, index, &size))
+      return end;
+
+    int64_t segmentEnd = (int64_t)index * segmentSize + size;
+    if (segmentEnd <= end)
+      return end;
+    end = segmentEnd;
+  }
+  return end;
+}
+
+int64_t CSegmentCache::WaitForData(unsigned int minimum, unsigned int millis)
+{
+  CSingleLock lock(m_sync);
+
+  // looking further ahead than the writer may get is pointless
+  int64_t limit = std::max<int64_t>(m_store.GetCapacity() / 2, m_store.GetSegmentSize());
+  int64_t avail = ContiguousEnd(m_cur, m_cur + limit) - m_cur;
+
+  if (millis == 0 || IsEndOfInput())
+    return avail;
+
+  if (minimum > limit)
+    minimum = (unsigned int)limit;
+
+  XbmcThreads::EndTime endtime(millis);
+  while (!IsEndOfInput() && avail < minimum && !endtime.IsTimePast())
+  {
+    lock.Leave();
+    m_written.WaitMSec(50); // may miss the deadline. shouldn't be a problem.
+    lock.Enter();
+    avail = ContiguousEnd(m_cur, m_cur + limit) - m_cur;
+  }
+
+  return avail;
+}
+
+int64_t CSegmentCache::Seek(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+
+  // if seek is a bit over what we have, try to wait a few seconds for the data to be available.
+  // we try to avoid a (heavy) seek on the source
+  if (pos >= m_end && pos < m_end + 100000)
+  {
+    lock.Leave();
+    WaitForData((size_t)(pos - m_cur), 5000);
+    lock.Enter();
+  }
+
+  // only data connected to the write position (or the end of the source)
+  // can be read without waiting for a writer that's somewhere else
+  int64_t end = ContiguousEnd(pos, std::numeric_limits<int64_t>::max());
+  if ((pos <= m_end && end >= m_end) || (m_length > 0 && end >= m_length))
+  {
+    m_cur = pos;
+    UpdatePin(m_cur, m_end);
+    return pos;
+  }
+
+  return CACHE_RC_ERROR;
+}
+
+/**
+ * Where the source has to be read from if the reader continues at pos:
+ * the end of the cached data at pos, or the start of the segment pos is
+ * in as only whole segments are stored.
+ */
+int64_t CSegmentCache::WritePositionIfSeekTo(int64_t pos)
+{
+  int64_t end = ContiguousEnd(pos, std::numeric_limits<int64_t>::max());
+  if (end == pos && pos != m_end && (m_length <= 0 || pos < m_length))
+  {
+    end = pos - pos % m_store.GetSegmentSize();
+    // continue the segment being written rather than fetching it again
+    if (end == m_pendingStart && m_end > end && m_end < pos)
+      end = m_end;
+  }
+
+  // keep what is going to be read from being evicted in the meantime
+  UpdatePin(pos, end);
+  return end;
+}
+
+void CSegmentCache::Reset(int64_t pos, bool clearAnyway)
+{
+  // stored data stays valid, so clearAnyway makes no difference
+  CSingleLock lock(m_sync);
+  int64_t end = WritePositionIfSeekTo(pos);
+  if (end != m_end)
+  {
+    // the partial segment isn't connected to the new position, drop it
+    m_end = end;
+    m_pendingStart = end;
+  }
+  m_cur = pos;
+  UpdatePin(m_cur, m_end);
+}
+
+void CSegmentCache::EndOfInput()
+{
+  CSingleLock lock(m_sync);
+  // the last segment of a source is shorter, store it as well
+  if (m_length > 0 && m_end == m_length && !m_pending.empty())
+    CommitPending(lock);
+
+  CCacheStrategy::EndOfInput();
+  m_written.Set();
+}
+
+int64_t CSegmentCache::CachedDataEndPosIfSeekTo(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+  return WritePositionIfSeekTo(iFilePosition);
+}
+
+int64_t CSegmentCache::CachedDataEndPos()
+{
+  CSingleLock lock(m_sync);
+  return m_end;
+}
+
+bool CSegmentCache::IsCachedPosition(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+  return iFilePosition == m_end || ContiguousEnd(iFilePosition, iFilePosition + 1) > iFilePosition;
+}
+
+CCacheStrategy *CSegmentCache::CreateNew()
+{
+  return new CSegmentCache(m_store);
+}
@@ -0,0 +1,233 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CACHESEGMENT_H
+#define CACHESEGMENT_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "CacheStrategy.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+
+namespace XFILE {
+
+/*!
+ \brief Read only view of a stored segment, memory mapped where supported
+ */
+class CSegmentView
+{
+public:
+  ~CSegmentView();
+
+  const uint8_t *GetData() const { return m_data; }
+  size_t GetSize() const { return m_size; }
+
+private:
+  friend class CSegmentStore;
+  CSegmentView();
+
+  const uint8_t *m_data;
+  size_t m_size;
+#ifdef TARGET_POSIX
+  void *m_mapping;
+#else
+  std::vector<uint8_t> m_buffer;
+#endif
+};
+
+/*!
+ \brief Size bounded on-disk store of fixed size segments of network files
+
+ Segments are stored one per file, named after the key of the file they
+ belong to and their index, so the store survives restarts: the directory
+ is scanned on first use and the modification times give the initial LRU
+ order. When the store is full the least recently used segments are
+ evicted, except those pinned by open caches.
+
+ Keys are derived from the URL, size and modification time of the source
+ (see MakeKey()), so a changed file doesn't reuse stale data.
+ */
+class CSegmentStore
+{
+public:
+  CSegmentStore(const std::string &path, uint64_t capacity, size_t segmentSize);
+  ~CSegmentStore();
+
+  /*!
+   \brief The store used by CFileCache, sized by advancedsettings' network/persistentcachesize
+   */
+  static CSegmentStore &GetInstance();
+
+  static std::string MakeKey(const std::string &url, int64_t length, time_t mtime);
+
+  size_t GetSegmentSize() const { return m_segmentSize; }
+  uint64_t GetCapacity() const { return m_capacity; }
+  uint64_t GetUsage();
+
+  /*!
+   \brief Whether a segment is stored
+   \param size Set to the size of the segment, only the last segment of a file is smaller than GetSegmentSize()
+   */
+  bool Has(const std::string &key, uint32_t index, size_t *size = NULL);
+
+  /*!
+   \brief Store a segment, replacing an earlier copy and evicting others if the store is full
+   */
+  bool Add(const std::string &key, uint32_t index, const char *data, size_t size);
+
+  /*!
+   \brief Map a stored segment for reading, marking it as recently used
+   \return NULL if the segment isn't stored, otherwise a view to be deleted by the caller
+   */
+  CSegmentView *Map(const std::string &key, uint32_t index);
+
+  /*!
+   \brief Remove all segments of a key
+   */
+  void Remove(const std::string &key);
+
+  /*!
+   \brief Protect segments first to last (inclusive) of a key from eviction
+   \return Handle for Repin() and Unpin()
+   */
+  unsigned int Pin(const std::string &key, uint32_t first, uint32_t last);
+  void Repin(unsigned int pin, uint32_t first, uint32_t last);
+  void Unpin(unsigned int pin);
+
+private:
+  struct SegmentId
+  {
+    SegmentId(const std::string &key, uint32_t index) : key(key), index(index) { }
+    bool operator<(const SegmentId &right) const
+    {
+      int result = key.compare(right.key);
+      return result < 0 || (result == 0 && index < right.index);
+    }
+
+    std::string key;
+    uint32_t index;
+  };
+
+  typedef std::list<SegmentId> SegmentList;
+
+  struct Segment
+  {
+    size_t size;
+    SegmentList::iterator lru;
+  };
+
+  struct SegmentPin
+  {
+    std::string key;
+    uint32_t first;
+    uint32_t last;
+  };
+
+  typedef std::map<SegmentId, Segment> SegmentMap;
+
+  void Initialize();
+  std::string GetSegmentPath(const SegmentId &id) const;
+  bool IsPinned(const SegmentId &id) const;
+  void Evict(size_t needed);
+  void Erase(SegmentMap::iterator segment, bool deleteFile);
+
+  std::string m_path;
+  uint64_t m_capacity;
+  size_t m_segmentSize;
+  uint64_t m_usage;
+  bool m_initialized;
+  SegmentMap m_segments;
+  SegmentList m_lru;         ///< least recently used first
+  std::map<unsigned int, SegmentPin> m_pins;
+  unsigned int m_nextPin;
+  volatile long m_nextTemp;  ///< tells apart concurrent writes of the same segment
+  CCriticalSection m_critSection;
+};
+
+/*!
+ \brief Cache strategy keeping the data of network files in a CSegmentStore
+
+ Unlike CSimpleFileCache and CSparseCache the data outlives Close(), so
+ reopening a file (resume, playback after thumbnail extraction, ...) reads
+ whatever was downloaded before from local disk and only fetches the gaps.
+ The source is fetched in whole segments, a seek to uncached data restarts
+ the download at the start of the segment.
+
+ Sources of unknown length can't be recognised later, their segments are
+ removed again on Close().
+ */
+class CSegmentCache : public CCacheStrategy
+{
+public:
+  CSegmentCache(CSegmentStore &store);
+  virtual ~CSegmentCache();
+
+  virtual int Open();
+  virtual void Close();
+  virtual void SetSource(const std::string &path, int64_t length, time_t mtime);
+
+  virtual int WriteToCache(const char *buf, size_t len);
+  virtual int ReadFromCache(char *buf, size_t len);
+  virtual int64_t WaitForData(unsigned int minimum, unsigned int millis);
+
+  virtual int64_t Seek(int64_t pos);
+  virtual void Reset(int64_t pos, bool clearAnyway=true);
+  virtual void EndOfInput();
+
+  virtual int64_t CachedDataEndPosIfSeekTo(int64_t iFilePosition);
+  virtual int64_t CachedDataEndPos();
+  virtual bool IsCachedPosition(int64_t iFilePosition);
+
+  virtual CCacheStrategy *CreateNew();
+
+protected:
+  int64_t ContiguousEnd(int64_t pos, int64_t stop);
+  int64_t WritePositionIfSeekTo(int64_t pos);
+  bool CommitPending(CSingleLock &lock);
+  void UpdatePin(int64_t from, int64_t to);
+
+  CSegmentStore    &m_store;
+  std::string       m_key;
+  bool              m_persistent;   /**< whether the segments are kept after Close() */
+  int64_t           m_length;       /**< length of the source, 0 if unknown */
+  int64_t           m_cur;          /**< current reading index in file */
+  int64_t           m_end;          /**< index in file where the next write goes */
+  int64_t           m_pendingStart; /**< index in file of the segment being written */
+  std::vector<char> m_pending;      /**< data of the segment being written, up to m_end */
+  std::vector<char> m_committing;   /**< data of the segment the store is writing */
+  int64_t           m_committingStart;
+  size_t            m_committingSize; /**< 0 unless the store is writing a segment */
+  CSegmentView     *m_view;         /**< segment being read */
+  uint32_t          m_viewIndex;
+  unsigned int      m_pin;
+  bool              m_pinned;
+  uint32_t          m_pinFirst;
+  uint32_t          m_pinLast;
+  CCriticalSection  m_sync;
+  CEvent            m_written;
+};
+
+} // namespace XFILE
+#endif
@@ -0,0 +1,325 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include "threads/SystemClock.h"
+#include "system.h"
+#include "utils/log.h"
+#include "threads/SingleLock.h"
+#include "utils/TimeUtils.h"
+#include "SparseCache.h"
+
+#define SPARSE_CACHE_BLOCK_SIZE (64 * 1024)
+#define SPARSE_CACHE_MIN_BLOCKS 4
+
+using namespace XFILE;
+
+CSparseCache::CSparseCache(size_t front, size_t back)
+ : CCacheStrategy()
+ , m_cur(0)
+ , m_end(0)
+ , m_buf(NULL)
+ , m_size(front + back)
+ , m_size_back(back)
+{
+}
+
+CSparseCache::~CSparseCache()
+{
+  Close();
+}
+
+int CSparseCache::Open()
+{
+  CSingleLock lock(m_sync);
+  Close();
+
+  size_t blocks = std::max<size_t>(m_size / SPARSE_CACHE_BLOCK_SIZE, SPARSE_CACHE_MIN_BLOCKS);
+  m_buf = new uint8_t[blocks * SPARSE_CACHE_BLOCK_SIZE];
+  if (m_buf == NULL)
+    return CACHE_RC_ERROR;
+
+  for (size_t i = 0; i < blocks; i++)
+    m_free.push_back(m_buf + i * SPARSE_CACHE_BLOCK_SIZE);
+  m_cur = 0;
+  m_end = 0;
+  return CACHE_RC_OK;
+}
+
+void CSparseCache::Close()
+{
+  CSingleLock lock(m_sync);
+  m_blocks.clear();
+  m_free.clear();
+  delete[] m_buf;
+  m_buf = NULL;
+}
+
+/**
+ * Distance of the data in a block from the read position. History is
+ * weighted by front / back, so with a full cache the reader keeps about
+ * m_size_back behind it while m_size - m_size_back is read ahead.
+ */
+double CSparseCache::Distance(int64_t index, const Block &block) const
+{
+  int64_t begin = index * SPARSE_CACHE_BLOCK_SIZE + block.begin;
+  int64_t end = index * SPARSE_CACHE_BLOCK_SIZE + block.end;
+  if (begin > m_cur)
+    return (double)(begin - m_cur);
+  if (end < m_cur)
+    return (double)(m_cur - end) * (m_size - m_size_back) / std::max<size_t>(m_size_back, 1);
+  return 0.0;
+}
+
+uint8_t *CSparseCache::AllocateBlock(int64_t index)
+{
+  if (!m_free.empty())
+  {
+    uint8_t *data = m_free.back();
+    m_free.pop_back();
+    return data;
+  }
+
+  // reuse the block furthest from the reader, unless the new one would be further away
+  Block wanted = { NULL, (size_t)(m_end % SPARSE_CACHE_BLOCK_SIZE), (size_t)(m_end % SPARSE_CACHE_BLOCK_SIZE) };
+  double limit = Distance(index, wanted);
+
+  BlockMap::iterator victim = m_blocks.end();
+  double furthest = limit;
+  for (BlockMap::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+  {
+    double distance = Distance(it->first, it->second);
+    if (distance > furthest)
+    {
+      furthest = distance;
+      victim = it;
+    }
+  }
+
+  if (victim == m_blocks.end())
+    return NULL;
+
+  uint8_t *data = victim->second.data;
+  m_blocks.erase(victim);
+  return data;
+}
+
+/**
+ * Function will write to the block m_end is in. It will only
+ * write up to the end of the block, so multiple calls may be
+ * needed to write everything.
+ *
+ * It returns 0 if the reader is (m_size - m_size_back) behind,
+ * or if no block is further away from the reader than m_end.
+ */
+int CSparseCache::WriteToCache(const char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  // limit by max forward size
+  if (m_end >= m_cur)
+  {
+    size_t front = (size_t)(m_end - m_cur);
+    if (front >= m_size - m_size_back)
+      return 0;
+    if (len > m_size - m_size_back - front)
+      len = m_size - m_size_back - front;
+  }
+
+  int64_t index = m_end / SPARSE_CACHE_BLOCK_SIZE;
+  size_t pos = (size_t)(m_end % SPARSE_CACHE_BLOCK_SIZE);
+  if (len > SPARSE_CACHE_BLOCK_SIZE - pos)
+    len = SPARSE_CACHE_BLOCK_SIZE - pos;
+
+  if (len == 0)
+    return 0;
+
+  BlockMap::iterator it = m_blocks.find(index);
+  if (it == m_blocks.end())
+  {
+    Block block = { AllocateBlock(index), pos, pos };
+    if (block.data == NULL)
+      return 0;
+    it = m_blocks.insert(std::make_pair(index, block)).first;
+  }
+
+  Block &block = it->second;
+  memcpy(block.data + pos, buf, len);
+  if (pos + len < block.begin || pos > block.end)
+  {
+    // what the block held isn't connected to the new data, drop it
+    block.begin = pos;
+    block.end = pos + len;
+  }
+  else
+  {
+    block.begin = std::min(block.begin, pos);
+    block.end = std::max(block.end, pos + len);
+  }
+  m_end += len;
+
+  m_written.Set();
+
+  return len;
+}
+
+/**
+ * Reads data from cache. Will only read up till the end
+ * of a block. So multiple calls may be needed to read
+ * everything.
+ */
+int CSparseCache::ReadFromCache(char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  int64_t index = m_cur / SPARSE_CACHE_BLOCK_SIZE;
+  size_t pos = (size_t)(m_cur % SPARSE_CACHE_BLOCK_SIZE);
+  BlockMap::const_iterator it = m_blocks.find(index);
+  if (it == m_blocks.end() || pos < it->second.begin || pos >= it->second.end)
+  {
+    // the end of another range isn't the end of the file
+    if (m_cur == m_end && IsEndOfInput())
+      return 0;
+    else
+      return CACHE_RC_WOULD_BLOCK;
+  }
+
+  if (len > it->second.end - pos)
+    len = it->second.end - pos;
+
+  memcpy(buf, it->second.data + pos, len);
+  m_cur += len;
+
+  m_space.Set();
+
+  return len;
+}
+
+/**
+ * End of the data readable from pos without a gap, pos if there is
+ * nothing cached at pos.
+ */
+int64_t CSparseCache::ContiguousEnd(int64_t pos)
+{
+  int64_t index = pos / SPARSE_CACHE_BLOCK_SIZE;
+  size_t offset = (size_t)(pos % SPARSE_CACHE_BLOCK_SIZE);
+  BlockMap::const_iterator it = m_blocks.find(index);
+  if (it == m_blocks.end() || offset < it->second.begin || offset >= it->second.end)
+    return pos;
+
+  int64_t end = index * SPARSE_CACHE_BLOCK_SIZE + it->second.end;
+  while (it->second.end == SPARSE_CACHE_BLOCK_SIZE)
+  {
+    ++it;
+    if (it == m_blocks.end() || it->first != ++index || it->second.begin != 0)
+      break;
+    end = index * SPARSE_CACHE_BLOCK_SIZE + it->second.end;
+  }
+  return end;
+}
+
+bool CSparseCache::IsCached(int64_t pos)
+{
+  return pos == m_end || ContiguousEnd(pos) > pos;
+}
+
+int64_t CSparseCache::WaitForData(unsigned int minumum, unsigned int millis)
+{
+  CSingleLock lock(m_sync);
+  int64_t avail = ContiguousEnd(m_cur) - m_cur;
+
+  if(millis == 0 || IsEndOfInput())
+    return avail;
+
+  if(minumum > m_size - m_size_back)
+    minumum = m_size - m_size_back;
+
+  XbmcThreads::EndTime endtime(millis);
+  while (!IsEndOfInput() && avail < minumum && !endtime.IsTimePast() )
+  {
+    lock.Leave();
+    m_written.WaitMSec(50); // may miss the deadline. shouldn't be a problem.
+    lock.Enter();
+    avail = ContiguousEnd(m_cur) - m_cur;
+  }
+
+  return avail;
+}
+
+int64_t CSparseCache::Seek(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+
+  // if seek is a bit over what the writer has, try to wait a few seconds for the data to be available.
+  // we try to avoid a (heavy) seek on the source
+  if (pos >= m_end && pos < m_end + 100000 && (m_cur == m_end || ContiguousEnd(m_cur) == m_end))
+  {
+    lock.Leave();
+    WaitForData((size_t)(pos - m_cur), 5000);
+    lock.Enter();
+  }
+
+  if (IsCached(pos))
+  {
+    m_cur = pos;
+    return pos;
+  }
+
+  return CACHE_RC_ERROR;
+}
+
+void CSparseCache::Reset(int64_t pos, bool clearAnyway)
+{
+  CSingleLock lock(m_sync);
+  if (clearAnyway)
+  {
+    for (BlockMap::const_iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+      m_free.push_back(it->second.data);
+    m_blocks.clear();
+  }
+
+  // continue filling the range pos is in, or start a new one
+  m_cur = pos;
+  m_end = ContiguousEnd(pos);
+}
+
+int64_t CSparseCache::CachedDataEndPosIfSeekTo(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+  return ContiguousEnd(iFilePosition);
+}
+
+int64_t CSparseCache::CachedDataEndPos()
+{
+  CSingleLock lock(m_sync);
+  return m_end;
+}
+
+bool CSparseCache::IsCachedPosition(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+  return IsCached(iFilePosition);
+}
+
+CCacheStrategy *CSparseCache::CreateNew()
+{
+  return new CSparseCache(m_size - m_size_back, m_size_back);
+}
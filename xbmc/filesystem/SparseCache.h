@@ -0,0 +1,96 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CACHESPARSE_H
+#define CACHESPARSE_H
+
+#include <map>
+#include <vector>
+
+#include "CacheStrategy.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+namespace XFILE {
+
+/*!
+ \brief Memory cache holding several independent ranges of a file
+
+ The memory is split into fixed size blocks at fixed file offsets, so
+ data read before a seek stays available next to the data read after it,
+ e.g. the index at the end of a file that the demuxer probed before
+ jumping back to the start. When all blocks are in use, the block
+ furthest from the read position is reused. Data behind the reader
+ counts as further away, in the same proportion as the front and back
+ sizes, so sequential reading keeps about the back size of history.
+
+ Only the range the writer is in grows, CFileCache moves the writer to
+ the range of the reader once the reader runs out of data.
+ */
+class CSparseCache : public CCacheStrategy
+{
+public:
+  CSparseCache(size_t front, size_t back);
+  virtual ~CSparseCache();
+
+  virtual int Open();
+  virtual void Close();
+
+  virtual int WriteToCache(const char *buf, size_t len);
+  virtual int ReadFromCache(char *buf, size_t len);
+  virtual int64_t WaitForData(unsigned int minimum, unsigned int millis);
+
+  virtual int64_t Seek(int64_t pos);
+  virtual void Reset(int64_t pos, bool clearAnyway=true);
+
+  virtual int64_t CachedDataEndPosIfSeekTo(int64_t iFilePosition);
+  virtual int64_t CachedDataEndPos();
+  virtual bool IsCachedPosition(int64_t iFilePosition);
+
+  virtual CCacheStrategy *CreateNew();
+
+protected:
+  struct Block
+  {
+    uint8_t *data;
+    size_t   begin; /**< offset of the first valid byte in the block */
+    size_t   end;   /**< offset behind the last valid byte in the block */
+  };
+
+  typedef std::map<int64_t, Block> BlockMap;
+
+  int64_t ContiguousEnd(int64_t pos);
+  bool IsCached(int64_t pos);
+  double Distance(int64_t index, const Block &block) const;
+  uint8_t *AllocateBlock(int64_t index);
+
+  int64_t           m_cur;       /**< current reading index in file */
+  int64_t           m_end;       /**< index in file where the next write goes */
+  uint8_t          *m_buf;       /**< memory of all blocks */
+  size_t            m_size;      /**< size of the cache (front + back) */
+  size_t            m_size_back; /**< guaranteed size of history behind the reader, when reading sequentially */
+  BlockMap          m_blocks;    /**< blocks in use by file offset / block size */
+  std::vector<uint8_t*> m_free;  /**< blocks not in use */
+  CCriticalSection  m_sync;
+  CEvent            m_written;
+};
+
+} // namespace XFILE
+#endif
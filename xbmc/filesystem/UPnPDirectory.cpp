@@ -35,6 +35,8 @@ using namespace MUSIC_INFO;
 using namespace XFILE;
 using namespace UPNP;
 
+#define UPNP_BROWSE_PAGE 200 // items per browse request when delivering items as they arrive
+
 namespace XFILE
 {
 
@@ -286,57 +288,72 @@ CUPnPDirectory::GetDirectory(const CStdString& strPath, CFileItemList &items)
         }
 #endif
 
-        // if error, return now, the device could have gone away
-        // this will make us go back to the sources list
-        PLT_MediaObjectListReference list;
-        NPT_Result res = upnp->m_MediaBrowser->BrowseSync(device, object_id, list);
-        if (NPT_FAILED(res)) goto failure;
-
-        // empty list is ok
-        if (list.IsNull()) goto cleanup;
-
-        PLT_MediaObjectList::Iterator entry = list->GetFirstItem();
-        while (entry) {
-            // disregard items with wrong class/type
-            if( (!video && (*entry)->m_ObjectClass.type.CompareN("object.item.videoitem", 21,true) == 0)
-             || (!audio && (*entry)->m_ObjectClass.type.CompareN("object.item.audioitem", 21,true) == 0)
-             || (!image && (*entry)->m_ObjectClass.type.CompareN("object.item.imageitem", 21,true) == 0) )
-            {
-                ++entry;
-                continue;
+        // when someone wants the items as they arrive, browse page by page instead
+        // of waiting for the whole container. Pages bypass the browser cache, so
+        // only do that when the container isn't cached already.
+        bool paged = m_callback && !upnp->m_MediaBrowser->IsCached(uuid, object_id);
+        NPT_Int32 start = 0;
+        for (;;) {
+            // if error, return now, the device could have gone away
+            // this will make us go back to the sources list
+            PLT_MediaObjectListReference list;
+            NPT_Result res = upnp->m_MediaBrowser->BrowseSync(device, object_id, list, false, start, paged ? UPNP_BROWSE_PAGE : 0);
+            if (NPT_FAILED(res)) goto failure;
+
+            // empty list is ok
+            if (list.IsNull()) {
+                if (start == 0) goto cleanup;
+                break;
             }
 
-            // never show empty containers in media views
-            if((*entry)->IsContainer()) {
-                if( (audio || video || image)
-                 && ((PLT_MediaContainer*)(*entry))->m_ChildrenCount == 0) {
+            PLT_MediaObjectList::Iterator entry = list->GetFirstItem();
+            while (entry) {
+                // disregard items with wrong class/type
+                if( (!video && (*entry)->m_ObjectClass.type.CompareN("object.item.videoitem", 21,true) == 0)
+                 || (!audio && (*entry)->m_ObjectClass.type.CompareN("object.item.audioitem", 21,true) == 0)
+                 || (!image && (*entry)->m_ObjectClass.type.CompareN("object.item.imageitem", 21,true) == 0) )
+                {
                     ++entry;
                     continue;
                 }
-            }
 
+                // never show empty containers in media views
+                if((*entry)->IsContainer()) {
+                    if( (audio || video || image)
+                     && ((PLT_MediaContainer*)(*entry))->m_ChildrenCount == 0) {
+                        ++entry;
+                        continue;
+                    }
+                }
 
-            // keep count of classes
-            classes[(*entry)->m_ObjectClass.type]++;
-            CFileItemPtr pItem = BuildObject(*entry);
-            if(!pItem) {
-                ++entry;
-                continue;
-            }
 
-            CStdString id;
-            if ((*entry)->m_ReferenceID.IsEmpty())
-                id = (const char*) (*entry)->m_ObjectID;
-            else
-                id = (const char*) (*entry)->m_ReferenceID;
+                // keep count of classes
+                classes[(*entry)->m_ObjectClass.type]++;
+                CFileItemPtr pItem = BuildObject(*entry);
+                if(!pItem) {
+                    ++entry;
+                    continue;
+                }
 
-            CURL::Encode(id);
-            URIUtils::AddSlashAtEnd(id);
-            pItem->SetPath(CStdString((const char*) "upnp://" + uuid + "/" + id.c_str()));
+                CStdString id;
+                if ((*entry)->m_ReferenceID.IsEmpty())
+                    id = (const char*) (*entry)->m_ObjectID;
+                else
+                    id = (const char*) (*entry)->m_ReferenceID;
 
-            items.Add(pItem);
+                CURL::Encode(id);
+                URIUtils::AddSlashAtEnd(id);
+                pItem->SetPath(CStdString((const char*) "upnp://" + uuid + "/" + id.c_str()));
+
+                items.Add(pItem);
+
+                ++entry;
+            }
+
+            if (!DeliverItems(items)) goto failure;
 
-            ++entry;
+            start += list->GetItemCount();
+            if (!paged || list->GetItemCount() < UPNP_BROWSE_PAGE) break;
         }
 
         NPT_String max_string = "";
@@ -78,7 +78,13 @@ bool CVirtualDirectory::GetDirectory(const CStdString& strPath, CFileItemList &i
   if (!bUseFileDirectories)
     flags |= DIR_FLAG_NO_FILE_DIRS;
   if (!strPath.IsEmpty() && strPath != "files://")
-    return CDirectory::GetDirectory(strPath, items, m_strFileMask, flags, m_allowThreads);
+  {
+    CDirectory::CHints hints;
+    hints.mask = m_strFileMask;
+    hints.flags = flags;
+    hints.callback = m_callback;
+    return CDirectory::GetDirectory(strPath, items, hints, m_allowThreads);
+  }
 
   // if strPath is blank, clear the list (to avoid parent items showing up)
   if (strPath.IsEmpty())
@@ -20,11 +20,21 @@
 
 #include "ZipFile.h"
 #include "URL.h"
+#include "SpecialProtocol.h"
 #include "utils/URIUtils.h"
 
 #include <sys/stat.h>
+#ifdef TARGET_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #define ZIP_CACHE_LIMIT 4*1024*1024
+// uncompressed bytes between inflate checkpoints, each costs about 40k
+#define ZIP_CHECKPOINT_DISTANCE (1024*1024)
+// checkpoints kept at most, beyond that they're thinned out to twice the distance
+#define ZIP_MAX_CHECKPOINTS 32
 
 using namespace XFILE;
 using namespace std;
@@ -35,6 +45,11 @@ CZipFile::CZipFile()
   m_szStartOfStringBuffer = NULL;
   m_iDataInStringBuffer = 0;
   m_bCached = false;
+  m_bCheckpoints = false;
+  m_iCheckpointDistance = ZIP_CHECKPOINT_DISTANCE;
+  m_mapped = NULL;
+  m_mapping = NULL;
+  m_mappingSize = 0;
   m_iRead = -1;
 }
 
@@ -65,7 +80,9 @@ bool CZipFile::Open(const CURL&url)
     return false;
   }
 
-  if (mZipItem.method != 0 && mZipItem.usize > ZIP_CACHE_LIMIT && strOpts != "?cache=no")
+  // large entries of local archives are read directly, seeking from the inflate checkpoints
+  bool local = URIUtils::IsHD(url.GetHostName());
+  if (mZipItem.method != 0 && mZipItem.usize > ZIP_CACHE_LIMIT && strOpts != "?cache=no" && !local)
   {
     if (!CFile::Exists("special://temp/" + URIUtils::GetFileName(strPath)))
     {
@@ -82,8 +99,58 @@ bool CZipFile::Open(const CURL&url)
     CLog::Log(LOGERROR,"FileZip: unable to open zip file %s!",url.GetHostName().c_str());
     return false;
   }
+  if (local)
+    MapArchive(url.GetHostName());
   mFile.Seek(mZipItem.offset,SEEK_SET);
-  return InitDecompress();
+  if (!InitDecompress())
+    return false;
+  m_bCheckpoints = mZipItem.method == 8;
+  m_iCheckpointDistance = ZIP_CHECKPOINT_DISTANCE;
+  return true;
+}
+
+bool CZipFile::MapArchive(const CStdString& strArchive)
+{
+#ifdef TARGET_POSIX
+  if (mZipItem.csize == 0)
+    return false;
+
+  CStdString strPath = CSpecialProtocol::TranslatePath(strArchive);
+  int fd = open(strPath.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  // a truncated archive would fault on access rather than fail to read
+  struct stat st;
+  void* mapping = MAP_FAILED;
+  long page = sysconf(_SC_PAGESIZE);
+  int64_t start = mZipItem.offset - mZipItem.offset % page;
+  size_t size = (size_t)(mZipItem.offset + mZipItem.csize - start);
+  if (fstat(fd, &st) == 0 && st.st_size >= mZipItem.offset + mZipItem.csize)
+    mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, start);
+  close(fd);
+
+  if (mapping == MAP_FAILED)
+    return false;
+
+  m_mapping = mapping;
+  m_mappingSize = size;
+  m_mapped = (const char*)mapping + (mZipItem.offset - start);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void CZipFile::UnmapArchive()
+{
+#ifdef TARGET_POSIX
+  if (m_mapping)
+    munmap(m_mapping, m_mappingSize);
+#endif
+  m_mapping = NULL;
+  m_mappingSize = 0;
+  m_mapped = NULL;
 }
 
 bool CZipFile::InitDecompress()
@@ -93,6 +160,7 @@ bool CZipFile::InitDecompress()
   m_iZipFilePos = 0;
   m_iAvailBuffer = 0;
   m_bFlush = false;
+  m_bCheckpoints = false;
   m_ZStream.zalloc = Z_NULL;
   m_ZStream.zfree = Z_NULL;
   m_ZStream.opaque = Z_NULL;
@@ -130,111 +198,168 @@ int64_t CZipFile::Seek(int64_t iFilePosition, int iWhence)
     return mFile.Seek(iFilePosition,iWhence);
   if (mZipItem.method == 0) // this is easy
   {
-    int64_t iResult;
+    int64_t iTarget;
     switch (iWhence)
     {
     case SEEK_SET:
-      if (iFilePosition > mZipItem.usize)
-        return -1;
-      m_iFilePos = iFilePosition;
-      m_iZipFilePos = m_iFilePos;
-      iResult = mFile.Seek(iFilePosition+mZipItem.offset,SEEK_SET)-mZipItem.offset;
-      return iResult;
+      iTarget = iFilePosition;
       break;
-
     case SEEK_CUR:
-      if (m_iFilePos+iFilePosition > mZipItem.usize)
-        return -1;
-      m_iFilePos += iFilePosition;
-      m_iZipFilePos = m_iFilePos;
-      iResult = mFile.Seek(iFilePosition,SEEK_CUR)-mZipItem.offset;
-      return iResult;
+      iTarget = m_iFilePos + iFilePosition;
       break;
-
     case SEEK_END:
-      if (iFilePosition > mZipItem.usize)
-        return -1;
-      m_iFilePos = mZipItem.usize+iFilePosition;
-      m_iZipFilePos = m_iFilePos;
-      iResult = mFile.Seek(mZipItem.offset+mZipItem.usize+iFilePosition,SEEK_SET)-mZipItem.offset;
-      return iResult;
+      iTarget = mZipItem.usize + iFilePosition;
       break;
     default:
       return -1;
-
     }
+
+    // Read() copies straight from the mapped archive at this position
+    if (iTarget > mZipItem.usize || iTarget < 0)
+      return -1;
+
+    m_iFilePos = iTarget;
+    m_iZipFilePos = m_iFilePos;
+    return mFile.Seek(mZipItem.offset+iTarget,SEEK_SET)-mZipItem.offset;
   }
-  // here goes the stupid part..
   if (mZipItem.method == 8)
   {
-    char temp[131072];
+    int64_t iTarget;
     switch (iWhence)
     {
     case SEEK_SET:
-      if (iFilePosition == m_iFilePos)
-        return m_iFilePos; // mp3reader does this lots-of-times
-      if (iFilePosition > mZipItem.usize || iFilePosition < 0)
-        return -1;
-      // read until position in 128k blocks.. only way to do it due to format.
-      // can't start in the middle of data since then we'd have no clue where
-      // we are in uncompressed data..
-      if (iFilePosition < m_iFilePos)
-      {
-        m_iFilePos = 0;
-        m_iZipFilePos = 0;
-        inflateEnd(&m_ZStream);
-        inflateInit2(&m_ZStream,-MAX_WBITS); // simply restart zlib
-        mFile.Seek(mZipItem.offset,SEEK_SET);
-        m_ZStream.next_in = (Bytef*)m_szBuffer;
-        m_ZStream.avail_in = 0;
-        m_ZStream.total_out = 0;
-        while (m_iFilePos < iFilePosition)
-        {
-          unsigned int iToRead = (iFilePosition-m_iFilePos)>131072?131072:(int)(iFilePosition-m_iFilePos);
-          if (Read(temp,iToRead) != iToRead)
-            return -1;
-        }
-        return m_iFilePos;
-      }
-      else // seek forward
-        return Seek(iFilePosition-m_iFilePos,SEEK_CUR);
+      iTarget = iFilePosition;
       break;
-
     case SEEK_CUR:
-      if (iFilePosition < 0)
-        return Seek(m_iFilePos+iFilePosition,SEEK_SET); // can't rewind stream
-      // read until requested position, drop data
-      if (m_iFilePos+iFilePosition > mZipItem.usize)
-        return -1;
-      iFilePosition += m_iFilePos;
-      while (m_iFilePos < iFilePosition)
-      {
-        unsigned int iToRead = (iFilePosition-m_iFilePos)>131072?131072:(int)(iFilePosition-m_iFilePos);
-        if (Read(temp,iToRead) != iToRead)
-          return -1;
-      }
-      return m_iFilePos;
+      iTarget = m_iFilePos + iFilePosition;
       break;
-
     case SEEK_END:
-      // now this is a nasty bastard, possibly takes lotsoftime
-      // uncompress, minding m_ZStream.total_out
-
-      while( (int)m_ZStream.total_out < mZipItem.usize+iFilePosition)
-      {
-        unsigned int iToRead = (mZipItem.usize+iFilePosition-m_ZStream.total_out > 131072)?131072:(int)(mZipItem.usize+iFilePosition-m_ZStream.total_out);
-        if (Read(temp,iToRead) != iToRead)
-          return -1;
-      }
-      return m_iFilePos;
+      iTarget = mZipItem.usize + iFilePosition;
       break;
     default:
       return -1;
     }
+
+    if (iTarget == m_iFilePos)
+      return m_iFilePos; // mp3reader does this lots-of-times
+    if (iTarget > mZipItem.usize || iTarget < 0)
+      return -1;
+
+    // we can't start in the middle of the data, we'd have no clue where we
+    // are in the uncompressed data. continue from the closest checkpoint
+    // before the position instead, if that is closer than where we are
+    SCheckpoint* checkpoint = FindCheckpoint(iTarget);
+    if (iTarget < m_iFilePos || (checkpoint && checkpoint->filePos > m_iFilePos))
+    {
+      if (!RestoreCheckpoint(checkpoint))
+        return -1;
+    }
+
+    // read until position in 128k blocks, drop data
+    char temp[131072];
+    while (m_iFilePos < iTarget)
+    {
+      unsigned int iToRead = (iTarget-m_iFilePos)>131072?131072:(int)(iTarget-m_iFilePos);
+      if (Read(temp,iToRead) != iToRead)
+        return -1;
+    }
+    return m_iFilePos;
   }
   return -1;
 }
 
+void CZipFile::AddCheckpoint()
+{
+  if (!m_bCheckpoints)
+    return;
+
+  // checkpoints are in order, we may pass them again after going back
+  int64_t iPos = m_ZStream.total_out;
+  int64_t iLast = m_checkpoints.empty() ? 0 : m_checkpoints.back()->filePos;
+  if (iPos < iLast + m_iCheckpointDistance)
+    return;
+
+  if (m_checkpoints.size() >= ZIP_MAX_CHECKPOINTS)
+  { // keep every second checkpoint, and take new ones twice as far apart
+    vector<SCheckpoint*> kept;
+    for (size_t i = 0; i < m_checkpoints.size(); i++)
+    {
+      if (i % 2)
+        kept.push_back(m_checkpoints[i]);
+      else
+      {
+        inflateEnd(&m_checkpoints[i]->stream);
+        delete m_checkpoints[i];
+      }
+    }
+    m_checkpoints.swap(kept);
+    m_iCheckpointDistance *= 2;
+    if (iPos < m_checkpoints.back()->filePos + m_iCheckpointDistance)
+      return;
+  }
+
+  SCheckpoint* checkpoint = new SCheckpoint;
+  if (inflateCopy(&checkpoint->stream, &m_ZStream) != Z_OK)
+  {
+    delete checkpoint;
+    return;
+  }
+  checkpoint->filePos = iPos;
+  checkpoint->zipPos = m_iZipFilePos;
+  checkpoint->flush = m_bFlush;
+  m_checkpoints.push_back(checkpoint);
+}
+
+CZipFile::SCheckpoint* CZipFile::FindCheckpoint(int64_t iFilePosition)
+{
+  for (vector<SCheckpoint*>::reverse_iterator it = m_checkpoints.rbegin(); it != m_checkpoints.rend(); ++it)
+  {
+    if ((*it)->filePos <= iFilePosition)
+      return *it;
+  }
+  return NULL;
+}
+
+bool CZipFile::RestoreCheckpoint(SCheckpoint* checkpoint)
+{
+  inflateEnd(&m_ZStream);
+  if (checkpoint)
+  {
+    if (inflateCopy(&m_ZStream, &checkpoint->stream) != Z_OK)
+      return false;
+    m_iFilePos = checkpoint->filePos;
+    m_iZipFilePos = checkpoint->zipPos;
+    m_bFlush = checkpoint->flush;
+  }
+  else
+  {
+    // simply restart zlib
+    if (inflateInit2(&m_ZStream,-MAX_WBITS) != Z_OK)
+      return false;
+    m_iFilePos = 0;
+    m_iZipFilePos = 0;
+    m_bFlush = false;
+    m_ZStream.total_out = 0;
+  }
+
+  // checkpoints are taken with the input consumed, the next read refills it
+  m_ZStream.next_in = (Bytef*)m_szBuffer;
+  m_ZStream.avail_in = 0;
+  if (!m_mapped)
+    mFile.Seek(mZipItem.offset+m_iZipFilePos,SEEK_SET);
+  return true;
+}
+
+void CZipFile::ClearCheckpoints()
+{
+  for (vector<SCheckpoint*>::iterator it = m_checkpoints.begin(); it != m_checkpoints.end(); ++it)
+  {
+    inflateEnd(&(*it)->stream);
+    delete *it;
+  }
+  m_checkpoints.clear();
+}
+
 bool CZipFile::Exists(const CURL& url)
 {
   SZipEntry item;
@@ -309,6 +434,7 @@ unsigned int CZipFile::Read(void* lpBuf, int64_t uiBufSize)
 
       if (!m_ZStream.avail_in)
       {
+        AddCheckpoint();
         if (!FillBuffer()) // eof!
         {
           iDecompressed = m_ZStream.total_out-prevOut;
@@ -338,7 +464,14 @@ unsigned int CZipFile::Read(void* lpBuf, int64_t uiBufSize)
     {
       return 0; // we are past eof, this shouldn't happen but test anyway
     }
-    unsigned int iResult = mFile.Read(lpBuf,uiBufSize);
+    unsigned int iResult;
+    if (m_mapped)
+    {
+      memcpy(lpBuf,m_mapped+m_iFilePos,static_cast<size_t>(uiBufSize));
+      iResult = static_cast<unsigned int>(uiBufSize);
+    }
+    else
+      iResult = mFile.Read(lpBuf,uiBufSize);
     m_iZipFilePos += iResult;
     m_iFilePos += iResult;
     return iResult;
@@ -352,6 +485,8 @@ void CZipFile::Close()
   if (mZipItem.method == 8 && !m_bCached && m_iRead != -1)
     inflateEnd(&m_ZStream);
 
+  ClearCheckpoints();
+  UnmapArchive();
   mFile.Close();
 }
 /* CHANGED: JM - moved to CFile
@@ -434,6 +569,15 @@ bool CZipFile::FillBuffer()
   if (sToRead <= 0)
     return false; // eof!
 
+  // the compressed data is right there in the mapping
+  if (m_mapped)
+  {
+    m_ZStream.avail_in = sToRead;
+    m_ZStream.next_in = (Bytef*)m_mapped+m_iZipFilePos;
+    m_iZipFilePos += sToRead;
+    return true;
+  }
+
   if (mFile.Read(m_szBuffer,sToRead) != sToRead)
     return false;
   m_ZStream.avail_in = sToRead;
@@ -22,6 +22,7 @@
 
 
 #include "IFile.h"
+#include <vector>
 #include <zlib.h>
 #include "utils/log.h"
 #include "File.h"
@@ -48,9 +49,24 @@ namespace XFILE
 
     int UnpackFromMemory(std::string& strDest, const std::string& strInput, bool isGZ=false);
   private:
+    /*! \brief State of the inflater at some position, to continue decompressing from */
+    struct SCheckpoint
+    {
+      z_stream stream;  // never moved, zlib keeps a pointer to it
+      int64_t filePos;
+      int64_t zipPos;
+      bool flush;
+    };
+
     bool InitDecompress();
     bool FillBuffer();
     void DestroyBuffer(void* lpBuffer, int iBufSize);
+    bool MapArchive(const CStdString& strArchive);
+    void UnmapArchive();
+    void AddCheckpoint();
+    SCheckpoint* FindCheckpoint(int64_t iFilePosition);
+    bool RestoreCheckpoint(SCheckpoint* checkpoint);
+    void ClearCheckpoints();
     CFile mFile;
     SZipEntry mZipItem;
     int64_t m_iFilePos; // position in _uncompressed_ data read
@@ -64,6 +80,12 @@ namespace XFILE
     int m_iRead;
     bool m_bFlush;
     bool m_bCached;
+    bool m_bCheckpoints;
+    std::vector<SCheckpoint*> m_checkpoints;
+    int64_t m_iCheckpointDistance; // uncompressed bytes between checkpoints
+    const char* m_mapped;  // compressed data of the entry, if the archive is mapped
+    void* m_mapping;
+    size_t m_mappingSize;
   };
 }
 
@@ -22,12 +22,15 @@
 #include "ZipManager.h"
 #include "URL.h"
 #include "File.h"
+#include "threads/SingleLock.h"
 #include "utils/CharsetConverter.h"
+#include "utils/Crc32.h"
 #include "utils/log.h"
 #include "utils/EndianSwap.h"
 #include "utils/URIUtils.h"
 #include "SpecialProtocol.h"
 
+#include <algorithm>
 
 #ifndef min
 #define min(a,b)            (((a) < (b)) ? (a) : (b))
@@ -60,19 +63,18 @@ bool CZipManager::GetZipList(const CStdString& strPath, vector<SZipEntry>& items
     return false;
   }
 
-  map<CStdString,vector<SZipEntry> >::iterator it = mZipMap.find(strFile);
+  CSingleLock lock(m_critSection);
+  map<CStdString,SZipArchive>::iterator it = mZipMap.find(strFile);
   if (it != mZipMap.end()) // already listed, just return it if not changed, else release and reread
   {
-    map<CStdString,int64_t>::iterator it2=mZipDate.find(strFile);
-    CLog::Log(LOGDEBUG,"statdata: %"PRId64" new: %"PRIu64, it2->second, (uint64_t)m_StatData.st_mtime);
+    CLog::Log(LOGDEBUG,"statdata: %"PRId64" new: %"PRIu64, it->second.mtime, (uint64_t)m_StatData.st_mtime);
 
-      if (m_StatData.st_mtime == it2->second)
+      if (m_StatData.st_mtime == it->second.mtime)
       {
-        items = it->second;
+        items = it->second.items;
         return true;
       }
       mZipMap.erase(it);
-      mZipDate.erase(it2);
   }
 
   CFile mFile;
@@ -90,8 +92,6 @@ bool CZipManager::GetZipList(const CStdString& strPath, vector<SZipEntry>& items
     mFile.Close();
     return false;
   }
-  // push date for update detection
-  mZipDate.insert(make_pair(strFile,m_StatData.st_mtime));
 
 
   // Look for end of central directory record
@@ -161,83 +161,135 @@ bool CZipManager::GetZipList(const CStdString& strPath, vector<SZipEntry>& items
   mFile.Read(&cdirOffset,4);
   cdirOffset = Endian_SwapLE32(cdirOffset);
 
-  // Go to the start of central directory
-  mFile.Seek(cdirOffset,SEEK_SET);
+  // Read the whole central directory at once, rather than a seek and read per entry
+  if ((int64_t)cdirOffset + cdirSize > fileSize)
+  {
+    CLog::Log(LOGDEBUG,"ZipManager: broken file %s!",strFile.c_str());
+    mFile.Close();
+    return false;
+  }
+
+  vector<char> cdir(cdirSize);
+  if (cdirSize > 0 && (mFile.Seek(cdirOffset,SEEK_SET) != cdirOffset || mFile.Read(&cdir[0], cdirSize) != cdirSize))
+  {
+    CLog::Log(LOGDEBUG,"ZipManager: unable to read central directory of %s!",strFile.c_str());
+    mFile.Close();
+    return false;
+  }
 
-  char temp[CHDR_SIZE];
-  while (mFile.GetPosition() < cdirOffset + cdirSize)
+  unsigned int pos = 0;
+  while (pos < cdirSize)
   {
     SZipEntry ze;
-    mFile.Read(temp,CHDR_SIZE);
-    readCHeader(temp, ze);
-    if (ze.header != ZIP_CENTRAL_HEADER)
+    if (pos + CHDR_SIZE <= cdirSize)
+      readCHeader(&cdir[pos], ze);
+    if (ze.header != ZIP_CENTRAL_HEADER || pos + CHDR_SIZE + ze.flength > cdirSize)
     {
       CLog::Log(LOGDEBUG,"ZipManager: broken file %s!",strFile.c_str());
       mFile.Close();
       return false;
     }
+    pos += CHDR_SIZE;
 
     // Get the filename just after the central file header
-    CStdString strName;
-    mFile.Read(strName.GetBuffer(ze.flength), ze.flength);
-    strName.ReleaseBuffer();
+    CStdString strName(&cdir[pos], ze.flength);
     g_charsetConverter.unknownToUTF8(strName);
     ZeroMemory(ze.name, 255);
     strncpy(ze.name, strName.c_str(), strName.size()>254 ? 254 : strName.size());
 
     // Jump after central file header extra field and file comment
-    mFile.Seek(ze.eclength + ze.clength,SEEK_CUR);
+    pos += ze.flength + ze.eclength + ze.clength;
 
     items.push_back(ze);
   }
 
   /* go through list and figure out file header lengths */
-  for(vector<SZipEntry>::iterator it = items.begin(); it != items.end(); ++it)
+  // !! local header extra field length != central file header extra field length !!
+  // they are scattered over the whole file, so fetch them all in one batch
+  vector<SReadRange> ranges(items.size());
+  for (size_t i = 0; i < items.size(); i++)
   {
-    SZipEntry& ze = *it;
-    // Go to the local file header to get the extra field length
-    // !! local header extra field length != central file header extra field length !!
-    mFile.Seek(ze.lhdrOffset+28,SEEK_SET);
-    mFile.Read(&(ze.elength),2);
-    ze.elength = Endian_SwapLE16(ze.elength);
+    ranges[i].offset = (int64_t)items[i].lhdrOffset + 28;
+    ranges[i].buffer = &items[i].elength;
+    ranges[i].size = 2;
+    ranges[i].read = 0;
+  }
+  if (!ranges.empty())
+    mFile.ReadV(&ranges[0], ranges.size());
+
+  for (size_t i = 0; i < items.size(); i++)
+  {
+    SZipEntry& ze = items[i];
+    ze.elength = ranges[i].read == 2 ? Endian_SwapLE16(ze.elength) : 0;
 
     // Compressed data offset = local header offset + size of local header + filename length + local file header extra field length
     ze.offset = ze.lhdrOffset + LHDR_SIZE + ze.flength + ze.elength;
-
   }
 
-  mZipMap.insert(make_pair(strFile,items));
+  // keep the date for update detection
+  SZipArchive& archive = mZipMap[strFile];
+  archive.mtime = m_StatData.st_mtime;
+  archive.items = items;
+  BuildIndex(archive);
+
   mFile.Close();
   return true;
 }
 
+uint32_t CZipManager::HashName(const CStdString& name)
+{
+  Crc32 crc;
+  crc.Compute(name);
+  return crc;
+}
+
+void CZipManager::BuildIndex(SZipArchive& archive)
+{
+  archive.index.clear();
+  archive.index.reserve(archive.items.size());
+  for (unsigned int i = 0; i < archive.items.size(); i++)
+    archive.index.push_back(make_pair(HashName(archive.items[i].name), i));
+  // stable, so the first of duplicate names is found like before
+  stable_sort(archive.index.begin(), archive.index.end());
+}
+
+const SZipEntry* CZipManager::FindEntry(const SZipArchive& archive, const CStdString& name)
+{
+  uint32_t hash = HashName(name);
+  vector<pair<uint32_t, unsigned int> >::const_iterator it = lower_bound(archive.index.begin(), archive.index.end(), make_pair(hash, 0U));
+  for (; it != archive.index.end() && it->first == hash; ++it)
+  {
+    const SZipEntry& entry = archive.items[it->second];
+    if (name == entry.name)
+      return &entry;
+  }
+  return NULL;
+}
+
 bool CZipManager::GetZipEntry(const CStdString& strPath, SZipEntry& item)
 {
   CURL url(strPath);
 
   CStdString strFile = url.GetHostName();
 
-  map<CStdString,vector<SZipEntry> >::iterator it = mZipMap.find(strFile);
-  vector<SZipEntry> items;
+  CSingleLock lock(m_critSection);
+  map<CStdString,SZipArchive>::iterator it = mZipMap.find(strFile);
   if (it == mZipMap.end()) // we need to list the zip
   {
-    GetZipList(strPath,items);
-  }
-  else
-  {
-    items = it->second;
+    vector<SZipEntry> items;
+    if (!GetZipList(strPath,items))
+      return false;
+    it = mZipMap.find(strFile);
+    if (it == mZipMap.end())
+      return false;
   }
 
-  CStdString strFileName = url.GetFileName();
-  for (vector<SZipEntry>::iterator it2=items.begin();it2 != items.end();++it2)
-  {
-    if (CStdString(it2->name) == strFileName)
-    {
-      memcpy(&item,&(*it2),sizeof(SZipEntry));
-      return true;
-    }
-  }
-  return false;
+  const SZipEntry* entry = FindEntry(it->second, url.GetFileName());
+  if (entry == NULL)
+    return false;
+
+  item = *entry;
+  return true;
 }
 
 bool CZipManager::ExtractArchive(const CStdString& strArchive, const CStdString& strPath)
@@ -317,13 +369,8 @@ void CZipManager::readCHeader(const char* buffer, SZipEntry& info)
 void CZipManager::release(const CStdString& strPath)
 {
   CURL url(strPath);
-  map<CStdString,vector<SZipEntry> >::iterator it= mZipMap.find(url.GetHostName());
-  if (it != mZipMap.end())
-  {
-    map<CStdString,int64_t>::iterator it2=mZipDate.find(url.GetHostName());
-    mZipMap.erase(it);
-    mZipDate.erase(it2);
-  }
+  CSingleLock lock(m_critSection);
+  mZipMap.erase(url.GetHostName());
 }
 
 
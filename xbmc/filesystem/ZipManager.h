@@ -30,6 +30,7 @@
 #define ECDREC_SIZE 22
 
 #include  "utils/StdString.h"
+#include "threads/CriticalSection.h"
 
 #include <memory.h>
 #include <vector>
@@ -108,8 +109,20 @@ public:
   static void readHeader(const char* buffer, SZipEntry& info);
   static void readCHeader(const char* buffer, SZipEntry& info);
 private:
-  std::map<CStdString,std::vector<SZipEntry> > mZipMap;
-  std::map<CStdString,int64_t> mZipDate;
+  /*! \brief Listing of an archive, with the entries indexed by the hash of their name */
+  struct SZipArchive
+  {
+    int64_t mtime;
+    std::vector<SZipEntry> items;
+    std::vector<std::pair<uint32_t, unsigned int> > index; ///< name hash and position in items, sorted
+  };
+
+  static uint32_t HashName(const CStdString& name);
+  static void BuildIndex(SZipArchive& archive);
+  static const SZipEntry* FindEntry(const SZipArchive& archive, const CStdString& name);
+
+  std::map<CStdString,SZipArchive> mZipMap;
+  CCriticalSection m_critSection;
 };
 
 extern CZipManager g_ZipManager;
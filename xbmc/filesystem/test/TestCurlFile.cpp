@@ -0,0 +1,361 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+
+#ifdef TARGET_POSIX
+
+// before DllLibCurl.h, which includes the curl headers in a namespace
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <strings.h>
+#include <unistd.h>
+#include <vector>
+
+#include "filesystem/CurlFile.h"
+#include "filesystem/CurlRangeReader.h"
+#include "filesystem/DllLibCurl.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/Thread.h"
+#include "URL.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+using namespace XFILE;
+using namespace XCURL;
+
+static char TestByte(int64_t pos)
+{
+  return (char)(pos % 251);
+}
+
+/* Stand-in for a http server, serving a single generated file of size
+ * bytes. Requests on a connection are answered one after the other. */
+class CTestHttpServer : public CThread
+{
+public:
+  CTestHttpServer(int64_t size, bool ranges)
+    : CThread("TestHttpServer"), m_connections(0), m_requests(0), m_rangeRequests(0),
+      m_size(size), m_ranges(ranges), m_socket(-1), m_port(0)
+  { }
+
+  ~CTestHttpServer()
+  {
+    StopThread(true);
+  }
+
+  bool Start()
+  {
+    m_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_socket < 0)
+      return false;
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if (bind(m_socket, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(m_socket, 16) < 0 ||
+        getsockname(m_socket, (struct sockaddr*)&addr, &len) < 0)
+    {
+      close(m_socket);
+      return false;
+    }
+    m_port = ntohs(addr.sin_port);
+    Create();
+    return true;
+  }
+
+  std::string GetURL() const { return StringUtils::Format("http://127.0.0.1:%d/test.bin", m_port); }
+
+  int m_connections;
+  int m_requests;
+  int m_rangeRequests;
+
+protected:
+  struct Client
+  {
+    int socket;
+    std::string request;
+  };
+
+  virtual void Process()
+  {
+    std::vector<Client> clients;
+    while (!m_bStop)
+    {
+      fd_set fds;
+      FD_ZERO(&fds);
+      FD_SET(m_socket, &fds);
+      int maxfd = m_socket;
+      for (size_t i = 0; i < clients.size(); i++)
+      {
+        FD_SET(clients[i].socket, &fds);
+        maxfd = std::max(maxfd, clients[i].socket);
+      }
+
+      struct timeval timeout = { 0, 100000 };
+      if (select(maxfd + 1, &fds, NULL, NULL, &timeout) <= 0)
+        continue;
+
+      if (FD_ISSET(m_socket, &fds))
+      {
+        Client client;
+        client.socket = accept(m_socket, NULL, NULL);
+        if (client.socket >= 0)
+        {
+          clients.push_back(client);
+          m_connections++;
+        }
+      }
+
+      for (size_t i = 0; i < clients.size(); )
+      {
+        if (FD_ISSET(clients[i].socket, &fds) && !Receive(clients[i]))
+        {
+          close(clients[i].socket);
+          clients.erase(clients.begin() + i);
+        }
+        else
+          i++;
+      }
+    }
+
+    for (size_t i = 0; i < clients.size(); i++)
+      close(clients[i].socket);
+    close(m_socket);
+  }
+
+  bool Receive(Client &client)
+  {
+    char buffer[4096];
+    ssize_t received = recv(client.socket, buffer, sizeof(buffer), 0);
+    if (received <= 0)
+      return false;
+    client.request.append(buffer, received);
+
+    size_t end;
+    while ((end = client.request.find("\r\n\r\n")) != std::string::npos)
+    {
+      std::string request = client.request.substr(0, end + 2);
+      client.request.erase(0, end + 4);
+      if (!Respond(client.socket, request))
+        return false;
+    }
+    return true;
+  }
+
+  bool Respond(int socket, const std::string &request)
+  {
+    m_requests++;
+
+    int64_t begin = 0, last = m_size - 1;
+    bool partial = false;
+    for (size_t pos = request.find("\r\n"); pos != std::string::npos; pos = request.find("\r\n", pos + 2))
+    {
+      const char *line = request.c_str() + pos + 2;
+      long long a = 0, b = -1;
+      if (strncasecmp(line, "Range: bytes=", 13) != 0 || sscanf(line + 13, "%lld-%lld", &a, &b) < 1)
+        continue;
+      m_rangeRequests++;
+      if (m_ranges)
+      {
+        partial = true;
+        begin = a;
+        if (b >= 0 && b < last)
+          last = b;
+      }
+    }
+
+    std::string header;
+    if (partial)
+      header = StringUtils::Format("HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %lld-%lld/%lld\r\n",
+                                   (long long)begin, (long long)last, (long long)m_size);
+    else
+      header = "HTTP/1.1 200 OK\r\n";
+    // advertised even when ignored, like some broken servers do
+    header += StringUtils::Format("Accept-Ranges: bytes\r\nContent-Length: %lld\r\n\r\n", (long long)(last - begin + 1));
+    if (!Send(socket, header.c_str(), header.size()))
+      return false;
+
+    if (request.compare(0, 5, "HEAD ") == 0)
+      return true;
+
+    char buffer[65536];
+    for (int64_t pos = begin; pos <= last; )
+    {
+      size_t amount = (size_t)std::min<int64_t>(sizeof(buffer), last - pos + 1);
+      for (size_t i = 0; i < amount; i++)
+        buffer[i] = TestByte(pos + i);
+      if (!Send(socket, buffer, amount))
+        return false;
+      pos += amount;
+    }
+    return true;
+  }
+
+  bool Send(int socket, const char *data, size_t size)
+  {
+    while (size > 0)
+    {
+      ssize_t sent = send(socket, data, size, MSG_NOSIGNAL);
+      if (sent <= 0)
+        return false;
+      data += sent;
+      size -= sent;
+    }
+    return true;
+  }
+
+  int64_t m_size;
+  bool m_ranges;
+  int m_socket;
+  int m_port;
+};
+
+static bool ReadAndVerify(IFile &file, int64_t from, int64_t size)
+{
+  std::vector<char> buffer(100000);
+  int64_t pos = from;
+  while (pos < size)
+  {
+    unsigned int read = file.Read(&buffer[0], buffer.size());
+    if (read == 0)
+      return false;
+    for (unsigned int i = 0; i < read; i++)
+    {
+      if (buffer[i] != TestByte(pos + i))
+        return false;
+    }
+    pos += read;
+  }
+  return pos == size;
+}
+
+TEST(TestCurlFile, RangeReader)
+{
+  const int64_t size = 1000000;
+  CTestHttpServer server(size, true);
+  ASSERT_TRUE(server.Start());
+
+  CURL_HANDLE* easy = NULL;
+  g_curlInterface.easy_aquire("http", "127.0.0.1", &easy, NULL);
+  ASSERT_TRUE(easy != NULL);
+  g_curlInterface.easy_setopt(easy, CURLOPT_URL, server.GetURL().c_str());
+
+  {
+    CCurlRangeReader reader(easy, size, 4, 65536);
+    ASSERT_TRUE(reader.Start(12345));
+
+    std::vector<char> data;
+    char buffer[30000];
+    int read;
+    while ((read = reader.Read(buffer, sizeof(buffer))) > 0)
+      data.insert(data.end(), buffer, buffer + read);
+    EXPECT_EQ(0, read);
+    ASSERT_EQ(size - 12345, (int64_t)data.size());
+    for (size_t i = 0; i < data.size(); i++)
+      ASSERT_EQ(TestByte(12345 + i), data[i]);
+
+    // backwards, out of the requested chunks
+    EXPECT_TRUE(reader.Seek(100));
+    EXPECT_EQ(100, reader.GetPosition());
+    EXPECT_EQ(10, reader.Read(buffer, 10));
+    for (int i = 0; i < 10; i++)
+      EXPECT_EQ(TestByte(100 + i), buffer[i]);
+  }
+
+  g_curlInterface.easy_release(&easy, NULL);
+  EXPECT_LE(size / 65536, server.m_rangeRequests);
+}
+
+TEST(TestCurlFile, RangeReaderNoRanges)
+{
+  const int64_t size = 500000;
+  CTestHttpServer server(size, false);
+  ASSERT_TRUE(server.Start());
+
+  CURL_HANDLE* easy = NULL;
+  g_curlInterface.easy_aquire("http", "127.0.0.1", &easy, NULL);
+  ASSERT_TRUE(easy != NULL);
+  g_curlInterface.easy_setopt(easy, CURLOPT_URL, server.GetURL().c_str());
+
+  {
+    CCurlRangeReader reader(easy, size, 4, 65536);
+    ASSERT_TRUE(reader.Start(0));
+    char buffer[1000];
+    EXPECT_EQ(-1, reader.Read(buffer, sizeof(buffer)));
+  }
+
+  g_curlInterface.easy_release(&easy, NULL);
+}
+
+TEST(TestCurlFile, ParallelRanges)
+{
+  const int64_t size = 10 * 1024 * 1024 + 1234;
+  CTestHttpServer server(size, true);
+  ASSERT_TRUE(server.Start());
+
+  unsigned int ranges = g_advancedSettings.m_curlParallelRanges;
+  g_advancedSettings.m_curlParallelRanges = 4;
+
+  CCurlFile file;
+  ASSERT_TRUE(file.Open(CURL(server.GetURL())));
+  EXPECT_EQ(size, file.GetLength());
+  EXPECT_TRUE(ReadAndVerify(file, 0, size));
+
+  EXPECT_EQ(size / 2, file.Seek(size / 2, SEEK_SET));
+  EXPECT_EQ(size / 2, file.GetPosition());
+  EXPECT_TRUE(ReadAndVerify(file, size / 2, size));
+  file.Close();
+
+  g_advancedSettings.m_curlParallelRanges = ranges;
+
+  // initial request plus one per chunk
+  EXPECT_LE(11, server.m_rangeRequests);
+  EXPECT_LE(2, server.m_connections);
+}
+
+TEST(TestCurlFile, ParallelRangesIgnored)
+{
+  const int64_t size = 9 * 1024 * 1024;
+  CTestHttpServer server(size, false);
+  ASSERT_TRUE(server.Start());
+
+  unsigned int ranges = g_advancedSettings.m_curlParallelRanges;
+  g_advancedSettings.m_curlParallelRanges = 4;
+
+  // falls back to a single connection, after the first range came back whole
+  CCurlFile file;
+  ASSERT_TRUE(file.Open(CURL(server.GetURL())));
+  EXPECT_TRUE(ReadAndVerify(file, 0, size));
+  file.Close();
+
+  g_advancedSettings.m_curlParallelRanges = ranges;
+}
+
+#endif
@@ -19,6 +19,7 @@
  */
 
 #include "filesystem/Directory.h"
+#include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
 #include "FileItem.h"
 #include "utils/URIUtils.h"
@@ -26,6 +27,23 @@
 
 #include "gtest/gtest.h"
 
+class TestDirectoryCallback : public XFILE::IDirectoryCallback
+{
+public:
+  TestDirectoryCallback(bool cancel) : m_cancel(cancel), m_calls(0) {}
+
+  virtual bool OnDirectoryItems(const CFileItemList &items)
+  {
+    m_calls++;
+    m_items.Append(items);
+    return !m_cancel;
+  }
+
+  bool          m_cancel;
+  int           m_calls;
+  CFileItemList m_items;
+};
+
 TEST(TestDirectory, General)
 {
   CStdString tmppath1, tmppath2, tmppath3;
@@ -52,3 +70,48 @@ TEST(TestDirectory, General)
   EXPECT_TRUE(XFILE::CDirectory::Remove(tmppath1));
   EXPECT_FALSE(XFILE::CDirectory::Exists(tmppath1));
 }
+
+TEST(TestDirectory, Callback)
+{
+  CStdString tmppath;
+  CFileItemList items;
+  XFILE::CFile file;
+  tmppath = CSpecialProtocol::TranslatePath("special://temp/");
+  tmppath = URIUtils::AddFileToFolder(tmppath, "TestDirectoryCallback");
+  EXPECT_TRUE(XFILE::CDirectory::Create(tmppath));
+  for (int i = 0; i < 3; i++)
+  {
+    CStdString name;
+    name.Format("file%d.txt", i);
+    EXPECT_TRUE(file.OpenForWrite(URIUtils::AddFileToFolder(tmppath, name)));
+    file.Close();
+  }
+  EXPECT_TRUE(file.OpenForWrite(URIUtils::AddFileToFolder(tmppath, "file.nfo")));
+  file.Close();
+
+  // the listing is made of the filtered batches
+  TestDirectoryCallback collect(false);
+  XFILE::CDirectory::CHints hints;
+  hints.flags = XFILE::DIR_FLAG_BYPASS_CACHE;
+  hints.mask = ".txt";
+  hints.callback = &collect;
+  EXPECT_TRUE(XFILE::CDirectory::GetDirectory(tmppath, items, hints));
+  EXPECT_EQ(3, items.Size());
+  EXPECT_EQ(3, collect.m_items.Size());
+  EXPECT_LE(1, collect.m_calls);
+
+  TestDirectoryCallback cancel(true);
+  hints.callback = &cancel;
+  items.Clear();
+  EXPECT_FALSE(XFILE::CDirectory::GetDirectory(tmppath, items, hints));
+  EXPECT_EQ(1, cancel.m_calls);
+
+  for (int i = 0; i < 3; i++)
+  {
+    CStdString name;
+    name.Format("file%d.txt", i);
+    EXPECT_TRUE(XFILE::CFile::Delete(URIUtils::AddFileToFolder(tmppath, name)));
+  }
+  EXPECT_TRUE(XFILE::CFile::Delete(URIUtils::AddFileToFolder(tmppath, "file.nfo")));
+  EXPECT_TRUE(XFILE::CDirectory::Remove(tmppath));
+}
@@ -0,0 +1,90 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+#include "filesystem/DirectoryCache.h"
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+static void MakeList(CFileItemList &items, const CStdString &path, int count)
+{
+  items.Clear();
+  items.SetPath(path);
+  for (int i = 0; i < count; i++)
+  {
+    CStdString file;
+    file.Format("%sfile%03i.avi", path.c_str(), i);
+    items.Add(CFileItemPtr(new CFileItem(file, false)));
+  }
+}
+
+TEST(TestDirectoryCache, GetDirectory)
+{
+  CDirectoryCache cache;
+  CFileItemList items;
+  MakeList(items, "smb://host/share/", 10);
+  cache.SetDirectory("smb://host/share/", items, DIR_CACHE_ONCE);
+
+  CFileItemList cached;
+  EXPECT_FALSE(cache.GetDirectory("smb://host/share", cached, false));
+  EXPECT_TRUE(cache.GetDirectory("smb://host/share", cached, true));
+  EXPECT_EQ(10, cached.Size());
+
+  // the caller gets a copy it may change
+  cached[0]->SetPath("smb://host/share/changed.avi");
+  bool inCache;
+  EXPECT_TRUE(cache.FileExists("smb://host/share/file000.avi", inCache));
+  EXPECT_TRUE(inCache);
+  EXPECT_FALSE(cache.FileExists("smb://host/share/changed.avi", inCache));
+
+  cache.AddFile("smb://host/share/new.avi");
+  EXPECT_TRUE(cache.FileExists("smb://host/share/new.avi", inCache));
+  EXPECT_EQ(10, cached.Size());
+}
+
+TEST(TestDirectoryCache, MemoryBudget)
+{
+  CDirectoryCache cache;
+  CFileItemList items;
+  MakeList(items, "smb://host/a/", 100);
+  size_t size = CDirectoryCache::EstimateSize(items);
+  cache.SetMaxMemory(size * 5 / 2);
+
+  cache.SetDirectory("smb://host/a/", items, DIR_CACHE_ALWAYS);
+  MakeList(items, "smb://host/b/", 100);
+  cache.SetDirectory("smb://host/b/", items, DIR_CACHE_ONCE);
+  MakeList(items, "smb://host/c/", 100);
+  cache.SetDirectory("smb://host/c/", items, DIR_CACHE_ONCE);
+  EXPECT_LE(cache.GetMemoryUsage(), size * 5 / 2);
+
+  // b is the least recently used of the folders that aren't always cached
+  bool inCache;
+  cache.FileExists("smb://host/c/file000.avi", inCache);
+  EXPECT_TRUE(inCache);
+  cache.FileExists("smb://host/b/file000.avi", inCache);
+  EXPECT_FALSE(inCache);
+  cache.FileExists("smb://host/a/file000.avi", inCache);
+  EXPECT_TRUE(inCache);
+
+  cache.Clear();
+  EXPECT_EQ(0U, cache.GetMemoryUsage());
+}
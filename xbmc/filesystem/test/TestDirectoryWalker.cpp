@@ -0,0 +1,135 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/DirectoryWalker.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "FileItem.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+class TestDirectoryWalkerCallback : public XFILE::IDirectoryWalkerCallback
+{
+public:
+  virtual XFILE::DIRECTORY_WALK OnDirectory(const CStdString &path, CFileItemList &items)
+  {
+    items.Sort(SORT_METHOD_LABEL, SortOrderAscending);
+    m_paths.push_back(path);
+    m_sizes.push_back(items.Size());
+    return path == m_skip ? XFILE::WALK_SKIP : XFILE::WALK_RECURSE;
+  }
+
+  virtual bool NeedsListing(const CStdString &path)
+  {
+    return path != m_unlisted;
+  }
+
+  std::vector<CStdString> m_paths;
+  std::vector<int>        m_sizes;
+  CStdString              m_skip;
+  CStdString              m_unlisted;
+};
+
+class TestDirectoryWalker : public testing::Test
+{
+protected:
+  TestDirectoryWalker()
+  {
+    m_root = CSpecialProtocol::TranslatePath("special://temp/");
+    m_root = URIUtils::AddFileToFolder(m_root, "TestDirectoryWalker");
+    URIUtils::AddSlashAtEnd(m_root);
+    XFILE::CDirectory::Create(m_root);
+    const char *dirs[] = { "a", "a/a1", "a/a2", "b", "b/b1", "c", "c/c1" };
+    for (unsigned int i = 0; i < sizeof(dirs) / sizeof(dirs[0]); i++)
+    {
+      CStdString dir = Path(dirs[i]);
+      XFILE::CDirectory::Create(dir);
+      m_dirs.push_back(dir);
+    }
+  }
+
+  ~TestDirectoryWalker()
+  {
+    XFILE::CFile::Delete(Path("b") + ".nomedia");
+    for (std::vector<CStdString>::reverse_iterator it = m_dirs.rbegin(); it != m_dirs.rend(); ++it)
+      XFILE::CDirectory::Remove(*it);
+    XFILE::CDirectory::Remove(m_root);
+  }
+
+  CStdString Path(const CStdString &dir)
+  {
+    CStdString path = URIUtils::AddFileToFolder(m_root, dir);
+    URIUtils::AddSlashAtEnd(path);
+    return path;
+  }
+
+  CStdString              m_root;
+  std::vector<CStdString> m_dirs;
+};
+
+TEST_F(TestDirectoryWalker, Order)
+{
+  TestDirectoryWalkerCallback callback;
+  XFILE::CDirectoryWalker walker("", XFILE::DIR_FLAG_BYPASS_CACHE);
+  EXPECT_TRUE(walker.Walk(m_root, callback));
+  ASSERT_EQ(8U, callback.m_paths.size());
+  EXPECT_STREQ(m_root.c_str(), callback.m_paths[0].c_str());
+  EXPECT_STREQ(Path("a").c_str(), callback.m_paths[1].c_str());
+  EXPECT_STREQ(Path("a/a1").c_str(), callback.m_paths[2].c_str());
+  EXPECT_STREQ(Path("a/a2").c_str(), callback.m_paths[3].c_str());
+  EXPECT_STREQ(Path("b").c_str(), callback.m_paths[4].c_str());
+  EXPECT_STREQ(Path("b/b1").c_str(), callback.m_paths[5].c_str());
+  EXPECT_STREQ(Path("c").c_str(), callback.m_paths[6].c_str());
+  EXPECT_STREQ(Path("c/c1").c_str(), callback.m_paths[7].c_str());
+}
+
+TEST_F(TestDirectoryWalker, Skip)
+{
+  XFILE::CFile file;
+  EXPECT_TRUE(file.OpenForWrite(Path("b") + ".nomedia"));
+  file.Close();
+
+  TestDirectoryWalkerCallback callback;
+  callback.m_skip = Path("a");
+  CStdStringArray excludes;
+  excludes.push_back("/c1/");
+  XFILE::CDirectoryWalker walker("", XFILE::DIR_FLAG_BYPASS_CACHE);
+  walker.SetExcludes(excludes);
+  EXPECT_TRUE(walker.Walk(m_root, callback));
+  ASSERT_EQ(3U, callback.m_paths.size());
+  EXPECT_STREQ(m_root.c_str(), callback.m_paths[0].c_str());
+  EXPECT_STREQ(Path("a").c_str(), callback.m_paths[1].c_str());
+  EXPECT_STREQ(Path("c").c_str(), callback.m_paths[2].c_str());
+}
+
+TEST_F(TestDirectoryWalker, NeedsListing)
+{
+  TestDirectoryWalkerCallback callback;
+  callback.m_unlisted = Path("a");
+  XFILE::CDirectoryWalker walker("", XFILE::DIR_FLAG_BYPASS_CACHE);
+  EXPECT_TRUE(walker.Walk(m_root, callback));
+  ASSERT_EQ(6U, callback.m_paths.size());
+  EXPECT_STREQ(Path("a").c_str(), callback.m_paths[1].c_str());
+  EXPECT_EQ(0, callback.m_sizes[1]);
+  EXPECT_STREQ(Path("b").c_str(), callback.m_paths[2].c_str());
+  EXPECT_EQ(1, callback.m_sizes[2]);
+}
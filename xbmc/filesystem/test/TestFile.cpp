@@ -96,6 +96,73 @@ TEST(TestFile, Read)
   file.Close();
 }
 
+TEST(TestFile, ReadV)
+{
+  XFILE::CFile file;
+  ASSERT_TRUE(file.Open(
+    XBMC_REF_FILE_PATH("/xbmc/filesystem/test/reffile.txt")));
+  int64_t length = file.GetLength();
+
+  char expected[3][20];
+  const int64_t offsets[3] = { 500, 10, length - 5 };
+  for (int i = 0; i < 3; i++)
+  {
+    EXPECT_EQ(offsets[i], file.Seek(offsets[i]));
+    file.Read(expected[i], sizeof(expected[i]));
+  }
+
+  // out of order, the last one is cut short by the end of the file
+  char buf[3][20];
+  XFILE::SReadRange ranges[3];
+  for (int i = 0; i < 3; i++)
+  {
+    ranges[i].offset = offsets[i];
+    ranges[i].buffer = buf[i];
+    ranges[i].size = sizeof(buf[i]);
+    ranges[i].read = 0;
+  }
+  EXPECT_EQ(45, file.ReadV(ranges, 3));
+  EXPECT_EQ(20U, ranges[0].read);
+  EXPECT_EQ(20U, ranges[1].read);
+  EXPECT_EQ(5U, ranges[2].read);
+  EXPECT_TRUE(memcmp(expected[0], buf[0], 20) == 0);
+  EXPECT_TRUE(memcmp(expected[1], buf[1], 20) == 0);
+  EXPECT_TRUE(memcmp(expected[2], buf[2], 5) == 0);
+  file.Close();
+}
+
+class TestFileReadCallback : public XFILE::IFileReadCallback
+{
+public:
+  TestFileReadCallback() : result(-2) {}
+  virtual void OnReadComplete(XFILE::CFile* file, XFILE::SReadRange* ranges, unsigned int count, int64_t result)
+  {
+    this->result = result;
+  }
+  int64_t result;
+};
+
+TEST(TestFile, ReadAsync)
+{
+  XFILE::CFile file;
+  ASSERT_TRUE(file.Open(
+    XBMC_REF_FILE_PATH("/xbmc/filesystem/test/reffile.txt")));
+
+  char expected[10];
+  file.Read(expected, sizeof(expected));
+
+  char buf[10];
+  XFILE::SReadRange range = { 0, buf, sizeof(buf), 0 };
+  TestFileReadCallback callback;
+  ASSERT_TRUE(file.ReadAsync(&range, 1, &callback));
+  file.WaitForRead();
+  EXPECT_FALSE(file.IsReadPending());
+  EXPECT_EQ(10, callback.result);
+  EXPECT_EQ(10U, range.read);
+  EXPECT_TRUE(memcmp(expected, buf, sizeof(buf)) == 0);
+  file.Close();
+}
+
 TEST(TestFile, Write)
 {
   XFILE::CFile *file;
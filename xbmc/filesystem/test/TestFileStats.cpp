@@ -0,0 +1,100 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/File.h"
+#include "filesystem/FileStats.h"
+#include "utils/TimeUtils.h"
+#include "test/TestUtils.h"
+#include "URL.h"
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+TEST(TestFileStats, Percentile)
+{
+  uint64_t latency[FILESTATS_BUCKETS] = { 0 };
+  EXPECT_EQ(0U, CFileStats::GetPercentile(latency, 0.5f));
+
+  latency[0] = 90;
+  latency[3] = 9;
+  latency[FILESTATS_BUCKETS - 1] = 1;
+  EXPECT_EQ(64U, CFileStats::GetPercentile(latency, 0.5f));
+  EXPECT_EQ(CFileStats::GetBucketLimit(3), CFileStats::GetPercentile(latency, 0.99f));
+  EXPECT_EQ(CFileStats::GetBucketLimit(FILESTATS_BUCKETS - 2), CFileStats::GetPercentile(latency, 1.0f));
+  EXPECT_EQ(0U, CFileStats::GetBucketLimit(FILESTATS_BUCKETS - 1));
+}
+
+TEST(TestFileStats, RecordAndReset)
+{
+  int slot = CFileStats::GetSlot("teststats");
+  ASSERT_LE(0, slot);
+  EXPECT_EQ(slot, CFileStats::GetSlot("teststats"));
+  CFileStats::Reset();
+
+  CFileStats::Record(slot, FILESTATS_READ, CurrentHostCounter(), true, 100);
+  CFileStats::Record(slot, FILESTATS_READ, CurrentHostCounter(), false);
+  CFileStats::Record(slot, FILESTATS_SEEK, CurrentHostCounter(), true);
+
+  std::map<std::string, SFileStatsCounters> counters;
+  CFileStats::GetCounters(counters);
+  const SFileStatsCounters &stats = counters["teststats"];
+  EXPECT_EQ(2U, stats.calls[FILESTATS_READ]);
+  EXPECT_EQ(1U, stats.failures[FILESTATS_READ]);
+  EXPECT_EQ(1U, stats.calls[FILESTATS_SEEK]);
+  EXPECT_EQ(0U, stats.calls[FILESTATS_OPEN]);
+  EXPECT_EQ(100U, stats.bytesRead);
+
+  uint64_t total = 0;
+  for (unsigned int bucket = 0; bucket < FILESTATS_BUCKETS; bucket++)
+    total += stats.latency[FILESTATS_READ][bucket];
+  EXPECT_EQ(2U, total);
+
+  CFileStats::Reset();
+  counters.clear();
+  CFileStats::GetCounters(counters);
+  EXPECT_EQ(0U, counters["teststats"].calls[FILESTATS_READ]);
+  EXPECT_EQ(0U, counters["teststats"].bytesRead);
+}
+
+TEST(TestFileStats, File)
+{
+  std::string path = XBMC_REF_FILE_PATH("/xbmc/filesystem/test/reffile.txt");
+  std::string protocol = CURL(path).GetProtocol().c_str();
+  if (protocol.empty())
+    protocol = "file";
+  CFileStats::Reset();
+
+  XFILE::CFile file;
+  char buf[16];
+  ASSERT_TRUE(file.Open(path));
+  EXPECT_EQ(sizeof(buf), file.Read(buf, sizeof(buf)));
+  EXPECT_EQ(0, file.Seek(0, SEEK_SET));
+  file.Close();
+
+  std::map<std::string, SFileStatsCounters> counters;
+  CFileStats::GetCounters(counters);
+  const SFileStatsCounters &stats = counters[protocol];
+  EXPECT_EQ(1U, stats.calls[FILESTATS_OPEN]);
+  EXPECT_EQ(1U, stats.calls[FILESTATS_READ]);
+  EXPECT_EQ(1U, stats.calls[FILESTATS_SEEK]);
+  EXPECT_EQ(0U, stats.failures[FILESTATS_READ]);
+  EXPECT_EQ(sizeof(buf), stats.bytesRead);
+}
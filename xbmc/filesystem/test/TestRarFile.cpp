@@ -637,4 +637,32 @@ TEST(TestRarFile, NormalRAR)
   EXPECT_EQ(-1, file.Seek(-100, SEEK_SET));
   file.Close();
 }
+
+TEST(TestRarFile, NormalRARBackwardSeek)
+{
+  XFILE::CFile file, reference;
+  char buf[100], refbuf[100];
+  CStdString reffile, strrarpath;
+
+  ASSERT_TRUE(reference.Open(XBMC_REF_FILE_PATH("xbmc/filesystem/test/reffile.txt")));
+
+  /* compressed entries are decoded on the fly, so seeking back has to be
+   * served from the decoded window or by decoding from the start again */
+  reffile = XBMC_REF_FILE_PATH("xbmc/filesystem/test/refRARnormal.rar");
+  URIUtils::CreateArchivePath(strrarpath, "rar", reffile, "reffile.txt");
+  ASSERT_TRUE(file.Open(strrarpath));
+  ASSERT_EQ(reference.GetLength(), file.GetLength());
+
+  int64_t positions[] = { 1500, 700, 0, 1200, 50, 1515 };
+  for (unsigned int i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+  {
+    EXPECT_EQ(positions[i], file.Seek(positions[i], SEEK_SET));
+    EXPECT_EQ(positions[i], reference.Seek(positions[i], SEEK_SET));
+    EXPECT_EQ(sizeof(buf), file.Read(buf, sizeof(buf)));
+    EXPECT_EQ(sizeof(refbuf), reference.Read(refbuf, sizeof(refbuf)));
+    EXPECT_TRUE(!memcmp(refbuf, buf, sizeof(buf)));
+  }
+  file.Close();
+  reference.Close();
+}
 #endif /*HAS_FILESYSTEM_RAR*/
@@ -0,0 +1,213 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/Directory.h"
+#include "filesystem/SegmentCache.h"
+#include "filesystem/SpecialProtocol.h"
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+#define SEGMENT_SIZE 16
+
+class TestSegmentCache : public testing::Test
+{
+protected:
+  TestSegmentCache()
+  {
+    path = CSpecialProtocol::TranslatePath("special://temp/segmentcachetest/");
+    for (int i = 0; i < 100; i++)
+      data[i] = (char)i;
+  }
+
+  ~TestSegmentCache()
+  {
+    CSegmentStore store(path, 1024, SEGMENT_SIZE);
+    store.Remove(CSegmentStore::MakeKey("http://host/file", 100, 1));
+    store.Remove(CSegmentStore::MakeKey("key", 0, 0));
+    CDirectory::Remove(path);
+  }
+
+  void Write(CSegmentCache &cache, int64_t from, int64_t to)
+  {
+    while (from < to)
+    {
+      int written = cache.WriteToCache(data + from, (size_t)(to - from));
+      ASSERT_GT(written, 0);
+      from += written;
+    }
+  }
+
+  std::string Read(CSegmentCache &cache, size_t size)
+  {
+    std::string result;
+    char buffer[100];
+    while (result.size() < size)
+    {
+      int read = cache.ReadFromCache(buffer, size - result.size());
+      if (read <= 0)
+        break;
+      result.append(buffer, read);
+    }
+    return result;
+  }
+
+  std::string path;
+  char data[100];
+};
+
+TEST_F(TestSegmentCache, StoreEviction)
+{
+  std::string key = CSegmentStore::MakeKey("key", 0, 0);
+  CSegmentStore store(path, 3 * SEGMENT_SIZE, SEGMENT_SIZE);
+  EXPECT_TRUE(store.Add(key, 0, data, SEGMENT_SIZE));
+  EXPECT_TRUE(store.Add(key, 1, data + 16, SEGMENT_SIZE));
+  EXPECT_TRUE(store.Add(key, 2, data + 32, 4));
+  EXPECT_EQ(36U, store.GetUsage());
+
+  size_t size;
+  EXPECT_TRUE(store.Has(key, 2, &size));
+  EXPECT_EQ(4U, size);
+
+  CSegmentView *view = store.Map(key, 1);
+  ASSERT_TRUE(view != NULL);
+  EXPECT_EQ((size_t)SEGMENT_SIZE, view->GetSize());
+  EXPECT_EQ(0, memcmp(data + 16, view->GetData(), SEGMENT_SIZE));
+  delete view;
+
+  // 0 is the least recently used, 2 is pinned
+  unsigned int pin = store.Pin(key, 2, 2);
+  EXPECT_TRUE(store.Add(key, 3, data + 48, SEGMENT_SIZE));
+  EXPECT_FALSE(store.Has(key, 0));
+  EXPECT_TRUE(store.Has(key, 1));
+  EXPECT_TRUE(store.Has(key, 2));
+  store.Unpin(pin);
+
+  // only as much as needed is evicted
+  EXPECT_TRUE(store.Add(key, 4, data + 64, SEGMENT_SIZE));
+  EXPECT_FALSE(store.Has(key, 2));
+  EXPECT_TRUE(store.Has(key, 1));
+  EXPECT_EQ(3U * SEGMENT_SIZE, store.GetUsage());
+}
+
+TEST_F(TestSegmentCache, StorePersists)
+{
+  std::string key = CSegmentStore::MakeKey("key", 0, 0);
+  {
+    CSegmentStore store(path, 1024, SEGMENT_SIZE);
+    EXPECT_TRUE(store.Add(key, 7, data, 10));
+  }
+
+  CSegmentStore store(path, 1024, SEGMENT_SIZE);
+  size_t size;
+  EXPECT_TRUE(store.Has(key, 7, &size));
+  EXPECT_EQ(10U, size);
+  EXPECT_EQ(10U, store.GetUsage());
+}
+
+TEST_F(TestSegmentCache, ReadAcrossOpens)
+{
+  CSegmentStore store(path, 1024, SEGMENT_SIZE);
+  {
+    CSegmentCache cache(store);
+    ASSERT_EQ(CACHE_RC_OK, cache.Open());
+    cache.SetSource("http://host/file", 100, 1);
+    Write(cache, 0, 100);
+    cache.EndOfInput();
+    EXPECT_EQ(std::string(data, 100), Read(cache, 100));
+    cache.Close();
+  }
+
+  CSegmentCache cache(store);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  cache.SetSource("http://host/file", 100, 1);
+  EXPECT_EQ(100, cache.CachedDataEndPosIfSeekTo(0));
+  cache.Reset(0, false);
+  EXPECT_EQ(100, cache.CachedDataEndPos());
+  EXPECT_EQ(50, cache.Seek(50));
+  EXPECT_EQ(std::string(data + 50, 50), Read(cache, 100));
+
+  // a different modification time is a different file
+  CSegmentCache changed(store);
+  ASSERT_EQ(CACHE_RC_OK, changed.Open());
+  changed.SetSource("http://host/file", 100, 2);
+  EXPECT_EQ(0, changed.CachedDataEndPosIfSeekTo(0));
+}
+
+TEST_F(TestSegmentCache, SeekToUncachedData)
+{
+  CSegmentStore store(path, 1024, SEGMENT_SIZE);
+  CSegmentCache cache(store);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  cache.SetSource("http://host/file", 100, 1);
+  Write(cache, 0, 40);
+
+  // whole segments are fetched, continue at the start of the segment
+  char buffer[1];
+  EXPECT_EQ(64, cache.CachedDataEndPosIfSeekTo(70));
+  cache.Reset(70, false);
+  EXPECT_EQ(64, cache.CachedDataEndPos());
+  EXPECT_EQ(CACHE_RC_WOULD_BLOCK, cache.ReadFromCache(buffer, 1));
+  Write(cache, 64, 100);
+  cache.EndOfInput();
+  EXPECT_EQ(std::string(data + 70, 30), Read(cache, 100));
+
+  // the first two segments were complete, they connect to nothing but are kept
+  EXPECT_EQ(32, cache.CachedDataEndPosIfSeekTo(0));
+  cache.Reset(0, false);
+  EXPECT_EQ(32, cache.CachedDataEndPos());
+  EXPECT_EQ(std::string(data, 32), Read(cache, 32));
+}
+
+TEST_F(TestSegmentCache, TransientWithoutLength)
+{
+  CSegmentStore store(path, 1024, SEGMENT_SIZE);
+  CSegmentCache cache(store);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  cache.SetSource("http://host/stream", 0, 0);
+  Write(cache, 0, 40);
+  EXPECT_EQ(std::string(data, 40), Read(cache, 40));
+  EXPECT_EQ(32U, store.GetUsage());
+
+  cache.Close();
+  EXPECT_EQ(0U, store.GetUsage());
+}
+
+TEST_F(TestSegmentCache, TransientWithoutModificationTime)
+{
+  CSegmentStore store(path, 1024, SEGMENT_SIZE);
+  {
+    CSegmentCache cache(store);
+    ASSERT_EQ(CACHE_RC_OK, cache.Open());
+    cache.SetSource("http://host/file", 100, 0);
+    Write(cache, 0, 100);
+    cache.EndOfInput();
+    cache.Close();
+  }
+  EXPECT_EQ(0U, store.GetUsage());
+
+  CSegmentCache cache(store);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  cache.SetSource("http://host/file", 100, 0);
+  EXPECT_EQ(0, cache.CachedDataEndPosIfSeekTo(0));
+}
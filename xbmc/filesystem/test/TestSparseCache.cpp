@@ -0,0 +1,168 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/SparseCache.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+// must match SPARSE_CACHE_BLOCK_SIZE
+#define BLOCK (64 * 1024)
+
+class TestSparseCache : public testing::Test
+{
+protected:
+  TestSparseCache()
+  {
+    data.resize(16 * BLOCK);
+    for (size_t i = 0; i < data.size(); i++)
+      data[i] = (char)(i * 7 + i / 251);
+  }
+
+  /* writes [from, to), returns where the writer stopped */
+  int64_t Write(CSparseCache &cache, int64_t from, int64_t to)
+  {
+    while (from < to)
+    {
+      int written = cache.WriteToCache(&data[from], (size_t)(to - from));
+      if (written <= 0)
+        break;
+      from += written;
+    }
+    return from;
+  }
+
+  std::string Read(CSparseCache &cache, size_t size)
+  {
+    std::string result;
+    std::string buffer(size, 0);
+    while (result.size() < size)
+    {
+      int read = cache.ReadFromCache(&buffer[0], size - result.size());
+      if (read <= 0)
+        break;
+      result.append(buffer, 0, read);
+    }
+    return result;
+  }
+
+  std::string data;
+};
+
+TEST_F(TestSparseCache, Sequential)
+{
+  CSparseCache cache(3 * BLOCK, BLOCK);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  EXPECT_EQ(BLOCK + 100, Write(cache, 0, BLOCK + 100));
+  EXPECT_EQ(BLOCK + 100, cache.WaitForData(0, 0));
+  EXPECT_EQ(data.substr(0, BLOCK + 100), Read(cache, 2 * BLOCK));
+
+  char buffer[1];
+  EXPECT_EQ(CACHE_RC_WOULD_BLOCK, cache.ReadFromCache(buffer, 1));
+  cache.EndOfInput();
+  EXPECT_EQ(0, cache.ReadFromCache(buffer, 1));
+}
+
+TEST_F(TestSparseCache, FrontLimit)
+{
+  CSparseCache cache(3 * BLOCK, BLOCK);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // no more than front ahead of the reader
+  EXPECT_EQ(3 * BLOCK, Write(cache, 0, 4 * BLOCK));
+  EXPECT_EQ(0, cache.WriteToCache(&data[3 * BLOCK], 1));
+
+  EXPECT_EQ(data.substr(0, 10), Read(cache, 10));
+  EXPECT_EQ(3 * BLOCK + 10, Write(cache, 3 * BLOCK, 4 * BLOCK));
+}
+
+TEST_F(TestSparseCache, KeepsSeveralRanges)
+{
+  CSparseCache cache(6 * BLOCK, 2 * BLOCK);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // e.g. a demuxer probing the index at the end of the file
+  cache.Reset(10 * BLOCK, false);
+  EXPECT_EQ(10 * BLOCK + 500, Write(cache, 10 * BLOCK, 10 * BLOCK + 500));
+  EXPECT_EQ(data.substr(10 * BLOCK, 500), Read(cache, 500));
+
+  // and jumping back to the start
+  EXPECT_FALSE(cache.IsCachedPosition(0));
+  EXPECT_EQ(0, cache.CachedDataEndPosIfSeekTo(0));
+  cache.Reset(0, false);
+  EXPECT_EQ(2 * BLOCK, Write(cache, 0, 2 * BLOCK));
+
+  // both ranges are available and report their own end
+  EXPECT_TRUE(cache.IsCachedPosition(BLOCK));
+  EXPECT_TRUE(cache.IsCachedPosition(10 * BLOCK + 100));
+  EXPECT_FALSE(cache.IsCachedPosition(5 * BLOCK));
+  EXPECT_EQ(2 * BLOCK, cache.CachedDataEndPosIfSeekTo(BLOCK));
+  EXPECT_EQ(10 * BLOCK + 500, cache.CachedDataEndPosIfSeekTo(10 * BLOCK + 100));
+  EXPECT_EQ(2 * BLOCK, cache.CachedDataEndPos());
+
+  EXPECT_EQ(10 * BLOCK + 100, cache.Seek(10 * BLOCK + 100));
+  EXPECT_EQ(data.substr(10 * BLOCK + 100, 400), Read(cache, 400));
+  EXPECT_EQ(100, cache.Seek(100));
+  EXPECT_EQ(data.substr(100, 1000), Read(cache, 1000));
+
+  // the writer continues the range of the reader
+  cache.Reset(10 * BLOCK + 100, false);
+  EXPECT_EQ(10 * BLOCK + 500, cache.CachedDataEndPos());
+  EXPECT_EQ(10 * BLOCK + 1000, Write(cache, 10 * BLOCK + 500, 10 * BLOCK + 1000));
+  EXPECT_EQ(data.substr(10 * BLOCK + 100, 900), Read(cache, 900));
+
+  cache.Reset(0, true);
+  EXPECT_FALSE(cache.IsCachedPosition(10 * BLOCK + 100));
+  EXPECT_FALSE(cache.IsCachedPosition(100));
+}
+
+TEST_F(TestSparseCache, EvictsFurthestBlock)
+{
+  CSparseCache cache(3 * BLOCK, BLOCK);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // two blocks at the end, two at the start
+  cache.Reset(14 * BLOCK, false);
+  EXPECT_EQ(16 * BLOCK, Write(cache, 14 * BLOCK, 16 * BLOCK));
+  cache.Reset(0, false);
+  EXPECT_EQ(2 * BLOCK, Write(cache, 0, 2 * BLOCK));
+
+  // the cache is full, the last block is furthest from the reader at 0
+  EXPECT_EQ(3 * BLOCK, Write(cache, 2 * BLOCK, 3 * BLOCK));
+  EXPECT_TRUE(cache.IsCachedPosition(14 * BLOCK));
+  EXPECT_FALSE(cache.IsCachedPosition(15 * BLOCK));
+
+  // the front limit stops the writer before the rest of the end is evicted
+  EXPECT_EQ(3 * BLOCK, Write(cache, 3 * BLOCK, 4 * BLOCK));
+  EXPECT_TRUE(cache.IsCachedPosition(14 * BLOCK));
+
+  // once the reader moved on the history goes first
+  EXPECT_EQ(data.substr(0, 2 * BLOCK + 10), Read(cache, 2 * BLOCK + 10));
+  EXPECT_EQ(4 * BLOCK, Write(cache, 3 * BLOCK, 4 * BLOCK));
+  EXPECT_FALSE(cache.IsCachedPosition(14 * BLOCK));
+  EXPECT_EQ(5 * BLOCK, Write(cache, 4 * BLOCK, 5 * BLOCK));
+  EXPECT_FALSE(cache.IsCachedPosition(0));
+  EXPECT_TRUE(cache.IsCachedPosition(BLOCK));
+  EXPECT_EQ(data.substr(2 * BLOCK + 10, 2 * BLOCK), Read(cache, 2 * BLOCK));
+}
@@ -26,9 +26,98 @@
 #include "test/TestUtils.h"
 
 #include <errno.h>
+#include <zlib.h>
 
 #include "gtest/gtest.h"
 
+static void AppendLE(std::string &out, unsigned int value, int bytes)
+{
+  for (int i = 0; i < bytes; i++)
+    out += (char)((value >> (8 * i)) & 0xFF);
+}
+
+static char TestByte(unsigned int pos)
+{
+  // 16 letters without a pattern, compresses to about half
+  unsigned int x = pos * 2654435761U;
+  x ^= x >> 15;
+  x *= 2246822519U;
+  x ^= x >> 13;
+  return (char)('a' + (x >> 28));
+}
+
+/* writes a zip holding a single deflated entry of size bytes */
+static bool CreateDeflatedZip(XFILE::CFile *file, const std::string &name, unsigned int size)
+{
+  std::string data;
+  for (unsigned int i = 0; i < size; i++)
+    data += TestByte(i);
+
+  z_stream stream = {};
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+  std::string compressed(deflateBound(&stream, size), '\0');
+  stream.next_in = (Bytef*)data.data();
+  stream.avail_in = size;
+  stream.next_out = (Bytef*)&compressed[0];
+  stream.avail_out = compressed.size();
+  int ret = deflate(&stream, Z_FINISH);
+  compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+  if (ret != Z_STREAM_END)
+    return false;
+
+  unsigned int crc = crc32(0, (const Bytef*)data.data(), size);
+
+  std::string zip;
+  AppendLE(zip, 0x04034b50, 4); // local header
+  AppendLE(zip, 20, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 8, 2);
+  AppendLE(zip, 0, 4);
+  AppendLE(zip, crc, 4);
+  AppendLE(zip, compressed.size(), 4);
+  AppendLE(zip, size, 4);
+  AppendLE(zip, name.size(), 2);
+  AppendLE(zip, 0, 2);
+  zip += name;
+  zip += compressed;
+
+  unsigned int cdirOffset = zip.size();
+  AppendLE(zip, 0x02014b50, 4); // central header
+  AppendLE(zip, 20, 2);
+  AppendLE(zip, 20, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 8, 2);
+  AppendLE(zip, 0, 4);
+  AppendLE(zip, crc, 4);
+  AppendLE(zip, compressed.size(), 4);
+  AppendLE(zip, size, 4);
+  AppendLE(zip, name.size(), 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 0, 4);
+  AppendLE(zip, 0, 4);
+  zip += name;
+
+  unsigned int cdirSize = zip.size() - cdirOffset;
+  AppendLE(zip, 0x06054b50, 4); // end of central directory
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 0, 2);
+  AppendLE(zip, 1, 2);
+  AppendLE(zip, 1, 2);
+  AppendLE(zip, cdirSize, 4);
+  AppendLE(zip, cdirOffset, 4);
+  AppendLE(zip, 0, 2);
+
+  if (file->Write(zip.data(), zip.size()) != (int)zip.size())
+    return false;
+  file->Flush();
+  return true;
+}
+
 class TestZipFile : public testing::Test
 {
 protected:
@@ -212,3 +301,48 @@ TEST_F(TestZipFile, CorruptedFile)
   file->Close();
   XBMC_DELETETEMPFILE(file);
 }
+
+TEST_F(TestZipFile, SeekDeflated)
+{
+  // large enough for several inflate checkpoints
+  const unsigned int size = 5 * 1024 * 1024 + 123;
+  XFILE::CFile *tmpfile = XBMC_CREATETEMPFILE(".zip");
+  ASSERT_TRUE(tmpfile != NULL);
+  ASSERT_TRUE(CreateDeflatedZip(tmpfile, "data.bin", size));
+
+  CStdString strzippath;
+  URIUtils::CreateArchivePath(strzippath, "zip", XBMC_TEMPFILEPATH(tmpfile), "data.bin");
+
+  XFILE::CFile file;
+  ASSERT_TRUE(file.Open(strzippath));
+  EXPECT_EQ(size, file.GetLength());
+
+  // read through once, which records the checkpoints
+  char buf[65536];
+  unsigned int pos = 0, read;
+  bool same = true;
+  while ((read = file.Read(buf, sizeof(buf))) > 0)
+  {
+    for (unsigned int i = 0; i < read && same; i++)
+      same = buf[i] == TestByte(pos + i);
+    pos += read;
+  }
+  EXPECT_TRUE(same);
+  EXPECT_EQ(size, pos);
+
+  const int64_t offsets[] = { 100, 4 * 1024 * 1024 + 7, 1024 * 1024, 1024 * 1024 - 1, size - 10, 0, 3 * 1024 * 1024 + 4321 };
+  for (unsigned int i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++)
+  {
+    ASSERT_EQ(offsets[i], file.Seek(offsets[i], SEEK_SET));
+    ASSERT_EQ(10U, file.Read(buf, 10));
+    for (int j = 0; j < 10; j++)
+      EXPECT_EQ(TestByte(offsets[i] + j), buf[j]) << "at " << offsets[i] + j;
+  }
+
+  EXPECT_EQ(size - 5, file.Seek(-5, SEEK_END));
+  EXPECT_EQ(5U, file.Read(buf, sizeof(buf)));
+  EXPECT_EQ(TestByte(size - 1), buf[4]);
+
+  file.Close();
+  XBMC_DELETETEMPFILE(tmpfile);
+}
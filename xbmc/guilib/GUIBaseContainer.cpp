@@ -399,6 +399,14 @@ bool CGUIBaseContainer::OnMessage(CGUIMessage& message)
         SelectItem(message.GetParam1());
         return true;
       }
+      else if (message.GetMessage() == GUI_MSG_LABEL_APPEND && message.GetPointer())
+      { // add to our items, keeping the layouts and selection of those we have
+        CFileItemList *items = (CFileItemList *)message.GetPointer();
+        for (int i = 0; i < items->Size(); i++)
+          m_items.push_back(items->Get(i));
+        UpdateLayout(false);
+        return true;
+      }
       else if (message.GetMessage() == GUI_MSG_LABEL_RESET)
       {
         Reset();
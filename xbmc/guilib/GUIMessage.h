@@ -133,6 +133,11 @@
 
 #define GUI_MSG_WINDOW_LOAD 43
 
+/*!
+ \brief Append the items of the CFileItemList pointer to those a list control is bound to
+ */
+#define GUI_MSG_LABEL_APPEND 44
+
 #define GUI_MSG_USER         1000
 
 /*!
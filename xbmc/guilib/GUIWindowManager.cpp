@@ -32,6 +32,7 @@
 #include "addons/Skin.h"
 #include "GUITexture.h"
 #include "windowing/WindowingFactory.h"
+#include "utils/Trace.h"
 #include "utils/Variant.h"
 #include "Key.h"
 
@@ -494,6 +495,7 @@ bool RenderOrderSortFunction(CGUIWindow *first, CGUIWindow *second)
 
 void CGUIWindowManager::Process(unsigned int currentTime)
 {
+  TRACE_FUNCTION("gui");
   assert(g_application.IsCurrentThread());
   CSingleLock lock(g_graphicsContext);
 
@@ -547,6 +549,7 @@ void CGUIWindowManager::RenderPass()
 
 bool CGUIWindowManager::Render()
 {
+  TRACE_FUNCTION("gui");
   assert(g_application.IsCurrentThread());
   CSingleLock lock(g_graphicsContext);
 
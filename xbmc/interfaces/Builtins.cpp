@@ -56,6 +56,7 @@
 #include "settings/MediaSourceSettings.h"
 #include "settings/SkinSettings.h"
 #include "utils/StringUtils.h"
+#include "utils/Trace.h"
 #include "utils/URIUtils.h"
 #include "Util.h"
 #include "URL.h"
@@ -218,6 +219,7 @@ const BUILT_IN commands[] = {
 #endif
   { "VideoLibrary.Search",        false,  "Brings up a search dialog which will search the library" },
   { "ToggleDebug",                false,  "Enables/disables debug mode" },
+  { "Trace",                      true,   "Starts (start), stops (stop) or writes (dump, optional temp or log folder) a timeline trace" },
   { "StartPVRManager",            false,  "(Re)Starts the PVR manager" },
   { "StopPVRManager",             false,  "Stops the PVR manager" },
 #if defined(TARGET_ANDROID)
@@ -1651,6 +1653,26 @@ int CBuiltins::Execute(const CStdString& execString)
     CSettings::Get().SetBool("debug.showloginfo", !debug);
     g_advancedSettings.SetDebugMode(!debug);
   }
+  else if (execute.Equals("trace"))
+  {
+    if (params.size() < 1)
+    {
+      CLog::Log(LOGERROR, "Trace called with no parameter");
+      return -2;
+    }
+    if (params[0].Equals("start"))
+      CTrace::Start();
+    else if (params[0].Equals("stop"))
+      CTrace::Stop();
+    else if (params[0].Equals("dump"))
+    {
+      std::string file;
+      if (CTrace::Dump(file, params.size() > 1 && params[1].Equals("log")))
+        CLog::Log(LOGNOTICE, "Trace written to %s", file.c_str());
+    }
+    else
+      CLog::Log(LOGERROR, "Trace called with unknown parameter %s", params[0].c_str());
+  }
   else if (execute.Equals("startpvrmanager"))
   {
     g_application.StartPVRManager();
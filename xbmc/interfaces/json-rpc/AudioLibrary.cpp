@@ -20,6 +20,7 @@
 
 #include "AudioLibrary.h"
 #include "music/MusicDatabase.h"
+#include "music/MusicDbUrl.h"
 #include "FileItem.h"
 #include "Util.h"
 #include "utils/StringUtils.h"
@@ -390,6 +391,57 @@ JSONRPC_STATUS CAudioLibrary::GetGenres(const CStdString &method, ITransportLaye
   return OK;
 }
 
+JSONRPC_STATUS CAudioLibrary::Search(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  CMusicDatabase musicdatabase;
+  if (!musicdatabase.Open())
+    return InternalError;
+
+  // without sorting the best matches come first and the limits apply to each kind of item
+  SortDescription sorting;
+  ParseLimits(parameterObject, sorting.limitStart, sorting.limitEnd);
+  std::string query = parameterObject["query"].asString();
+
+  CMusicDbUrl musicUrl;
+  CFileItemList artists;
+  if (!musicUrl.FromString("musicdb://artists/"))
+    return InternalError;
+  musicUrl.AddOption("search", query);
+  if (!musicdatabase.GetArtistsByWhere(musicUrl.ToString(), CDatabase::Filter(), artists, sorting))
+    return InternalError;
+
+  CFileItemList albums;
+  if (!musicUrl.FromString("musicdb://albums/"))
+    return InternalError;
+  musicUrl.AddOption("search", query);
+  if (!musicdatabase.GetAlbumsByWhere(musicUrl.ToString(), CDatabase::Filter(), albums, sorting))
+    return InternalError;
+
+  CFileItemList songs;
+  if (!musicUrl.FromString("musicdb://songs/"))
+    return InternalError;
+  musicUrl.AddOption("search", query);
+  if (!musicdatabase.GetSongsByWhere(musicUrl.ToString(), CDatabase::Filter(), songs, sorting))
+    return InternalError;
+
+  // the properties are given per kind of item
+  CVariant param = parameterObject;
+  param["properties"] = parameterObject["properties"]["artists"];
+  HandleFileItemList("artistid", false, "artists", artists, param, result, false);
+
+  param["properties"] = parameterObject["properties"]["albums"];
+  if (GetAdditionalAlbumDetails(param, albums, musicdatabase) != OK)
+    return InternalError;
+  HandleFileItemList("albumid", false, "albums", albums, param, result, false);
+
+  param["properties"] = parameterObject["properties"]["songs"];
+  if (GetAdditionalSongDetails(param, songs, musicdatabase) != OK)
+    return InternalError;
+  HandleFileItemList("songid", true, "songs", songs, param, result, false);
+  result.erase("limits");
+  return OK;
+}
+
 JSONRPC_STATUS CAudioLibrary::SetArtistDetails(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
 {
   int id = (int)parameterObject["artistid"].asInteger();
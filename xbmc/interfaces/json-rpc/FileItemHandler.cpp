@@ -350,7 +350,7 @@ void CFileItemHandler::HandleFileItem(const char *ID, bool allowFile, const char
   if (resultname)
   {
     if (append)
-      result[resultname].append(object);
+      result[resultname].push_back_swap(object);
     else
       result[resultname] = object;
   }
@@ -24,6 +24,7 @@
 #include "MediaSource.h"
 #include "filesystem/Directory.h"
 #include "filesystem/File.h"
+#include "filesystem/FileStats.h"
 #include "FileItem.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/MediaSourceSettings.h"
@@ -232,6 +233,61 @@ JSONRPC_STATUS CFileOperations::Download(const CStdString &method, ITransportLay
   return transport->Download(parameterObject["path"].asString().c_str(), result) ? OK : InvalidParams;
 }
 
+JSONRPC_STATUS CFileOperations::GetStatistics(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  static const char *operations[FILESTATS_OPS] = { "open", "read", "seek", "stat" };
+
+  std::map<std::string, SFileStatsCounters> counters;
+  CFileStats::GetCounters(counters);
+
+  result["latencylimits"] = CVariant(CVariant::VariantTypeArray);
+  for (unsigned int bucket = 0; bucket < FILESTATS_BUCKETS; bucket++)
+    result["latencylimits"].push_back(CFileStats::GetBucketLimit(bucket));
+
+  result["protocols"] = CVariant(CVariant::VariantTypeArray);
+  for (std::map<std::string, SFileStatsCounters>::const_iterator it = counters.begin(); it != counters.end(); ++it)
+  {
+    CVariant protocol(CVariant::VariantTypeObject);
+    protocol["protocol"] = it->first;
+    protocol["bytesread"] = it->second.bytesRead;
+    for (unsigned int op = 0; op < FILESTATS_OPS; op++)
+    {
+      CVariant operation(CVariant::VariantTypeObject);
+      operation["calls"] = it->second.calls[op];
+      operation["failures"] = it->second.failures[op];
+      operation["time"] = it->second.time[op];
+      operation["median"] = CFileStats::GetPercentile(it->second.latency[op], 0.5f);
+      operation["p99"] = CFileStats::GetPercentile(it->second.latency[op], 0.99f);
+      operation["latency"] = CVariant(CVariant::VariantTypeArray);
+      for (unsigned int bucket = 0; bucket < FILESTATS_BUCKETS; bucket++)
+        operation["latency"].push_back(it->second.latency[op][bucket]);
+      protocol[operations[op]] = operation;
+    }
+    result["protocols"].push_back(protocol);
+  }
+
+  std::vector<SFileCacheStats> caches;
+  CFileStats::GetCaches(caches);
+
+  result["caches"] = CVariant(CVariant::VariantTypeArray);
+  for (std::vector<SFileCacheStats>::const_iterator it = caches.begin(); it != caches.end(); ++it)
+  {
+    CVariant cache(CVariant::VariantTypeObject);
+    cache["path"] = CURL(it->path).GetWithoutUserDetails();
+    cache["forward"] = it->status.forward;
+    cache["maxrate"] = it->status.maxrate;
+    cache["currate"] = it->status.currate;
+    cache["full"] = it->status.full;
+    cache["underruns"] = it->status.underruns;
+    result["caches"].push_back(cache);
+  }
+
+  if (parameterObject["reset"].asBoolean())
+    CFileStats::Reset();
+
+  return OK;
+}
+
 bool CFileOperations::FillFileItem(const CFileItemPtr &originalItem, CFileItemPtr &item, CStdString media /* = "" */, const CVariant &parameterObject /* = CVariant(CVariant::VariantTypeArray) */)
 {
   if (originalItem.get() == NULL)
@@ -26,6 +26,7 @@
 #include "interfaces/AnnouncementManager.h"
 #include "playlists/SmartPlayList.h"
 #include "settings/AdvancedSettings.h"
+#include "utils/JSONStreamWriter.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
@@ -222,12 +223,22 @@ JSONRPC_STATUS CJSONRPC::NotifyAll(const CStdString &method, ITransportLayer *tr
 }
 
 CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client)
+{
+  std::string str;
+  CJSONStringOutputStream output(str);
+  MethodCall(inputString, transport, client, output);
+  return str;
+}
+
+bool CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client, IJSONOutputStream &output)
 {
   CVariant inputroot, outputroot, result;
   bool hasResponse = false;
 
   CLog::Log(LOGDEBUG, "JSONRPC: Incoming request: %s", inputString.c_str());
   inputroot = CJSONVariantParser::Parse((unsigned char *)inputString.c_str(), inputString.length());
+
+  CJSONStreamWriter writer(output, g_advancedSettings.m_jsonOutputCompact);
   if (!inputroot.isNull())
   {
     if (inputroot.isArray())
@@ -235,20 +246,26 @@ CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *
       if (inputroot.size() <= 0)
       {
         CLog::Log(LOGERROR, "JSONRPC: Empty batch call\n");
-        BuildResponse(inputroot, InvalidRequest, CVariant(), outputroot);
+        BuildResponse(inputroot, InvalidRequest, result, outputroot);
         hasResponse = true;
       }
       else
       {
+        // write every response as soon as its call has been handled
         for (CVariant::const_iterator_array itr = inputroot.begin_array(); itr != inputroot.end_array(); itr++)
         {
           CVariant response;
           if (HandleMethodCall(*itr, response, transport, client))
           {
-            outputroot.append(response);
+            if (!hasResponse)
+              writer.StartArray();
+            writer.Value(response, true);
             hasResponse = true;
           }
         }
+        if (hasResponse)
+          writer.EndArray();
+        return hasResponse && writer.Flush();
       }
     }
     else
@@ -257,12 +274,15 @@ CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *
   else
   {
     CLog::Log(LOGERROR, "JSONRPC: Failed to parse '%s'\n", inputString.c_str());
-    BuildResponse(inputroot, ParseError, CVariant(), outputroot);
+    BuildResponse(inputroot, ParseError, result, outputroot);
     hasResponse = true;
   }
 
-  CStdString str = hasResponse ? CJSONVariantWriter::Write(outputroot, g_advancedSettings.m_jsonOutputCompact) : "";
-  return str;
+  if (!hasResponse)
+    return false;
+
+  writer.Value(outputroot, true);
+  return writer.Flush();
 }
 
 bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client)
@@ -302,7 +322,7 @@ inline bool CJSONRPC::IsProperJSONRPC(const CVariant& inputroot)
   return inputroot.isObject() && inputroot.isMember("jsonrpc") && inputroot["jsonrpc"].isString() && inputroot["jsonrpc"] == CVariant("2.0") && inputroot.isMember("method") && inputroot["method"].isString() && (!inputroot.isMember("params") || inputroot["params"].isArray() || inputroot["params"].isObject());
 }
 
-inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code, const CVariant& result, CVariant& response)
+inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code, CVariant& result, CVariant& response)
 {
   response["jsonrpc"] = "2.0";
   response["id"] = request.isObject() && request.isMember("id") ? request["id"] : CVariant();
@@ -310,7 +330,8 @@ inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code
   switch (code)
   {
     case OK:
-      response["result"] = result;
+      // the result can be huge, move it instead of copying it
+      response["result"].swap(result);
       break;
     case ACK:
       response["result"] = "OK";
@@ -29,6 +29,8 @@
 #include "interfaces/IAnnouncer.h"
 #include "utils/StdString.h"
 
+class IJSONOutputStream;
+
 namespace JSONRPC
 {
   /*!
@@ -64,6 +66,23 @@ namespace JSONRPC
      */
     static CStdString MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client);
 
+    /*
+     \brief Handles an incoming JSON-RPC request, streaming the response
+     \param inputString received JSON-RPC request
+     \param transport Transport protocol on which the request arrived
+     \param client Client which sent the request
+     \param output Stream receiving the JSON-RPC response in chunks
+     \return True if a response was written
+
+     Same as the string returning version, but the response is serialized
+     straight into the output stream and every part of it is released as
+     soon as it has been written. Responses of a batch call are written one
+     after another as the calls complete.
+     The method handlers still build the complete CVariant result before
+     anything is written, only the serialized text is never held in full.
+     */
+    static bool MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client, IJSONOutputStream &output);
+
     static JSONRPC_STATUS Introspect(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Version(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Permission(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
@@ -77,7 +96,7 @@ namespace JSONRPC
     static bool HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client);
     static inline bool IsProperJSONRPC(const CVariant& inputroot);
 
-    inline static void BuildResponse(const CVariant& request, JSONRPC_STATUS code, const CVariant& result, CVariant& response);
+    inline static void BuildResponse(const CVariant& request, JSONRPC_STATUS code, CVariant& result, CVariant& response);
 
     static bool m_initialized;
   };
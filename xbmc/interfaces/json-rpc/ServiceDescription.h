@@ -22,7 +22,7 @@
 namespace JSONRPC
 {
   const char* const JSONRPC_SERVICE_ID          = "http://www.xbmc.org/jsonrpc/ServiceDescription.json";
-  const char* const JSONRPC_SERVICE_VERSION     = "6.5.1";
+  const char* const JSONRPC_SERVICE_VERSION     = "6.9.0";
   const char* const JSONRPC_SERVICE_DESCRIPTION = "JSON-RPC API of XBMC";
 
   const char* const JSONRPC_SERVICE_TYPES[] = {  
@@ -1842,6 +1842,23 @@ namespace JSONRPC
         "}"
       "}"
     "}",
+    "\"Files.GetStatistics\": {"
+      "\"type\": \"method\","
+      "\"description\": \"Retrieves the number, failures and latencies of the file operations per protocol and the state of the open file caches\","
+      "\"transport\": \"Response\","
+      "\"permission\": \"ReadData\","
+      "\"params\": ["
+        "{ \"name\": \"reset\", \"type\": \"boolean\", \"default\": false, \"description\": \"Zero the counters after retrieving them\" }"
+      "],"
+      "\"returns\": {"
+        "\"type\": \"object\","
+        "\"properties\": {"
+          "\"latencylimits\": { \"type\": \"array\", \"items\": { \"type\": \"integer\" }, \"required\": true, \"description\": \"Upper limit of each latency bucket in microseconds, 0 for unbounded\" },"
+          "\"protocols\": { \"type\": \"array\", \"items\": { \"type\": \"object\" }, \"required\": true },"
+          "\"caches\": { \"type\": \"array\", \"items\": { \"type\": \"object\" }, \"required\": true }"
+        "}"
+      "}"
+    "}",
     "\"AudioLibrary.GetArtists\": {"
       "\"type\": \"method\","
       "\"description\": \"Retrieve all artists\","
@@ -2079,6 +2096,38 @@ namespace JSONRPC
         "}"
       "}"
     "}",
+    "\"AudioLibrary.Search\": {"
+      "\"type\": \"method\","
+      "\"description\": \"Search artists, albums and song titles, artists and albums for words starting with the words of a query, best matches first\","
+      "\"transport\": \"Response\","
+      "\"permission\": \"ReadData\","
+      "\"params\": ["
+        "{ \"name\": \"query\", \"type\": \"string\", \"required\": true, \"minLength\": 1 },"
+        "{ \"name\": \"properties\", \"type\": \"object\", \"description\": \"Properties to retrieve for each kind of item\","
+          "\"properties\": {"
+            "\"artists\": { \"$ref\": \"Audio.Fields.Artist\" },"
+            "\"albums\": { \"$ref\": \"Audio.Fields.Album\" },"
+            "\"songs\": { \"$ref\": \"Audio.Fields.Song\" }"
+          "},"
+          "\"additionalProperties\": false"
+        "},"
+        "{ \"name\": \"limits\", \"$ref\": \"List.Limits\", \"description\": \"Applied to artists, albums and songs separately\" }"
+      "],"
+      "\"returns\": {"
+        "\"type\": \"object\","
+        "\"properties\": {"
+          "\"artists\": { \"type\": \"array\", \"required\": true,"
+            "\"items\": { \"$ref\": \"Audio.Details.Artist\" }"
+          "},"
+          "\"albums\": { \"type\": \"array\", \"required\": true,"
+            "\"items\": { \"$ref\": \"Audio.Details.Album\" }"
+          "},"
+          "\"songs\": { \"type\": \"array\", \"required\": true,"
+            "\"items\": { \"$ref\": \"Audio.Details.Song\" }"
+          "}"
+        "}"
+      "}"
+    "}",
     "\"AudioLibrary.SetArtistDetails\": {"
       "\"type\": \"method\","
       "\"description\": \"Update the given artist with the given details\","
@@ -2513,6 +2562,38 @@ namespace JSONRPC
         "}"
       "}"
     "}",
+    "\"VideoLibrary.Search\": {"
+      "\"type\": \"method\","
+      "\"description\": \"Search titles, plots and actors of movies, tv shows and episodes for words starting with the words of a query, best matches first\","
+      "\"transport\": \"Response\","
+      "\"permission\": \"ReadData\","
+      "\"params\": ["
+        "{ \"name\": \"query\", \"type\": \"string\", \"required\": true, \"minLength\": 1 },"
+        "{ \"name\": \"properties\", \"type\": \"object\", \"description\": \"Properties to retrieve for each kind of item\","
+          "\"properties\": {"
+            "\"movies\": { \"$ref\": \"Video.Fields.Movie\" },"
+            "\"tvshows\": { \"$ref\": \"Video.Fields.TVShow\" },"
+            "\"episodes\": { \"$ref\": \"Video.Fields.Episode\" }"
+          "},"
+          "\"additionalProperties\": false"
+        "},"
+        "{ \"name\": \"limits\", \"$ref\": \"List.Limits\", \"description\": \"Applied to movies, tv shows and episodes separately\" }"
+      "],"
+      "\"returns\": {"
+        "\"type\": \"object\","
+        "\"properties\": {"
+          "\"movies\": { \"type\": \"array\", \"required\": true,"
+            "\"items\": { \"$ref\": \"Video.Details.Movie\" }"
+          "},"
+          "\"tvshows\": { \"type\": \"array\", \"required\": true,"
+            "\"items\": { \"$ref\": \"Video.Details.TVShow\" }"
+          "},"
+          "\"episodes\": { \"type\": \"array\", \"required\": true,"
+            "\"items\": { \"$ref\": \"Video.Details.Episode\" }"
+          "}"
+        "}"
+      "}"
+    "}",
     "\"VideoLibrary.SetMovieDetails\": {"
       "\"type\": \"method\","
       "\"description\": \"Update the given movie with the given details\","
@@ -3164,6 +3245,17 @@ namespace JSONRPC
         "\"additionalProperties\": { \"type\": \"string\" }"
       "}"
     "}",
+    "\"XBMC.Trace\": {"
+      "\"type\": \"method\","
+      "\"description\": \"Starts, stops or writes a timeline trace of XBMC's hot paths in the Chrome trace event format\","
+      "\"transport\": \"Response\","
+      "\"permission\": \"ControlSystem\","
+      "\"params\": ["
+        "{ \"name\": \"action\", \"type\": \"string\", \"required\": true, \"enum\": [ \"start\", \"stop\", \"dump\" ] },"
+        "{ \"name\": \"location\", \"type\": \"string\", \"enum\": [ \"temp\", \"log\" ], \"default\": \"temp\", \"description\": \"Folder a dump is written to, special://temp/ or special://logpath/\" }"
+      "],"
+      "\"returns\": { \"type\": \"string\", \"description\": \"Path of the written dump, OK for start and stop\" }"
+    "}",
     "\"Favourites.GetFavourites\": {"
       "\"type\": \"method\","
       "\"description\": \"Retrieve all favourites\","
@@ -454,6 +454,67 @@ JSONRPC_STATUS CVideoLibrary::GetGenres(const CStdString &method, ITransportLaye
   return OK;
 }
 
+JSONRPC_STATUS CVideoLibrary::Search(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  CVideoDatabase videodatabase;
+  if (!videodatabase.Open())
+    return InternalError;
+
+  // without sorting the best matches come first and the limits apply to each kind of item
+  SortDescription sorting;
+  ParseLimits(parameterObject, sorting.limitStart, sorting.limitEnd);
+  std::string query = parameterObject["query"].asString();
+
+  CVideoDbUrl videoUrl;
+  CFileItemList movies;
+  if (!videoUrl.FromString("videodb://movies/titles/"))
+    return InternalError;
+  videoUrl.AddOption("search", query);
+  if (!videodatabase.GetMoviesByWhere(videoUrl.ToString(), CDatabase::Filter(), movies, sorting))
+    return InternalError;
+
+  CFileItemList tvshows;
+  if (!videoUrl.FromString("videodb://tvshows/titles/"))
+    return InternalError;
+  videoUrl.AddOption("search", query);
+  if (!videodatabase.GetTvShowsByWhere(videoUrl.ToString(), CDatabase::Filter(), tvshows, sorting))
+    return InternalError;
+
+  CFileItemList episodes;
+  if (!videoUrl.FromString("videodb://tvshows/titles/-1/-1/"))
+    return InternalError;
+  videoUrl.AddOption("search", query);
+  if (!videodatabase.GetEpisodesByWhere(videoUrl.ToString(), CDatabase::Filter(), episodes, false, sorting))
+    return InternalError;
+
+  // the properties are given per kind of item
+  CVariant param = parameterObject;
+  param["properties"] = parameterObject["properties"]["movies"];
+  if (GetAdditionalMovieDetails(param, movies, result, videodatabase, false) != OK)
+    return InternalError;
+
+  param["properties"] = parameterObject["properties"]["tvshows"];
+  bool additionalInfo = false;
+  for (CVariant::const_iterator_array itr = param["properties"].begin_array(); itr != param["properties"].end_array(); itr++)
+  {
+    CStdString fieldValue = itr->asString();
+    if (fieldValue == "cast" || fieldValue == "tag")
+      additionalInfo = true;
+  }
+  if (additionalInfo)
+  {
+    for (int index = 0; index < tvshows.Size(); index++)
+      videodatabase.GetTvShowInfo("", *(tvshows[index]->GetVideoInfoTag()), tvshows[index]->GetVideoInfoTag()->m_iDbId);
+  }
+  HandleFileItemList("tvshowid", false, "tvshows", tvshows, param, result, false);
+
+  param["properties"] = parameterObject["properties"]["episodes"];
+  if (GetAdditionalEpisodeDetails(param, episodes, result, videodatabase, false) != OK)
+    return InternalError;
+  result.erase("limits");
+  return OK;
+}
+
 JSONRPC_STATUS CVideoLibrary::SetMovieDetails(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
 {
   int id = (int)parameterObject["movieid"].asInteger();
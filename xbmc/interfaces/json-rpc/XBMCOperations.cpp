@@ -21,6 +21,7 @@
 #include "XBMCOperations.h"
 #include "ApplicationMessenger.h"
 #include "Util.h"
+#include "utils/Trace.h"
 #include "utils/Variant.h"
 #include "powermanagement/PowerManager.h"
 
@@ -92,3 +93,27 @@ JSONRPC_STATUS CXBMCOperations::GetInfoBooleans(const CStdString &method, ITrans
 
   return OK;
 }
+
+JSONRPC_STATUS CXBMCOperations::Trace(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  std::string action = parameterObject["action"].asString();
+  if (action == "start")
+  {
+    if (!CTrace::Start())
+      return FailedToExecute;
+  }
+  else if (action == "stop")
+    CTrace::Stop();
+  else if (action == "dump")
+  {
+    std::string file;
+    if (!CTrace::Dump(file, parameterObject["location"].asString() == "log"))
+      return FailedToExecute;
+    result = file;
+    return OK;
+  }
+  else
+    return InvalidParams;
+
+  return ACK;
+}
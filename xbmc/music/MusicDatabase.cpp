@@ -221,6 +221,8 @@ bool CMusicDatabase::CreateTables()
     m_pDS->exec("CREATE TRIGGER delete_album AFTER DELETE ON album FOR EACH ROW BEGIN DELETE FROM art WHERE media_id=old.idAlbum AND media_type='album'; END");
     m_pDS->exec("CREATE TRIGGER delete_artist AFTER DELETE ON artist FOR EACH ROW BEGIN DELETE FROM art WHERE media_id=old.idArtist AND media_type='artist'; END");
 
+    CreateSearchIndex();
+
     // we create views last to ensure all indexes are rolled in
     CreateViews();
 
@@ -237,6 +239,64 @@ bool CMusicDatabase::CreateTables()
   return true;
 }
 
+void CMusicDatabase::CreateSearchIndex()
+{
+  // full-text tables are sqlite only, searches fall back to LIKE without them
+  if (!m_sqlite)
+    return;
+
+  try
+  {
+    // undone as a whole if anything fails, rather than leaving part of the tables and triggers
+    m_pDS->exec("SAVEPOINT searchindex");
+
+    CLog::Log(LOGINFO, "create search index");
+    m_pDS->exec("CREATE VIRTUAL TABLE songsearch USING fts4(title, artist, album, prefix=\"2,3\")");
+    m_pDS->exec("CREATE VIRTUAL TABLE albumsearch USING fts4(album, artist, prefix=\"2,3\")");
+    m_pDS->exec("CREATE VIRTUAL TABLE artistsearch USING fts4(artist, prefix=\"2,3\")");
+
+    CLog::Log(LOGINFO, "create search index triggers");
+    m_pDS->exec("CREATE TRIGGER songsearch_insert AFTER INSERT ON song FOR EACH ROW BEGIN "
+                "INSERT INTO songsearch(docid, title, artist, album) VALUES (new.idSong, new.strTitle, new.strArtists, (SELECT strAlbum FROM album WHERE idAlbum=new.idAlbum)); END");
+    m_pDS->exec("CREATE TRIGGER songsearch_update AFTER UPDATE OF strTitle, strArtists, idAlbum ON song FOR EACH ROW "
+                "WHEN new.strTitle IS NOT old.strTitle OR new.strArtists IS NOT old.strArtists OR new.idAlbum IS NOT old.idAlbum BEGIN "
+                "UPDATE songsearch SET title=new.strTitle, artist=new.strArtists, album=(SELECT strAlbum FROM album WHERE idAlbum=new.idAlbum) WHERE docid=new.idSong; END");
+    m_pDS->exec("CREATE TRIGGER songsearch_delete AFTER DELETE ON song FOR EACH ROW BEGIN DELETE FROM songsearch WHERE docid=old.idSong; END");
+    m_pDS->exec("CREATE TRIGGER albumsearch_insert AFTER INSERT ON album FOR EACH ROW BEGIN "
+                "INSERT INTO albumsearch(docid, album, artist) VALUES (new.idAlbum, new.strAlbum, new.strArtists); END");
+    m_pDS->exec("CREATE TRIGGER albumsearch_update AFTER UPDATE OF strAlbum, strArtists ON album FOR EACH ROW "
+                "WHEN new.strAlbum IS NOT old.strAlbum OR new.strArtists IS NOT old.strArtists BEGIN "
+                "UPDATE albumsearch SET album=new.strAlbum, artist=new.strArtists WHERE docid=new.idAlbum; "
+                "UPDATE songsearch SET album=new.strAlbum WHERE docid IN (SELECT idSong FROM song WHERE idAlbum=new.idAlbum); END");
+    m_pDS->exec("CREATE TRIGGER albumsearch_delete AFTER DELETE ON album FOR EACH ROW BEGIN DELETE FROM albumsearch WHERE docid=old.idAlbum; END");
+    m_pDS->exec("CREATE TRIGGER artistsearch_insert AFTER INSERT ON artist FOR EACH ROW BEGIN "
+                "INSERT INTO artistsearch(docid, artist) VALUES (new.idArtist, new.strArtist); END");
+    m_pDS->exec("CREATE TRIGGER artistsearch_update AFTER UPDATE OF strArtist ON artist FOR EACH ROW "
+                "WHEN new.strArtist IS NOT old.strArtist BEGIN UPDATE artistsearch SET artist=new.strArtist WHERE docid=new.idArtist; END");
+    m_pDS->exec("CREATE TRIGGER artistsearch_delete AFTER DELETE ON artist FOR EACH ROW BEGIN DELETE FROM artistsearch WHERE docid=old.idArtist; END");
+
+    // index what's already in the library
+    m_pDS->exec("INSERT INTO songsearch(docid, title, artist, album) SELECT idSong, strTitle, song.strArtists, strAlbum FROM song LEFT JOIN album ON album.idAlbum=song.idAlbum");
+    m_pDS->exec("INSERT INTO albumsearch(docid, album, artist) SELECT idAlbum, strAlbum, strArtists FROM album");
+    m_pDS->exec("INSERT INTO artistsearch(docid, artist) SELECT idArtist, strArtist FROM artist");
+
+    m_pDS->exec("RELEASE searchindex");
+  }
+  catch (...)
+  {
+    CLog::Log(LOGWARNING, "%s - unable to create the search index, sqlite has no full-text search", __FUNCTION__);
+    try
+    {
+      m_pDS->exec("ROLLBACK TO searchindex");
+      m_pDS->exec("RELEASE searchindex");
+    }
+    catch (...)
+    {
+      CLog::Log(LOGERROR, "%s - unable to remove the partial search index", __FUNCTION__);
+    }
+  }
+}
+
 void CMusicDatabase::CreateViews()
 {
   CLog::Log(LOGINFO, "create song view");
@@ -364,40 +424,52 @@ int CMusicDatabase::AddSong(const int idAlbum,
     bHasKaraoke = CKaraokeLyricsFactory::HasLyrics(strPathAndFileName);
 #endif
 
-    strSQL=PrepareSQL("SELECT * FROM song WHERE (idAlbum = %i AND strMusicBrainzTrackID = '%s') OR (idAlbum=%i AND dwFileNameCRC='%ul' AND strTitle='%s' AND strMusicBrainzTrackID IS NULL)",
-                      idAlbum,
-                      strMusicBrainzTrackID.c_str(),
-                      idAlbum,
-                      crc,
-                      strTitle.c_str());
-
-    if (!m_pDS->query(strSQL.c_str()))
+    // the crc has always been stored with a trailing 'l'
+    CStdString strCRC;
+    strCRC.Format("%ul", crc);
+    dbiplus::field_value null;
+    null.set_isNull();
+
+    strSQL = "SELECT * FROM song WHERE (idAlbum = ? AND strMusicBrainzTrackID = ?) OR (idAlbum=? AND dwFileNameCRC=? AND strTitle=? AND strMusicBrainzTrackID IS NULL)";
+    dbiplus::query_params params;
+    params.push_back(idAlbum);
+    params.push_back(strMusicBrainzTrackID);
+    params.push_back(idAlbum);
+    params.push_back(strCRC);
+    params.push_back(strTitle);
+
+    if (!m_pDS->query(strSQL, params))
       return -1;
 
     if (m_pDS->num_rows() == 0)
     {
       m_pDS->close();
-      strSQL=PrepareSQL("INSERT INTO song (idSong,idAlbum,idPath,strArtists,strGenres,strTitle,iTrack,iDuration,iYear,dwFileNameCRC,strFileName,strMusicBrainzTrackID,iTimesPlayed,iStartOffset,iEndOffset,lastplayed,rating,comment) values (NULL, %i, %i, '%s', '%s', '%s', %i, %i, %i, '%ul', '%s'",
-                    idAlbum,
-                    idPath,
-                    StringUtils::Join(artists, g_advancedSettings.m_musicItemSeparator).c_str(),
-                    StringUtils::Join(genres, g_advancedSettings.m_musicItemSeparator).c_str(),
-                    strTitle.c_str(),
-                    iTrack, iDuration, iYear,
-                    crc, strFileName.c_str());
-
+      strSQL = "INSERT INTO song (idSong,idAlbum,idPath,strArtists,strGenres,strTitle,iTrack,iDuration,iYear,dwFileNameCRC,strFileName,strMusicBrainzTrackID,iTimesPlayed,iStartOffset,iEndOffset,lastplayed,rating,comment) values (NULL,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)";
+      params.clear();
+      params.push_back(idAlbum);
+      params.push_back(idPath);
+      params.push_back(StringUtils::Join(artists, g_advancedSettings.m_musicItemSeparator));
+      params.push_back(StringUtils::Join(genres, g_advancedSettings.m_musicItemSeparator));
+      params.push_back(strTitle);
+      params.push_back(iTrack);
+      params.push_back(iDuration);
+      params.push_back(iYear);
+      params.push_back(strCRC);
+      params.push_back(strFileName);
       if (strMusicBrainzTrackID.IsEmpty())
-        strSQL += PrepareSQL(",NULL");
+        params.push_back(null);
       else
-        strSQL += PrepareSQL(",'%s'", strMusicBrainzTrackID.c_str());
-
+        params.push_back(strMusicBrainzTrackID);
+      params.push_back(iTimesPlayed);
+      params.push_back(iStartOffset);
+      params.push_back(iEndOffset);
       if (dtLastPlayed.IsValid())
-        strSQL += PrepareSQL(",%i,%i,%i,'%s','%c','%s')",
-                      iTimesPlayed, iStartOffset, iEndOffset, dtLastPlayed.GetAsDBDateTime().c_str(), rating, strComment.c_str());
+        params.push_back(dtLastPlayed.GetAsDBDateTime());
       else
-        strSQL += PrepareSQL(",%i,%i,%i,NULL,'%c','%s')",
-                      iTimesPlayed, iStartOffset, iEndOffset, rating, strComment.c_str());
-      m_pDS->exec(strSQL.c_str());
+        params.push_back(null);
+      params.push_back(rating);
+      params.push_back(strComment);
+      m_pDS->exec(strSQL, params);
       idSong = (int)m_pDS->lastinsertid();
     }
     else
@@ -891,14 +963,16 @@ int CMusicDatabase::AddPath(const CStdString& strPath1)
     if (it != m_pathCache.end())
       return it->second;
 
-    strSQL=PrepareSQL( "select * from path where strPath='%s'", strPath.c_str());
-    m_pDS->query(strSQL.c_str());
+    strSQL = "select * from path where strPath=?";
+    dbiplus::query_params params;
+    params.push_back(strPath);
+    m_pDS->query(strSQL, params);
     if (m_pDS->num_rows() == 0)
     {
       m_pDS->close();
       // doesnt exists, add it
-      strSQL=PrepareSQL("insert into path (idPath, strPath) values( NULL, '%s' )", strPath.c_str());
-      m_pDS->exec(strSQL.c_str());
+      strSQL = "insert into path (idPath, strPath) values( NULL, ? )";
+      m_pDS->exec(strSQL, params);
 
       int idPath = (int)m_pDS->lastinsertid();
       m_pathCache.insert(pair<CStdString, int>(strPath, idPath));
@@ -1226,7 +1300,13 @@ bool CMusicDatabase::SearchArtists(const CStdString& search, CFileItemList &arti
 
     CStdString strVariousArtists = g_localizeStrings.Get(340).c_str();
     CStdString strSQL;
-    if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
+    std::string hits = GetFullTextHits("artistsearch", search);
+    if (!hits.empty())
+    {
+      strSQL = "select artist.* from " + hits + " join artist on artist.idArtist=hits.docid";
+      strSQL += PrepareSQL(" where strArtist <> '%s' order by hits.score desc", strVariousArtists.c_str());
+    }
+    else if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
       strSQL=PrepareSQL("select * from artist "
                                 "where (strArtist like '%s%%' or strArtist like '%% %s%%') and strArtist <> '%s' "
                                 , search.c_str(), search.c_str(), strVariousArtists.c_str() );
@@ -1798,7 +1878,10 @@ bool CMusicDatabase::SearchSongs(const CStdString& search, CFileItemList &items)
     if (NULL == m_pDS.get()) return false;
 
     CStdString strSQL;
-    if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
+    std::string hits = GetFullTextHits("songsearch", search, "title");
+    if (!hits.empty())
+      strSQL = "select songview.* from " + hits + " join songview on songview.idSong=hits.docid order by hits.score desc limit 1000";
+    else if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
       strSQL=PrepareSQL("select * from songview where strTitle like '%s%%' or strTitle like '%% %s%%' limit 1000", search.c_str(), search.c_str());
     else
       strSQL=PrepareSQL("select * from songview where strTitle like '%s%%' limit 1000", search.c_str());
@@ -1834,7 +1917,10 @@ bool CMusicDatabase::SearchAlbums(const CStdString& search, CFileItemList &album
     if (NULL == m_pDS.get()) return false;
 
     CStdString strSQL;
-    if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
+    std::string hits = GetFullTextHits("albumsearch", search, "album");
+    if (!hits.empty())
+      strSQL = "select albumview.* from " + hits + " join albumview on albumview.idAlbum=hits.docid order by hits.score desc";
+    else if (search.GetLength() >= MIN_FULL_SEARCH_LENGTH)
       strSQL=PrepareSQL("select * from albumview where strAlbum like '%s%%' or strAlbum like '%% %s%%'", search.c_str(), search.c_str());
     else
       strSQL=PrepareSQL("select * from albumview where strAlbum like '%s%%'", search.c_str());
@@ -3032,7 +3118,7 @@ bool CMusicDatabase::GetArtistsByWhere(const CStdString& strBaseDir, const Filte
     for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
     {
       unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
+      const dbiplus::sql_record* const record = &data.at(targetRow);
       
       try
       {
@@ -3196,7 +3282,7 @@ bool CMusicDatabase::GetAlbumsByWhere(const CStdString &baseDir, const Filter &f
     for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
     {
       unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
+      const dbiplus::sql_record* const record = &data.at(targetRow);
       
       try
       {
@@ -3253,13 +3339,21 @@ bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &fi
       extFilter.AppendGroup("songview.idSong");
     }
 
+    // Let the database sort when it orders like SortUtils would, the rows can
+    // then be converted one by one while stepping through them
+    std::string orderClause;
+    bool sortInSQL = extFilter.limit.empty() &&
+                    (sortDescription.sortBy == SortByNone || extFilter.order.empty()) &&
+                     SortUtils::BuildOrderClause(sortDescription, MediaTypeSong, orderClause);
+    if (sortInSQL && !orderClause.empty())
+      extFilter.order = orderClause;
+
     CStdString strSQLExtra;
     if (!BuildSQL(strSQLExtra, extFilter, strSQLExtra))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
-    if (extFilter.limit.empty() &&
-        sortDescription.sortBy == SortByNone &&
+    // Apply the limiting directly here if the database does the sorting
+    if (sortInSQL &&
        (sortDescription.limitStart > 0 || sortDescription.limitEnd > 0))
     {
       total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
@@ -3269,6 +3363,31 @@ bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &fi
     strSQL = PrepareSQL(strSQL, !filter.fields.empty() && filter.fields.compare("*") != 0 ? filter.fields.c_str() : "songview.*") + strSQLExtra;
 
     CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
+    if (sortInSQL)
+    {
+      CReadDataset ds(*this);
+      if (!ds->query_cursor(strSQL))
+        return false;
+
+      int count = 0;
+      while (!ds->eof())
+      {
+        CFileItemPtr item(new CFileItem);
+        GetFileItemFromDataset(ds->get_sql_record(), item.get(), musicUrl.ToString());
+        // HACK for sorting by database returned order
+        item->m_iprogramCount = ++count;
+        items.Add(item);
+        ds->next();
+      }
+      ds->close();
+
+      if (total < count)
+        total = count;
+      items.SetProperty("total", total);
+      CLog::Log(LOGDEBUG, "%s(%s) - took %d ms", __FUNCTION__, filter.where.c_str(), XbmcThreads::SystemClockMillis() - time);
+      return true;
+    }
+
     // run query
     if (!m_pDS->query(strSQL.c_str()))
       return false;
@@ -3297,7 +3416,7 @@ bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &fi
     for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
     {
       unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
+      const dbiplus::sql_record* const record = &data.at(targetRow);
       
       try
       {
@@ -3788,6 +3907,9 @@ bool CMusicDatabase::UpdateOldVersion(int version)
     m_pDS->exec("DROP INDEX idxSong6 ON song");
     m_pDS->exec("CREATE INDEX idxSong6 on song( idPath, strFileName(255) )");
   }
+
+  if (version < 38)
+    CreateSearchIndex();
     
   // always recreate the views after any table change
   CreateViews();
@@ -3797,7 +3919,7 @@ bool CMusicDatabase::UpdateOldVersion(int version)
 
 int CMusicDatabase::GetMinVersion() const
 {
-  return 37;
+  return 38;
 }
 
 unsigned int CMusicDatabase::GetSongIDs(const Filter &filter, vector<pair<int,int> > &songIDs)
@@ -5466,6 +5588,19 @@ bool CMusicDatabase::GetFilter(CDbUrl &musicUrl, Filter &filter, SortDescription
       strSQL += PrepareSQL(" and artistview.strArtist <> '%s'", strVariousArtists.c_str());
     }
 
+    option = options.find("search");
+    if (option != options.end())
+    {
+      std::string hits = GetFullTextHits("artistsearch", option->second.asString());
+      if (!hits.empty())
+      {
+        filter.AppendJoin("JOIN " + hits + " ON hits.docid = artistview.idArtist");
+        filter.AppendOrder("hits.score DESC");
+      }
+      else
+        strSQL += PrepareSQL(" and artistview.strArtist like '%%%s%%'", option->second.asString().c_str());
+    }
+
     filter.AppendWhere(strSQL);
   }
   else if (type == "albums")
@@ -5508,6 +5643,19 @@ bool CMusicDatabase::GetFilter(CDbUrl &musicUrl, Filter &filter, SortDescription
       else
         filter.AppendWhere("albumview.strAlbum <> ''");
     }
+
+    option = options.find("search");
+    if (option != options.end())
+    {
+      std::string hits = GetFullTextHits("albumsearch", option->second.asString(), "", "2, 1");
+      if (!hits.empty())
+      {
+        filter.AppendJoin("JOIN " + hits + " ON hits.docid = albumview.idAlbum");
+        filter.AppendOrder("hits.score DESC");
+      }
+      else
+        filter.AppendWhere(PrepareSQL("albumview.strAlbum like '%%%s%%'", option->second.asString().c_str()));
+    }
   }
   else if (type == "songs" || type == "singles")
   {
@@ -5550,6 +5698,19 @@ bool CMusicDatabase::GetFilter(CDbUrl &musicUrl, Filter &filter, SortDescription
       filter.AppendWhere(PrepareSQL("songview.idSong IN (SELECT song_artist.idSong FROM song_artist JOIN artist ON artist.idArtist = song_artist.idArtist WHERE artist.strArtist like '%s')" // song artists
                                     " OR songview.idSong IN (SELECT song.idSong FROM song JOIN album_artist ON song.idAlbum=album_artist.idAlbum JOIN artist ON artist.idArtist = album_artist.idArtist WHERE artist.strArtist like '%s')", // album artists
                                     option->second.asString().c_str(), option->second.asString().c_str()));
+
+    option = options.find("search");
+    if (option != options.end())
+    {
+      std::string hits = GetFullTextHits("songsearch", option->second.asString(), "", "4, 2, 1");
+      if (!hits.empty())
+      {
+        filter.AppendJoin("JOIN " + hits + " ON hits.docid = songview.idSong");
+        filter.AppendOrder("hits.score DESC");
+      }
+      else
+        filter.AppendWhere(PrepareSQL("songview.strTitle like '%%%s%%'", option->second.asString().c_str()));
+    }
   }
 
   option = options.find("xsp");
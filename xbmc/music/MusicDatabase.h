@@ -33,8 +33,7 @@ class CFileItem;
 
 namespace dbiplus
 {
-  class field_value;
-  typedef std::vector<field_value> sql_record;
+  class sql_record;
 }
 
 #include <set>
@@ -427,6 +426,11 @@ private:
    */
   virtual void CreateViews();
 
+  /*! \brief Create the full-text index used to search songs, albums and artists
+   and the triggers keeping it up to date. Does nothing if sqlite has no full-text search.
+   */
+  void CreateSearchIndex();
+
   void SplitString(const CStdString &multiString, std::vector<std::string> &vecStrings, CStdString &extraStrings);
   CSong GetSongFromDataset(bool bWithMusicDbPath=false);
   CArtist GetArtistFromDataset(dbiplus::Dataset* pDS, bool needThumb = true);
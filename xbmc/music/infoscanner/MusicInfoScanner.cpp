@@ -38,6 +38,7 @@
 #include "guilib/GUIKeyboardFactory.h"
 #include "filesystem/File.h"
 #include "filesystem/Directory.h"
+#include "filesystem/DirectoryWalker.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "FileItem.h"
@@ -375,17 +376,22 @@ static CStdString Prettify(const CStdString& strDirectory)
 
 bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
 {
-  if (m_handle)
-    m_handle->SetText(Prettify(strDirectory));
+  // the walker lists the folders below while we read the tags of the current one,
+  // skipping all excluded folders defined by m_audioExcludeFromScanRegExps
+  CDirectoryWalker walker(g_advancedSettings.m_musicExtensions + "|.jpg|.tbn|.lrc|.cdg");
+  walker.SetExcludes(g_advancedSettings.m_audioExcludeFromScanRegExps);
+  if (!walker.Walk(strDirectory, *this))
+    m_bStop = true;
+  return !m_bStop;
+}
 
-  // Discard all excluded files defined by m_musicExcludeRegExps
-  CStdStringArray regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
-  if (CUtil::ExcludeFileOrFolder(strDirectory, regexps))
-    return true;
+DIRECTORY_WALK CMusicInfoScanner::OnDirectory(const CStdString& strDirectory, CFileItemList& items)
+{
+  if (m_bStop)
+    return WALK_STOP;
 
-  // load subfolder
-  CFileItemList items;
-  CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_musicExtensions + "|.jpg|.tbn|.lrc|.cdg");
+  if (m_handle)
+    m_handle->SetText(Prettify(strDirectory));
 
   // sort and get the path hash.  Note that we don't filter .cue sheet items here as we want
   // to detect changes in the .cue sheet as well.  The .cue sheet items only need filtering
@@ -420,7 +426,7 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
   else
   { // path is the same - no need to rescan
     CLog::Log(LOGDEBUG, "%s Skipping dir '%s' due to no change", __FUNCTION__, strDirectory.c_str());
-    m_currentItem += CountFiles(items, false);  // false for non-recursive
+    m_currentItem += CountFiles(items);
 
     // updated the dialog with our progress
     if (m_handle)
@@ -432,24 +438,7 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
   }
 
   // now scan the subfolders
-  for (int i = 0; i < items.Size(); ++i)
-  {
-    CFileItemPtr pItem = items[i];
-
-    if (m_bStop)
-      break;
-    // if we have a directory item (non-playlist) we then recurse into that folder
-    if (pItem->m_bIsFolder && !pItem->IsParentFolder() && !pItem->IsPlayList())
-    {
-      CStdString strPath=pItem->GetPath();
-      if (!DoScan(strPath))
-      {
-        m_bStop = true;
-      }
-    }
-  }
-
-  return !m_bStop;
+  return m_bStop ? WALK_STOP : WALK_RECURSE;
 }
 
 INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList& scannedItems)
@@ -1626,31 +1615,49 @@ void CMusicInfoScanner::Run()
   m_itemCount = count;
 }
 
+/*! \brief Counts the audio files below the folders we scan */
+class CMusicInfoScanner::CFileCounter : public IDirectoryWalkerCallback
+{
+public:
+  CFileCounter(const volatile bool &stop) : m_stop(stop), m_count(0) {}
+
+  virtual DIRECTORY_WALK OnDirectory(const CStdString &strDirectory, CFileItemList &items)
+  {
+    if (m_stop)
+      return WALK_STOP;
+    m_count += CountFiles(items);
+    return WALK_RECURSE;
+  }
+
+  virtual bool IsStopped() { return m_stop; }
+
+  int GetCount() const { return m_count; }
+
+private:
+  const volatile bool &m_stop;
+  int                  m_count;
+};
+
 // Recurse through all folders we scan and count files
 int CMusicInfoScanner::CountFilesRecursively(const CStdString& strPath)
 {
-  // load subfolder
-  CFileItemList items;
-  CDirectory::GetDirectory(strPath, items, g_advancedSettings.m_musicExtensions, DIR_FLAG_NO_FILE_DIRS);
-
-  if (m_bStop)
+  CFileCounter counter(m_bStop);
+  CDirectoryWalker walker(g_advancedSettings.m_musicExtensions, DIR_FLAG_NO_FILE_DIRS);
+  walker.SetExcludes(g_advancedSettings.m_audioExcludeFromScanRegExps);
+  if (!walker.Walk(strPath, counter))
     return 0;
 
-  // true for recursive counting
-  int count = CountFiles(items, true);
-  return count;
+  return counter.GetCount();
 }
 
-int CMusicInfoScanner::CountFiles(const CFileItemList &items, bool recursive)
+int CMusicInfoScanner::CountFiles(const CFileItemList &items)
 {
   int count = 0;
   for (int i=0; i<items.Size(); ++i)
   {
     const CFileItemPtr pItem=items[i];
     
-    if (recursive && pItem->m_bIsFolder)
-      count+=CountFilesRecursively(pItem->GetPath());
-    else if (pItem->IsAudio() && !pItem->IsPlayList() && !pItem->IsNFO())
+    if (!pItem->m_bIsFolder && pItem->IsAudio() && !pItem->IsPlayList() && !pItem->IsNFO())
       count++;
   }
   return count;
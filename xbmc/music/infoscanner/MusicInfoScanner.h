@@ -22,6 +22,7 @@
 #include "music/MusicDatabase.h"
 #include "MusicAlbumInfo.h"
 #include "MusicInfoScraper.h"
+#include "filesystem/DirectoryWalker.h"
 
 class CAlbum;
 class CArtist;
@@ -41,7 +42,7 @@ enum INFO_RET
   INFO_ADDED 
 };
 
-class CMusicInfoScanner : CThread, public IRunnable
+class CMusicInfoScanner : CThread, public IRunnable, public XFILE::IDirectoryWalkerCallback
 {
 public:
   /*! \brief Flags for controlling the scanning process
@@ -187,9 +188,18 @@ protected:
 
   bool DoScan(const CStdString& strDirectory);
 
+  /*! \brief Scan a directory found by DoScan()
+   \param strDirectory the directory.
+   \param items its items, the folders left in it are scanned next.
+   \sa XFILE::IDirectoryWalkerCallback
+   */
+  virtual XFILE::DIRECTORY_WALK OnDirectory(const CStdString& strDirectory, CFileItemList& items);
+  virtual bool IsStopped() { return m_bStop; }
+
   virtual void Run();
-  int CountFiles(const CFileItemList& items, bool recursive);
+  static int CountFiles(const CFileItemList& items);
   int CountFilesRecursively(const CStdString& strPath);
+  class CFileCounter;
 
   /*! \brief Resolve a MusicBrainzID to a URL
    If we have a MusicBrainz ID for an artist or album, 
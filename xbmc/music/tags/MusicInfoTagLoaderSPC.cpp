@@ -38,35 +38,37 @@ SPC_ID666 *SPC_get_id666FP (CFile& file)
   if (id == NULL)
     return NULL;
 
-  file.Seek(0x23,SEEK_SET);
-  char c;
-  file.Read(&c,1);
+  memset(id, 0, sizeof(*id));
+
+  // the fields are scattered over the header, fetch them in one go
+  char c = 0;
+  char emulator = 0;
+  SReadRange ranges[] = {
+    { 0x23, &c,            1,  0 },
+    { 0x2E, id->songname,  32, 0 },
+    { 0x4E, id->gametitle, 32, 0 },
+    { 0x6E, id->dumper,    16, 0 },
+    { 0x7E, id->comments,  32, 0 },
+    { 0xA9, playtime_str,  3,  0 },
+    { 0xB0, id->author,    32, 0 },
+    { 0xD1, &emulator,     1,  0 },
+  };
+  file.ReadV(ranges, sizeof(ranges) / sizeof(ranges[0]));
+
   if (c == 27) {
       free(id);
       return NULL;
   }
 
-  file.Seek(0x2E,SEEK_SET);
-  file.Read(id->songname,32);
   id->songname[32] = '\0';
-
-  file.Read(id->gametitle,32);
   id->gametitle[32] = '\0';
-
-  file.Read(id->dumper,16);
   id->dumper[16] = '\0';
-
-  file.Read(id->comments,32);
   id->comments[32] = '\0';
-
-  file.Seek(0xA9,SEEK_SET);
-  file.Read(playtime_str,3);
+  id->author[32] = '\0';
   playtime_str[3] = '\0';
   id->playtime = atoi((char*)playtime_str);
 
-  file.Seek(0xD1,SEEK_SET);
-  file.Read(&c,1);
-  switch (c) {
+  switch (emulator) {
   case 1:
       id->emulator = SPC_EMULATOR_ZSNES;
       break;
@@ -79,10 +81,6 @@ SPC_ID666 *SPC_get_id666FP (CFile& file)
       break;
   }
 
-  file.Seek(0xB0,SEEK_SET);
-  file.Read(id->author,32);
-  id->author[32] = '\0';
-
   return id;
 }
 
@@ -240,7 +240,7 @@ void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char
         continue;
     }
 
-    m_connections[i]->Send(str.c_str(), str.size());
+    m_connections[i]->SendAnnouncement(str);
   }
 }
 
@@ -489,6 +489,7 @@ CTCPServer::CTCPClient::CTCPClient()
   m_endBrackets = 0;
   m_beginChar = 0;
   m_endChar = 0;
+  m_streaming = false;
 
   m_addrlen = sizeof(m_cliaddr);
 }
@@ -520,14 +521,58 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
   return true;
 }
 
-void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
+bool CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
   unsigned int sent = 0;
   do
   {
     CSingleLock lock (m_critSection);
-    sent += send(m_socket, data, size - sent, 0);
+    int ret = send(m_socket, data + sent, size - sent, 0);
+    if (ret <= 0)
+      return false;
+    sent += ret;
   } while (sent < size);
+
+  return true;
+}
+
+void CTCPServer::CTCPClient::SendAnnouncement(const std::string &announcement)
+{
+  // keep announcements from ending up between the parts of a response,
+  // they are sent once the response is complete, see EndStreaming().
+  // The lock is held while sending so a response can't start meanwhile.
+  CSingleLock lock (m_critSection);
+  if (m_streaming)
+  {
+    m_announcements.push_back(announcement);
+    return;
+  }
+
+  Send(announcement.c_str(), announcement.size());
+}
+
+bool CTCPServer::CTCPClient::Write(const char *data, size_t length)
+{
+  // a failed send stops the serialization of the rest of the response
+  return Send(data, (unsigned int)length);
+}
+
+void CTCPServer::CTCPClient::StartStreaming()
+{
+  CSingleLock lock (m_critSection);
+  m_streaming = true;
+}
+
+void CTCPServer::CTCPClient::EndStreaming()
+{
+  // send what was queued before announcements can go out directly again
+  CSingleLock lock (m_critSection);
+  m_streaming = false;
+
+  std::vector<std::string> announcements;
+  announcements.swap(m_announcements);
+  for (std::vector<std::string>::const_iterator it = announcements.begin(); it != announcements.end(); ++it)
+    Send(it->c_str(), it->size());
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -558,8 +603,19 @@ void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, in
         m_endBrackets++;
       if (m_beginBrackets > 0 && m_endBrackets > 0 && m_beginBrackets == m_endBrackets)
       {
-        std::string line = CJSONRPC::MethodCall(m_buffer, host, this);
-        Send(line.c_str(), line.size());
+        if (CanStream())
+        {
+          // handlers run without holding m_critSection, they may wait for
+          // threads that announce to this client
+          StartStreaming();
+          CJSONRPC::MethodCall(m_buffer, host, this, *this);
+          EndStreaming();
+        }
+        else
+        {
+          std::string line = CJSONRPC::MethodCall(m_buffer, host, this);
+          Send(line.c_str(), line.size());
+        }
         m_beginChar = m_beginBrackets = m_endBrackets = 0;
         m_buffer.clear();
       }
@@ -590,6 +646,7 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_streaming         = false;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
@@ -623,15 +680,20 @@ CTCPServer::CWebSocketClient& CTCPServer::CWebSocketClient::operator=(const CWeb
   return *this;
 }
 
-void CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
+bool CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
 {
   const CWebSocketMessage *msg = m_websocket->Send(WebSocketTextFrame, data, size);
   if (msg == NULL || !msg->IsComplete())
-    return;
+    return false;
 
   std::vector<const CWebSocketFrame *> frames = msg->GetFrames();
   for (unsigned int index = 0; index < frames.size(); index++)
-    CTCPClient::Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
+  {
+    if (!CTCPClient::Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength()))
+      return false;
+  }
+
+  return true;
 }
 
 void CTCPServer::CWebSocketClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -27,6 +27,7 @@
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
+#include "utils/JSONStreamWriter.h"
 #include "websocket/WebSocket.h"
 
 namespace JSONRPC
@@ -52,7 +53,7 @@ namespace JSONRPC
     bool InitializeTCP();
     void Deinitialize();
 
-    class CTCPClient : public IClient
+    class CTCPClient : public IClient, public IJSONOutputStream
     {
     public:
       CTCPClient();
@@ -66,10 +67,17 @@ namespace JSONRPC
       virtual int  GetAnnouncementFlags();
       virtual bool SetAnnouncementFlags(int flags);
 
-      virtual void Send(const char *data, unsigned int size);
+      virtual bool Send(const char *data, unsigned int size);
       virtual void PushBuffer(CTCPServer *host, const char *buffer, int length);
       virtual void Disconnect();
 
+      /*! \brief Send an announcement, or queue it until the response being streamed is complete */
+      void SendAnnouncement(const std::string &announcement);
+
+      virtual bool Write(const char *data, size_t length);
+      /*! \brief Whether responses may be sent in several parts as they are serialized */
+      virtual bool CanStream() const { return true; }
+
       virtual bool IsNew() const { return m_new; }
       virtual bool Closing() const { return false; }
 
@@ -81,11 +89,18 @@ namespace JSONRPC
     protected:
       void Copy(const CTCPClient& client);
     private:
+      /*! \brief Queue announcements until the response about to be streamed is complete */
+      void StartStreaming();
+      /*! \brief Mark the streamed response complete and send the announcements queued meanwhile */
+      void EndStreaming();
+
       bool m_new;
       int m_announcementflags;
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      bool m_streaming;
+      std::vector<std::string> m_announcements;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -97,10 +112,13 @@ namespace JSONRPC
       CWebSocketClient& operator=(const CWebSocketClient& client);
       ~CWebSocketClient();
 
-      virtual void Send(const char *data, unsigned int size);
+      virtual bool Send(const char *data, unsigned int size);
       virtual void PushBuffer(CTCPServer *host, const char *buffer, int length);
       virtual void Disconnect();
 
+      // every Send() becomes a websocket message of its own
+      virtual bool CanStream() const { return false; }
+
       virtual bool IsNew() const { return m_websocket == NULL; }
       virtual bool Closing() const { return m_websocket != NULL && m_websocket->GetState() == WebSocketStateClosed; }
 
@@ -33,6 +33,10 @@
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
 
+#ifndef MHD_SIZE_UNKNOWN
+#define MHD_SIZE_UNKNOWN ((uint64_t)-1)
+#endif
+
 //#define WEBSERVER_DEBUG
 
 #ifdef TARGET_WINDOWS
@@ -296,7 +300,8 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
 
   struct MHD_Response *response = NULL;
   int responseCode = handler->GetHTTPResonseCode();
-  switch (handler->GetHTTPResponseType())
+  HTTPResponseType responseType = handler->GetHTTPResponseType();
+  switch (responseType)
   {
     case HTTPNone:
       delete handler;
@@ -326,6 +331,10 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
       ret = CreateMemoryDownloadResponse(request.connection, handler->GetHTTPResponseData(), handler->GetHTTPResonseDataLength(), true, true, response);
       break;
 
+    case HTTPStreamDownload:
+      ret = CreateStreamDownloadResponse(request.connection, handler, response);
+      break;
+
     case HTTPError:
       ret = CreateErrorResponse(request.connection, handler->GetHTTPResonseCode(), request.method, response);
       break;
@@ -347,7 +356,10 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
 
   MHD_queue_response(request.connection, responseCode, response);
   MHD_destroy_response(response);
-  delete handler;
+  // a streamed response owns its handler until it has been sent, it may
+  // already have been deleted by now
+  if (responseType != HTTPStreamDownload)
+    delete handler;
 
   return MHD_YES;
 }
@@ -622,6 +634,22 @@ int CWebServer::CreateMemoryDownloadResponse(struct MHD_Connection *connection,
   return MHD_NO;
 }
 
+int CWebServer::CreateStreamDownloadResponse(struct MHD_Connection *connection, IHTTPRequestHandler *handler, struct MHD_Response *&response)
+{
+  uint64_t length = handler->GetHTTPResonseDataLength();
+  // sent with chunked transfer encoding
+  if (handler->GetHTTPResonseDataLength() == HTTP_RESPONSE_LENGTH_UNKNOWN)
+    length = MHD_SIZE_UNKNOWN;
+
+  response = MHD_create_response_from_callback(length,
+                                               2048,
+                                               &CWebServer::StreamReaderCallback, handler,
+                                               &CWebServer::StreamReaderFreeCallback);
+  if (response)
+    return MHD_YES;
+  return MHD_NO;
+}
+
 int CWebServer::SendErrorResponse(struct MHD_Connection *connection, int errorType, HTTPMethod method)
 {
   struct MHD_Response *response = NULL;
@@ -749,6 +777,30 @@ void CWebServer::ContentReaderFreeCallback(void *cls)
   delete context;
 }
 
+#if (MHD_VERSION >= 0x00090200)
+ssize_t CWebServer::StreamReaderCallback(void *cls, uint64_t pos, char *buf, size_t max)
+#elif (MHD_VERSION >= 0x00040001)
+int CWebServer::StreamReaderCallback(void *cls, uint64_t pos, char *buf, int max)
+#else   //libmicrohttpd < 0.4.0
+int CWebServer::StreamReaderCallback(void *cls, size_t pos, char *buf, int max)
+#endif
+{
+  IHTTPRequestHandler *handler = (IHTTPRequestHandler *)cls;
+  if (handler == NULL || max <= 0)
+    return -1;
+
+  size_t read = handler->ReadHTTPResponseData(buf, (size_t)max);
+  if (read == 0)
+    return -1;
+
+  return read;
+}
+
+void CWebServer::StreamReaderFreeCallback(void *cls)
+{
+  delete (IHTTPRequestHandler *)cls;
+}
+
 struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
 {
   unsigned int timeout = 60 * 60 * 24;
@@ -18,19 +18,57 @@
  *
  */
 
+#include <algorithm>
+
 #include "HTTPJsonRpcHandler.h"
 #include "interfaces/json-rpc/JSONRPC.h"
 #include "interfaces/json-rpc/JSONServiceDescription.h"
 #include "interfaces/json-rpc/JSONUtils.h"
 #include "network/WebServer.h"
-#include "utils/JSONVariantWriter.h"
+#include "threads/Atomics.h"
+#include "utils/JSONStreamWriter.h"
 #include "utils/log.h"
 
 #define MAX_STRING_POST_SIZE 20000
+#define JSONRPC_HTTP_MAX_QUEUED (256 * 1024)
+#if (MHD_VERSION >= 0x00040002) && (MHD_VERSION < 0x00090B01)
+// the webserver shares a small pool of threads between all connections,
+// a read blocking for the next part of a response would stall the others
+#define JSONRPC_HTTP_MAX_STREAMS 0
+#else
+// responses sent while their call runs, every one of them takes a thread
+// and blocks the connection's thread while it waits for the next part
+#define JSONRPC_HTTP_MAX_STREAMS 4
+#endif
 
 using namespace std;
 using namespace JSONRPC;
 
+volatile long CHTTPJsonRpcHandler::m_streams = 0;
+
+CHTTPJsonRpcHandler::CHTTPJsonRpcHandler()
+  : CThread("HTTPJsonRpc"),
+    m_isRequest(false),
+    m_transport(NULL),
+    m_streamed(false),
+    m_responseQueued(0),
+    m_responseOffset(0),
+    m_complete(false),
+    m_aborted(false)
+{ }
+
+CHTTPJsonRpcHandler::~CHTTPJsonRpcHandler()
+{
+  // the client went away or the whole response has been sent
+  {
+    CSingleLock lock(m_section);
+    m_aborted = true;
+  }
+  m_read.Set();
+  if (m_streamed)
+    StopThread(true);
+}
+
 bool CHTTPJsonRpcHandler::CheckHTTPRequest(const HTTPRequest &request)
 {
   return (request.url.compare("/jsonrpc") == 0);
@@ -38,8 +76,7 @@ bool CHTTPJsonRpcHandler::CheckHTTPRequest(const HTTPRequest &request)
 
 int CHTTPJsonRpcHandler::HandleHTTPRequest(const HTTPRequest &request)
 {
-  CHTTPClient client;
-  bool isRequest = false;
+  m_isRequest = false;
   if (request.method == POST)
   {
     string contentType = CWebServer::GetRequestHeaderValue(request.connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_CONTENT_TYPE);
@@ -51,7 +88,7 @@ int CHTTPJsonRpcHandler::HandleHTTPRequest(const HTTPRequest &request)
       return MHD_YES;
     }
 
-    isRequest = true;
+    m_isRequest = true;
   }
   else if (request.method == GET)
   {
@@ -62,31 +99,116 @@ int CHTTPJsonRpcHandler::HandleHTTPRequest(const HTTPRequest &request)
       if (argument != arguments.end() && !argument->second.empty())
       {
         m_request = argument->second;
-        isRequest = true;
+        m_isRequest = true;
       }
     }
   }
 
-  if (isRequest)
-    m_response = CJSONRPC::MethodCall(m_request, request.webserver, &client);
+  m_transport = request.webserver;
+  // the call runs while the response is being sent, see Process(). Once
+  // too many responses are streamed the call runs here and the whole
+  // response is queued before it is sent.
+  if (AtomicIncrement(&m_streams) <= JSONRPC_HTTP_MAX_STREAMS)
+  {
+    m_streamed = true;
+    Create();
+  }
   else
   {
-    // get the whole output of JSONRPC.Introspect
-    CVariant result;
-    CJSONServiceDescription::Print(result, request.webserver, &client);
-    m_response = CJSONVariantWriter::Write(result, false);
+    AtomicDecrement(&m_streams);
+    Process();
   }
 
   m_responseHeaderFields.insert(pair<string, string>("Content-Type", "application/json"));
 
-  m_request.clear();
-  
-  m_responseType = HTTPMemoryDownloadNoFreeCopy;
+  m_responseType = HTTPStreamDownload;
   m_responseCode = MHD_HTTP_OK;
 
   return MHD_YES;
 }
 
+void CHTTPJsonRpcHandler::Process()
+{
+  if (m_isRequest)
+    CJSONRPC::MethodCall(m_request, m_transport, &m_client, *this);
+  else
+  {
+    // get the whole output of JSONRPC.Introspect
+    CVariant result;
+    CJSONServiceDescription::Print(result, m_transport, &m_client);
+    CJSONStreamWriter writer(*this, false);
+    writer.Value(result, true);
+  }
+  m_request.clear();
+
+  {
+    CSingleLock lock(m_section);
+    m_complete = true;
+  }
+  m_written.Set();
+
+  if (m_streamed)
+    AtomicDecrement(&m_streams);
+}
+
+bool CHTTPJsonRpcHandler::Write(const char *data, size_t length)
+{
+  // don't get too far ahead of a slow client
+  while (true)
+  {
+    {
+      CSingleLock lock(m_section);
+      if (m_aborted)
+        return false;
+      if (m_responseQueued < JSONRPC_HTTP_MAX_QUEUED || !m_streamed)
+      {
+        m_response.push_back(string(data, length));
+        m_responseQueued += length;
+        break;
+      }
+    }
+    m_read.Wait();
+  }
+
+  m_written.Set();
+  return true;
+}
+
+size_t CHTTPJsonRpcHandler::ReadHTTPResponseData(char *buffer, size_t size)
+{
+  size_t read = 0;
+  while (read == 0)
+  {
+    {
+      CSingleLock lock(m_section);
+      while (read < size && !m_response.empty())
+      {
+        const string &chunk = m_response.front();
+        size_t length = std::min(size - read, chunk.size() - m_responseOffset);
+        memcpy(buffer + read, chunk.c_str() + m_responseOffset, length);
+        read += length;
+        m_responseOffset += length;
+
+        if (m_responseOffset >= chunk.size())
+        {
+          m_responseQueued -= chunk.size();
+          m_response.pop_front();
+          m_responseOffset = 0;
+        }
+      }
+
+      if (read == 0 && m_complete)
+        return 0;
+    }
+
+    if (read == 0)
+      m_written.Wait();
+  }
+
+  m_read.Set();
+  return read;
+}
+
 #if (MHD_VERSION >= 0x00040001)
 bool CHTTPJsonRpcHandler::appendPostData(const char *data, size_t size)
 #else
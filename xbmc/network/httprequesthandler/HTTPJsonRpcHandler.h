@@ -19,20 +19,39 @@
  *
  */
 
+#include <deque>
+
 #include "IHTTPRequestHandler.h"
 #include "interfaces/json-rpc/IClient.h"
+#include "interfaces/json-rpc/ITransportLayer.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+#include "utils/JSONStreamWriter.h"
+
+/*!
+ \brief Handles JSON-RPC requests over HTTP
 
-class CHTTPJsonRpcHandler : public IHTTPRequestHandler
+ The method call runs in a thread of its own and the response is sent with
+ chunked transfer encoding while it is serialized, at most
+ JSONRPC_HTTP_MAX_QUEUED bytes ahead of the client. At most
+ JSONRPC_HTTP_MAX_STREAMS calls run like that at a time, others run on the
+ webserver's thread and are sent once complete.
+ */
+class CHTTPJsonRpcHandler : public IHTTPRequestHandler, public IJSONOutputStream, private CThread
 {
 public:
-  CHTTPJsonRpcHandler() { };
+  CHTTPJsonRpcHandler();
+  virtual ~CHTTPJsonRpcHandler();
   
   virtual IHTTPRequestHandler* GetInstance() { return new CHTTPJsonRpcHandler(); }
   virtual bool CheckHTTPRequest(const HTTPRequest &request);
   virtual int HandleHTTPRequest(const HTTPRequest &request);
 
-  virtual void* GetHTTPResponseData() const { return (void *)m_response.c_str(); };
-  virtual size_t GetHTTPResonseDataLength() const { return m_response.size(); }
+  virtual size_t GetHTTPResonseDataLength() const { return HTTP_RESPONSE_LENGTH_UNKNOWN; }
+  virtual size_t ReadHTTPResponseData(char *buffer, size_t size);
+
+  virtual bool Write(const char *data, size_t length);
 
   virtual int GetPriority() const { return 2; }
 
@@ -43,10 +62,9 @@ protected:
   virtual bool appendPostData(const char *data, unsigned int size);
 #endif
 
-private:
-  std::string m_request;
-  std::string m_response;
+  virtual void Process();
 
+private:
   class CHTTPClient : public JSONRPC::IClient
   {
   public:
@@ -54,4 +72,21 @@ private:
     virtual int  GetAnnouncementFlags();
     virtual bool SetAnnouncementFlags(int flags);
   };
+
+  std::string m_request;
+  bool m_isRequest;
+  JSONRPC::ITransportLayer *m_transport;
+  CHTTPClient m_client;
+  bool m_streamed;
+  static volatile long m_streams;
+
+  // chunks of the response not sent yet, every chunk is freed once it has been sent
+  CCriticalSection m_section;
+  std::deque<std::string> m_response;
+  size_t m_responseQueued;
+  size_t m_responseOffset;
+  bool m_complete;
+  bool m_aborted;
+  CEvent m_written;
+  CEvent m_read;
 };
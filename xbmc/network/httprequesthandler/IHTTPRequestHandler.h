@@ -50,7 +50,8 @@ enum HTTPResponseType
   HTTPMemoryDownloadNoFreeNoCopy,
   HTTPMemoryDownloadNoFreeCopy,
   HTTPMemoryDownloadFreeNoCopy,
-  HTTPMemoryDownloadFreeCopy
+  HTTPMemoryDownloadFreeCopy,
+  HTTPStreamDownload
 };
 
 typedef struct HTTPRequest
@@ -62,6 +63,8 @@ typedef struct HTTPRequest
   CWebServer *webserver;
 } HTTPRequest;
 
+#define HTTP_RESPONSE_LENGTH_UNKNOWN ((size_t)-1)
+
 class IHTTPRequestHandler
 {
 public:
@@ -72,7 +75,23 @@ public:
   virtual int HandleHTTPRequest(const HTTPRequest &request) = 0;
   
   virtual void* GetHTTPResponseData() const { return NULL; };
+  /*!
+   \brief Length of the response data
+   \return The length in bytes, HTTP_RESPONSE_LENGTH_UNKNOWN for an
+   HTTPStreamDownload response that is sent while it is produced
+   */
   virtual size_t GetHTTPResonseDataLength() const { return 0; }
+  /*!
+   \brief Copy the next part of an HTTPStreamDownload response
+   \param buffer Buffer receiving the data
+   \param size Size of the buffer
+   \return Number of bytes copied, 0 once everything has been read
+
+   The webserver keeps the handler alive until the whole response has
+   been read and sent. The call may block until the next part has been
+   produced.
+   */
+  virtual size_t ReadHTTPResponseData(char *buffer, size_t size) { return 0; }
   virtual std::string GetHTTPRedirectUrl() const { return ""; }
   virtual std::string GetHTTPResponseFile() const { return ""; }
 
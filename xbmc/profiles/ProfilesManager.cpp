@@ -239,6 +239,9 @@ bool CProfilesManager::LoadProfile(size_t index)
   if (m_currentProfile == index)
     return true;
 
+  // close the connections kept to the databases of the old profile
+  CDatabaseManager::Get().Deinitialize();
+
   // unload any old settings
   CSettings::Get().Unload();
 
@@ -25,6 +25,7 @@
 #include "Application.h"
 #include "network/DNSNameCache.h"
 #include "filesystem/File.h"
+#include "utils/CharsetConverter.h"
 #include "utils/LangCodeExpander.h"
 #include "LangInfo.h"
 #include "profiles/ProfilesManager.h"
@@ -196,6 +197,7 @@ void CAdvancedSettings::Initialize()
   m_cddbAddress = "freedb.freedb.org";
 
   m_handleMounting = g_application.IsStandAlone();
+  m_showFileStats = false;
 
   m_fullScreenOnMovieStart = true;
   m_cachePath = "special://temp/";
@@ -313,6 +315,9 @@ void CAdvancedSettings::Initialize()
   m_curlretries = 2;
   m_curlDisableIPV6 = false;      //Certain hardware/OS combinations have trouble
                                   //with ipv6.
+  m_curlMaxHostSessions = 0;
+  m_curlParallelRanges = 0;
+  m_dirWalkHostRequests = 4;
 
   m_fullScreen = m_startFullScreen = false;
   m_showExitButton = true;
@@ -361,7 +366,11 @@ void CAdvancedSettings::Initialize()
   m_measureRefreshrate = false;
 
   m_cacheMemBufferSize = 1024 * 1024 * 20;
+  m_persistentCacheSize = 0;
   m_alwaysForceBuffer = false;
+  m_dirCacheMemorySize = 16; // MB
+  m_dirCachePersist = false;
+  m_dirCachePersistSize = 32; // MB
   m_addonPackageFolderSize = 200;
 
   m_jsonOutputCompact = true;
@@ -373,6 +382,7 @@ void CAdvancedSettings::Initialize()
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
   m_guiDirtyRegionNoFlipTimeout = 0;
+  m_guiBiDiCacheSize = 512;
   m_logEnableAirtunes = false;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
@@ -380,6 +390,8 @@ void CAdvancedSettings::Initialize()
 
   m_databaseMusic.Reset();
   m_databaseVideo.Reset();
+  m_sqliteWAL = false;
+  m_sqliteReadConnections = 2;
 
   m_pictureExtensions = ".png|.jpg|.jpeg|.bmp|.gif|.ico|.tif|.tiff|.tga|.pcx|.cbz|.zip|.cbr|.rar|.m3u|.dng|.nef|.cr2|.crw|.orf|.arw|.erf|.3fr|.dcr|.x3f|.mef|.raf|.mrw|.pef|.sr2|.rss";
   m_musicExtensions = ".nsv|.m4a|.flac|.aac|.strm|.pls|.rm|.rma|.mpa|.wav|.wma|.ogg|.mp3|.mp2|.m3u|.mod|.amf|.669|.dmf|.dsm|.far|.gdm|.imf|.it|.m15|.med|.okt|.s3m|.stm|.sfx|.ult|.uni|.xm|.sid|.ac3|.dts|.cue|.aif|.aiff|.wpl|.ape|.mac|.mpc|.mp+|.mpp|.shn|.zip|.rar|.wv|.nsf|.spc|.gym|.adx|.dsp|.adp|.ymf|.ast|.afc|.hps|.xsp|.xwav|.waa|.wvs|.wam|.gcm|.idsp|.mpdsp|.mss|.spt|.rsd|.mid|.kar|.sap|.cmc|.cmr|.dmc|.mpt|.mpd|.rmt|.tmc|.tm8|.tm2|.oga|.url|.pxml|.tta|.rss|.cm3|.cms|.dlt|.brstm|.wtv|.mka";
@@ -391,6 +403,7 @@ void CAdvancedSettings::Initialize()
   m_videoExtensions += "|.pvr";
 
   m_logLevelHint = m_logLevel = LOG_LEVEL_NORMAL;
+  m_logAsync = false;
   m_extraLogLevels = 0;
 
   #if defined(TARGET_DARWIN)
@@ -414,6 +427,8 @@ bool CAdvancedSettings::Load()
   for (unsigned int i = 0; i < m_settingsFiles.size(); i++)
     ParseSettingsFile(m_settingsFiles[i]);
   ParseSettingsFile(CProfilesManager::Get().GetUserDataItem("advancedsettings.xml"));
+
+  g_charsetConverter.SetBiDiCacheSize(m_guiBiDiCacheSize);
   return true;
 }
 
@@ -764,7 +779,11 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetInt(pElement, "curllowspeedtime", m_curllowspeedtime, 1, 1000);
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
     XMLUtils::GetBoolean(pElement,"disableipv6", m_curlDisableIPV6);
+    XMLUtils::GetUInt(pElement, "curlmaxhostsessions", m_curlMaxHostSessions, 0, 64);
+    XMLUtils::GetUInt(pElement, "curlparallelranges", m_curlParallelRanges, 0, 16);
+    XMLUtils::GetUInt(pElement, "dirwalkhostrequests", m_dirWalkHostRequests, 1, 16);
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
+    XMLUtils::GetUInt(pElement, "persistentcachesize", m_persistentCacheSize);
     XMLUtils::GetBoolean(pElement, "alwaysforcebuffer", m_alwaysForceBuffer);
   }
 
@@ -787,6 +806,14 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   if (pElement)
     XMLUtils::GetBoolean(pElement, "statfilesize", m_bHTTPDirectoryStatFilesize);
 
+  pElement = pRootElement->FirstChildElement("directorycache");
+  if (pElement)
+  {
+    XMLUtils::GetUInt(pElement, "memorysize", m_dirCacheMemorySize, 1, 1024);
+    XMLUtils::GetBoolean(pElement, "persist", m_dirCachePersist);
+    XMLUtils::GetUInt(pElement, "persistsize", m_dirCachePersistSize, 1, 1024);
+  }
+
   pElement = pRootElement->FirstChildElement("ftp");
   if (pElement)
   {
@@ -809,6 +836,10 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     CLog::SetLogLevel(g_advancedSettings.m_logLevel);
   }
 
+  // hand log lines to a writer thread instead of writing them on the caller
+  if (XMLUtils::GetBoolean(pRootElement, "asynclogging", m_logAsync))
+    CLog::SetAsync(m_logAsync);
+
   XMLUtils::GetString(pRootElement, "cddbaddress", m_cddbAddress);
 
   //airtunes + airplay
@@ -817,6 +848,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   XMLUtils::GetInt(pRootElement,     "airplayport", m_airPlayPort);  
 
   XMLUtils::GetBoolean(pRootElement, "handlemounting", m_handleMounting);
+  XMLUtils::GetBoolean(pRootElement, "showfilestats", m_showFileStats);
 
 #if defined(HAS_SDL) || defined(TARGET_WINDOWS)
   XMLUtils::GetBoolean(pRootElement, "fullscreen", m_startFullScreen);
@@ -1117,6 +1149,13 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetString(pDatabase, "name", m_databaseEpg.name);
   }
 
+  pDatabase = pRootElement->FirstChildElement("sqlite");
+  if (pDatabase)
+  {
+    XMLUtils::GetBoolean(pDatabase, "wal", m_sqliteWAL);
+    XMLUtils::GetUInt(pDatabase, "readconnections", m_sqliteReadConnections, 0, 16);
+  }
+
   pElement = pRootElement->FirstChildElement("enablemultimediakeys");
   if (pElement)
   {
@@ -1129,6 +1168,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    XMLUtils::GetUInt(pElement, "bidicachesize",            m_guiBiDiCacheSize);
   }
 
   // load in the settings overrides
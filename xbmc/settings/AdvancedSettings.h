@@ -192,6 +192,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_logLevel;
     int m_logLevelHint;
     int m_extraLogLevels;
+    bool m_logAsync;
     CStdString m_cddbAddress;
 
     //airtunes + airplay
@@ -200,6 +201,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_airPlayPort;
 
     bool m_handleMounting;
+    bool m_showFileStats;
 
     bool m_fullScreenOnMovieStart;
     CStdString m_cachePath;
@@ -305,6 +307,9 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_curllowspeedtime;
     int m_curlretries;
     bool m_curlDisableIPV6;
+    unsigned int m_curlMaxHostSessions; ///< \brief concurrent connections to a single host, 0 (default) for no limit. Over the limit a new connection waits up to 2s for one to be released
+    unsigned int m_curlParallelRanges;  ///< \brief connections to fetch a large http file with, 0 or 1 to use only one
+    unsigned int m_dirWalkHostRequests; ///< \brief directories a library scan lists at once from a single host, 4 by default, 1 to 16
 
     bool m_fullScreen;
     bool m_startFullScreen;
@@ -357,14 +362,21 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     DatabaseSettings m_databaseVideo; // advanced video database setup
     DatabaseSettings m_databaseTV;    // advanced tv database setup
     DatabaseSettings m_databaseEpg;   /*!< advanced EPG database setup */
+    bool m_sqliteWAL;                     ///< sqlite databases use the write-ahead log, readers then don't wait on writers
+    unsigned int m_sqliteReadConnections; ///< read-only connections pooled per sqlite database in WAL mode, 0 disables the pool
 
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    unsigned int m_guiBiDiCacheSize; ///< logical to visual conversions of labels kept, 0 disables the cache
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
+    unsigned int m_persistentCacheSize; ///< MB of network files kept on disk across opens, 0 disables the persistent cache
     bool m_alwaysForceBuffer;
+    unsigned int m_dirCacheMemorySize; ///< MB of directory listings kept in memory
+    bool m_dirCachePersist;            ///< keep listings cached with DIR_CACHE_ALWAYS on disk across restarts
+    unsigned int m_dirCachePersistSize; ///< MB of stored listings kept on disk
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
@@ -25,6 +25,7 @@
 
 #include "threads/Thread.h"
 #include "commons/ilog.h"
+#include "utils/JobManager.h"
 
 #include <cstdio>
 #include <cstdlib>
@@ -51,6 +52,9 @@ int main(int argc, char **argv)
   }
   int ret = RUN_ALL_TESTS();
 
+  // don't leave the workers of tests using the job manager running into static destruction
+  CJobManager::GetInstance().CancelJobs();
+
   delete nullLogger;
 
   return ret;
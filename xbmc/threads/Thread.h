@@ -62,6 +62,7 @@ public:
   int GetSchedRRPriority(void);
   bool SetPrioritySched_RR(int iPriority);
   bool IsAutoDelete() const;
+  const std::string &GetThreadName() const { return m_ThreadName; }
   virtual void StopThread(bool bWait = true);
   bool IsRunning() const;
 
@@ -0,0 +1,156 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "bench/Benchmark.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/SharedSection.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+
+#include <vector>
+
+BENCHMARK(CriticalSection, Lock)
+{
+  CCriticalSection section;
+  while (state.KeepRunning())
+  {
+    CSingleLock lock(section);
+  }
+}
+
+BENCHMARK(CriticalSection, RecursiveLock)
+{
+  CCriticalSection section;
+  CSingleLock outer(section);
+  while (state.KeepRunning())
+  {
+    CSingleLock lock(section);
+  }
+}
+
+BENCHMARK(SharedSection, Shared)
+{
+  CSharedSection section;
+  while (state.KeepRunning())
+  {
+    CSharedLock lock(section);
+  }
+}
+
+BENCHMARK(SharedSection, Exclusive)
+{
+  CSharedSection section;
+  while (state.KeepRunning())
+  {
+    CExclusiveLock lock(section);
+  }
+}
+
+class CSharedReader : public IRunnable
+{
+public:
+  CSharedReader(CSharedSection &section, volatile bool &stop) : m_section(section), m_stop(stop) {}
+  virtual void Run()
+  {
+    while (!m_stop)
+    {
+      CSharedLock lock(m_section);
+    }
+  }
+private:
+  CSharedSection &m_section;
+  volatile bool &m_stop;
+};
+
+BENCHMARK(SharedSection, SharedContended)
+{
+  CSharedSection section;
+  volatile bool stop = false;
+  CSharedReader reader(section, stop);
+  std::vector<CThread*> threads;
+  for (int i = 0; i < 3; i++)
+  {
+    threads.push_back(new CThread(&reader, "BenchmarkReader"));
+    threads.back()->Create();
+  }
+
+  while (state.KeepRunning())
+  {
+    CSharedLock lock(section);
+  }
+
+  stop = true;
+  for (std::vector<CThread*>::iterator it = threads.begin(); it != threads.end(); ++it)
+  {
+    (*it)->StopThread();
+    delete *it;
+  }
+}
+
+BENCHMARK(Event, SetWait)
+{
+  CEvent event;
+  while (state.KeepRunning())
+  {
+    event.Set();
+    event.Wait();
+  }
+}
+
+class CEventPong : public IRunnable
+{
+public:
+  CEventPong(CEvent &ping, CEvent &pong, volatile bool &stop) : m_ping(ping), m_pong(pong), m_stop(stop) {}
+  virtual void Run()
+  {
+    while (true)
+    {
+      m_ping.Wait();
+      if (m_stop)
+        break;
+      m_pong.Set();
+    }
+  }
+private:
+  CEvent &m_ping;
+  CEvent &m_pong;
+  volatile bool &m_stop;
+};
+
+BENCHMARK(Event, PingPong)
+{
+  // round trip latency of waking up another thread and being woken up again
+  CEvent ping, pong;
+  volatile bool stop = false;
+  CEventPong runnable(ping, pong, stop);
+  CThread thread(&runnable, "BenchmarkPong");
+  thread.Create();
+
+  while (state.KeepRunning())
+  {
+    ping.Set();
+    pong.Wait();
+  }
+
+  stop = true;
+  ping.Set();
+  thread.StopThread();
+}
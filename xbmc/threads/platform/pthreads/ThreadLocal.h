@@ -34,6 +34,12 @@ namespace XbmcThreads
   public:
     inline ThreadLocal() : key(0) { pthread_key_create(&key,NULL); }
 
+    /**
+     * cleanup is called with the thread's (non NULL) value when a
+     * thread exits.
+     */
+    inline ThreadLocal(void (*cleanup)(T*)) : key(0) { pthread_key_create(&key,(void (*)(void*))cleanup); }
+
     inline ~ThreadLocal() { pthread_key_delete(key); }
 
     inline void set(T* val) { pthread_setspecific(key,(void*)val); }
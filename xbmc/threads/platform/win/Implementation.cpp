@@ -19,6 +19,7 @@
  */
 
 #include "threads/Condition.h"
+#include "threads/ThreadLocal.h"
 
 namespace XbmcThreads
 {
@@ -49,6 +50,44 @@ namespace XbmcThreads
         WakeAllConditionVariableProc != NULL &&
         WakeConditionVariableProc != NULL;
     }
+
+    FlsVista::AllocProc FlsVista::FlsAllocProc;
+    FlsVista::FreeProc FlsVista::FlsFreeProc;
+    FlsVista::GetValueProc FlsVista::FlsGetValueProc;
+    FlsVista::SetValueProc FlsVista::FlsSetValueProc;
+
+    bool FlsVista::setFlsFuncs()
+    {
+      HMODULE mod = GetModuleHandle("Kernel32");
+
+      if (mod == NULL)
+        return false;
+
+      FlsAllocProc = (AllocProc)GetProcAddress(mod,"FlsAlloc");
+      FlsFreeProc = (FreeProc)GetProcAddress(mod,"FlsFree");
+      FlsGetValueProc = (GetValueProc)GetProcAddress(mod,"FlsGetValue");
+      FlsSetValueProc = (SetValueProc)GetProcAddress(mod,"FlsSetValue");
+
+      return FlsAllocProc != NULL &&
+        FlsFreeProc != NULL &&
+        FlsGetValueProc != NULL &&
+        FlsSetValueProc != NULL;
+    }
+
+    bool FlsVista::getAvailable()
+    {
+      if (!isAvailableSet)
+      {
+        available = setFlsFuncs();
+        isAvailableSet = true;
+      }
+
+      return available;
+    }
+
+    bool FlsVista::available = getAvailable();
+    // bss segment nulled out by loader.
+    bool FlsVista::isAvailableSet;
   }
 
   bool ConditionVariable::getIsVista()
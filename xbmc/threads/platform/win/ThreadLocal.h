@@ -25,22 +25,96 @@
 
 namespace XbmcThreads
 {
+  namespace intern
+  {
+    /**
+     * Fiber local storage, the only Windows thread storage with an exit
+     * notification, is Vista and later. As for ConditionVariableVista the
+     * functions are looked up at runtime so that XP builds still load.
+     */
+    class FlsVista
+    {
+    public:
+      typedef VOID (NTAPI *Callback)(PVOID);
+      typedef DWORD (WINAPI *AllocProc)(Callback);
+      typedef BOOL (WINAPI *FreeProc)(DWORD);
+      typedef PVOID (WINAPI *GetValueProc)(DWORD);
+      typedef BOOL (WINAPI *SetValueProc)(DWORD, PVOID);
+
+      static const DWORD OutOfIndexes = (DWORD)0xFFFFFFFF;
+
+      static AllocProc FlsAllocProc;
+      static FreeProc FlsFreeProc;
+      static GetValueProc FlsGetValueProc;
+      static SetValueProc FlsSetValueProc;
+
+      /**
+       * \return true if the Fls* functions were resolved.
+       */
+      static inline bool isAvailable() { return isAvailableSet ? available : getAvailable(); }
+
+    private:
+      // stupid hack for statics
+      static bool isAvailableSet;
+      static bool available;
+      static bool getAvailable();
+      static bool setFlsFuncs();
+    };
+  }
+
   /**
    * A thin wrapper around windows thread specific storage
    * functionality.
    */
   template <typename T> class ThreadLocal
   {
+    /**
+     * What an exiting thread has to clean up, kept in a fiber local
+     * slot whose callback runs on thread exit.
+     */
+    struct ExitNode
+    {
+      void (*cleanup)(T*);
+      T* value;
+    };
+
+    static VOID NTAPI OnExit(PVOID data)
+    {
+      ExitNode* node = (ExitNode*)data;
+      if (node->value)
+        node->cleanup(node->value);
+      delete node;
+    }
+
     DWORD key;
+    DWORD exitKey;
+    void (*cleanup)(T*);
   public:
-    inline ThreadLocal()
+    inline ThreadLocal() : exitKey(intern::FlsVista::OutOfIndexes), cleanup(NULL)
     {
        if ((key = TlsAlloc()) == TLS_OUT_OF_INDEXES)
           throw XbmcCommons::UncheckedException("Ran out of Windows TLS Indexes. Windows Error Code %d",(int)GetLastError());
     }
 
+    /**
+     * cleanup is called with the value of every exiting thread. This
+     * needs fiber local storage; on XP cleanup is never called and the
+     * values of exited threads leak.
+     */
+    inline ThreadLocal(void (*cleanup_)(T*)) : exitKey(intern::FlsVista::OutOfIndexes), cleanup(cleanup_)
+    {
+       if ((key = TlsAlloc()) == TLS_OUT_OF_INDEXES)
+          throw XbmcCommons::UncheckedException("Ran out of Windows TLS Indexes. Windows Error Code %d",(int)GetLastError());
+       if (intern::FlsVista::isAvailable() &&
+           (exitKey = (*intern::FlsVista::FlsAllocProc)(OnExit)) == intern::FlsVista::OutOfIndexes)
+          throw XbmcCommons::UncheckedException("Ran out of Windows FLS Indexes. Windows Error Code %d",(int)GetLastError());
+    }
+
     inline ~ThreadLocal() 
     {
+       // freeing the FLS slot runs the callback for the threads still alive
+       if (exitKey != intern::FlsVista::OutOfIndexes)
+          (*intern::FlsVista::FlsFreeProc)(exitKey);
        if (!TlsFree(key))
           throw XbmcCommons::UncheckedException("Failed to free Tls %d, Windows Error Code %d",(int)key, (int)GetLastError());
     }
@@ -49,9 +123,26 @@ namespace XbmcThreads
     {
        if (!TlsSetValue(key,(LPVOID)val))
           throw XbmcCommons::UncheckedException("Failed to set Tls %d, Windows Error Code %d",(int)key, (int)GetLastError());
+
+       if (exitKey != intern::FlsVista::OutOfIndexes)
+       {
+          ExitNode* node = (ExitNode*)(*intern::FlsVista::FlsGetValueProc)(exitKey);
+          if (node)
+             node->value = val;
+          else if (val)
+          {
+             node = new ExitNode;
+             node->cleanup = cleanup;
+             node->value = val;
+             if (!(*intern::FlsVista::FlsSetValueProc)(exitKey,node))
+             {
+                delete node;
+                throw XbmcCommons::UncheckedException("Failed to set Fls %d, Windows Error Code %d",(int)exitKey, (int)GetLastError());
+             }
+          }
+       }
     }
 
     inline T* get() { return (T*)TlsGetValue(key); }
   };
 }
-
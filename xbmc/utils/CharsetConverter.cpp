@@ -24,11 +24,19 @@
 #include "LangInfo.h"
 #include "guilib/LocalizeStrings.h"
 #include "settings/Setting.h"
+#include "threads/Atomics.h"
 #include "threads/SingleLock.h"
+#include "threads/ThreadLocal.h"
 #include "log.h"
 
 #include <errno.h>
 #include <iconv.h>
+#include <list>
+#include <map>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #if defined(TARGET_DARWIN)
 #ifdef __POWERPC__
@@ -55,18 +63,25 @@
 #endif
 
 
-static iconv_t m_iconvStringCharsetToFontCharset = (iconv_t)-1;
-static iconv_t m_iconvSubtitleCharsetToW         = (iconv_t)-1;
-static iconv_t m_iconvUtf8ToStringCharset        = (iconv_t)-1;
-static iconv_t m_iconvStringCharsetToUtf8        = (iconv_t)-1;
-static iconv_t m_iconvUcs2CharsetToStringCharset = (iconv_t)-1;
-static iconv_t m_iconvUtf32ToStringCharset       = (iconv_t)-1;
-static iconv_t m_iconvWtoUtf8                    = (iconv_t)-1;
-static iconv_t m_iconvUtf16LEtoW                 = (iconv_t)-1;
-static iconv_t m_iconvUtf16BEtoUtf8              = (iconv_t)-1;
-static iconv_t m_iconvUtf16LEtoUtf8              = (iconv_t)-1;
-static iconv_t m_iconvUtf8toW                    = (iconv_t)-1;
-static iconv_t m_iconvUcs2CharsetToUtf8          = (iconv_t)-1;
+// default number of BiDi conversions kept by CBiDiCache
+#define BIDI_CACHE_SIZE 512
+
+// conversions with a fixed pair of charsets, each thread has its own iconv handle for them
+enum ConverterType
+{
+  SubtitleCharsetToW = 0,
+  Utf8ToStringCharset,
+  StringCharsetToUtf8,
+  Ucs2CharsetToStringCharset,
+  Utf32ToStringCharset,
+  WtoUtf8,
+  Utf16LEtoW,
+  Utf16BEtoUtf8,
+  Utf16LEtoUtf8,
+  Utf8toW,
+  Ucs2CharsetToUtf8,
+  NumberOfConverters
+};
 
 #if defined(FRIBIDI_CHAR_SET_NOT_FOUND)
 static FriBidiCharSet m_stringFribidiCharset     = FRIBIDI_CHAR_SET_NOT_FOUND;
@@ -78,6 +93,7 @@ static FriBidiCharSet m_stringFribidiCharset     = FRIBIDI_CHARSET_NOT_FOUND;
 #define FRIBIDI_NOTFOUND FRIBIDI_CHARSET_NOT_FOUND
 #endif
 
+// protects fribidi, which isn't threadsafe, and m_stringFribidiCharset
 static CCriticalSection            m_critSection;
 
 static struct SFribidMapping
@@ -142,6 +158,348 @@ static struct SCharsetMapping
 #define ICONV_PREPARE(iconv) iconv=(iconv_t)-1
 #define ICONV_SAFE_CLOSE(iconv) if (iconv!=(iconv_t)-1) { iconv_close(iconv); iconv=(iconv_t)-1; }
 
+/*!
+ \brief The iconv handles of one thread
+
+ An iconv handle carries conversion state, so sharing one between threads
+ would need a lock around every conversion. reset() bumps the generation,
+ making every thread reopen its handles on the next conversion.
+ */
+struct CConverterHandles
+{
+  CConverterHandles(long generation) : generation(generation)
+  {
+    for (int i = 0; i < NumberOfConverters; i++)
+      ICONV_PREPARE(handles[i]);
+  }
+
+  ~CConverterHandles() { Close(); }
+
+  void Close()
+  {
+    for (int i = 0; i < NumberOfConverters; i++)
+      ICONV_SAFE_CLOSE(handles[i]);
+  }
+
+  iconv_t handles[NumberOfConverters];
+  long generation;
+};
+
+static volatile long m_handlesGeneration = 0;
+
+static void ReleaseConverterHandles(CConverterHandles *handles)
+{
+  delete handles;
+}
+
+static iconv_t& GetConverterHandle(ConverterType type)
+{
+  // never destroyed, conversions may still happen during static destruction
+  static XbmcThreads::ThreadLocal<CConverterHandles> *threadHandles =
+    new XbmcThreads::ThreadLocal<CConverterHandles>(ReleaseConverterHandles);
+
+  long generation = AtomicAdd(&m_handlesGeneration, 0);
+  CConverterHandles *handles = threadHandles->get();
+  if (handles == NULL)
+  {
+    handles = new CConverterHandles(generation);
+    threadHandles->set(handles);
+  }
+  else if (handles->generation != generation)
+  {
+    handles->Close();
+    handles->generation = generation;
+  }
+  return handles->handles[type];
+}
+
+/*!
+ \brief Bounded LRU cache of logical to visual BiDi conversions
+
+ Skins redraw the same right-to-left labels every frame, running them all
+ through fribidi again is expensive (and serialized by m_critSection).
+ */
+class CBiDiCache
+{
+public:
+  CBiDiCache() : m_maxSize(BIDI_CACHE_SIZE) { }
+
+  bool Get(const CStdStringA &source, FriBidiCharSet charset, FriBidiCharType base, CStdStringA &dest, bool *bWasFlipped)
+  {
+    CSingleLock lock(m_section);
+    if (m_maxSize == 0)
+      return false;
+
+    Map::iterator it = m_map.find(Key(source, charset, base));
+    if (it == m_map.end())
+      return false;
+
+    // move to the front, it's the most recently used entry now
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    dest = it->second->second.first;
+    if (bWasFlipped)
+      *bWasFlipped = it->second->second.second;
+    return true;
+  }
+
+  void Add(const CStdStringA &source, FriBidiCharSet charset, FriBidiCharType base, const CStdStringA &dest, bool bWasFlipped)
+  {
+    CSingleLock lock(m_section);
+    if (m_maxSize == 0)
+      return;
+
+    Key key(source, charset, base);
+    if (m_map.find(key) != m_map.end())
+      return; // converted by another thread in the meantime
+
+    m_entries.push_front(make_pair(key, make_pair(dest, bWasFlipped)));
+    m_map.insert(make_pair(key, m_entries.begin()));
+    Trim();
+  }
+
+  void SetMaxSize(unsigned int maxSize)
+  {
+    CSingleLock lock(m_section);
+    m_maxSize = maxSize;
+    Trim();
+  }
+
+  void Clear()
+  {
+    CSingleLock lock(m_section);
+    m_map.clear();
+    m_entries.clear();
+  }
+
+private:
+  struct Key
+  {
+    Key(const CStdStringA &source, FriBidiCharSet charset, FriBidiCharType base)
+      : source(source), charset(charset), base(base)
+    { }
+
+    bool operator<(const Key &right) const
+    {
+      if (base != right.base)
+        return base < right.base;
+      if (charset != right.charset)
+        return charset < right.charset;
+      return source < right.source;
+    }
+
+    CStdStringA source;
+    FriBidiCharSet charset;
+    FriBidiCharType base;
+  };
+
+  typedef std::list< std::pair<Key, std::pair<CStdStringA, bool> > > Entries;
+  typedef std::map<Key, Entries::iterator> Map;
+
+  void Trim()
+  {
+    while (m_map.size() > m_maxSize)
+    {
+      m_map.erase(m_entries.back().first);
+      m_entries.pop_back();
+    }
+  }
+
+  CCriticalSection m_section;
+  unsigned int m_maxSize;
+  Entries m_entries; ///< most recently used first
+  Map m_map;
+};
+
+static CBiDiCache &GetBiDiCache()
+{
+  // never destroyed, see GetConverterHandle()
+  static CBiDiCache *cache = new CBiDiCache();
+  return *cache;
+}
+
+/*!
+ \brief Length of the pure ASCII prefix of buf
+ */
+static size_t AsciiPrefixLength(const char *buf, size_t len)
+{
+  size_t pos = 0;
+#ifdef __SSE2__
+  // the sign bits of 16 bytes at once, non zero as soon as one isn't ASCII
+  for (; pos + 16 <= len; pos += 16)
+  {
+    if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(buf + pos))) != 0)
+      break;
+  }
+#else
+  for (; pos + sizeof(unsigned long) <= len; pos += sizeof(unsigned long))
+  {
+    unsigned long word;
+    memcpy(&word, buf + pos, sizeof(word));
+    if (word & ((unsigned long)-1 / 0xff * 0x80))
+      break;
+  }
+#endif
+  while (pos < len && !(buf[pos] & 0x80))
+    pos++;
+  return pos;
+}
+
+/*!
+ \brief Decode one well-formed (RFC 3629) multi byte UTF-8 sequence
+ \return The length of the sequence, 0 if it is malformed, overlong or a surrogate
+ */
+static size_t DecodeUtf8Sequence(const unsigned char *buf, size_t len, uint32_t &c)
+{
+  unsigned char lead = buf[0];
+  unsigned char low = 0x80, high = 0xbf; // range of the second byte
+  size_t length;
+  if (lead >= 0xc2 && lead <= 0xdf)
+  {
+    length = 2;
+    c = lead & 0x1f;
+  }
+  else if (lead >= 0xe0 && lead <= 0xef)
+  {
+    length = 3;
+    c = lead & 0x0f;
+    if (lead == 0xe0)
+      low = 0xa0;
+    else if (lead == 0xed)
+      high = 0x9f;
+  }
+  else if (lead >= 0xf0 && lead <= 0xf4)
+  {
+    length = 4;
+    c = lead & 0x07;
+    if (lead == 0xf0)
+      low = 0x90;
+    else if (lead == 0xf4)
+      high = 0x8f;
+  }
+  else
+    return 0;
+
+  if (len < length || buf[1] < low || buf[1] > high)
+    return 0;
+
+  for (size_t i = 1; i < length; i++)
+  {
+    if ((buf[i] & 0xc0) != 0x80)
+      return 0;
+    c = (c << 6) | (buf[i] & 0x3f);
+  }
+  return length;
+}
+
+/*!
+ \brief Whether fribidi might reorder or strip the character
+
+ Deliberately coarse: the right-to-left blocks, their presentation forms
+ and the explicit directional marks.
+ */
+static inline bool IsBiDiCharacter(uint32_t c)
+{
+  return (c >= 0x0590 && c <= 0x08ff) ||
+         c == 0x180e ||
+         (c >= 0x200e && c <= 0x200f) ||
+         (c >= 0x202a && c <= 0x202e) ||
+         (c >= 0x2066 && c <= 0x206f) ||
+         (c >= 0xfb1d && c <= 0xfdff) ||
+         (c >= 0xfe70 && c <= 0xfeff) ||
+         (c >= 0xfff0 && c <= 0xfff8) ||
+         (c >= 0x10800 && c <= 0x10fff) ||
+         (c >= 0x1bca0 && c <= 0x1bca3) ||
+         (c >= 0x1d173 && c <= 0x1d17a) ||
+         (c >= 0x1e800 && c <= 0x1efff) ||
+         (c >= 0xe0000 && c <= 0xe0fff);
+}
+
+/*!
+ \brief Whether the character is one of the common boundary neutrals
+
+ fribidi_remove_bidi_marks() strips every boundary neutral character, the
+ fast path strips these itself: the control characters, the soft hyphen,
+ the zero width space and joiners and the invisible operators. The rarer
+ ones are left to fribidi by IsBiDiCharacter().
+ */
+static inline bool IsBoundaryNeutral(uint32_t c)
+{
+  return c <= 0x08 ||
+         (c >= 0x0e && c <= 0x1b) ||
+         (c >= 0x7f && c <= 0x84) ||
+         (c >= 0x86 && c <= 0x9f) ||
+         c == 0xad ||
+         (c >= 0x200b && c <= 0x200d) ||
+         (c >= 0x2060 && c <= 0x2064);
+}
+
+/*!
+ \brief Convert UTF-8 to wchar_t without iconv and fribidi
+
+ Only handles input for which the result is known to be identical to the
+ iconv path: well-formed UTF-8 and, if bVisualBiDiFlip is set, without any
+ character fribidi could reorder. Like the fribidi path it drops newlines
+ and boundary neutral characters in that case.
+ \return false if the string has to be converted the slow way
+ */
+static bool utf8ToWFast(const CStdStringA& utf8String, CStdStringW& wString, bool bVisualBiDiFlip)
+{
+  // iconv stops at an embedded NUL as well
+  const unsigned char *buf = (const unsigned char *)utf8String.c_str();
+  size_t len = strlen(utf8String.c_str());
+  if (len == 0)
+  {
+    wString.clear();
+    return true;
+  }
+
+  // never more wchar_t's than bytes, even for surrogate pairs
+  wchar_t *dest = wString.GetBuffer(len);
+  size_t written = 0;
+  size_t pos = 0;
+  while (pos < len)
+  {
+    size_t end = pos + AsciiPrefixLength((const char *)buf + pos, len - pos);
+    for (; pos < end; pos++)
+    {
+      if (!bVisualBiDiFlip || (buf[pos] != '\n' && !IsBoundaryNeutral(buf[pos])))
+        dest[written++] = buf[pos];
+    }
+    if (pos == len)
+      break;
+
+#if defined(TARGET_DARWIN)
+    // UTF-8-MAC composes decomposed characters, leave anything but ASCII to iconv
+    wString.ReleaseBuffer(0);
+    return false;
+#else
+    uint32_t c;
+    size_t length = DecodeUtf8Sequence(buf + pos, len - pos, c);
+    if (length == 0 || (bVisualBiDiFlip && IsBiDiCharacter(c)))
+    {
+      wString.ReleaseBuffer(0);
+      return false;
+    }
+    pos += length;
+
+    if (bVisualBiDiFlip && IsBoundaryNeutral(c))
+      continue;
+
+    if (sizeof(wchar_t) == 2 && c >= 0x10000)
+    {
+      c -= 0x10000;
+      dest[written++] = (wchar_t)(0xd800 + (c >> 10));
+      dest[written++] = (wchar_t)(0xdc00 + (c & 0x3ff));
+    }
+    else
+      dest[written++] = (wchar_t)c;
+#endif
+  }
+
+  wString.ReleaseBuffer(written);
+  return true;
+}
+
 size_t iconv_const (void* cd, const char** inbuf, size_t *inbytesleft,
                     char* * outbuf, size_t *outbytesleft)
 {
@@ -275,7 +633,7 @@ static void convert(iconv_t& type, int multiplier, const CStdString& strFromChar
 
 using namespace std;
 
-static void logicalToVisualBiDi(const CStdStringA& strSource, CStdStringA& strDest, FriBidiCharSet fribidiCharset, FriBidiCharType base = FRIBIDI_TYPE_LTR, bool* bWasFlipped =NULL)
+static void logicalToVisualBiDiUncached(const CStdStringA& strSource, CStdStringA& strDest, FriBidiCharSet fribidiCharset, FriBidiCharType base, bool* bWasFlipped)
 {
   // libfribidi is not threadsafe, so make sure we make it so
   CSingleLock lock(m_critSection);
@@ -337,6 +695,22 @@ static void logicalToVisualBiDi(const CStdStringA& strSource, CStdStringA& strDe
   strDest = resultString;
 }
 
+static void logicalToVisualBiDi(const CStdStringA& strSource, CStdStringA& strDest, FriBidiCharSet fribidiCharset, FriBidiCharType base = FRIBIDI_TYPE_LTR, bool* bWasFlipped =NULL)
+{
+  CBiDiCache &cache = GetBiDiCache();
+  if (cache.Get(strSource, fribidiCharset, base, strDest, bWasFlipped))
+    return;
+
+  // strSource and strDest may be the same string
+  CStdStringA source(strSource);
+  bool flipped = false;
+  logicalToVisualBiDiUncached(source, strDest, fribidiCharset, base, &flipped);
+  cache.Add(source, fribidiCharset, base, strDest, flipped);
+
+  if (bWasFlipped)
+    *bWasFlipped = flipped;
+}
+
 CCharsetConverter::CCharsetConverter()
 {
 }
@@ -401,20 +775,11 @@ bool CCharsetConverter::isBidiCharset(const CStdString& charset)
 
 void CCharsetConverter::reset(void)
 {
-  CSingleLock lock(m_critSection);
-
-  ICONV_SAFE_CLOSE(m_iconvStringCharsetToFontCharset);
-  ICONV_SAFE_CLOSE(m_iconvUtf8ToStringCharset);
-  ICONV_SAFE_CLOSE(m_iconvStringCharsetToUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUcs2CharsetToStringCharset);
-  ICONV_SAFE_CLOSE(m_iconvSubtitleCharsetToW);
-  ICONV_SAFE_CLOSE(m_iconvWtoUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUtf16BEtoUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUtf16LEtoUtf8);
-  ICONV_SAFE_CLOSE(m_iconvUtf32ToStringCharset);
-  ICONV_SAFE_CLOSE(m_iconvUtf8toW);
-  ICONV_SAFE_CLOSE(m_iconvUcs2CharsetToUtf8);
+  // every thread reopens its iconv handles on its next conversion
+  AtomicIncrement(&m_handlesGeneration);
+  GetBiDiCache().Clear();
 
+  CSingleLock lock(m_critSection);
 
   m_stringFribidiCharset = FRIBIDI_NOTFOUND;
 
@@ -430,27 +795,30 @@ void CCharsetConverter::reset(void)
 // of the string is already made or the string is not displayed in the GUI
 void CCharsetConverter::utf8ToW(const CStdStringA& utf8String, CStdStringW &wString, bool bVisualBiDiFlip/*=true*/, bool forceLTRReadingOrder /*=false*/, bool* bWasFlipped/*=NULL*/)
 {
+  // most labels are ASCII or left-to-right text, which needs neither fribidi nor iconv
+  if (utf8ToWFast(utf8String, wString, bVisualBiDiFlip))
+  {
+    if (bVisualBiDiFlip && bWasFlipped)
+      *bWasFlipped = false;
+    return;
+  }
+
   // Try to flip hebrew/arabic characters, if any
   if (bVisualBiDiFlip)
   {
     CStdStringA strFlipped;
     FriBidiCharType charset = forceLTRReadingOrder ? FRIBIDI_TYPE_LTR : FRIBIDI_TYPE_PDF;
     logicalToVisualBiDi(utf8String, strFlipped, FRIBIDI_UTF8, charset, bWasFlipped);
-    CSingleLock lock(m_critSection);
-    convert(m_iconvUtf8toW,sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,strFlipped,wString);
+    convert(GetConverterHandle(Utf8toW),sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,strFlipped,wString);
   }
   else
-  {
-    CSingleLock lock(m_critSection);
-    convert(m_iconvUtf8toW,sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,utf8String,wString);
-  }
+    convert(GetConverterHandle(Utf8toW),sizeof(wchar_t),UTF8_SOURCE,WCHAR_CHARSET,utf8String,wString);
 }
 
 void CCharsetConverter::subtitleCharsetToW(const CStdStringA& strSource, CStdStringW& strDest)
 {
   // No need to flip hebrew/arabic as mplayer does the flipping
-  CSingleLock lock(m_critSection);
-  convert(m_iconvSubtitleCharsetToW,sizeof(wchar_t),g_langInfo.GetSubtitleCharSet(),WCHAR_CHARSET,strSource,strDest);
+  convert(GetConverterHandle(SubtitleCharsetToW),sizeof(wchar_t),g_langInfo.GetSubtitleCharSet(),WCHAR_CHARSET,strSource,strDest);
 }
 
 void CCharsetConverter::fromW(const CStdStringW& strSource,
@@ -473,8 +841,7 @@ void CCharsetConverter::toW(const CStdStringA& strSource,
 
 void CCharsetConverter::utf8ToStringCharset(const CStdStringA& strSource, CStdStringA& strDest)
 {
-  CSingleLock lock(m_critSection);
-  convert(m_iconvUtf8ToStringCharset,1,UTF8_SOURCE,g_langInfo.GetGuiCharSet(),strSource,strDest);
+  convert(GetConverterHandle(Utf8ToStringCharset),1,UTF8_SOURCE,g_langInfo.GetGuiCharSet(),strSource,strDest);
 }
 
 void CCharsetConverter::utf8ToStringCharset(CStdStringA& strSourceDest)
@@ -535,44 +902,36 @@ void CCharsetConverter::unknownToUTF8(const CStdStringA &source, CStdStringA &de
   if (isValidUtf8(source))
     dest = source;
   else
-  {
-    CSingleLock lock(m_critSection);
-    convert(m_iconvStringCharsetToUtf8, UTF8_DEST_MULTIPLIER, g_langInfo.GetGuiCharSet(), "UTF-8", source, dest);
-  }
+    convert(GetConverterHandle(StringCharsetToUtf8), UTF8_DEST_MULTIPLIER, g_langInfo.GetGuiCharSet(), "UTF-8", source, dest);
 }
 
 void CCharsetConverter::wToUTF8(const CStdStringW& strSource, CStdStringA &strDest)
 {
-  CSingleLock lock(m_critSection);
-  convert(m_iconvWtoUtf8,UTF8_DEST_MULTIPLIER,WCHAR_CHARSET,"UTF-8",strSource,strDest);
+  convert(GetConverterHandle(WtoUtf8),UTF8_DEST_MULTIPLIER,WCHAR_CHARSET,"UTF-8",strSource,strDest);
 }
 
 void CCharsetConverter::utf16BEtoUTF8(const CStdString16& strSource, CStdStringA &strDest)
 {
-  CSingleLock lock(m_critSection);
-  if(!convert_checked(m_iconvUtf16BEtoUtf8,UTF8_DEST_MULTIPLIER,"UTF-16BE","UTF-8",strSource,strDest))
+  if(!convert_checked(GetConverterHandle(Utf16BEtoUtf8),UTF8_DEST_MULTIPLIER,"UTF-16BE","UTF-8",strSource,strDest))
     strDest.clear();
 }
 
 void CCharsetConverter::utf16LEtoUTF8(const CStdString16& strSource,
                                       CStdStringA &strDest)
 {
-  CSingleLock lock(m_critSection);
-  if(!convert_checked(m_iconvUtf16LEtoUtf8,UTF8_DEST_MULTIPLIER,"UTF-16LE","UTF-8",strSource,strDest))
+  if(!convert_checked(GetConverterHandle(Utf16LEtoUtf8),UTF8_DEST_MULTIPLIER,"UTF-16LE","UTF-8",strSource,strDest))
     strDest.clear();
 }
 
 void CCharsetConverter::ucs2ToUTF8(const CStdString16& strSource, CStdStringA& strDest)
 {
-  CSingleLock lock(m_critSection);
-  if(!convert_checked(m_iconvUcs2CharsetToUtf8,UTF8_DEST_MULTIPLIER,"UCS-2LE","UTF-8",strSource,strDest))
+  if(!convert_checked(GetConverterHandle(Ucs2CharsetToUtf8),UTF8_DEST_MULTIPLIER,"UCS-2LE","UTF-8",strSource,strDest))
     strDest.clear();
 }
 
 void CCharsetConverter::utf16LEtoW(const CStdString16& strSource, CStdStringW &strDest)
 {
-  CSingleLock lock(m_critSection);
-  if(!convert_checked(m_iconvUtf16LEtoW,sizeof(wchar_t),"UTF-16LE",WCHAR_CHARSET,strSource,strDest))
+  if(!convert_checked(GetConverterHandle(Utf16LEtoW),sizeof(wchar_t),"UTF-16LE",WCHAR_CHARSET,strSource,strDest))
     strDest.clear();
 }
 
@@ -593,22 +952,21 @@ void CCharsetConverter::ucs2CharsetToStringCharset(const CStdStringW& strSource,
       s++;
     }
   }
-  CSingleLock lock(m_critSection);
-  convert(m_iconvUcs2CharsetToStringCharset,4,"UTF-16LE",
+  convert(GetConverterHandle(Ucs2CharsetToStringCharset),4,"UTF-16LE",
           g_langInfo.GetGuiCharSet(),strCopy,strDest);
 }
 
 void CCharsetConverter::utf32ToStringCharset(const unsigned long* strSource, CStdStringA& strDest)
 {
-  CSingleLock lock(m_critSection);
+  iconv_t &iconvUtf32ToStringCharset = GetConverterHandle(Utf32ToStringCharset);
 
-  if (m_iconvUtf32ToStringCharset == (iconv_t) - 1)
+  if (iconvUtf32ToStringCharset == (iconv_t) - 1)
   {
     CStdString strCharset=g_langInfo.GetGuiCharSet();
-    m_iconvUtf32ToStringCharset = iconv_open(strCharset.c_str(), "UTF-32LE");
+    iconvUtf32ToStringCharset = iconv_open(strCharset.c_str(), "UTF-32LE");
   }
 
-  if (m_iconvUtf32ToStringCharset != (iconv_t) - 1)
+  if (iconvUtf32ToStringCharset != (iconv_t) - 1)
   {
     const unsigned long* ptr=strSource;
     while (*ptr) ptr++;
@@ -618,7 +976,7 @@ void CCharsetConverter::utf32ToStringCharset(const unsigned long* strSource, CSt
     char *dst = strDest.GetBuffer(inBytes);
     size_t outBytes = inBytes;
 
-    if (iconv_const(m_iconvUtf32ToStringCharset, &src, &inBytes, &dst, &outBytes) == (size_t)-1)
+    if (iconv_const(iconvUtf32ToStringCharset, &src, &inBytes, &dst, &outBytes) == (size_t)-1)
     {
       CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
       strDest.ReleaseBuffer();
@@ -626,7 +984,7 @@ void CCharsetConverter::utf32ToStringCharset(const unsigned long* strSource, CSt
       return;
     }
 
-    if (iconv(m_iconvUtf32ToStringCharset, NULL, NULL, &dst, &outBytes) == (size_t)-1)
+    if (iconv(iconvUtf32ToStringCharset, NULL, NULL, &dst, &outBytes) == (size_t)-1)
     {
       CLog::Log(LOGERROR, "%s failed cleanup", __FUNCTION__);
       strDest.ReleaseBuffer();
@@ -648,6 +1006,11 @@ void CCharsetConverter::utf8ToSystem(CStdStringA& strSourceDest)
 // Taken from RFC2640
 bool CCharsetConverter::isValidUtf8(const char *buf, unsigned int len)
 {
+  // skip the (often complete) ASCII prefix in bulk
+  size_t ascii = AsciiPrefixLength(buf, len);
+  buf += ascii;
+  len -= ascii;
+
   const unsigned char *endbuf = (unsigned char*)buf + len;
   unsigned char byte2mask=0x00, c;
   int trailing=0; // trailing (continuation) bytes to follow
@@ -716,6 +1079,11 @@ void CCharsetConverter::utf8logicalToVisualBiDi(const CStdStringA& strSource, CS
   logicalToVisualBiDi(strSource, strDest, FRIBIDI_UTF8, FRIBIDI_TYPE_RTL);
 }
 
+void CCharsetConverter::SetBiDiCacheSize(unsigned int entries)
+{
+  GetBiDiCache().SetMaxSize(entries);
+}
+
 void CCharsetConverter::SettingOptionsCharsetsFiller(const CSetting *setting, std::vector< std::pair<std::string, std::string> > &list, std::string &current)
 {
   vector<CStdString> vecCharsets = g_charsetConverter.getCharsetLabels();
@@ -71,6 +71,12 @@ public:
 
   void utf8logicalToVisualBiDi(const CStdStringA& strSource, CStdStringA& strDest);
 
+  /*!
+   \brief Set how many BiDi conversions of repeatedly drawn labels are kept
+   \param entries Maximum number of cached conversions, 0 disables the cache
+   */
+  void SetBiDiCacheSize(unsigned int entries);
+
   void utf32ToStringCharset(const unsigned long* strSource, CStdStringA& strDest);
 
   std::vector<CStdString> getCharsetLabels();
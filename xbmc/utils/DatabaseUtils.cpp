@@ -545,6 +545,33 @@ bool DatabaseUtils::GetFieldValue(const dbiplus::field_value &fieldValue, CVaria
   return false;
 }
 
+bool DatabaseUtils::GetFieldValue(const dbiplus::field_ref &fieldValue, CVariant &variantValue)
+{
+  if (fieldValue.get_isNull())
+  {
+    variantValue = CVariant::ConstNullVariant;
+    return true;
+  }
+
+  // a result only holds text, 64-bit integers and doubles
+  switch (fieldValue.get_fType())
+  {
+  case dbiplus::ft_String:
+    variantValue = fieldValue.get_asCString();
+    return true;
+  case dbiplus::ft_Double:
+    variantValue = fieldValue.get_asDouble();
+    return true;
+  case dbiplus::ft_Int64:
+    variantValue = fieldValue.get_asInt64();
+    return true;
+  default:
+    break;
+  }
+
+  return false;
+}
+
 bool DatabaseUtils::GetDatabaseResults(MediaType mediaType, const FieldList &fields, const std::auto_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results)
 {
   if (dataset->num_rows() == 0)
@@ -588,7 +615,7 @@ bool DatabaseUtils::GetDatabaseResults(MediaType mediaType, const FieldList &fie
 
       std::pair<Field, CVariant> value;
       value.first = *it;
-      if (!GetFieldValue(resultSet.records[index]->at(fieldIndex), value.second))
+      if (!GetFieldValue(resultSet.records[index].at(fieldIndex), value.second))
         CLog::Log(LOGWARNING, "GetDatabaseResults: unable to retrieve value of field %s", resultSet.record_header[fieldIndex].name.c_str());
 
       if (value.first == FieldYear &&
@@ -674,3 +701,29 @@ std::string DatabaseUtils::BuildLimitClause(int end, int start /* = 0 */)
 
   return sql.str();
 }
+
+std::string DatabaseUtils::BuildFullTextQuery(const std::string &search, const std::string &column /* = "" */)
+{
+  std::string query, word;
+  for (size_t i = 0; i <= search.size(); i++)
+  {
+    unsigned char c = i < search.size() ? search[i] : ' ';
+    // bytes of multi-byte UTF-8 characters are always part of a word
+    if (isalnum(c) || c >= 0x80)
+    {
+      word += (char)(c < 0x80 ? tolower(c) : c);
+      continue;
+    }
+    if (word.empty())
+      continue;
+
+    if (!query.empty())
+      query += " ";
+    if (!column.empty())
+      query += column + ":";
+    query += word + "*";
+    word.clear();
+  }
+
+  return query;
+}
@@ -31,6 +31,7 @@ namespace dbiplus
 {
   class Dataset;
   class field_value;
+  class field_ref;
 }
 
 typedef enum {
@@ -160,7 +161,18 @@ public:
   static bool GetSelectFields(const Fields &fields, MediaType mediaType, FieldList &selectFields);
   
   static bool GetFieldValue(const dbiplus::field_value &fieldValue, CVariant &variantValue);
+  static bool GetFieldValue(const dbiplus::field_ref &fieldValue, CVariant &variantValue);
   static bool GetDatabaseResults(MediaType mediaType, const FieldList &fields, const std::auto_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results);
 
   static std::string BuildLimitClause(int end, int start = 0);
+
+  /*! \brief Turn a search string into a MATCH expression for a full-text table.
+   Every word of the search has to match the start of a word in the index. Characters
+   that mean something in the query syntax are dropped and words are lower cased, so
+   a search is never read as an operator.
+   \param search the search string as entered by the user.
+   \param column if not empty, only match words in this column of the index.
+   \return the MATCH expression, empty if the search contains no words.
+   */
+  static std::string BuildFullTextQuery(const std::string &search, const std::string &column = "");
 };
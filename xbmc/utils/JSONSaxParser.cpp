@@ -0,0 +1,424 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <locale.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "JSONSaxParser.h"
+
+// deeper documents are rejected instead of risking the stack
+#define JSON_MAX_DEPTH 512
+
+static inline bool IsDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+static inline int HexValue(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+/*! \brief Length of the UTF-8 sequence at str, 0 if it is invalid or truncated */
+static inline size_t UTF8SequenceLength(const unsigned char *str, const unsigned char *end)
+{
+  size_t length;
+  if ((str[0] >> 5) == 0x06)
+    length = 2;
+  else if ((str[0] >> 4) == 0x0E)
+    length = 3;
+  else if ((str[0] >> 3) == 0x1E)
+    length = 4;
+  else
+    return 0;
+
+  if ((size_t)(end - str) < length)
+    return 0;
+  for (size_t i = 1; i < length; i++)
+  {
+    if ((str[i] >> 6) != 0x02)
+      return 0;
+  }
+  return length;
+}
+
+static void AppendUTF8(std::string &str, uint32_t codepoint)
+{
+  if (codepoint < 0x80)
+    str += (char)codepoint;
+  else if (codepoint < 0x800)
+  {
+    str += (char)(0xC0 | (codepoint >> 6));
+    str += (char)(0x80 | (codepoint & 0x3F));
+  }
+  else if (codepoint < 0x10000)
+  {
+    str += (char)(0xE0 | (codepoint >> 12));
+    str += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    str += (char)(0x80 | (codepoint & 0x3F));
+  }
+  else
+  {
+    str += (char)(0xF0 | (codepoint >> 18));
+    str += (char)(0x80 | ((codepoint >> 12) & 0x3F));
+    str += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    str += (char)(0x80 | (codepoint & 0x3F));
+  }
+}
+
+CJSONSaxParser::CJSONSaxParser(const char *json, size_t length, IJSONSaxHandler &handler)
+  : m_pos(json), m_end(json + length), m_handler(handler)
+{ }
+
+bool CJSONSaxParser::Parse(const char *json, size_t length, IJSONSaxHandler &handler)
+{
+  if (json == NULL)
+    return false;
+
+  CJSONSaxParser parser(json, length, handler);
+  if (!parser.ParseValue(0))
+    return false;
+
+  // nothing but whitespace may follow the value
+  return !parser.SkipWhitespace();
+}
+
+bool CJSONSaxParser::SkipWhitespace()
+{
+  while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\n' || *m_pos == '\r'))
+    m_pos++;
+
+  return m_pos < m_end;
+}
+
+bool CJSONSaxParser::ParseValue(unsigned int depth)
+{
+  if (depth > JSON_MAX_DEPTH || !SkipWhitespace())
+    return false;
+
+  switch (*m_pos)
+  {
+  case '{':
+    return ParseObject(depth);
+  case '[':
+    return ParseArray(depth);
+  case '"':
+    return ParseString(false);
+  case 't':
+    return ParseLiteral("true", 4) && m_handler.Boolean(true);
+  case 'f':
+    return ParseLiteral("false", 5) && m_handler.Boolean(false);
+  case 'n':
+    return ParseLiteral("null", 4) && m_handler.Null();
+  default:
+    if (*m_pos == '-' || IsDigit(*m_pos))
+      return ParseNumber();
+    return false;
+  }
+}
+
+bool CJSONSaxParser::ParseObject(unsigned int depth)
+{
+  m_pos++;
+  if (!m_handler.StartObject() || !SkipWhitespace())
+    return false;
+
+  size_t members = 0;
+  if (*m_pos == '}')
+  {
+    m_pos++;
+    return m_handler.EndObject(members);
+  }
+
+  while (true)
+  {
+    if (!SkipWhitespace() || *m_pos != '"' || !ParseString(true))
+      return false;
+    if (!SkipWhitespace() || *m_pos != ':')
+      return false;
+    m_pos++;
+    if (!ParseValue(depth + 1))
+      return false;
+    members++;
+
+    if (!SkipWhitespace())
+      return false;
+    if (*m_pos == ',')
+      m_pos++;
+    else if (*m_pos == '}')
+    {
+      m_pos++;
+      return m_handler.EndObject(members);
+    }
+    else
+      return false;
+  }
+}
+
+bool CJSONSaxParser::ParseArray(unsigned int depth)
+{
+  m_pos++;
+  if (!m_handler.StartArray() || !SkipWhitespace())
+    return false;
+
+  size_t elements = 0;
+  if (*m_pos == ']')
+  {
+    m_pos++;
+    return m_handler.EndArray(elements);
+  }
+
+  while (true)
+  {
+    if (!ParseValue(depth + 1))
+      return false;
+    elements++;
+
+    if (!SkipWhitespace())
+      return false;
+    if (*m_pos == ',')
+      m_pos++;
+    else if (*m_pos == ']')
+    {
+      m_pos++;
+      return m_handler.EndArray(elements);
+    }
+    else
+      return false;
+  }
+}
+
+bool CJSONSaxParser::ParseString(bool key)
+{
+  const char *start = ++m_pos;
+
+  // fast path, hand out the string in place as long as there is nothing to unescape
+  while (m_pos < m_end)
+  {
+    unsigned char c = (unsigned char)*m_pos;
+    if (c == '"')
+    {
+      size_t length = m_pos - start;
+      m_pos++;
+      return key ? m_handler.Key(start, length) : m_handler.String(start, length);
+    }
+    else if (c == '\\')
+      break;
+    else if (c < 0x20)
+      return false;
+    else if (c < 0x80)
+      m_pos++;
+    else
+    {
+      size_t length = UTF8SequenceLength((const unsigned char *)m_pos, (const unsigned char *)m_end);
+      if (length == 0)
+        return false;
+      m_pos += length;
+    }
+  }
+
+  if (m_pos >= m_end)
+    return false;
+
+  // slow path, unescape into the scratch buffer
+  m_scratch.assign(start, m_pos - start);
+  while (m_pos < m_end)
+  {
+    unsigned char c = (unsigned char)*m_pos;
+    if (c == '"')
+    {
+      m_pos++;
+      return key ? m_handler.Key(m_scratch.c_str(), m_scratch.size()) : m_handler.String(m_scratch.c_str(), m_scratch.size());
+    }
+    else if (c == '\\')
+    {
+      if (++m_pos >= m_end)
+        return false;
+
+      switch (*m_pos++)
+      {
+      case '"':  m_scratch += '"'; break;
+      case '\\': m_scratch += '\\'; break;
+      case '/':  m_scratch += '/'; break;
+      case 'b':  m_scratch += '\b'; break;
+      case 'f':  m_scratch += '\f'; break;
+      case 'n':  m_scratch += '\n'; break;
+      case 'r':  m_scratch += '\r'; break;
+      case 't':  m_scratch += '\t'; break;
+      case 'u':
+        {
+          uint32_t codepoint = 0;
+          for (int i = 0; i < 4; i++)
+          {
+            int value = m_pos < m_end ? HexValue(*m_pos++) : -1;
+            if (value < 0)
+              return false;
+            codepoint = (codepoint << 4) | value;
+          }
+
+          // combine surrogate pairs, a lone surrogate can't be represented in UTF-8
+          if (codepoint >= 0xD800 && codepoint <= 0xDBFF &&
+              m_end - m_pos >= 6 && m_pos[0] == '\\' && m_pos[1] == 'u')
+          {
+            uint32_t low = 0;
+            bool valid = true;
+            for (int i = 2; i < 6 && valid; i++)
+            {
+              int value = HexValue(m_pos[i]);
+              valid = value >= 0;
+              low = (low << 4) | value;
+            }
+            if (valid && low >= 0xDC00 && low <= 0xDFFF)
+            {
+              codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+              m_pos += 6;
+            }
+          }
+          if (codepoint >= 0xD800 && codepoint <= 0xDFFF)
+            m_scratch += '?';
+          else
+            AppendUTF8(m_scratch, codepoint);
+          break;
+        }
+      default:
+        return false;
+      }
+    }
+    else if (c < 0x20)
+      return false;
+    else if (c < 0x80)
+      m_scratch += *m_pos++;
+    else
+    {
+      size_t length = UTF8SequenceLength((const unsigned char *)m_pos, (const unsigned char *)m_end);
+      if (length == 0)
+        return false;
+      m_scratch.append(m_pos, length);
+      m_pos += length;
+    }
+  }
+
+  return false;
+}
+
+bool CJSONSaxParser::ParseNumber()
+{
+  const char *start = m_pos;
+  bool negative = false;
+  bool integer = true;
+  bool overflow = false;
+  uint64_t value = 0;
+
+  if (*m_pos == '-')
+  {
+    negative = true;
+    m_pos++;
+  }
+
+  if (m_pos >= m_end || !IsDigit(*m_pos))
+    return false;
+
+  if (*m_pos == '0')
+    m_pos++;
+  else
+  {
+    while (m_pos < m_end && IsDigit(*m_pos))
+    {
+      uint64_t digit = *m_pos++ - '0';
+      if (value > (~(uint64_t)0 - digit) / 10)
+        overflow = true;
+      value = value * 10 + digit;
+    }
+  }
+
+  if (m_pos < m_end && *m_pos == '.')
+  {
+    integer = false;
+    m_pos++;
+    if (m_pos >= m_end || !IsDigit(*m_pos))
+      return false;
+    while (m_pos < m_end && IsDigit(*m_pos))
+      m_pos++;
+  }
+
+  if (m_pos < m_end && (*m_pos == 'e' || *m_pos == 'E'))
+  {
+    integer = false;
+    m_pos++;
+    if (m_pos < m_end && (*m_pos == '+' || *m_pos == '-'))
+      m_pos++;
+    if (m_pos >= m_end || !IsDigit(*m_pos))
+      return false;
+    while (m_pos < m_end && IsDigit(*m_pos))
+      m_pos++;
+  }
+
+  if (integer && !overflow)
+  {
+    const uint64_t limit = (uint64_t)1 << 63;
+    if (!negative && value < limit)
+      return m_handler.Integer((int64_t)value);
+    if (negative && value <= limit)
+      return m_handler.Integer((int64_t)(0 - value));
+  }
+
+  // strtod needs a terminated copy and honours the locale's decimal point,
+  // the rare number too long for the buffer is copied to the scratch string
+  char buffer[64];
+  char *number = buffer;
+  size_t length = m_pos - start;
+  if (length < sizeof(buffer))
+  {
+    memcpy(buffer, start, length);
+    buffer[length] = '\0';
+  }
+  else
+  {
+    m_scratch.assign(start, length);
+    m_scratch.push_back('\0');
+    number = &m_scratch[0];
+  }
+
+  const char *decimalPoint = localeconv()->decimal_point;
+  if (decimalPoint != NULL && decimalPoint[0] != '.' && decimalPoint[0] != '\0' && decimalPoint[1] == '\0')
+  {
+    char *separator = strchr(number, '.');
+    if (separator != NULL)
+      *separator = decimalPoint[0];
+  }
+
+  return m_handler.Double(strtod(number, NULL));
+}
+
+bool CJSONSaxParser::ParseLiteral(const char *literal, size_t length)
+{
+  if ((size_t)(m_end - m_pos) < length || memcmp(m_pos, literal, length) != 0)
+    return false;
+
+  m_pos += length;
+  return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+
+/*!
+ \brief Receiver of the events produced by CJSONSaxParser
+
+ Strings and keys point either straight into the parsed buffer or into a
+ scratch buffer of the parser (if they contained escape sequences), they
+ are only valid during the call. Returning false from any method stops
+ the parser.
+ */
+class IJSONSaxHandler
+{
+public:
+  virtual ~IJSONSaxHandler() { }
+
+  virtual bool Null() = 0;
+  virtual bool Boolean(bool value) = 0;
+  virtual bool Integer(int64_t value) = 0;
+  virtual bool Double(double value) = 0;
+  virtual bool String(const char *value, size_t length) = 0;
+
+  virtual bool StartObject() = 0;
+  virtual bool Key(const char *key, size_t length) = 0;
+  /*!
+   \param members Number of members of the object just closed
+   */
+  virtual bool EndObject(size_t members) = 0;
+
+  virtual bool StartArray() = 0;
+  /*!
+   \param elements Number of elements of the array just closed
+   */
+  virtual bool EndArray(size_t elements) = 0;
+};
+
+/*!
+ \brief Parser tokenising a complete JSON document in place
+
+ Unlike CJSONVariantParser it neither copies the input nor builds a tree,
+ strings without escape sequences are handed to the handler as pointers
+ into the input buffer. Comments aren't allowed, strings must be valid UTF-8.
+ */
+class CJSONSaxParser
+{
+public:
+  /*!
+   \brief Parse the first JSON value in the given buffer
+   \param json Buffer holding the JSON document, doesn't need to be null terminated
+   \param length Length of the buffer
+   \param handler Handler receiving the parse events
+   \return True if a complete value has been parsed and only whitespace follows it
+   */
+  static bool Parse(const char *json, size_t length, IJSONSaxHandler &handler);
+
+private:
+  CJSONSaxParser(const char *json, size_t length, IJSONSaxHandler &handler);
+
+  bool ParseValue(unsigned int depth);
+  bool ParseObject(unsigned int depth);
+  bool ParseArray(unsigned int depth);
+  bool ParseString(bool key);
+  bool ParseNumber();
+  bool ParseLiteral(const char *literal, size_t length);
+  bool SkipWhitespace(); ///< false once the end of the input is reached
+
+  const char *m_pos;
+  const char *m_end;
+  IJSONSaxHandler &m_handler;
+  std::string m_scratch;
+};
@@ -0,0 +1,255 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "JSONStreamWriter.h"
+
+using namespace std;
+
+CJSONStreamWriter::CJSONStreamWriter(IJSONOutputStream &output, bool compact, size_t chunkSize /* = JSON_STREAM_CHUNK_SIZE */)
+  : m_output(output), m_chunkSize(chunkSize), m_good(true)
+{
+  m_buffer.reserve(m_chunkSize + 1024);
+
+#if YAJL_MAJOR == 2
+  m_gen = yajl_gen_alloc(NULL);
+  yajl_gen_config(m_gen, yajl_gen_beautify, compact ? 0 : 1);
+  yajl_gen_config(m_gen, yajl_gen_indent_string, "\t");
+  yajl_gen_config(m_gen, yajl_gen_print_callback, &CJSONStreamWriter::Print, this);
+#else
+  yajl_gen_config conf = { compact ? 0 : 1, "\t" };
+  m_gen = yajl_gen_alloc2(&CJSONStreamWriter::Print, &conf, NULL, this);
+#endif
+}
+
+CJSONStreamWriter::~CJSONStreamWriter()
+{
+  Flush();
+  yajl_gen_free(m_gen);
+}
+
+#if YAJL_MAJOR == 2
+void CJSONStreamWriter::Print(void *ctx, const char *str, size_t length)
+#else
+void CJSONStreamWriter::Print(void *ctx, const char *str, unsigned int length)
+#endif
+{
+  CJSONStreamWriter *writer = (CJSONStreamWriter *)ctx;
+  if (!writer->m_good)
+    return;
+
+  writer->m_buffer.append(str, length);
+  if (writer->m_buffer.size() >= writer->m_chunkSize)
+    writer->Flush();
+}
+
+bool CJSONStreamWriter::Flush()
+{
+  if (m_good && !m_buffer.empty())
+  {
+    m_good = m_output.Write(m_buffer.c_str(), m_buffer.size());
+    m_buffer.clear();
+  }
+
+  return m_good;
+}
+
+bool CJSONStreamWriter::Check(yajl_gen_status status)
+{
+  if (status != yajl_gen_status_ok)
+    m_good = false;
+
+  return m_good;
+}
+
+bool CJSONStreamWriter::StartObject()
+{
+  return m_good && Check(yajl_gen_map_open(m_gen));
+}
+
+bool CJSONStreamWriter::EndObject()
+{
+  return m_good && Check(yajl_gen_map_close(m_gen));
+}
+
+bool CJSONStreamWriter::StartArray()
+{
+  return m_good && Check(yajl_gen_array_open(m_gen));
+}
+
+bool CJSONStreamWriter::EndArray()
+{
+  return m_good && Check(yajl_gen_array_close(m_gen));
+}
+
+bool CJSONStreamWriter::Key(const string &key)
+{
+  return String(key);
+}
+
+bool CJSONStreamWriter::String(const string &value)
+{
+  return String(value.c_str(), value.size());
+}
+
+bool CJSONStreamWriter::String(const char *value, size_t length)
+{
+#if YAJL_MAJOR == 2
+  return m_good && Check(yajl_gen_string(m_gen, (const unsigned char*)value, length));
+#else
+  return m_good && Check(yajl_gen_string(m_gen, (const unsigned char*)value, (unsigned int)length));
+#endif
+}
+
+bool CJSONStreamWriter::Integer(int64_t value)
+{
+#if YAJL_MAJOR == 2
+  return m_good && Check(yajl_gen_integer(m_gen, (long long int)value));
+#else
+  return m_good && Check(yajl_gen_integer(m_gen, (long int)value));
+#endif
+}
+
+bool CJSONStreamWriter::UnsignedInteger(uint64_t value)
+{
+#if YAJL_MAJOR == 2
+  return m_good && Check(yajl_gen_integer(m_gen, (long long int)value));
+#else
+  return m_good && Check(yajl_gen_integer(m_gen, (long int)value));
+#endif
+}
+
+bool CJSONStreamWriter::Double(double value)
+{
+  if (!m_good)
+    return false;
+
+  // JSON has no representation for NaN and infinity (for both x - x is NaN)
+  if (!(value - value == 0.0))
+    return Null();
+
+  // format the number ourselves instead of switching the process wide
+  // locale to "C", the decimal point is the only locale dependent part.
+  // 17 significant digits are enough to read back the same double.
+  char number[64];
+  int length = snprintf(number, sizeof(number), "%.17g", value);
+  if (length <= 0 || length >= (int)sizeof(number) - 2)
+    return m_good = false;
+
+  const char *decimalPoint = localeconv()->decimal_point;
+  if (decimalPoint != NULL && decimalPoint[0] != '\0' && strcmp(decimalPoint, ".") != 0)
+  {
+    char *separator = strstr(number, decimalPoint);
+    if (separator != NULL)
+    {
+      size_t separatorLength = strlen(decimalPoint);
+      *separator = '.';
+      memmove(separator + 1, separator + separatorLength, length - (separator - number) - separatorLength + 1);
+      length -= separatorLength - 1;
+    }
+  }
+
+  // keep whole numbers recognisable as doubles, i.e. 7.0 and not 7
+  if (strpbrk(number, ".eEn") == NULL)
+  {
+    strcpy(number + length, ".0");
+    length += 2;
+  }
+
+  return Check(yajl_gen_number(m_gen, number, length));
+}
+
+bool CJSONStreamWriter::Boolean(bool value)
+{
+  return m_good && Check(yajl_gen_bool(m_gen, value ? 1 : 0));
+}
+
+bool CJSONStreamWriter::Null()
+{
+  return m_good && Check(yajl_gen_null(m_gen));
+}
+
+bool CJSONStreamWriter::Value(const CVariant &value)
+{
+  switch (value.type())
+  {
+  case CVariant::VariantTypeInteger:
+    return Integer(value.asInteger());
+  case CVariant::VariantTypeUnsignedInteger:
+    return UnsignedInteger(value.asUnsignedInteger());
+  case CVariant::VariantTypeDouble:
+    return Double(value.asDouble());
+  case CVariant::VariantTypeBoolean:
+    return Boolean(value.asBoolean());
+  case CVariant::VariantTypeString:
+    return String(value.c_str(), value.size());
+  case CVariant::VariantTypeArray:
+    StartArray();
+    for (CVariant::const_iterator_array itr = value.begin_array(); itr != value.end_array() && m_good; itr++)
+      Value(*itr);
+    return EndArray();
+  case CVariant::VariantTypeObject:
+    StartObject();
+    for (CVariant::const_iterator_map itr = value.begin_map(); itr != value.end_map() && m_good; itr++)
+    {
+      if (Key(itr->first))
+        Value(itr->second);
+    }
+    return EndObject();
+  case CVariant::VariantTypeConstNull:
+  case CVariant::VariantTypeNull:
+  default:
+    return Null();
+  }
+}
+
+bool CJSONStreamWriter::Value(CVariant &value, bool release)
+{
+  if (!release || (!value.isArray() && !value.isObject()))
+    return Value(value);
+
+  if (value.isArray())
+  {
+    StartArray();
+    for (CVariant::iterator_array itr = value.begin_array(); itr != value.end_array() && m_good; itr++)
+    {
+      Value(*itr, true);
+      *itr = CVariant();
+    }
+    EndArray();
+  }
+  else
+  {
+    StartObject();
+    for (CVariant::iterator_map itr = value.begin_map(); itr != value.end_map() && m_good; itr++)
+    {
+      if (Key(itr->first))
+        Value(itr->second, true);
+      itr->second = CVariant();
+    }
+    EndObject();
+  }
+
+  value.clear();
+  return m_good;
+}
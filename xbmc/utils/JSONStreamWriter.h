@@ -0,0 +1,124 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "Variant.h"
+#include <string>
+#include <yajl/yajl_gen.h>
+#ifdef HAVE_YAJL_YAJL_VERSION_H
+#include <yajl/yajl_version.h>
+#endif
+
+#define JSON_STREAM_CHUNK_SIZE 16384
+
+/*!
+ \brief Receiver of the chunks produced by CJSONStreamWriter
+ */
+class IJSONOutputStream
+{
+public:
+  virtual ~IJSONOutputStream() {}
+
+  /*!
+   \brief Take the next chunk of serialized JSON
+   \param data Serialized JSON, only valid during the call
+   \param length Number of bytes in data
+   \return false to abort, e.g. because the client went away
+   */
+  virtual bool Write(const char *data, size_t length) = 0;
+};
+
+/*!
+ \brief Output stream appending everything to a string
+ */
+class CJSONStringOutputStream : public IJSONOutputStream
+{
+public:
+  CJSONStringOutputStream(std::string &output) : m_output(output) {}
+
+  virtual bool Write(const char *data, size_t length) { m_output.append(data, length); return true; }
+
+private:
+  std::string &m_output;
+};
+
+/*!
+ \brief SAX style JSON writer
+
+ Values are serialized as they are written and handed to the output stream
+ in chunks of roughly chunkSize bytes, so a response never has to exist as
+ a single string. Every method returns false once writing failed or the
+ output stream asked to abort, all following calls are ignored.
+ */
+class CJSONStreamWriter
+{
+public:
+  CJSONStreamWriter(IJSONOutputStream &output, bool compact, size_t chunkSize = JSON_STREAM_CHUNK_SIZE);
+  ~CJSONStreamWriter();
+
+  bool StartObject();
+  bool EndObject();
+  bool StartArray();
+  bool EndArray();
+  bool Key(const std::string &key);
+
+  bool String(const std::string &value);
+  bool String(const char *value, size_t length);
+  bool Integer(int64_t value);
+  bool UnsignedInteger(uint64_t value);
+  bool Double(double value);
+  bool Boolean(bool value);
+  bool Null();
+
+  /*!
+   \brief Write a complete CVariant tree
+   */
+  bool Value(const CVariant &value);
+
+  /*!
+   \brief Write a complete CVariant tree, releasing every array element
+   and object member as soon as it has been serialized
+   \param value Tree to serialize, empty afterwards if release is true
+   \param release Whether to free the tree while writing it
+   */
+  bool Value(CVariant &value, bool release);
+
+  /*!
+   \brief Hand everything written so far to the output stream
+   */
+  bool Flush();
+
+  bool IsGood() const { return m_good; }
+
+private:
+#if YAJL_MAJOR == 2
+  static void Print(void *ctx, const char *str, size_t length);
+#else
+  static void Print(void *ctx, const char *str, unsigned int length);
+#endif
+  bool Check(yajl_gen_status status);
+
+  yajl_gen           m_gen;
+  IJSONOutputStream &m_output;
+  std::string        m_buffer;
+  size_t             m_chunkSize;
+  bool               m_good;
+};
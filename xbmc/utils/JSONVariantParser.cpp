@@ -18,7 +18,97 @@
  *
  */
 
+#include <deque>
+
 #include "JSONVariantParser.h"
+#include "JSONSaxParser.h"
+
+/*!
+ \brief Builds a CVariant tree from the events of CJSONSaxParser
+
+ Values are collected on a stack until their container is complete, the
+ container is then created with the right size and the values are swapped
+ into it instead of being copied.
+ */
+class CVariantBuilder : public IJSONSaxHandler
+{
+public:
+  CVariantBuilder() : m_depth(0), m_complete(false) { }
+
+  virtual bool Null() { return Push(CVariant::VariantTypeNull); }
+  virtual bool Boolean(bool value) { return Push(value); }
+  virtual bool Integer(int64_t value) { return Push(value); }
+  virtual bool Double(double value) { return Push((float)value); }
+  virtual bool String(const char *value, size_t length)
+  {
+    CVariant string(value, (unsigned int)length);
+    return Push(string);
+  }
+
+  virtual bool StartObject() { m_depth++; return true; }
+  virtual bool Key(const char *key, size_t length)
+  {
+    m_keys.push_back(std::string());
+    m_keys.back().assign(key, length);
+    return true;
+  }
+  virtual bool EndObject(size_t members)
+  {
+    CVariant object(CVariant::VariantTypeObject);
+    size_t first = m_values.size() - members;
+    for (size_t i = 0; i < members; i++)
+      object[m_keys[m_keys.size() - members + i]].swap(m_values[first + i]);
+    m_keys.resize(m_keys.size() - members);
+    m_values.resize(first);
+    m_depth--;
+    return Push(object);
+  }
+
+  virtual bool StartArray() { m_depth++; return true; }
+  virtual bool EndArray(size_t elements)
+  {
+    CVariant array(CVariant::VariantTypeArray);
+    array.reserve(elements);
+    size_t first = m_values.size() - elements;
+    for (size_t i = 0; i < elements; i++)
+      array.push_back_swap(m_values[first + i]);
+    m_values.resize(first);
+    m_depth--;
+    return Push(array);
+  }
+
+  bool IsComplete() const { return m_complete; }
+  CVariant &GetOutput() { return m_output; }
+
+private:
+  bool Push(const CVariant &value)
+  {
+    CVariant copy(value);
+    return Push(copy);
+  }
+
+  bool Push(CVariant &value)
+  {
+    if (m_depth == 0)
+    {
+      m_output.swap(value);
+      m_complete = true;
+    }
+    else
+    {
+      m_values.push_back(CVariant());
+      m_values.back().swap(value);
+    }
+    return true;
+  }
+
+  // a deque never moves its elements around when growing
+  std::deque<CVariant> m_values;
+  std::deque<std::string> m_keys;
+  unsigned int m_depth;
+  bool m_complete;
+  CVariant m_output;
+};
 
 yajl_callbacks CJSONVariantParser::callbacks = {
   CJSONVariantParser::ParseNull,
@@ -69,12 +159,17 @@ void CJSONVariantParser::push_buffer(const unsigned char *buffer, unsigned int l
 
 CVariant CJSONVariantParser::Parse(const unsigned char *json, unsigned int length)
 {
-  CSimpleParseCallback callback;
-  CJSONVariantParser parser(&callback);
+  // the whole document is available, so tokenise it in place instead of
+  // going through yajl and the parse state stack
+  CVariantBuilder builder;
+  CJSONSaxParser::Parse((const char *)json, length, builder);
 
-  parser.push_buffer(json, length);
+  if (!builder.IsComplete())
+    return CVariant();
 
-  return callback.GetOutput();
+  CVariant output;
+  output.swap(builder.GetOutput());
+  return output;
 }
 
 int CJSONVariantParser::ParseNull(void * ctx)
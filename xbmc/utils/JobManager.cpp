@@ -21,7 +21,10 @@
 #include "JobManager.h"
 #include <algorithm>
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
+#include "utils/CPUInfo.h"
 #include "utils/log.h"
+#include "utils/Trace.h"
 
 #include "system.h"
 
@@ -35,9 +38,11 @@ bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
   return false;
 }
 
-CJobWorker::CJobWorker(CJobManager *manager) : CThread("JobWorker")
+CJobWorker::CJobWorker(CJobManager *manager, unsigned int lane, bool warm) : CThread("JobWorker")
 {
   m_jobManager = manager;
+  m_lane = lane;
+  m_warm = warm;
   Create(true); // start work immediately, and kill ourselves when we're done
 }
 
@@ -64,6 +69,8 @@ void CJobWorker::Process()
     bool success = false;
     try
     {
+      // job types are string literals, so they can be recorded as the name
+      TRACE_SCOPE("jobs", *job->GetType() ? job->GetType() : "job");
       success = job->DoWork();
     }
     catch (...)
@@ -174,26 +181,46 @@ CJobManager &CJobManager::GetInstance()
 CJobManager::CJobManager()
 {
   m_jobCounter = 0;
+  m_processingCount = 0;
+  m_idleWorkers = 0;
+  m_nextLane = 0;
+  m_workerCounter = 0;
   m_running = true;
-  
+
+  // keep one warm worker per CPU, bounded by the number of jobs we'll run at once
+  int cpus = g_cpuInfo.getCPUCount();
+  m_warmWorkers = std::min(std::max(cpus, 1), (int)MAX_WORKERS);
+
   for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
     m_jobPause[priority] = false; // Set this priority to unpaused
 }
 
+void CJobManager::Restart()
+{
+  CSingleLock lock(m_section);
+  m_running = true;
+}
+
 void CJobManager::CancelJobs()
 {
   CSingleLock lock(m_section);
   m_running = false;
 
-  // clear any pending jobs
-  for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+  for (unsigned int l = 0; l < WORK_LANES; ++l)
   {
-    for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), mem_fun_ref(&CWorkItem::FreeJob));
-    m_jobQueue[priority].clear();
-  }
+    CWorkLane &lane = m_lanes[l];
+    CSingleLock laneLock(lane.m_section);
+
+    // clear any pending jobs
+    for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+    {
+      for_each(lane.m_jobQueue[priority].begin(), lane.m_jobQueue[priority].end(), mem_fun_ref(&CWorkItem::FreeJob));
+      lane.m_jobQueue[priority].clear();
+    }
 
-  // cancel any callbacks on jobs still processing
-  for_each(m_processing.begin(), m_processing.end(), mem_fun_ref(&CWorkItem::Cancel));
+    // cancel any callbacks on jobs still processing
+    for_each(lane.m_processing.begin(), lane.m_processing.end(), mem_fun_ref(&CWorkItem::Cancel));
+  }
 
   // tell our workers to finish
   while (m_workers.size())
@@ -211,80 +238,118 @@ CJobManager::~CJobManager()
 
 unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
 {
+  // held while queueing, so CancelJobs() can't clear the lanes in between
   CSingleLock lock(m_section);
-
   if (!m_running)
     return 0;
 
   // increment the job counter, ensuring 0 (invalid job) is never hit
-  m_jobCounter++;
-  if (m_jobCounter == 0)
-    m_jobCounter++;
+  unsigned int id = (unsigned int)AtomicIncrement(&m_jobCounter);
+  if (id == 0)
+    id = (unsigned int)AtomicIncrement(&m_jobCounter);
 
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, priority, callback);
-  m_jobQueue[priority].push_back(work);
+  CWorkItem work(job, id, priority, callback);
+  {
+    CWorkLane &lane = m_lanes[GetLaneForNewJob()];
+    CSingleLock laneLock(lane.m_section);
+    lane.m_jobQueue[priority].push_back(work);
+  }
+  lock.Leave();
 
   StartWorkers(priority);
   return work.m_id;
 }
 
-void CJobManager::CancelJob(unsigned int jobID)
+unsigned int CJobManager::GetLaneForNewJob()
 {
-  CSingleLock lock(m_section);
+  // jobs queued from inside a job stay local to the worker running it
+  CJobWorker *worker = dynamic_cast<CJobWorker*>(CThread::GetCurrentThread());
+  if (worker && worker->GetManager() == this)
+    return worker->GetLane();
 
-  // check whether we have this job in the queue
-  for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+  return (unsigned long)AtomicIncrement(&m_nextLane) % WORK_LANES;
+}
+
+void CJobManager::CancelJob(unsigned int jobID)
+{
+  for (unsigned int l = 0; l < WORK_LANES; ++l)
   {
-    JobQueue::iterator i = find(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), jobID);
-    if (i != m_jobQueue[priority].end())
+    CWorkLane &lane = m_lanes[l];
+    CSingleLock lock(lane.m_section);
+
+    // check whether we have this job in the queue
+    for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
     {
-      delete i->m_job;
-      m_jobQueue[priority].erase(i);
+      JobQueue::iterator i = find(lane.m_jobQueue[priority].begin(), lane.m_jobQueue[priority].end(), jobID);
+      if (i != lane.m_jobQueue[priority].end())
+      {
+        delete i->m_job;
+        lane.m_jobQueue[priority].erase(i);
+        return;
+      }
+    }
+    // or if we're processing it
+    Processing::iterator it = find(lane.m_processing.begin(), lane.m_processing.end(), jobID);
+    if (it != lane.m_processing.end())
+    {
+      it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
       return;
     }
   }
-  // or if we're processing it
-  Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
-  if (it != m_processing.end())
-    it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
 }
 
 void CJobManager::StartWorkers(CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
-
   // check how many free threads we have
-  if (m_processing.size() >= GetMaxWorkers(priority))
+  if ((unsigned long)AtomicAdd(&m_processingCount, 0) >= GetMaxWorkers(priority))
     return;
 
   // do we have any sleeping threads?
-  if (m_processing.size() < m_workers.size())
+  if (AtomicAdd(&m_idleWorkers, 0) > 0)
   {
     m_jobEvent.Set();
     return;
   }
 
-  // everyone is busy - we need more workers
-  m_workers.push_back(new CJobWorker(this));
+  CSingleLock lock(m_section);
+  if (!m_running || m_workers.size() >= MAX_WORKERS)
+    return;
+
+  // everyone is busy - we need more workers. The first ones make up the warm pool.
+  bool warm = m_workers.size() < m_warmWorkers;
+  m_workers.push_back(new CJobWorker(this, m_workerCounter++ % WORK_LANES, warm));
 }
 
-CJob *CJobManager::PopJob()
+CJob *CJobManager::PopJob(unsigned int home)
 {
-  CSingleLock lock(m_section);
   for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW; --priority)
   {
     if (m_jobPause[priority]) // In case this priority is paused, skip it
       continue;
 
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    // our own lane first, then steal from the others
+    for (unsigned int l = 0; l < WORK_LANES; ++l)
     {
+      CWorkLane &lane = m_lanes[(home + l) % WORK_LANES];
+      CSingleLock lock(lane.m_section);
+      JobQueue &queue = lane.m_jobQueue[priority];
+      if (queue.empty())
+        continue;
+
+      // reserve a processing slot, backing out if this priority has no spare workers
+      if ((unsigned long)AtomicIncrement(&m_processingCount) > GetMaxWorkers(CJob::PRIORITY(priority)))
+      {
+        AtomicDecrement(&m_processingCount);
+        break;
+      }
+
       // pop the job off the queue
-      CWorkItem job = m_jobQueue[priority].front();
-      m_jobQueue[priority].pop_front();
+      CWorkItem job = queue.front();
+      queue.pop_front();
 
       // add to the processing vector
-      m_processing.push_back(job);
+      lane.m_processing.push_back(job);
       job.m_job->m_callback = this;
       return job.m_job;
     }
@@ -302,6 +367,11 @@ void CJobManager::UnPause(const CJob::PRIORITY &priority)
 {
   CSingleLock lock(m_section);
   m_jobPause[priority] = false;
+  lock.Leave();
+
+  // wake any idle workers so jobs queued while paused get picked up
+  if (AtomicAdd(&m_idleWorkers, 0) > 0)
+    m_jobEvent.Set();
 }
 
 bool CJobManager::IsPaused(const CJob::PRIORITY &priority) const
@@ -312,12 +382,15 @@ bool CJobManager::IsPaused(const CJob::PRIORITY &priority) const
 
 bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 {
-  CSingleLock lock(m_section);
-
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); it++)
+  for (unsigned int l = 0; l < WORK_LANES; ++l)
   {
-    if (priority == it->m_priority)
-      return true;
+    const CWorkLane &lane = m_lanes[l];
+    CSingleLock lock(lane.m_section);
+    for(Processing::const_iterator it = lane.m_processing.begin(); it < lane.m_processing.end(); it++)
+    {
+      if (priority == it->m_priority)
+        return true;
+    }
   }
   return false;
 }
@@ -325,34 +398,48 @@ bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 int CJobManager::IsProcessing(const std::string &pausedType) const
 {
   int jobsMatched = 0;
-  CSingleLock lock(m_section);
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); it++)
+  for (unsigned int l = 0; l < WORK_LANES; ++l)
   {
-    if (pausedType == std::string(it->m_job->GetType()))
-      jobsMatched++;
+    const CWorkLane &lane = m_lanes[l];
+    CSingleLock lock(lane.m_section);
+    for(Processing::const_iterator it = lane.m_processing.begin(); it < lane.m_processing.end(); it++)
+    {
+      if (pausedType == std::string(it->m_job->GetType()))
+        jobsMatched++;
+    }
   }
   return jobsMatched;
 }
 
 CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
+  unsigned int home = worker->GetLane();
   while (m_running)
   {
-    // grab a job off the queue if we have one
-    CJob *job = PopJob();
+    // grab a job off the queues if we have one
+    CJob *job = PopJob(home);
     if (job)
       return job;
-    // no jobs are left - sleep for 30 seconds to allow new jobs to come in
-    lock.Leave();
-    bool newJob = m_jobEvent.WaitMSec(30000);
-    lock.Enter();
-    if (!newJob)
+
+    // advertise that we're idle before checking once more, so that a job added
+    // between the check above and our wait always gets an event set for it
+    AtomicIncrement(&m_idleWorkers);
+    job = PopJob(home);
+    bool newJob = true;
+    if (!job && m_running)
+      newJob = m_jobEvent.WaitMSec(30000); // sleep for 30 seconds to allow new jobs to come in
+    AtomicDecrement(&m_idleWorkers);
+    if (job)
+      return job;
+
+    // workers in the warm pool stay around, others retire when idle
+    if (!newJob && !worker->IsWarm())
       break;
   }
   // ensure no jobs have come in during the period after
   // timeout and before we held the lock
-  CJob *job = PopJob();
+  CSingleLock lock(m_section);
+  CJob *job = PopJob(home);
   if (job)
     return job;
   // have no jobs
@@ -360,19 +447,36 @@ CJob *CJobManager::GetNextJob(const CJobWorker *worker)
   return NULL;
 }
 
+unsigned int CJobManager::FindProcessingLane(const CJob *job) const
+{
+  for (unsigned int l = 0; l < WORK_LANES; ++l)
+  {
+    const CWorkLane &lane = m_lanes[l];
+    CSingleLock lock(lane.m_section);
+    if (find(lane.m_processing.begin(), lane.m_processing.end(), job) != lane.m_processing.end())
+      return l;
+  }
+  return WORK_LANES;
+}
+
 bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
-  CSingleLock lock(m_section);
-  // find the job in the processing queue, and check whether it's cancelled (no callback)
-  Processing::const_iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  unsigned int l = FindProcessingLane(job);
+  if (l < WORK_LANES)
   {
-    CWorkItem item(*i);
-    lock.Leave(); // leave section prior to call
-    if (item.m_callback)
+    const CWorkLane &lane = m_lanes[l];
+    CSingleLock lock(lane.m_section);
+    // find the job in the processing queue, and check whether it's cancelled (no callback)
+    Processing::const_iterator i = find(lane.m_processing.begin(), lane.m_processing.end(), job);
+    if (i != lane.m_processing.end())
     {
-      item.m_callback->OnJobProgress(item.m_id, progress, total, job);
-      return false;
+      CWorkItem item(*i);
+      lock.Leave(); // leave section prior to call
+      if (item.m_callback)
+      {
+        item.m_callback->OnJobProgress(item.m_id, progress, total, job);
+        return false;
+      }
     }
   }
   return true; // couldn't find the job, or it's been cancelled
@@ -380,10 +484,16 @@ bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const
 
 void CJobManager::OnJobComplete(bool success, CJob *job)
 {
-  CSingleLock lock(m_section);
+  // jobs never move between lanes while processing
+  unsigned int l = FindProcessingLane(job);
+  if (l >= WORK_LANES)
+    return;
+
+  CWorkLane &lane = m_lanes[l];
+  CSingleLock lock(lane.m_section);
   // remove the job from the processing queue
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  Processing::iterator i = find(lane.m_processing.begin(), lane.m_processing.end(), job);
+  if (i != lane.m_processing.end())
   {
     // tell any listeners we're done with the job, then delete it
     CWorkItem item(*i);
@@ -398,10 +508,11 @@ void CJobManager::OnJobComplete(bool success, CJob *job)
       CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
     }
     lock.Enter();
-    Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
-    if (j != m_processing.end())
-      m_processing.erase(j);
+    Processing::iterator j = find(lane.m_processing.begin(), lane.m_processing.end(), job);
+    if (j != lane.m_processing.end())
+      lane.m_processing.erase(j);
     lock.Leave();
+    AtomicDecrement(&m_processingCount);
     item.FreeJob();
   }
 }
@@ -417,6 +528,5 @@ void CJobManager::RemoveWorker(const CJobWorker *worker)
 
 unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority) const
 {
-  static const unsigned int max_workers = 5;
-  return max_workers - (CJob::PRIORITY_HIGH - priority);
+  return MAX_WORKERS - (CJob::PRIORITY_HIGH - priority);
 }
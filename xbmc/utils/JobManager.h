@@ -31,12 +31,24 @@ class CJobManager;
 class CJobWorker : public CThread
 {
 public:
-  CJobWorker(CJobManager *manager);
+  /*!
+   \brief Create and start a worker thread.
+   \param manager the job manager this worker pulls jobs from.
+   \param lane the work lane this worker drains first before stealing from other lanes.
+   \param warm whether this worker belongs to the warm pool and so never retires when idle.
+   */
+  CJobWorker(CJobManager *manager, unsigned int lane, bool warm);
   virtual ~CJobWorker();
 
   void Process();
+
+  CJobManager *GetManager() const { return m_jobManager; };
+  unsigned int GetLane() const { return m_lane; };
+  bool IsWarm() const { return m_warm; };
 private:
   CJobManager  *m_jobManager;
+  unsigned int  m_lane;
+  bool          m_warm;
 };
 
 /*!
@@ -165,6 +177,15 @@ private:
  priority levels.  Lower priority jobs are executed only if there are sufficient
  spare worker threads free to allow for higher priority jobs that may arise.
 
+ Queued jobs are spread over a fixed number of work lanes, each with its own lock,
+ queues and processing list, so that adding, starting and completing jobs from
+ several threads does not serialize on a single lock.  Each worker drains its own
+ lane first and steals from the other lanes when it runs dry, always taking the
+ highest unpaused priority available across all lanes.  Jobs added from within a
+ job are queued on the calling worker's lane.  A warm pool of workers, sized to
+ the number of CPUs, stays alive between bursts of jobs; additional workers are
+ started on demand and retire after being idle for a while.
+
  \sa CJob and IJobCallback
  */
 class CJobManager
@@ -275,6 +296,15 @@ public:
 protected:
   friend class CJobWorker;
   friend class CJob;
+  friend class TestJobManagerThroughput;
+
+  /*!
+   \brief Re-start accepting jobs again
+   Called after calling CancelJobs() to allow this manager to accept more jobs,
+   only the tests need to do so.
+   \sa CancelJobs()
+   */
+  void Restart();
 
   /*!
    \brief Get a new job to process. Blocks until a new job is available, or a timeout has occurred.
@@ -310,27 +340,57 @@ private:
   CJobManager const& operator=(CJobManager const&);
   virtual ~CJobManager();
 
-  /*! \brief Pop a job off the job queue and add to the processing queue ready to process
+  /*! \brief Pop a job off the job queues and add to the processing queue ready to process
+   Looks in the given lane first, and steals from the other lanes if it has nothing
+   runnable at the current priority.
+   \param lane the lane to look in first.
    \return the job to process, NULL if no jobs are available
    */
-  CJob *PopJob();
+  CJob *PopJob(unsigned int lane);
 
   void StartWorkers(CJob::PRIORITY priority);
   void RemoveWorker(const CJobWorker *worker);
   unsigned int GetMaxWorkers(CJob::PRIORITY priority) const;
 
-  unsigned int m_jobCounter;
+  /*! \brief Choose the lane a new job is queued on
+   Jobs added from one of our workers stay on that worker's lane, others are spread round-robin.
+   */
+  unsigned int GetLaneForNewJob();
+
+  /*! \brief Find the lane a processing job lives in
+   \param job the job to search for.
+   \return the index of the lane processing this job, or WORK_LANES if it is not processing.
+   */
+  unsigned int FindProcessingLane(const CJob *job) const;
+
+  static const unsigned int MAX_WORKERS = 5;
+  static const unsigned int WORK_LANES  = MAX_WORKERS;
 
   typedef std::deque<CWorkItem>    JobQueue;
   typedef std::vector<CWorkItem>   Processing;
   typedef std::vector<CJobWorker*> Workers;
 
-  JobQueue   m_jobQueue[CJob::PRIORITY_HIGH+1];
-  bool       m_jobPause[CJob::PRIORITY_HIGH+1];
-  Processing m_processing;
-  Workers    m_workers;
+  class CWorkLane
+  {
+  public:
+    JobQueue         m_jobQueue[CJob::PRIORITY_HIGH+1];
+    Processing       m_processing;
+    CCriticalSection m_section;
+  };
+
+  CWorkLane     m_lanes[WORK_LANES];
+  volatile bool m_jobPause[CJob::PRIORITY_HIGH+1];
+
+  volatile long m_jobCounter;
+  volatile long m_processingCount; ///< number of jobs processing over all lanes
+  volatile long m_idleWorkers;     ///< number of workers waiting on m_jobEvent
+  volatile long m_nextLane;
+
+  Workers          m_workers;      ///< guarded by m_section
+  unsigned int     m_warmWorkers;  ///< size of the warm worker pool
+  unsigned int     m_workerCounter;
 
   CCriticalSection m_section;
   CEvent           m_jobEvent;
-  bool             m_running;
+  volatile bool    m_running;
 };
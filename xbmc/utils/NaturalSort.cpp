@@ -0,0 +1,165 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <string.h>
+
+#include "NaturalSort.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// StringUtils::AlphaNumericCompare compares at most this many digits as one number
+#define NATURAL_SORT_MAX_DIGITS 15
+
+using namespace std;
+
+static inline bool IsDigit(wchar_t c)
+{
+  return c >= L'0' && c <= L'9';
+}
+
+CNaturalSortCollator::CNaturalSortCollator()
+  : m_collate(use_facet< collate<wchar_t> >(locale()))
+{
+  memset(m_ascii, Unknown, sizeof(m_ascii));
+}
+
+int CNaturalSortCollator::CollateCompare(wchar_t left, wchar_t right) const
+{
+  int result = m_collate.compare(&left, &left + 1, &right, &right + 1);
+  return result < 0 ? -1 : (result > 0 ? 1 : 0);
+}
+
+void CNaturalSortKey::Set(const wstring &label)
+{
+  // like StringUtils::AlphaNumericCompare stop at an embedded NUL
+  m_folded.assign(label.c_str());
+  m_numbers.clear();
+
+  for (size_t pos = 0; pos < m_folded.size(); )
+  {
+    wchar_t &c = m_folded[pos];
+    if (c >= L'A' && c <= L'Z')
+      c += L'a' - L'A';
+
+    if (!IsDigit(c))
+    {
+      pos++;
+      continue;
+    }
+
+    Number number;
+    number.start = pos;
+    number.value = 0;
+    while (pos < m_folded.size() && IsDigit(m_folded[pos]) && pos < number.start + NATURAL_SORT_MAX_DIGITS)
+      number.value = number.value * 10 + (m_folded[pos++] - L'0');
+    number.digits = pos - number.start;
+    m_numbers.push_back(number);
+  }
+}
+
+void CNaturalSortKey::swap(CNaturalSortKey &other)
+{
+  m_folded.swap(other.m_folded);
+  m_numbers.swap(other.m_numbers);
+}
+
+size_t CNaturalSortKey::CommonPrefixLength(const wchar_t *left, const wchar_t *right, size_t length)
+{
+  size_t pos = 0;
+#ifdef __SSE2__
+  // comparing bytes is enough, characters are only equal if all their bytes are
+  const size_t step = sizeof(__m128i) / sizeof(wchar_t);
+  for (; pos + step <= length; pos += step)
+  {
+    __m128i l = _mm_loadu_si128((const __m128i *)(left + pos));
+    __m128i r = _mm_loadu_si128((const __m128i *)(right + pos));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)) != 0xffff)
+      break;
+  }
+#endif
+  while (pos < length && left[pos] == right[pos])
+    pos++;
+  return pos;
+}
+
+size_t CNaturalSortKey::GetNumber(size_t pos, vector<Number>::const_iterator &hint, int64_t &value) const
+{
+  // positions only ever grow during a comparison
+  while (hint != m_numbers.end() && hint->start < pos)
+    ++hint;
+  if (hint != m_numbers.end() && hint->start == pos)
+  {
+    value = hint->value;
+    return hint->digits;
+  }
+
+  // a number starting in the middle of a run of digits, which can only
+  // happen if the collation considered two different characters equal
+  size_t end = pos;
+  value = 0;
+  while (end < m_folded.size() && IsDigit(m_folded[end]) && end < pos + NATURAL_SORT_MAX_DIGITS)
+    value = value * 10 + (m_folded[end++] - L'0');
+  return end - pos;
+}
+
+int CNaturalSortKey::Compare(const CNaturalSortKey &right, CNaturalSortCollator &collator) const
+{
+  const wchar_t *l = m_folded.c_str();
+  const wchar_t *r = right.m_folded.c_str();
+  size_t lsize = m_folded.size();
+  size_t rsize = right.m_folded.size();
+
+  // an identical prefix compares equal, but a number has to be compared as
+  // a whole, so restart at the beginning of a number the prefix ends in
+  size_t pos = CommonPrefixLength(l, r, min(lsize, rsize));
+  while (pos > 0 && IsDigit(l[pos - 1]))
+    pos--;
+
+  vector<Number>::const_iterator lhint = lower_bound(m_numbers.begin(), m_numbers.end(), pos, NumberStartsBefore);
+  vector<Number>::const_iterator rhint = lower_bound(right.m_numbers.begin(), right.m_numbers.end(), pos, NumberStartsBefore);
+  size_t lpos = pos, rpos = pos;
+  while (lpos < lsize && rpos < rsize)
+  {
+    if (IsDigit(l[lpos]) && IsDigit(r[rpos]))
+    {
+      int64_t lnum, rnum;
+      lpos += GetNumber(lpos, lhint, lnum);
+      rpos += right.GetNumber(rpos, rhint, rnum);
+      if (lnum != rnum)
+        return lnum < rnum ? -1 : 1;
+      continue;
+    }
+
+    int result = collator.Compare(l[lpos], r[rpos]);
+    if (result != 0)
+      return result;
+    lpos++;
+    rpos++;
+  }
+
+  if (rpos < rsize)
+    return -1; // right is longer
+  if (lpos < lsize)
+    return 1;  // left is longer
+  return 0;
+}
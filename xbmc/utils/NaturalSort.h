@@ -0,0 +1,113 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <locale>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*!
+ \brief Caches the locale's collation of pairs of ASCII characters
+
+ Collating single characters through the locale facet is by far the most
+ expensive part of a natural order comparison, and labels are mostly ASCII.
+ The cache is filled as it goes, so an instance must not be shared between
+ threads.
+ */
+class CNaturalSortCollator
+{
+public:
+  CNaturalSortCollator();
+
+  int Compare(wchar_t left, wchar_t right)
+  {
+    if (left == right)
+      return 0;
+
+    if (left >= 0 && left < 128 && right >= 0 && right < 128)
+    {
+      signed char &cached = m_ascii[left][right];
+      if (cached == Unknown)
+        cached = CollateCompare(left, right);
+      return cached;
+    }
+
+    return CollateCompare(left, right);
+  }
+
+private:
+  static const signed char Unknown = 2;
+
+  int CollateCompare(wchar_t left, wchar_t right) const;
+
+  const std::collate<wchar_t> &m_collate;
+  signed char m_ascii[128][128];
+};
+
+/*!
+ \brief A label prepared once for natural order comparisons
+
+ Holds the label case folded the way StringUtils::AlphaNumericCompare folds
+ it, split into runs of text and numbers (of at most 15 digits) whose
+ values are computed up front. Comparing two keys skips their common prefix
+ in bulk and then only needs to look at where they differ, giving the same
+ order as StringUtils::AlphaNumericCompare.
+
+ Keys are plain values, so they can be kept with the item they belong to
+ and reused for every sort of it.
+ */
+class CNaturalSortKey
+{
+public:
+  CNaturalSortKey() { }
+  explicit CNaturalSortKey(const std::wstring &label) { Set(label); }
+
+  void Set(const std::wstring &label);
+  const std::wstring &GetFolded() const { return m_folded; }
+  bool IsEmpty() const { return m_folded.empty(); }
+  void swap(CNaturalSortKey &other);
+
+  /*!
+   \brief Natural order comparison of two keys
+   \return <0, 0 or >0 like StringUtils::AlphaNumericCompare
+   */
+  int Compare(const CNaturalSortKey &right, CNaturalSortCollator &collator) const;
+
+  /*!
+   \brief Length of the common prefix of two strings of at least length characters
+   */
+  static size_t CommonPrefixLength(const wchar_t *left, const wchar_t *right, size_t length);
+
+private:
+  struct Number
+  {
+    uint32_t start;
+    uint32_t digits;
+    int64_t value;
+  };
+
+  static bool NumberStartsBefore(const Number &number, size_t pos) { return number.start < pos; }
+  size_t GetNumber(size_t pos, std::vector<Number>::const_iterator &hint, int64_t &value) const;
+
+  std::wstring m_folded;
+  std::vector<Number> m_numbers; ///< ordered by start
+};
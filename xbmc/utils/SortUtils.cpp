@@ -18,12 +18,21 @@
  *
  */
 
+#include <algorithm>
+#include <boost/shared_ptr.hpp>
+
 #include "SortUtils.h"
 #include "URL.h"
 #include "Util.h"
 #include "XBDateTime.h"
 #include "settings/AdvancedSettings.h"
+#include "threads/Atomics.h"
+#include "threads/Event.h"
+#include "utils/CPUInfo.h"
 #include "utils/CharsetConverter.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
+#include "utils/NaturalSort.h"
 #include "utils/StdString.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
@@ -416,110 +425,181 @@ string ByDateTaken(SortAttribute attributes, const SortItem &values)
   return values.at(FieldDateTaken).asString();
 }
 
-bool preliminarySort(const SortItem &left, const SortItem &right, bool handleFolder, bool &result, std::wstring &labelLeft, std::wstring &labelRight)
+// sort items with at least this many entries are sorted in parallel chunks
+#define SORT_PARALLEL_THRESHOLD 10000
+#define SORT_MAX_THREADS        8
+
+/*!
+ \brief Per item data needed to sort, computed once before sorting.
+ The label is turned into a CNaturalSortKey up front, and the special
+ sort and folder attributes are reduced to a single group so that most
+ comparisons never touch the item's field map.
+
+ Unless folders are ignored, items with FieldFolder set come before all
+ others but those sorted on top, whatever the sort order. Items without
+ FieldFolder count as files.
+ */
+typedef struct SortKey
 {
-  // make sure both items have the necessary data to do the sorting
-  SortItem::const_iterator itLeftSort, itRightSort;
-  if ((itLeftSort = left.find(FieldSort)) == left.end())
+  enum Group
   {
-    result = false;
-    return true;
-  }
-  if ((itRightSort = right.find(FieldSort)) == right.end())
-  {
-    result = true;
-    return true;
-  }
+    GroupOnTop = 0,
+    GroupFolder,
+    GroupFile,
+    GroupOnBottom
+  };
+
+  int             group;
+  CNaturalSortKey label;
+  size_t          index;
+} SortKey;
+
+/*!
+ \brief Orders SortKeys. Ties are broken by the original position so the
+ ordering is total, which makes std::sort and std::partial_sort stable.
+ */
+class CSortKeyCompare
+{
+public:
+  CSortKeyCompare(bool descending, CNaturalSortCollator &collator)
+    : m_descending(descending), m_collator(&collator)
+  { }
 
-  // look at special sorting behaviour
-  SortItem::const_iterator itLeft, itRight;
-  SortSpecial leftSortSpecial = SortSpecialNone;
-  SortSpecial rightSortSpecial = SortSpecialNone;
-  if ((itLeft = left.find(FieldSortSpecial)) != left.end() && itLeft->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    leftSortSpecial = (SortSpecial)itLeft->second.asInteger();
-  if ((itRight = right.find(FieldSortSpecial)) != right.end() && itRight->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    rightSortSpecial = (SortSpecial)itRight->second.asInteger();
-  
-  // one has a special sort
-  if (leftSortSpecial != rightSortSpecial)
+  bool operator()(const SortKey *left, const SortKey *right) const
   {
-    // left should be sorted on top
-    // or right should be sorted on bottom
-    // => left is sorted above right
-    if (leftSortSpecial == SortSpecialOnTop ||
-        rightSortSpecial == SortSpecialOnBottom)
+    if (left->group != right->group)
+      return left->group < right->group;
+
+    // items sorted on top or bottom keep their order amongst each other
+    if (left->group != SortKey::GroupOnTop && left->group != SortKey::GroupOnBottom)
     {
-      result = true;
-      return true;
+      int result = left->label.Compare(right->label, *m_collator);
+      if (result != 0)
+        return m_descending ? result > 0 : result < 0;
     }
-    
-    // otherwise right is sorted above left
-    result = false;
-    return true;
+
+    return left->index < right->index;
+  }
+
+private:
+  bool m_descending;
+  CNaturalSortCollator *m_collator;
+};
+
+typedef std::vector<const SortKey*> SortKeyOrder;
+
+/*!
+ \brief Chunks of a large sort, shared by the sorting thread and the jobs
+ helping it. Chunks are claimed one at a time, so the sorting thread sorts
+ whatever no worker got to, and a job running late finds nothing left and
+ never touches the order again.
+ */
+class CSortChunks
+{
+public:
+  CSortChunks(SortKeyOrder &order, size_t chunkSize, bool descending)
+    : m_order(order), m_chunkSize(chunkSize), m_descending(descending)
+  {
+    m_count = (long)((order.size() + chunkSize - 1) / chunkSize);
+    m_next = 0;
+    m_pending = m_count;
   }
-  // both have either sort on top or sort on bottom -> leave as-is
-  else if (leftSortSpecial != SortSpecialNone && leftSortSpecial == rightSortSpecial)
+
+  long GetCount() const { return m_count; }
+
+  /*! \brief Sort the next unclaimed chunk, false once all are claimed */
+  bool SortNext()
   {
-    result = false;
+    long chunk = AtomicIncrement(&m_next) - 1;
+    if (chunk >= m_count)
+      return false;
+
+    size_t start = chunk * m_chunkSize;
+    size_t end = std::min(start + m_chunkSize, m_order.size());
+    // every thread needs its own collator as it caches as it goes
+    CNaturalSortCollator collator;
+    std::sort(m_order.begin() + start, m_order.begin() + end, CSortKeyCompare(m_descending, collator));
+
+    if (AtomicDecrement(&m_pending) == 0)
+      m_done.Set();
     return true;
   }
 
-  if (handleFolder)
+  /*! \brief Wait for the chunks claimed by other threads */
+  void Wait()
   {
-    itLeft = left.find(FieldFolder);
-    itRight = right.find(FieldFolder);
-    if (itLeft != left.end() && itRight != right.end() &&
-        itLeft->second.asBoolean() != itRight->second.asBoolean())
-    {
-      result = itLeft->second.asBoolean();
-      return true;
-    }
+    m_done.Wait();
   }
 
-  labelLeft = itLeftSort->second.asWideString();
-  labelRight = itRightSort->second.asWideString();
+private:
+  SortKeyOrder &m_order;
+  size_t m_chunkSize;
+  bool m_descending;
+  long m_count;
+  volatile long m_next;
+  volatile long m_pending;
+  CEvent m_done;
+};
 
-  return false;
-}
+typedef boost::shared_ptr<CSortChunks> SortChunksPtr;
 
-bool SorterAscending(const SortItem &left, const SortItem &right)
+class CSortJob : public CJob
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
+public:
+  CSortJob(const SortChunksPtr &chunks) : m_chunks(chunks) { }
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
-}
+  virtual const char *GetType() const { return "sort"; }
 
-bool SorterDescending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
+  virtual bool DoWork()
+  {
+    while (m_chunks->SortNext()) ;
+    return true;
+  }
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
-}
+private:
+  SortChunksPtr m_chunks;
+};
 
-bool SorterIgnoreFoldersAscending(const SortItem &left, const SortItem &right)
+/*!
+ \brief Sorts the given order. Large inputs are split into chunks that are
+ sorted with the help of the job manager's workers, followed by a merge.
+ */
+static void SortKeys(SortKeyOrder &order, bool descending, CNaturalSortCollator &collator)
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
+  unsigned int threads = std::min(std::max(g_cpuInfo.getCPUCount(), 1), SORT_MAX_THREADS);
+  if (order.size() < SORT_PARALLEL_THRESHOLD || threads < 2)
+  {
+    std::sort(order.begin(), order.end(), CSortKeyCompare(descending, collator));
+    return;
+  }
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
-}
+  size_t chunkSize = (order.size() + threads - 1) / threads;
+  SortChunksPtr chunks(new CSortChunks(order, chunkSize, descending));
 
-bool SorterIgnoreFoldersDescending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
+  // this thread sorts chunks as well, so the sort never waits for a worker
+  // that hasn't started, e.g. when sorting from within a job
+  for (long i = 1; i < chunks->GetCount(); i++)
+  {
+    CSortJob *job = new CSortJob(chunks);
+    if (CJobManager::GetInstance().AddJob(job, NULL, CJob::PRIORITY_HIGH) == 0)
+    {
+      delete job;
+      break;
+    }
+  }
+  while (chunks->SortNext()) ;
+  chunks->Wait();
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
+  // merge the sorted chunks, doubling the merged width each pass
+  CSortKeyCompare compare(descending, collator);
+  for (size_t width = chunkSize; width < order.size(); width *= 2)
+  {
+    for (size_t start = 0; start + width < order.size(); start += 2 * width)
+    {
+      size_t end = std::min(start + 2 * width, order.size());
+      std::inplace_merge(order.begin() + start, order.begin() + start + width, order.begin() + end, compare);
+    }
+  }
 }
 
 map<SortBy, SortUtils::SortPreparator> fillPreparators()
@@ -651,41 +731,89 @@ map<SortBy, Fields> SortUtils::m_sortingFields = fillSortingFields();
 
 void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, SortItems& items, int limitEnd /* = -1 */, int limitStart /* = 0 */)
 {
-  if (sortBy != SortByNone)
+  // work out which part of the items we end up with
+  size_t first = 0;
+  if (limitStart > 0 && (size_t)limitStart < items.size())
   {
-    // get the matching SortPreparator
-    SortPreparator preparator = getPreparator(sortBy);
-    if (preparator != NULL)
+    first = limitStart;
+    limitEnd -= limitStart;
+  }
+  size_t count = items.size() - first;
+  if (limitEnd > 0 && (size_t)limitEnd < count)
+    count = limitEnd;
+
+  SortPreparator preparator = sortBy != SortByNone ? getPreparator(sortBy) : NULL;
+  if (preparator == NULL)
+  {
+    if (first + count < items.size())
+      items.erase(items.begin() + first + count, items.end());
+    if (first > 0)
+      items.erase(items.begin(), items.begin() + first);
+    return;
+  }
+
+  const Fields &sortingFields = GetFieldsForSorting(sortBy);
+  bool handleFolder = !(attributes & SortAttributeIgnoreFolders);
+
+  // Prepare the string used for sorting and store it under FieldSort,
+  // along with the key we actually sort by
+  std::vector<SortKey> keys(items.size());
+  for (size_t index = 0; index < items.size(); index++)
+  {
+    SortItem &item = items[index];
+
+    // add all fields to the item that are required for sorting if they are currently missing
+    for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); field++)
     {
-      Fields sortingFields = GetFieldsForSorting(sortBy);
-
-      // Prepare the string used for sorting and store it under FieldSort
-      for (SortItems::iterator item = items.begin(); item != items.end(); item++)
-      {
-        // add all fields to the item that are required for sorting if they are currently missing
-        for (Fields::const_iterator field = sortingFields.begin(); field != sortingFields.end(); field++)
-        {
-          if (item->find(*field) == item->end())
-            item->insert(pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
-        }
-
-        CStdStringW sortLabel;
-        g_charsetConverter.utf8ToW(preparator(attributes, *item), sortLabel, false);
-        item->insert(pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
-      }
-
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorter(sortOrder, attributes));
+      if (item.find(*field) == item.end())
+        item.insert(pair<Field, CVariant>(*field, CVariant::ConstNullVariant));
     }
+
+    CStdStringW sortLabel;
+    g_charsetConverter.utf8ToW(preparator(attributes, item), sortLabel, false);
+    std::pair<SortItem::iterator, bool> sortField = item.insert(pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
+
+    SortKey &key = keys[index];
+    key.index = index;
+    key.label.Set(sortField.first->second.asWideString());
+
+    SortItem::const_iterator it;
+    int64_t special = SortSpecialNone;
+    if ((it = item.find(FieldSortSpecial)) != item.end() && it->second.asInteger() <= (int64_t)SortSpecialOnBottom)
+      special = it->second.asInteger();
+    if (special == SortSpecialOnTop)
+      key.group = SortKey::GroupOnTop;
+    else if (special == SortSpecialOnBottom)
+      key.group = SortKey::GroupOnBottom;
+    else if (handleFolder && (it = item.find(FieldFolder)) != item.end() && it->second.asBoolean())
+      key.group = SortKey::GroupFolder;
+    else
+      key.group = SortKey::GroupFile;
   }
 
-  if (limitStart > 0 && (size_t)limitStart < items.size())
+  SortKeyOrder order(keys.size());
+  for (size_t index = 0; index < keys.size(); index++)
+    order[index] = &keys[index];
+
+  // Do the sorting. When only a page of the items is wanted we only need to
+  // sort up to the end of that page.
+  bool descending = sortOrder == SortOrderDescending;
+  CNaturalSortCollator collator;
+  if (first + count < order.size())
   {
-    items.erase(items.begin(), items.begin() + limitStart);
-    limitEnd -= limitStart;
+    CSortKeyCompare compare(descending, collator);
+    if (first > 0)
+      std::nth_element(order.begin(), order.begin() + first, order.end(), compare);
+    std::partial_sort(order.begin() + first, order.begin() + first + count, order.end(), compare);
   }
-  if (limitEnd > 0 && (size_t)limitEnd < items.size())
-    items.erase(items.begin() + limitEnd, items.end());
+  else
+    SortKeys(order, descending, collator);
+
+  // and move the wanted items into place
+  SortItems sorted(count);
+  for (size_t index = 0; index < count; index++)
+    sorted[index].swap(items[order[first + index]->index]);
+  items.swap(sorted);
 }
 
 void SortUtils::Sort(const SortDescription &sortDescription, SortItems& items)
@@ -714,6 +842,46 @@ bool SortUtils::SortFromDataset(const SortDescription &sortDescription, MediaTyp
   return true;
 }
 
+bool SortUtils::BuildOrderClause(const SortDescription &sortDescription, MediaType mediaType, string &orderClause)
+{
+  orderClause.clear();
+  if (sortDescription.sortBy == SortByNone)
+    return true;
+
+  string field;
+  switch (sortDescription.sortBy)
+  {
+  case SortByTrackNumber:
+    field = DatabaseUtils::GetField(FieldTrackNumber, mediaType, DatabaseQueryPartOrderBy);
+    if (!field.empty())
+      field = "CAST(" + field + " AS INTEGER)";
+    break;
+  case SortByTime:
+    field = DatabaseUtils::GetField(FieldTime, mediaType, DatabaseQueryPartOrderBy);
+    if (!field.empty())
+      field = "CAST(" + field + " AS INTEGER)";
+    break;
+  case SortByDateAdded:
+    field = DatabaseUtils::GetField(FieldDateAdded, mediaType, DatabaseQueryPartOrderBy);
+    break;
+  default:
+    // everything else is compared as labels or has a label tie-break
+    return false;
+  }
+
+  string id = DatabaseUtils::GetField(FieldId, mediaType, DatabaseQueryPartOrderBy);
+  if (field.empty() || id.empty())
+    return false;
+
+  // Sort() keeps tied items in their original (ascending id) order, except
+  // for the date added whose sort label includes the id and so reverses too
+  const char *direction = sortDescription.sortOrder == SortOrderDescending ? " DESC" : "";
+  orderClause = field + direction;
+  if (field != id)
+    orderClause += ", " + id + (sortDescription.sortBy == SortByDateAdded ? direction : "");
+  return true;
+}
+
 const SortUtils::SortPreparator& SortUtils::getPreparator(SortBy sortBy)
 {
   map<SortBy, SortPreparator>::const_iterator it = m_preparators.find(sortBy);
@@ -723,14 +891,6 @@ const SortUtils::SortPreparator& SortUtils::getPreparator(SortBy sortBy)
   return m_preparators[SortByNone];
 }
 
-SortUtils::Sorter SortUtils::getSorter(SortOrder sortOrder, SortAttribute attributes)
-{
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIgnoreFoldersDescending : SorterIgnoreFoldersAscending;
-
-  return sortOrder == SortOrderDescending ? SorterDescending : SorterAscending;
-}
-
 const Fields& SortUtils::GetFieldsForSorting(SortBy sortBy)
 {
   map<SortBy, Fields>::const_iterator it = m_sortingFields.find(sortBy);
@@ -120,19 +120,33 @@ public:
    */
   static int GetSortLabel(SortBy sortBy);
 
+  /*! \brief sort the given items, keeping only those between limitStart and limitEnd.
+   Sort keys are computed once per item. When the limits select only part of
+   the items only that part is fully sorted, and large inputs are sorted with
+   the help of the job manager's workers. Unless SortAttributeIgnoreFolders is
+   given, items with FieldFolder set come first (after those sorted on top) in
+   either sort order.
+   */
   static void Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, SortItems& items, int limitEnd = -1, int limitStart = 0);
   static void Sort(const SortDescription &sortDescription, SortItems& items);
   static bool SortFromDataset(const SortDescription &sortDescription, MediaType mediaType, const std::auto_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results);
+  /*! \brief build the ORDER BY clause letting the database do a sort itself.
+   Only sorts on plain numbers and dates come out of SQL in the same order as
+   out of Sort(), ties are ordered by id. Other sorts have to go through Sort().
+   \param sortDescription the sort, its limits are not part of the clause
+   \param mediaType the media type the query returns
+   \param orderClause receives the clause, empty for SortByNone
+   \return true if the database can do the sort
+   */
+  static bool BuildOrderClause(const SortDescription &sortDescription, MediaType mediaType, std::string &orderClause);
   
   static const Fields& GetFieldsForSorting(SortBy sortBy);
   static std::string RemoveArticles(const std::string &label);
   
   typedef std::string (*SortPreparator) (SortAttribute, const SortItem&);
-  typedef bool (*Sorter) (const SortItem&, const SortItem&);
   
 private:
   static const SortPreparator& getPreparator(SortBy sortBy);
-  static Sorter getSorter(SortOrder sortOrder, SortAttribute attributes);
 
   static std::map<SortBy, SortPreparator> m_preparators;
   static std::map<SortBy, Fields> m_sortingFields;
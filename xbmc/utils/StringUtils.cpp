@@ -30,6 +30,7 @@
 
 
 #include "StringUtils.h"
+#include "utils/NaturalSort.h"
 #include "utils/RegExp.h"
 #include "utils/fstrcmp.h"
 #include <locale>
@@ -341,8 +342,13 @@ int StringUtils::FindNumber(const CStdString& strInput, const CStdString &strFin
 // and 0 if they are identical (essentially calculates left - right)
 int64_t StringUtils::AlphaNumericCompare(const wchar_t *left, const wchar_t *right)
 {
-  wchar_t *l = (wchar_t *)left;
-  wchar_t *r = (wchar_t *)right;
+  // skip the identical prefix, but compare a number it ends in as a whole
+  size_t prefix = CNaturalSortKey::CommonPrefixLength(left, right, std::min(wcslen(left), wcslen(right)));
+  while (prefix > 0 && left[prefix - 1] >= L'0' && left[prefix - 1] <= L'9')
+    prefix--;
+
+  wchar_t *l = (wchar_t *)left + prefix;
+  wchar_t *r = (wchar_t *)right + prefix;
   wchar_t *ld, *rd;
   wchar_t lc, rc;
   int64_t lnum, rnum;
@@ -0,0 +1,354 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+
+#include "Trace.h"
+#include "Util.h"
+#include "filesystem/File.h"
+#include "threads/Atomics.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "threads/ThreadLocal.h"
+#include "utils/JSONStreamWriter.h"
+#include "utils/log.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+// events per thread, must be a power of two
+#define TRACE_BUFFER_EVENTS 16384
+// threads that can be traced at the same time
+#define TRACE_MAX_BUFFERS   256
+
+// dumps are numbered, older ones are kept up to this many
+#define TRACE_MAX_DUMPS     999
+#define TRACE_DUMP_TEMPLATE "xbmc-trace%03d.json"
+
+using namespace std;
+
+struct TraceEvent
+{
+  const char *category;
+  const char *name;
+  int64_t start;
+  int64_t end;   ///< -1 for instant events
+};
+
+/*!
+ \brief Ring of events written by a single thread
+
+ Only the owning thread writes, publishing each event by incrementing
+ m_written. A reader copies the ring and afterwards discards whatever the
+ writer may have overwritten in the meantime, so neither side ever blocks.
+ */
+class CTraceBuffer
+{
+public:
+  CTraceBuffer() : m_written(0), m_threadId(0) { }
+
+  void Claim(unsigned int threadId, const string &threadName)
+  {
+    m_written = 0;
+    m_threadId = threadId;
+    m_threadName = threadName;
+  }
+
+  void Add(const char *category, const char *name, int64_t start, int64_t end)
+  {
+    TraceEvent &event = m_events[(unsigned long)m_written & (TRACE_BUFFER_EVENTS - 1)];
+    event.category = category;
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    // full barrier, the event is complete before it becomes visible
+    AtomicIncrement(&m_written);
+  }
+
+  void Collect(vector<TraceEvent> &events, int64_t since) const
+  {
+    unsigned long written = (unsigned long)AtomicAdd(&m_written, 0);
+    unsigned long count = written < TRACE_BUFFER_EVENTS ? written : TRACE_BUFFER_EVENTS;
+    unsigned long first = written - count;
+
+    vector<TraceEvent> copy;
+    copy.reserve(count);
+    for (unsigned long i = first; i != written; i++)
+      copy.push_back(m_events[i & (TRACE_BUFFER_EVENTS - 1)]);
+
+    // the writer may have lapped the oldest events while we were copying,
+    // the event being written right now reuses the slot of written - size
+    unsigned long now = (unsigned long)AtomicAdd(&m_written, 0);
+    unsigned long valid = now - first >= TRACE_BUFFER_EVENTS ? now - TRACE_BUFFER_EVENTS + 1 : first;
+    for (unsigned long i = first; i != written; i++)
+    {
+      if ((long)(i - valid) < 0)
+        continue;
+      const TraceEvent &event = copy[i - first];
+      if (event.start >= since)
+        events.push_back(event);
+    }
+  }
+
+  unsigned int GetThreadId() const { return m_threadId; }
+  const string &GetThreadName() const { return m_threadName; }
+
+private:
+  mutable volatile long m_written;
+  unsigned int m_threadId;
+  string m_threadName;
+  TraceEvent m_events[TRACE_BUFFER_EVENTS];
+};
+
+class CTraceOutputStream : public IJSONOutputStream
+{
+public:
+  CTraceOutputStream(XFILE::CFile &file) : m_file(file) { }
+
+  virtual bool Write(const char *data, size_t length)
+  {
+    return m_file.Write(data, length) == (int)length;
+  }
+
+private:
+  XFILE::CFile &m_file;
+};
+
+static void ReleaseBuffer(CTraceBuffer *buffer);
+
+/*!
+ \brief Global state, never destroyed as threads may still exit during static destruction
+ */
+struct TraceState
+{
+  TraceState() : current(ReleaseBuffer), nextThreadId(1), dropped(0), since(0) { }
+
+  CCriticalSection critSection;
+  XbmcThreads::ThreadLocal<CTraceBuffer> current;
+  vector<CTraceBuffer*> buffers;
+  vector<CTraceBuffer*> unused;
+  unsigned int nextThreadId;
+  volatile long dropped;
+  int64_t since;
+};
+
+static TraceState &GetState()
+{
+  static TraceState *state = new TraceState();
+  return *state;
+}
+
+static void ReleaseBuffer(CTraceBuffer *buffer)
+{
+  // keep the events of the exited thread until another thread needs the buffer
+  TraceState &state = GetState();
+  CSingleLock lock(state.critSection);
+  state.unused.push_back(buffer);
+}
+
+static CTraceBuffer *GetBuffer()
+{
+  TraceState &state = GetState();
+  CTraceBuffer *buffer = state.current.get();
+  if (buffer != NULL)
+    return buffer;
+
+  CSingleLock lock(state.critSection);
+  if (!state.unused.empty())
+  {
+    buffer = state.unused.back();
+    state.unused.pop_back();
+  }
+  else if (state.buffers.size() < TRACE_MAX_BUFFERS)
+  {
+    buffer = new CTraceBuffer();
+    state.buffers.push_back(buffer);
+  }
+  else
+  {
+    AtomicIncrement(&state.dropped);
+    return NULL;
+  }
+
+  unsigned int threadId = state.nextThreadId++;
+  CThread *thread = CThread::GetCurrentThread();
+  if (thread != NULL && !thread->GetThreadName().empty())
+    buffer->Claim(threadId, thread->GetThreadName());
+  else
+    buffer->Claim(threadId, StringUtils::Format("Thread %u", threadId));
+
+  state.current.set(buffer);
+  return buffer;
+}
+
+volatile bool CTrace::m_enabled = false;
+
+bool CTrace::IsSupported()
+{
+#ifdef HAS_TRACING
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool CTrace::Start()
+{
+  if (!IsSupported())
+  {
+    CLog::Log(LOGWARNING, "%s - tracing support has not been compiled in", __FUNCTION__);
+    return false;
+  }
+
+  TraceState &state = GetState();
+  {
+    CSingleLock lock(state.critSection);
+    state.since = CurrentHostCounter();
+    state.dropped = 0;
+  }
+  m_enabled = true;
+
+  CLog::Log(LOGNOTICE, "%s - tracing started", __FUNCTION__);
+  return true;
+}
+
+void CTrace::Stop()
+{
+  if (!m_enabled)
+    return;
+
+  m_enabled = false;
+  CLog::Log(LOGNOTICE, "%s - tracing stopped", __FUNCTION__);
+}
+
+void CTrace::Complete(const char *category, const char *name, int64_t start, int64_t end)
+{
+  CTraceBuffer *buffer = GetBuffer();
+  if (buffer != NULL)
+    buffer->Add(category, name, start, end);
+}
+
+void CTrace::Instant(const char *category, const char *name)
+{
+  if (!m_enabled)
+    return;
+
+  CTraceBuffer *buffer = GetBuffer();
+  if (buffer != NULL)
+    buffer->Add(category, name, CurrentHostCounter(), -1);
+}
+
+bool CTrace::Dump(string &file, bool logPath /* = false */)
+{
+  file = CUtil::GetNextFilename(URIUtils::AddFileToFolder(logPath ? "special://logpath/" : "special://temp/", TRACE_DUMP_TEMPLATE), TRACE_MAX_DUMPS);
+  if (file.empty())
+  {
+    CLog::Log(LOGERROR, "%s - too many trace dumps", __FUNCTION__);
+    return false;
+  }
+
+  // collect first, the file is written without holding the lock
+  TraceState &state = GetState();
+  vector< pair<unsigned int, string> > threads;
+  vector< vector<TraceEvent> > events;
+  long dropped;
+  {
+    CSingleLock lock(state.critSection);
+    for (vector<CTraceBuffer*>::const_iterator it = state.buffers.begin(); it != state.buffers.end(); ++it)
+    {
+      threads.push_back(make_pair((*it)->GetThreadId(), (*it)->GetThreadName()));
+      events.push_back(vector<TraceEvent>());
+      (*it)->Collect(events.back(), state.since);
+    }
+    dropped = state.dropped;
+  }
+
+  XFILE::CFile output;
+  if (!output.OpenForWrite(file, true))
+  {
+    CLog::Log(LOGERROR, "%s - unable to open %s", __FUNCTION__, file.c_str());
+    return false;
+  }
+
+  // chrome expects timestamps in microseconds
+  const double scale = 1000000.0 / CurrentHostFrequency();
+  size_t total = 0;
+
+  CTraceOutputStream stream(output);
+  CJSONStreamWriter writer(stream, true);
+  writer.StartObject();
+  writer.Key("traceEvents");
+  writer.StartArray();
+  for (size_t i = 0; i < threads.size(); i++)
+  {
+    writer.StartObject();
+    writer.Key("name"); writer.String("thread_name");
+    writer.Key("ph"); writer.String("M");
+    writer.Key("pid"); writer.Integer(1);
+    writer.Key("tid"); writer.Integer(threads[i].first);
+    writer.Key("args");
+    writer.StartObject();
+    writer.Key("name"); writer.String(threads[i].second);
+    writer.EndObject();
+    writer.EndObject();
+
+    for (vector<TraceEvent>::const_iterator event = events[i].begin(); event != events[i].end(); ++event)
+    {
+      writer.StartObject();
+      writer.Key("name"); writer.String(event->name);
+      writer.Key("cat"); writer.String(event->category);
+      writer.Key("pid"); writer.Integer(1);
+      writer.Key("tid"); writer.Integer(threads[i].first);
+      writer.Key("ts"); writer.Double((event->start - state.since) * scale);
+      if (event->end < 0)
+      {
+        writer.Key("ph"); writer.String("i");
+        writer.Key("s"); writer.String("t");
+      }
+      else
+      {
+        writer.Key("ph"); writer.String("X");
+        writer.Key("dur"); writer.Double((event->end - event->start) * scale);
+      }
+      writer.EndObject();
+    }
+    total += events[i].size();
+  }
+  writer.EndArray();
+  writer.Key("displayTimeUnit"); writer.String("ms");
+  writer.Key("otherData");
+  writer.StartObject();
+  writer.Key("droppedThreads"); writer.Integer(dropped);
+  writer.EndObject();
+  writer.EndObject();
+
+  bool success = writer.Flush();
+  output.Close();
+
+  if (!success)
+  {
+    CLog::Log(LOGERROR, "%s - unable to write %s", __FUNCTION__, file.c_str());
+    return false;
+  }
+
+  CLog::Log(LOGNOTICE, "%s - wrote %u events of %u threads to %s", __FUNCTION__,
+            (unsigned int)total, (unsigned int)threads.size(), file.c_str());
+  return true;
+}
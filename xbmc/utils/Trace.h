@@ -0,0 +1,123 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string>
+
+#include "system.h"
+#include "utils/TimeUtils.h"
+
+/* Scoped timeline tracing, only compiled in with --enable-tracing.
+ *
+ * Category and name must be string literals (or otherwise live for the
+ * whole runtime of XBMC), only the pointers are recorded.
+ *
+ *   void CSomething::Process()
+ *   {
+ *     TRACE_FUNCTION("gui");
+ *     ...
+ *     {
+ *       TRACE_SCOPE("gui", "layout");
+ *       ...
+ *     }
+ *   }
+ */
+#ifdef HAS_TRACING
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(category, name) CTraceScope TRACE_CONCAT(traceScope, __LINE__)(category, name)
+#define TRACE_FUNCTION(category) TRACE_SCOPE(category, __FUNCTION__)
+#define TRACE_INSTANT(category, name) CTrace::Instant(category, name)
+#else
+#define TRACE_SCOPE(category, name)
+#define TRACE_FUNCTION(category)
+#define TRACE_INSTANT(category, name)
+#endif
+
+/*!
+ \brief Recorder of timeline events, dumped in the Chrome trace event format
+
+ Every thread writes into its own fixed size ring buffer, recording an
+ event needs neither a lock nor an allocation. The rings keep the latest
+ events of every thread, so a trace can be dumped right after a stutter
+ was noticed. Dumps can be loaded into chrome://tracing.
+ */
+class CTrace
+{
+public:
+  /*!
+   \brief Whether tracing support has been compiled in
+   */
+  static bool IsSupported();
+
+  /*!
+   \brief Start recording, events recorded before are ignored by Dump()
+   \return false if tracing support hasn't been compiled in
+   */
+  static bool Start();
+  static void Stop();
+  static bool IsEnabled() { return m_enabled; }
+
+  /*!
+   \brief Write the recorded events as Chrome trace event JSON
+   The dump goes to a new xbmc-traceNNN.json file, callers can't pick the
+   destination as dumps can be requested remotely.
+   \param file Set to the path of the written file
+   \param logPath Write to special://logpath/ instead of special://temp/
+   \return false if the file couldn't be written
+   */
+  static bool Dump(std::string &file, bool logPath = false);
+
+  /*!
+   \brief Record an event spanning from start to end (CurrentHostCounter() values)
+   */
+  static void Complete(const char *category, const char *name, int64_t start, int64_t end);
+
+  /*!
+   \brief Record a point in time, e.g. a dropped frame
+   */
+  static void Instant(const char *category, const char *name);
+
+private:
+  static volatile bool m_enabled;
+};
+
+/*!
+ \brief Records the lifetime of the scope as a complete event, see TRACE_SCOPE
+ */
+class CTraceScope
+{
+public:
+  CTraceScope(const char *category, const char *name)
+    : m_category(category), m_name(name), m_start(CTrace::IsEnabled() ? CurrentHostCounter() : 0)
+  { }
+
+  ~CTraceScope()
+  {
+    if (m_start != 0 && CTrace::IsEnabled())
+      CTrace::Complete(m_category, m_name, m_start, CurrentHostCounter());
+  }
+
+private:
+  const char *m_category;
+  const char *m_name;
+  int64_t m_start;
+};
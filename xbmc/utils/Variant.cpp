@@ -267,6 +267,14 @@ CVariant::CVariant(const CVariant &variant)
   *this = variant;
 }
 
+#if __cplusplus >= 201103L
+CVariant::CVariant(CVariant &&variant)
+{
+  m_type = VariantTypeNull;
+  swap(variant);
+}
+#endif
+
 CVariant::~CVariant()
 {
   cleanup();
@@ -584,6 +592,19 @@ CVariant &CVariant::operator=(const CVariant &rhs)
   return *this;
 }
 
+#if __cplusplus >= 201103L
+CVariant &CVariant::operator=(CVariant &&rhs)
+{
+  if (m_type == VariantTypeConstNull || this == &rhs)
+    return *this;
+
+  cleanup();
+  swap(rhs);
+
+  return *this;
+}
+#endif
+
 bool CVariant::operator==(const CVariant &rhs) const
 {
   if (m_type == rhs.m_type)
@@ -623,7 +644,49 @@ void CVariant::push_back(const CVariant &variant)
   }
 
   if (m_type == VariantTypeArray)
+  {
+    // don't regrow when appending one of our own elements, as it'd be swapped out from under us
+    bool ownElement = !m_data.array->empty() && &variant >= &m_data.array->front() && &variant <= &m_data.array->back();
+    if (m_data.array->size() == m_data.array->capacity() && !ownElement)
+      reserveArray(m_data.array->size() * 2);
     m_data.array->push_back(variant);
+  }
+}
+
+void CVariant::push_back_swap(CVariant &variant)
+{
+  push_back(CVariant::VariantTypeNull);
+  if (m_type == VariantTypeArray)
+    m_data.array->back().swap(variant);
+}
+
+void CVariant::reserve(unsigned int size)
+{
+  if (m_type == VariantTypeNull)
+  {
+    m_type = VariantTypeArray;
+    m_data.array = new VariantArray;
+  }
+
+  if (m_type == VariantTypeArray && size > m_data.array->capacity())
+    reserveArray(size);
+}
+
+void CVariant::reserveArray(unsigned int size)
+{
+  if (size < 4)
+    size = 4;
+  if (size <= m_data.array->capacity())
+    return;
+
+  // grow into a new array and swap the elements across, so that growing an
+  // array of objects doesn't deep copy each of them.
+  VariantArray grown;
+  grown.reserve(size);
+  grown.resize(m_data.array->size());
+  for (unsigned int i = 0; i < m_data.array->size(); i++)
+    grown[i].swap((*m_data.array)[i]);
+  m_data.array->swap(grown);
 }
 
 void CVariant::append(const CVariant &variant)
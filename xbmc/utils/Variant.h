@@ -66,6 +66,9 @@ public:
   CVariant(const std::map<std::string, std::string> &strMap);
   CVariant(const std::map<std::string, CVariant> &variantMap);
   CVariant(const CVariant &variant);
+#if __cplusplus >= 201103L
+  CVariant(CVariant &&variant);
+#endif
   ~CVariant();
 
   bool isInteger() const;
@@ -94,10 +97,24 @@ public:
   const CVariant &operator[](unsigned int position) const;
 
   CVariant &operator=(const CVariant &rhs);
+#if __cplusplus >= 201103L
+  CVariant &operator=(CVariant &&rhs);
+#endif
   bool operator==(const CVariant &rhs) const;
 
   void push_back(const CVariant &variant);
   void append(const CVariant &variant);
+  /*!
+   \brief Append a variant to this array by taking over its contents
+   Avoids copying the (possibly deep) value, leaving variant null.
+   \param variant the variant to take over.
+   */
+  void push_back_swap(CVariant &variant);
+  /*!
+   \brief Make room for at least size elements in this array
+   \param size number of elements the array will hold.
+   */
+  void reserve(unsigned int size);
 
   const char *c_str() const;
 
@@ -136,6 +153,8 @@ public:
 
 private:
   void cleanup();
+  void reserveArray(unsigned int size);
+
   union VariantUnion
   {
     int64_t integer;
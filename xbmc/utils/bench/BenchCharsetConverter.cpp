@@ -0,0 +1,150 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "bench/Benchmark.h"
+#include "utils/CharsetConverter.h"
+
+static const char *BenchmarkASCII = "The Quick Brown Fox Jumps Over The Lazy Dog - Season 1 Episode 12";
+static const char *BenchmarkUTF8 = "Caf\xc3\xa9 \xc3\xa0 la cr\xc3\xa8me - \xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e - \xd0\xa0\xd1\x83\xd1\x81\xd1\x81\xd0\xba\xd0\xb8\xd0\xb9";
+static const char *BenchmarkRTL = "\xd7\xa9\xd7\x9c\xd7\x95\xd7\x9d \xd7\xa2\xd7\x95\xd7\x9c\xd7\x9d - Season 1 Episode 12";
+
+BENCHMARK(CharsetConverter, Utf8ToWASCII)
+{
+  CStdStringA input(BenchmarkASCII);
+  while (state.KeepRunning())
+  {
+    CStdStringW output;
+    g_charsetConverter.utf8ToW(input, output, false);
+    BenchmarkUse(output);
+  }
+  state.SetBytesProcessed(input.size());
+}
+
+BENCHMARK(CharsetConverter, Utf8ToW)
+{
+  CStdStringA input(BenchmarkUTF8);
+  while (state.KeepRunning())
+  {
+    CStdStringW output;
+    g_charsetConverter.utf8ToW(input, output, false);
+    BenchmarkUse(output);
+  }
+  state.SetBytesProcessed(input.size());
+}
+
+// labels are drawn with bVisualBiDiFlip set
+BENCHMARK(CharsetConverter, Utf8ToWFlipASCII)
+{
+  CStdStringA input(BenchmarkASCII);
+  while (state.KeepRunning())
+  {
+    CStdStringW output;
+    g_charsetConverter.utf8ToW(input, output);
+    BenchmarkUse(output);
+  }
+  state.SetBytesProcessed(input.size());
+}
+
+BENCHMARK(CharsetConverter, Utf8ToWFlip)
+{
+  CStdStringA input(BenchmarkUTF8);
+  while (state.KeepRunning())
+  {
+    CStdStringW output;
+    g_charsetConverter.utf8ToW(input, output);
+    BenchmarkUse(output);
+  }
+  state.SetBytesProcessed(input.size());
+}
+
+BENCHMARK(CharsetConverter, Utf8ToWFlipRTL)
+{
+  CStdStringA input(BenchmarkRTL);
+  while (state.KeepRunning())
+  {
+    CStdStringW output;
+    g_charsetConverter.utf8ToW(input, output);
+    BenchmarkUse(output);
+  }
+  state.SetBytesProcessed(input.size());
+}
+
+BENCHMARK(CharsetConverter, Utf8ToWFlipRTLUncached)
+{
+  CStdStringA input(BenchmarkRTL);
+  g_charsetConverter.SetBiDiCacheSize(0);
+  while (state.KeepRunning())
+  {
+    CStdStringW output;
+    g_charsetConverter.utf8ToW(input, output);
+    BenchmarkUse(output);
+  }
+  g_charsetConverter.SetBiDiCacheSize(512);
+  state.SetBytesProcessed(input.size());
+}
+
+BENCHMARK(CharsetConverter, WToUtf8)
+{
+  CStdStringW input;
+  g_charsetConverter.utf8ToW(BenchmarkUTF8, input, false);
+  while (state.KeepRunning())
+  {
+    CStdStringA output;
+    g_charsetConverter.wToUTF8(input, output);
+    BenchmarkUse(output);
+  }
+  state.SetItemsProcessed(input.size());
+}
+
+BENCHMARK(CharsetConverter, Utf8ToUtf16)
+{
+  CStdStringA input(BenchmarkUTF8);
+  while (state.KeepRunning())
+  {
+    CStdString16 output;
+    g_charsetConverter.utf8To("UTF-16LE", input, output);
+    BenchmarkUse(output);
+  }
+  state.SetBytesProcessed(input.size());
+}
+
+BENCHMARK(CharsetConverter, IsValidUtf8)
+{
+  CStdString input(BenchmarkUTF8);
+  while (state.KeepRunning())
+  {
+    bool valid = g_charsetConverter.isValidUtf8(input);
+    BenchmarkUse(valid);
+  }
+  state.SetBytesProcessed(input.size());
+}
+
+BENCHMARK(CharsetConverter, IsValidUtf8ASCII)
+{
+  CStdString input;
+  for (int i = 0; i < 16; i++)
+    input += BenchmarkASCII;
+  while (state.KeepRunning())
+  {
+    bool valid = g_charsetConverter.isValidUtf8(input);
+    BenchmarkUse(valid);
+  }
+  state.SetBytesProcessed(input.size());
+}
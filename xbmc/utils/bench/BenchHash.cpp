@@ -0,0 +1,77 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "bench/Benchmark.h"
+#include "utils/Crc32.h"
+#include "utils/md5.h"
+
+#include <string>
+
+#define HASH_BUFFER_SIZE (64 * 1024)
+
+BENCHMARK(Hash, Crc32)
+{
+  std::string buffer(HASH_BUFFER_SIZE, 'x');
+  while (state.KeepRunning())
+  {
+    Crc32 crc;
+    crc.Compute(buffer.c_str(), buffer.size());
+    BenchmarkUse((uint32_t)crc);
+  }
+  state.SetBytesProcessed(buffer.size());
+}
+
+BENCHMARK(Hash, Crc32Path)
+{
+  // the thumbnail and fanart hashes are computed from (lower cased) paths
+  CStdString path = "smb://Server/Share/Movies/Some Movie (2013)/Some.Movie.2013.1080p.BluRay.x264.mkv";
+  while (state.KeepRunning())
+  {
+    Crc32 crc;
+    crc.ComputeFromLowerCase(path);
+    BenchmarkUse((uint32_t)crc);
+  }
+  state.SetBytesProcessed(path.size());
+}
+
+BENCHMARK(Hash, MD5)
+{
+  std::string buffer(HASH_BUFFER_SIZE, 'x');
+  while (state.KeepRunning())
+  {
+    XBMC::XBMC_MD5 md5;
+    unsigned char digest[16];
+    md5.append(buffer.c_str(), buffer.size());
+    md5.getDigest(digest);
+    BenchmarkUse(digest);
+  }
+  state.SetBytesProcessed(buffer.size());
+}
+
+BENCHMARK(Hash, MD5String)
+{
+  CStdString text = "smb://server/share/Movies/Some Movie (2013)/Some.Movie.2013.1080p.BluRay.x264.mkv";
+  while (state.KeepRunning())
+  {
+    CStdString digest = XBMC::XBMC_MD5::GetMD5(text);
+    BenchmarkUse(digest);
+  }
+  state.SetBytesProcessed(text.size());
+}
@@ -0,0 +1,92 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "bench/Benchmark.h"
+#include "utils/JSONVariantParser.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/Variant.h"
+
+static CVariant BuildResponse(int count)
+{
+  CVariant result(CVariant::VariantTypeObject);
+  result["limits"]["start"] = 0;
+  result["limits"]["end"] = count;
+  result["limits"]["total"] = count;
+  for (int i = 0; i < count; i++)
+  {
+    CVariant movie(CVariant::VariantTypeObject);
+    movie["movieid"] = i;
+    movie["label"] = "Some movie title with \"quotes\" and \xc3\xa9";
+    movie["genre"].push_back("Drama");
+    movie["genre"].push_back("Thriller");
+    movie["rating"] = 6.5;
+    movie["year"] = 1990 + i % 25;
+    movie["playcount"] = i % 3;
+    result["movies"].push_back(movie);
+  }
+  return result;
+}
+
+BENCHMARK(JSON, Write)
+{
+  CVariant response = BuildResponse(500);
+  std::string json = CJSONVariantWriter::Write(response, true);
+  while (state.KeepRunning())
+  {
+    std::string output = CJSONVariantWriter::Write(response, true);
+    BenchmarkUse(output);
+  }
+  state.SetBytesProcessed(json.size());
+}
+
+BENCHMARK(JSON, Parse)
+{
+  std::string json = CJSONVariantWriter::Write(BuildResponse(500), false);
+  if (!CJSONVariantParser::Parse((const unsigned char *)json.c_str(), json.size()).isObject())
+  {
+    state.SetError("unable to parse the serialized response");
+    return;
+  }
+
+  while (state.KeepRunning())
+  {
+    CVariant parsed = CJSONVariantParser::Parse((const unsigned char *)json.c_str(), json.size());
+    BenchmarkUse(parsed);
+  }
+  state.SetBytesProcessed(json.size());
+}
+
+BENCHMARK(JSON, ParseRequest)
+{
+  std::string json = "{\"jsonrpc\": \"2.0\", \"method\": \"VideoLibrary.GetMovies\", \"params\": "
+                     "{ \"properties\": [\"title\", \"year\", \"rating\"], \"limits\": { \"start\": 0, \"end\": 50 } }, \"id\": 1}";
+  if (!CJSONVariantParser::Parse((const unsigned char *)json.c_str(), json.size()).isObject())
+  {
+    state.SetError("unable to parse the request");
+    return;
+  }
+
+  while (state.KeepRunning())
+  {
+    CVariant parsed = CJSONVariantParser::Parse((const unsigned char *)json.c_str(), json.size());
+    BenchmarkUse(parsed);
+  }
+  state.SetBytesProcessed(json.size());
+}
@@ -0,0 +1,101 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "bench/Benchmark.h"
+#include "threads/Atomics.h"
+#include "threads/Event.h"
+#include "utils/JobManager.h"
+
+#define JOBS_PER_ITERATION 1000
+
+class CBenchmarkJob : public CJob
+{
+public:
+  CBenchmarkJob(volatile long *counter) : m_counter(counter) {}
+  virtual bool DoWork()
+  {
+    AtomicIncrement(m_counter);
+    return true;
+  }
+  virtual const char *GetType() const { return "benchmarkjob"; }
+private:
+  volatile long *m_counter;
+};
+
+class CBenchmarkJobCallback : public IJobCallback
+{
+public:
+  CBenchmarkJobCallback() : m_completed(0), m_expected(0) {}
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    if (AtomicIncrement(&m_completed) == m_expected)
+      m_done.Set();
+  }
+  void Expect(long jobs)
+  {
+    m_completed = 0;
+    m_expected = jobs;
+    m_done.Reset();
+  }
+  bool Wait()
+  {
+    if (!m_done.WaitMSec(60000))
+      return false;
+    // the manager drops the job from its processing list only after the callback returned
+    while (CJobManager::GetInstance().IsProcessing("benchmarkjob"))
+      XbmcThreads::ThreadSleep(0);
+    return true;
+  }
+private:
+  volatile long m_completed;
+  long m_expected;
+  CEvent m_done;
+};
+
+static void JobManagerBenchmark(CBenchmarkState &state, bool mixedPriorities)
+{
+  volatile long counter = 0;
+  CBenchmarkJobCallback callback;
+  while (state.KeepRunning())
+  {
+    callback.Expect(JOBS_PER_ITERATION);
+    for (int i = 0; i < JOBS_PER_ITERATION; i++)
+    {
+      CJob::PRIORITY priority = mixedPriorities ? CJob::PRIORITY(i % (CJob::PRIORITY_HIGH + 1)) : CJob::PRIORITY_LOW;
+      CJobManager::GetInstance().AddJob(new CBenchmarkJob(&counter), &callback, priority);
+    }
+    if (!callback.Wait())
+    {
+      state.SetError("jobs did not complete in time");
+      break;
+    }
+  }
+  state.SetItemsProcessed(JOBS_PER_ITERATION);
+}
+
+BENCHMARK(JobManager, AddJob)
+{
+  JobManagerBenchmark(state, false);
+}
+
+BENCHMARK(JobManager, AddJobPriorities)
+{
+  JobManagerBenchmark(state, true);
+}
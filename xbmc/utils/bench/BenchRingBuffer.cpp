@@ -0,0 +1,58 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "bench/Benchmark.h"
+#include "utils/RingBuffer.h"
+
+#include <string.h>
+
+static void RingBufferBenchmark(CBenchmarkState &state, unsigned int chunkSize)
+{
+  CRingBuffer buffer;
+  if (!buffer.Create(256 * 1024))
+  {
+    state.SetError("unable to create ring buffer");
+    return;
+  }
+
+  char *data = new char[chunkSize];
+  memset(data, 'x', chunkSize);
+  while (state.KeepRunning())
+  {
+    if (!buffer.WriteData(data, chunkSize) || !buffer.ReadData(data, chunkSize))
+    {
+      state.SetError("ring buffer transfer failed");
+      break;
+    }
+  }
+  delete[] data;
+
+  state.SetBytesProcessed(chunkSize);
+}
+
+BENCHMARK(RingBuffer, SmallChunks)
+{
+  RingBufferBenchmark(state, 188);
+}
+
+BENCHMARK(RingBuffer, LargeChunks)
+{
+  RingBufferBenchmark(state, 32 * 1024);
+}
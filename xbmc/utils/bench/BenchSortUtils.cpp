@@ -0,0 +1,132 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "bench/Benchmark.h"
+#include "utils/NaturalSort.h"
+#include "utils/SortUtils.h"
+#include "utils/StringUtils.h"
+#include "utils/Variant.h"
+
+#include <stdlib.h>
+
+static SortItems BuildItems(unsigned int count)
+{
+  // deterministic pseudo random labels so every run sorts the same input
+  srand(4711);
+
+  SortItems items;
+  for (unsigned int i = 0; i < count; i++)
+  {
+    SortItem item;
+    item[FieldLabel] = StringUtils::Format("The Movie %d Part %d", rand() % 1000, rand() % 10);
+    item[FieldYear] = 1950 + rand() % 64;
+    item[FieldRating] = (rand() % 100) / 10.0f;
+    items.push_back(item);
+  }
+  return items;
+}
+
+static void SortBenchmark(CBenchmarkState &state, SortBy sortBy, SortAttribute attributes, unsigned int count)
+{
+  SortItems items = BuildItems(count);
+  while (state.KeepRunning())
+  {
+    state.PauseTiming();
+    SortItems copy(items);
+    state.ResumeTiming();
+
+    SortUtils::Sort(sortBy, SortOrderAscending, attributes, copy);
+  }
+  state.SetItemsProcessed(count);
+}
+
+BENCHMARK(SortUtils, Label)
+{
+  SortBenchmark(state, SortByLabel, SortAttributeNone, 2000);
+}
+
+BENCHMARK(SortUtils, LabelIgnoreArticle)
+{
+  SortBenchmark(state, SortByLabel, SortAttributeIgnoreArticle, 2000);
+}
+
+BENCHMARK(SortUtils, Year)
+{
+  SortBenchmark(state, SortByYear, SortAttributeNone, 2000);
+}
+
+BENCHMARK(SortUtils, Rating)
+{
+  SortBenchmark(state, SortByRating, SortAttributeNone, 2000);
+}
+
+BENCHMARK(SortUtils, Limit)
+{
+  SortItems items = BuildItems(2000);
+  while (state.KeepRunning())
+  {
+    state.PauseTiming();
+    SortItems copy(items);
+    state.ResumeTiming();
+
+    SortUtils::Sort(SortByLabel, SortOrderAscending, SortAttributeNone, copy, 50);
+  }
+  state.SetItemsProcessed(2000);
+}
+
+static std::vector<std::wstring> BuildLabels(unsigned int count)
+{
+  SortItems items = BuildItems(count);
+  std::vector<std::wstring> labels;
+  for (SortItems::const_iterator it = items.begin(); it != items.end(); ++it)
+    labels.push_back(it->find(FieldLabel)->second.asWideString());
+  return labels;
+}
+
+BENCHMARK(SortUtils, AlphaNumericCompare)
+{
+  std::vector<std::wstring> labels = BuildLabels(1000);
+  while (state.KeepRunning())
+  {
+    int64_t result = 0;
+    for (size_t i = 1; i < labels.size(); i++)
+      result += StringUtils::AlphaNumericCompare(labels[i - 1].c_str(), labels[i].c_str());
+    BenchmarkUse(result);
+  }
+  state.SetItemsProcessed(labels.size() - 1);
+}
+
+BENCHMARK(SortUtils, NaturalSortKeyCompare)
+{
+  std::vector<std::wstring> labels = BuildLabels(1000);
+  std::vector<CNaturalSortKey> keys;
+  for (size_t i = 0; i < labels.size(); i++)
+    keys.push_back(CNaturalSortKey(labels[i]));
+
+  CNaturalSortCollator collator;
+  while (state.KeepRunning())
+  {
+    int result = 0;
+    for (size_t i = 1; i < keys.size(); i++)
+      result += keys[i - 1].Compare(keys[i], collator);
+    BenchmarkUse(result);
+  }
+  state.SetItemsProcessed(keys.size() - 1);
+}
@@ -0,0 +1,90 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "bench/Benchmark.h"
+#include "utils/StringUtils.h"
+
+static const char *BenchmarkSentence = "The Quick Brown Fox Jumps Over The Lazy Dog, Again And Again";
+
+BENCHMARK(StringUtils, ToLower)
+{
+  std::string input(BenchmarkSentence);
+  while (state.KeepRunning())
+  {
+    std::string copy(input);
+    StringUtils::ToLower(copy);
+    BenchmarkUse(copy);
+  }
+  state.SetBytesProcessed(input.size());
+}
+
+BENCHMARK(StringUtils, Trim)
+{
+  std::string input = std::string("  \t ") + BenchmarkSentence + " \r\n ";
+  while (state.KeepRunning())
+  {
+    std::string copy(input);
+    StringUtils::Trim(copy);
+    BenchmarkUse(copy);
+  }
+}
+
+BENCHMARK(StringUtils, Replace)
+{
+  std::string input(BenchmarkSentence);
+  while (state.KeepRunning())
+  {
+    std::string copy(input);
+    StringUtils::Replace(copy, "Again", "once more");
+    BenchmarkUse(copy);
+  }
+  state.SetBytesProcessed(input.size());
+}
+
+BENCHMARK(StringUtils, Split)
+{
+  CStdString input = "smb://server/share/Movies/Some Movie (2013)/Some.Movie.2013.1080p.mkv";
+  while (state.KeepRunning())
+  {
+    std::vector<std::string> tokens = StringUtils::Split(input, "/");
+    BenchmarkUse(tokens);
+  }
+  state.SetBytesProcessed(input.size());
+}
+
+BENCHMARK(StringUtils, Format)
+{
+  while (state.KeepRunning())
+  {
+    std::string formatted = StringUtils::Format("%s - S%02dE%02d - %s (%.1f)", "Show", 3, 12, "Episode title", 8.5);
+    BenchmarkUse(formatted);
+  }
+}
+
+BENCHMARK(StringUtils, AlphaNumericCompare)
+{
+  const wchar_t *left = L"Episode 10 - The Return of the Something 2";
+  const wchar_t *right = L"Episode 9 - The Return of the Something 10";
+  while (state.KeepRunning())
+  {
+    int64_t result = StringUtils::AlphaNumericCompare(left, right);
+    BenchmarkUse(result);
+  }
+}
@@ -0,0 +1,100 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "bench/Benchmark.h"
+#include "utils/Variant.h"
+
+static CVariant BuildEpisode(int id)
+{
+  CVariant episode(CVariant::VariantTypeObject);
+  episode["episodeid"] = id;
+  episode["label"] = "Some episode label";
+  episode["file"] = "smb://server/share/TV Shows/Some Show/Season 1/Some.Show.S01E01.mkv";
+  episode["rating"] = 7.5;
+  episode["playcount"] = 0;
+  episode["watched"] = false;
+  episode["streamdetails"]["video"].push_back(CVariant(CVariant::VariantTypeObject));
+  episode["streamdetails"]["video"][0]["codec"] = "h264";
+  episode["streamdetails"]["video"][0]["width"] = 1920;
+  return episode;
+}
+
+BENCHMARK(Variant, BuildObject)
+{
+  while (state.KeepRunning())
+  {
+    CVariant episode = BuildEpisode(1);
+    BenchmarkUse(episode);
+  }
+  state.SetItemsProcessed(1);
+}
+
+BENCHMARK(Variant, PushBack)
+{
+  CVariant episode = BuildEpisode(1);
+  while (state.KeepRunning())
+  {
+    CVariant episodes(CVariant::VariantTypeArray);
+    for (int i = 0; i < 100; i++)
+      episodes.push_back(episode);
+    BenchmarkUse(episodes);
+  }
+  state.SetItemsProcessed(100);
+}
+
+// how JSON-RPC builds a list response, see CFileItemHandler
+BENCHMARK(Variant, BuildResponse)
+{
+  while (state.KeepRunning())
+  {
+    CVariant result(CVariant::VariantTypeObject);
+    for (int i = 0; i < 100; i++)
+    {
+      CVariant episode = BuildEpisode(i);
+      result["episodes"].push_back_swap(episode);
+    }
+    BenchmarkUse(result);
+  }
+  state.SetItemsProcessed(100);
+}
+
+BENCHMARK(Variant, CopyTree)
+{
+  CVariant episodes(CVariant::VariantTypeArray);
+  for (int i = 0; i < 100; i++)
+    episodes.push_back(BuildEpisode(i));
+
+  while (state.KeepRunning())
+  {
+    CVariant copy(episodes);
+    BenchmarkUse(copy);
+  }
+  state.SetItemsProcessed(100);
+}
+
+BENCHMARK(Variant, Lookup)
+{
+  CVariant episode = BuildEpisode(1);
+  while (state.KeepRunning())
+  {
+    int64_t width = episode["streamdetails"]["video"][0]["width"].asInteger();
+    BenchmarkUse(width);
+  }
+}
@@ -24,6 +24,8 @@
 #include "stat_utf8.h"
 #include "threads/CriticalSection.h"
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
+#include "threads/Event.h"
 #include "threads/Thread.h"
 #include "utils/StdString.h"
 #if defined(TARGET_ANDROID)
@@ -39,10 +41,264 @@
 #define m_repeatLine XBMC_GLOBAL_USE(CLog::CLogGlobals).m_repeatLine
 #define m_logLevel XBMC_GLOBAL_USE(CLog::CLogGlobals).m_logLevel
 #define m_extraLogLevels XBMC_GLOBAL_USE(CLog::CLogGlobals).m_extraLogLevels
+#define m_writer XBMC_GLOBAL_USE(CLog::CLogGlobals).m_writer
+#define m_async XBMC_GLOBAL_USE(CLog::CLogGlobals).m_async
+
+#define LOG_QUEUE_SIZE       4096 // records, must be a power of two
+#define LOG_WRITER_INTERVAL  100  // ms the writer sleeps when nobody wakes it
+#define LOG_CRASH_LOCK_TRIES 100  // ms a crashing thread waits for the log lock
 
 static char levelNames[][8] =
 {"DEBUG", "INFO", "NOTICE", "WARNING", "ERROR", "SEVERE", "FATAL", "NONE"};
 
+/*! \brief A log line formatted on the calling thread, waiting to be written */
+struct LogRecord
+{
+  int         level;
+  SYSTEMTIME  time;
+  uint64_t    threadId;
+  std::string data;
+};
+
+/*! \brief Bounded multi-producer, single-consumer queue of log records.
+ Every cell carries a sequence number telling producers and the consumer whose
+ turn it is, so neither side ever takes a lock.
+ */
+class CLogQueue
+{
+public:
+  CLogQueue() : m_enqueuePos(0), m_dequeuePos(0)
+  {
+    for (long i = 0; i < LOG_QUEUE_SIZE; i++)
+    {
+      m_cells[i].sequence = i;
+      m_cells[i].record = NULL;
+    }
+  }
+
+  ~CLogQueue()
+  {
+    LogRecord *record;
+    while ((record = Pop()) != NULL)
+      delete record;
+  }
+
+  /*! \brief Queue a record, safe to call from any thread.
+   \return false if the queue is full, the caller keeps ownership of the record.
+   */
+  bool Push(LogRecord *record)
+  {
+    long pos = AtomicAdd(&m_enqueuePos, 0);
+    for (;;)
+    {
+      Cell &cell = m_cells[pos & (LOG_QUEUE_SIZE - 1)];
+      long diff = AtomicAdd(&cell.sequence, 0) - pos;
+      if (diff == 0)
+      {
+        long prev = cas(&m_enqueuePos, pos, pos + 1);
+        if (prev == pos)
+        {
+          cell.record = record;
+          // publish the record to the consumer
+          cas(&cell.sequence, pos, pos + 1);
+          return true;
+        }
+        pos = prev;
+      }
+      else if (diff < 0)
+        return false;
+      else
+        pos = AtomicAdd(&m_enqueuePos, 0);
+    }
+  }
+
+  /*! \brief Take the oldest record, only ever called by one thread at a time.
+   \return the record, or NULL if nothing has been published yet.
+   */
+  LogRecord *Pop()
+  {
+    Cell &cell = m_cells[m_dequeuePos & (LOG_QUEUE_SIZE - 1)];
+    if (AtomicAdd(&cell.sequence, 0) != m_dequeuePos + 1)
+      return NULL;
+    LogRecord *record = cell.record;
+    cell.record = NULL;
+    // hand the cell back to the producers for the next round
+    cas(&cell.sequence, m_dequeuePos + 1, m_dequeuePos + LOG_QUEUE_SIZE);
+    m_dequeuePos++;
+    return record;
+  }
+
+  /*! \brief Approximate number of queued records */
+  long Size()
+  {
+    return AtomicAdd(&m_enqueuePos, 0) - m_dequeuePos;
+  }
+
+private:
+  struct Cell
+  {
+    volatile long sequence;
+    LogRecord    *record;
+  };
+
+  Cell          m_cells[LOG_QUEUE_SIZE];
+  volatile long m_enqueuePos;
+  volatile long m_dequeuePos;
+};
+
+/*! \brief Background thread draining the log queue into the log file.
+ Lines are written in batches with a single fflush per batch.
+ */
+class CLogWriter : public CThread
+{
+public:
+  CLogWriter() : CThread("LogWriter"), m_queued(0), m_written(0), m_dropped(0) {}
+
+  /*! \brief Queue a record, dropping it if the queue is full and the line is not important.
+   \return true if the writer took ownership of the record.
+   */
+  bool Queue(LogRecord *record)
+  {
+    while (!m_queue.Push(record))
+    {
+      if (record->level < LOGERROR)
+      {
+        AtomicIncrement(&m_dropped);
+        delete record;
+        return true;
+      }
+      // errors are never dropped, wait for the writer to make room
+      if (!IsRunning() || IsCurrentThread())
+        return false;
+      m_wakeup.Set();
+      XbmcThreads::ThreadSleep(1);
+    }
+    AtomicIncrement(&m_queued);
+    if (record->level >= LOGERROR || m_queue.Size() >= LOG_QUEUE_SIZE / 4)
+      m_wakeup.Set();
+    return true;
+  }
+
+  /*! \brief Wait until everything queued before the call has been written */
+  void Flush()
+  {
+    long target = AtomicAdd(&m_queued, 0);
+    if (IsCurrentThread())
+      return;
+    while (AtomicAdd(&m_written, 0) - target < 0 && IsRunning())
+    {
+      m_wakeup.Set();
+      m_drained.WaitMSec(10);
+    }
+    // writer is gone, write whatever is left ourselves
+    if (AtomicAdd(&m_written, 0) - target < 0)
+      Drain();
+  }
+
+  /*! \brief Write out every published record, may be called on any thread */
+  void Drain()
+  {
+    std::string output;
+
+    CSingleLock lock(critSec);
+    long count = Collect(output);
+    if (m_file && !output.empty())
+    {
+      fwrite(output.c_str(), output.size(), 1, m_file);
+      fflush(m_file);
+    }
+    lock.Leave();
+
+    Written(count);
+  }
+
+  /*! \brief Format every published record into output, the caller holds critSec.
+   Records are only ever taken out of the queue with critSec held, which keeps
+   the queue single-consumer whichever thread drains it.
+   \return the number of records taken, to be passed to Written() once output reached the file.
+   */
+  long Collect(std::string &output)
+  {
+    long count = 0;
+    LogRecord *record;
+    while ((record = m_queue.Pop()) != NULL)
+    {
+      CLog::FormatLine(record->level, record->time.wHour, record->time.wMinute, record->time.wSecond,
+                       record->threadId, record->data, output);
+      delete record;
+      count++;
+    }
+
+    long dropped = AtomicAdd(&m_dropped, 0);
+    if (dropped > 0 && cas(&m_dropped, dropped, 0) == dropped)
+    {
+      SYSTEMTIME time;
+      GetLocalTime(&time);
+      CStdString notice;
+      notice.Format("%ld log lines dropped, the log writer could not keep up", dropped);
+      CLog::FormatLine(LOGWARNING, time.wHour, time.wMinute, time.wSecond,
+                       (uint64_t)CThread::GetCurrentThreadId(), notice, output);
+    }
+    return count;
+  }
+
+  /*! \brief Account for records written by whoever collected them, waking Flush() */
+  void Written(long count)
+  {
+    if (count == 0)
+      return;
+    AtomicAdd(&m_written, count);
+    m_drained.Set();
+  }
+
+  /*! \brief Write out what is queued from a crashing thread.
+   Gives up rather than deadlocking when another thread holds the log lock.
+   */
+  void DrainOnCrash()
+  {
+    for (int i = 0; i < LOG_CRASH_LOCK_TRIES; i++)
+    {
+      if (critSec.try_lock())
+      {
+        std::string output;
+        Collect(output);
+        if (m_file && !output.empty())
+        {
+          fwrite(output.c_str(), output.size(), 1, m_file);
+          fflush(m_file);
+        }
+        critSec.unlock();
+        return;
+      }
+      XbmcThreads::ThreadSleep(1);
+    }
+  }
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      AbortableWait(m_wakeup, LOG_WRITER_INTERVAL);
+      Drain();
+    }
+    Drain();
+  }
+
+private:
+  CLogQueue     m_queue;
+  CEvent        m_wakeup;
+  CEvent        m_drained;
+  volatile long m_queued;
+  volatile long m_written;
+  volatile long m_dropped;
+};
+
+static void FlushLogAtExit()
+{
+  CLog::SetAsync(false);
+}
+
 CLog::CLog()
 {}
 
@@ -51,7 +307,8 @@ CLog::~CLog()
 
 void CLog::Close()
 {
-  
+  SetAsync(false);
+
   CSingleLock waitLock(critSec);
   if (m_file)
   {
@@ -61,85 +318,183 @@ void CLog::Close()
   m_repeatLine.clear();
 }
 
-void CLog::Log(int loglevel, const char *format, ... )
+bool CLog::IsLogged(int loglevel, int extras)
 {
-  static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%"PRIu64" %7s: ";
-  CSingleLock waitLock(critSec);
-  int extras = (loglevel >> LOGMASKBIT) << LOGMASKBIT;
-  loglevel = loglevel & LOGMASK;
 #if !(defined(_DEBUG) || defined(PROFILE))
-  if (m_logLevel > LOG_LEVEL_NORMAL ||
-     (m_logLevel > LOG_LEVEL_NONE && loglevel >= LOGNOTICE))
+  if (!(m_logLevel > LOG_LEVEL_NORMAL ||
+       (m_logLevel > LOG_LEVEL_NONE && loglevel >= LOGNOTICE)))
+    return false;
 #endif
-  {
-    if (!m_file)
-      return;
+  if (!m_file)
+    return false;
 
-    if (extras != 0 && (m_extraLogLevels & extras) == 0)
-      return;
+  if (extras != 0 && (m_extraLogLevels & extras) == 0)
+    return false;
 
-    SYSTEMTIME time;
-    GetLocalTime(&time);
+  return true;
+}
 
-    CStdString strPrefix, strData;
+void CLog::Log(int loglevel, const char *format, ... )
+{
+  int extras = (loglevel >> LOGMASKBIT) << LOGMASKBIT;
+  loglevel = loglevel & LOGMASK;
 
-    strData.reserve(16384);
-    va_list va;
-    va_start(va, format);
-    strData.FormatV(format,va);
-    va_end(va);
+  // filter before formatting, rejected lines cost no more than a few reads
+  if (!IsLogged(loglevel, extras))
+    return;
 
-    if (m_repeatLogLevel == loglevel && m_repeatLine == strData)
-    {
-      m_repeatCount++;
-      return;
-    }
-    else if (m_repeatCount)
+  SYSTEMTIME time;
+  GetLocalTime(&time);
+
+  CStdString strData;
+  va_list va;
+  va_start(va, format);
+  strData.FormatV(format,va);
+  va_end(va);
+
+  if (m_async)
+  {
+    CLogWriter *writer = m_writer;
+    if (writer)
     {
-      CStdString strData2;
-      strPrefix.Format(prefixFormat, time.wHour, time.wMinute, time.wSecond, (uint64_t)CThread::GetCurrentThreadId(), levelNames[m_repeatLogLevel]);
-
-      strData2.Format("Previous line repeats %d times." LINE_ENDING, m_repeatCount);
-      fputs(strPrefix.c_str(), m_file);
-      fputs(strData2.c_str(), m_file);
-      OutputDebugString(strData2);
-      m_repeatCount = 0;
+      LogRecord *record = new LogRecord;
+      record->level = loglevel;
+      record->time = time;
+      record->threadId = (uint64_t)CThread::GetCurrentThreadId();
+      record->data.swap(strData);
+      if (writer->Queue(record))
+      {
+        // make sure severe errors hit the disk before we possibly go down
+        if (loglevel >= LOGSEVERE)
+          writer->Flush();
+        return;
+      }
+      strData.swap(record->data);
+      delete record;
     }
-    
-    m_repeatLine      = strData;
-    m_repeatLogLevel  = loglevel;
+  }
 
-    unsigned int length = 0;
-    while ( length != strData.length() )
+  std::string output;
+  CSingleLock waitLock(critSec);
+  // lines still queued were logged before this one, keep them in front
+  CLogWriter *writer = m_writer;
+  long collected = writer ? writer->Collect(output) : 0;
+  if (m_file)
+  {
+    FormatLine(loglevel, time.wHour, time.wMinute, time.wSecond,
+               (uint64_t)CThread::GetCurrentThreadId(), strData, output);
+    if (!output.empty())
     {
-      length = strData.length();
-      strData.TrimRight(" ");
-      strData.TrimRight('\n');
-      strData.TrimRight("\r");
+      fputs(output.c_str(), m_file);
+      fflush(m_file);
     }
+  }
+  waitLock.Leave();
+  if (writer)
+    writer->Written(collected);
+}
 
-    if (!length)
-      return;
-    
-    OutputDebugString(strData);
+void CLog::FormatLine(int loglevel, int hour, int minute, int second, uint64_t threadId, std::string &data, std::string &output)
+{
+  static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%"PRIu64" %7s: ";
+  CStdString strPrefix, strData;
+
+  if (m_repeatLogLevel == loglevel && m_repeatLine == data)
+  {
+    m_repeatCount++;
+    return;
+  }
+  else if (m_repeatCount)
+  {
+    CStdString strData2;
+    strPrefix.Format(prefixFormat, hour, minute, second, threadId, levelNames[m_repeatLogLevel]);
+
+    strData2.Format("Previous line repeats %d times." LINE_ENDING, m_repeatCount);
+    output += strPrefix;
+    output += strData2;
+    OutputDebugString(strData2);
+    m_repeatCount = 0;
+  }
+
+  m_repeatLine      = data;
+  m_repeatLogLevel  = loglevel;
+
+  strData.swap(data);
+  unsigned int length = 0;
+  while ( length != strData.length() )
+  {
+    length = strData.length();
+    strData.TrimRight(" ");
+    strData.TrimRight('\n');
+    strData.TrimRight("\r");
+  }
 
-    /* fixup newline alignment, number of spaces should equal prefix length */
-    strData.Replace("\n", LINE_ENDING"                                            ");
-    strData += LINE_ENDING;
+  if (!length)
+    return;
 
-    strPrefix.Format(prefixFormat, time.wHour, time.wMinute, time.wSecond, (uint64_t)CThread::GetCurrentThreadId(), levelNames[loglevel]);
+  OutputDebugString(strData);
+
+  /* fixup newline alignment, number of spaces should equal prefix length */
+  strData.Replace("\n", LINE_ENDING"                                            ");
+  strData += LINE_ENDING;
+
+  strPrefix.Format(prefixFormat, hour, minute, second, threadId, levelNames[loglevel]);
 
 //print to adb
 #if defined(TARGET_ANDROID) && defined(_DEBUG)
   CXBMCApp::android_printf("%s%s",strPrefix.c_str(), strData.c_str());
 #endif
 
-    fputs(strPrefix.c_str(), m_file);
-    fputs(strData.c_str(), m_file);
-    fflush(m_file);
+  output += strPrefix;
+  output += strData;
+}
+
+void CLog::SetAsync(bool async)
+{
+  CSingleLock waitLock(critSec);
+  if (async == m_async)
+    return;
+
+  if (async)
+  {
+    if (!m_writer)
+    {
+      // the writer lives as long as the process, callers may still hold on to it
+      m_writer = new CLogWriter();
+      atexit(FlushLogAtExit);
+    }
+    m_writer->Create();
+    m_async = true;
+  }
+  else
+  {
+    m_async = false;
+    CLogWriter *writer = m_writer;
+    waitLock.Leave();
+    writer->StopThread();
+    // pick up anything queued while the writer was shutting down
+    writer->Drain();
   }
 }
 
+bool CLog::IsAsync()
+{
+  return m_async;
+}
+
+void CLog::Flush()
+{
+  if (m_async && m_writer)
+    m_writer->Flush();
+}
+
+void CLog::FlushOnCrash()
+{
+  CLogWriter *writer = m_writer;
+  if (writer)
+    writer->DrainOnCrash();
+}
+
 bool CLog::Init(const char* path)
 {
   CSingleLock waitLock(critSec);
@@ -21,6 +21,7 @@
  */
 
 #include <stdio.h>
+#include <stdint.h>
 #include <string>
 
 #include "commons/ilog.h"
@@ -33,6 +34,8 @@
 #define ATTRIB_LOG_FORMAT
 #endif
 
+class CLogWriter;
+
 class CLog
 {
 public:
@@ -40,13 +43,15 @@ public:
   class CLogGlobals
   {
   public:
-    CLogGlobals() : m_file(NULL), m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG) {}
+    CLogGlobals() : m_file(NULL), m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_extraLogLevels(0), m_writer(NULL), m_async(false) {}
     FILE*       m_file;
     int         m_repeatCount;
     int         m_repeatLogLevel;
     std::string m_repeatLine;
     int         m_logLevel;
     int         m_extraLogLevels;
+    CLogWriter* m_writer;
+    volatile bool m_async;
     CCriticalSection critSec;
   };
 
@@ -59,8 +64,29 @@ public:
   static void SetLogLevel(int level);
   static int  GetLogLevel();
   static void SetExtraLogLevels(int level);
+
+  /*! \brief Hand formatted lines to a background writer instead of writing them on the calling thread.
+   When enabled, lines below LOGERROR may be dropped (and counted) if the writer falls behind,
+   and lines of LOGSEVERE and above block until everything queued has reached the file.
+   \param async true to enable asynchronous logging, false to drain the queue and write synchronously again.
+   */
+  static void SetAsync(bool async);
+  static bool IsAsync();
+
+  /*! \brief Block until every line queued so far has been written and flushed.
+   */
+  static void Flush();
+
+  /*! \brief Write out lines still queued for the writer from a crashing thread.
+   Best effort, called from the unhandled exception filter: gives up if the log lock can't be had.
+   Takes locks and allocates, so it must not be called from a signal handler.
+   */
+  static void FlushOnCrash();
 private:
+  friend class CLogWriter;
   static void OutputDebugString(const std::string& line);
+  static bool IsLogged(int loglevel, int extras);
+  static void FormatLine(int loglevel, int hour, int minute, int second, uint64_t threadId, std::string &data, std::string &output);
 };
 
 #undef ATTRIB_LOG_FORMAT
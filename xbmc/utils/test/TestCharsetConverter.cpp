@@ -19,6 +19,7 @@
  */
 
 #include "settings/Settings.h"
+#include "threads/Thread.h"
 #include "utils/CharsetConverter.h"
 
 #include "gtest/gtest.h"
@@ -124,6 +125,116 @@ TEST_F(TestCharsetConverter, utf8ToW)
   EXPECT_STREQ(refstrw1.c_str(), varstrw1.c_str());
 }
 
+/* Strings covering the fast path of utf8ToW() and the fallbacks to iconv:
+ * ASCII longer than a SIMD block, 2, 3 and 4 byte sequences, and
+ * malformed input (overlong, surrogate, truncated, stray continuation).
+ */
+static const char *utf8ToWInputs[] = {
+  "",
+  "test utf8ToW",
+  "The Quick Brown Fox Jumps Over The Lazy Dog - Season 1 Episode 12",
+  "Caf\xc3\xa9 \xc3\xa0 la cr\xc3\xa8me",
+  "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e and more than sixteen ASCII characters",
+  "\xf0\x9f\x90\xad\xf0\x9f\x90\xae",
+  "overlong \xc0\xaf slash",
+  "surrogate \xed\xa0\x80 half",
+  "truncated \xe6\x97",
+  "stray \x80 continuation",
+  NULL
+};
+
+TEST_F(TestCharsetConverter, utf8ToW_FastPath)
+{
+  for (const char **input = utf8ToWInputs; *input; input++)
+  {
+    // toW() always goes through iconv
+    refstrw1.clear();
+    g_charsetConverter.toW(*input, refstrw1, "UTF-8");
+    varstrw1.clear();
+    g_charsetConverter.utf8ToW(*input, varstrw1, false);
+    EXPECT_TRUE(refstrw1 == varstrw1) << "input: " << *input;
+  }
+}
+
+TEST_F(TestCharsetConverter, utf8ToW_NotFlipped)
+{
+  bool flipped = true;
+  refstrw1 = L"test utf8ToW";
+  varstrw1.clear();
+  g_charsetConverter.utf8ToW("test utf8ToW", varstrw1, true, false, &flipped);
+  EXPECT_STREQ(refstrw1.c_str(), varstrw1.c_str());
+  EXPECT_FALSE(flipped);
+}
+
+TEST_F(TestCharsetConverter, utf8ToW_BoundaryNeutrals)
+{
+  // stripped like fribidi_remove_bidi_marks() does: controls, soft hyphen,
+  // zero width space and joiners, word joiner
+  refstrw1 = L"softhyphen zerowidth joiner";
+  varstrw1.clear();
+  g_charsetConverter.utf8ToW("soft\xc2\xadhyphen zero\xe2\x80\x8bwidth\x01 join\xe2\x81\xa0" "er", varstrw1, true, false, NULL);
+  EXPECT_STREQ(refstrw1.c_str(), varstrw1.c_str());
+
+  // and kept without the flip
+  refstrw1 = L"soft\x00adhyphen";
+  varstrw1.clear();
+  g_charsetConverter.utf8ToW("soft\xc2\xadhyphen", varstrw1, false);
+  EXPECT_STREQ(refstrw1.c_str(), varstrw1.c_str());
+}
+
+class ConvertRunnable : public IRunnable
+{
+public:
+  ConvertRunnable() : failures(0)
+  {
+    // converted by the thread running the test
+    for (const char **input = utf8ToWInputs; *input; input++)
+    {
+      CStdStringW wide;
+      CStdStringA utf8;
+      g_charsetConverter.utf8ToW(*input, wide, false);
+      g_charsetConverter.wToUTF8(wide, utf8);
+      expected.push_back(utf8);
+    }
+  }
+
+  virtual void Run()
+  {
+    for (int i = 0; i < 1000; i++)
+    {
+      for (unsigned int j = 0; utf8ToWInputs[j]; j++)
+      {
+        CStdStringW wide;
+        CStdStringA utf8;
+        g_charsetConverter.utf8ToW(utf8ToWInputs[j], wide, false);
+        g_charsetConverter.wToUTF8(wide, utf8);
+        if (utf8 != expected[j])
+          failures++;
+      }
+    }
+  }
+
+  std::vector<CStdStringA> expected;
+  int failures;
+};
+
+TEST_F(TestCharsetConverter, ConcurrentConversions)
+{
+  ConvertRunnable runnables[4];
+  CThread *threads[4];
+  for (int i = 0; i < 4; i++)
+  {
+    threads[i] = new CThread(&runnables[i], "TestCharsetConverter");
+    threads[i]->Create();
+  }
+  for (int i = 0; i < 4; i++)
+  {
+    threads[i]->WaitForThreadExit(0xFFFFFFFF);
+    delete threads[i];
+    EXPECT_EQ(0, runnables[i].failures);
+  }
+}
+
 TEST_F(TestCharsetConverter, utf16LEtoW)
 {
   refstrw1 = L"ｔｅｓｔ＿ｕｔｆ１６ＬＥｔｏｗ";
@@ -283,6 +394,29 @@ TEST_F(TestCharsetConverter, utf8logicalToVisualBiDi)
   EXPECT_STREQ(refstra2.c_str(), varstra1.c_str());
 }
 
+TEST_F(TestCharsetConverter, utf8logicalToVisualBiDi_Cache)
+{
+  refstra1 = "\xd7\xa9\xd7\x9c\xd7\x95\xd7\x9d 123";
+  varstra1.clear();
+  g_charsetConverter.utf8logicalToVisualBiDi(refstra1, varstra1);
+
+  // served from the cache
+  refstra2.clear();
+  g_charsetConverter.utf8logicalToVisualBiDi(refstra1, refstra2);
+  EXPECT_STREQ(varstra1.c_str(), refstra2.c_str());
+
+  // converted again without the cache
+  g_charsetConverter.SetBiDiCacheSize(0);
+  refstra2.clear();
+  g_charsetConverter.utf8logicalToVisualBiDi(refstra1, refstra2);
+  EXPECT_STREQ(varstra1.c_str(), refstra2.c_str());
+
+  // source and destination may be the same string
+  g_charsetConverter.SetBiDiCacheSize(512);
+  g_charsetConverter.utf8logicalToVisualBiDi(refstra1, refstra1);
+  EXPECT_STREQ(varstra1.c_str(), refstra1.c_str());
+}
+
 /* TODO: Resolve correct input/output for this function */
 // TEST_F(TestCharsetConverter, utf32ToStringCharset)
 // {
@@ -1400,6 +1400,15 @@ TEST(TestDatabaseUtils, BuildLimitClause)
   EXPECT_STREQ(" LIMIT 100", a.c_str());
 }
 
+TEST(TestDatabaseUtils, BuildFullTextQuery)
+{
+  EXPECT_STREQ("the* dark* knight*", DatabaseUtils::BuildFullTextQuery("The Dark-Knight").c_str());
+  EXPECT_STREQ("title:star* title:wars*", DatabaseUtils::BuildFullTextQuery(" Star  Wars ", "title").c_str());
+  EXPECT_STREQ("or* not*", DatabaseUtils::BuildFullTextQuery("\"OR\" * NOT'").c_str());
+  EXPECT_STREQ("bj\xc3\xb6rk*", DatabaseUtils::BuildFullTextQuery("Bj\xc3\xb6rk").c_str());
+  EXPECT_TRUE(DatabaseUtils::BuildFullTextQuery(" -*\" ").empty());
+}
+
 // class DatabaseUtils
 // {
 // public:
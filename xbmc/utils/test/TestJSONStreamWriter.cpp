@@ -0,0 +1,169 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/JSONStreamWriter.h"
+#include "utils/JSONVariantWriter.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+class CChunkOutputStream : public IJSONOutputStream
+{
+public:
+  CChunkOutputStream(size_t maxChunks = 0) : m_maxChunks(maxChunks) {}
+
+  virtual bool Write(const char *data, size_t length)
+  {
+    m_chunks.push_back(std::string(data, length));
+    return m_maxChunks == 0 || m_chunks.size() < m_maxChunks;
+  }
+
+  std::string Joined() const
+  {
+    std::string joined;
+    for (std::vector<std::string>::const_iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+      joined += *it;
+    return joined;
+  }
+
+  size_t m_maxChunks;
+  std::vector<std::string> m_chunks;
+};
+
+static CVariant BuildItems(int count)
+{
+  CVariant result(CVariant::VariantTypeObject);
+  result["limits"]["start"] = 0;
+  result["limits"]["end"] = count;
+  result["limits"]["total"] = count;
+  for (int i = 0; i < count; i++)
+  {
+    CVariant item(CVariant::VariantTypeObject);
+    item["episodeid"] = i;
+    item["label"] = "Some episode label";
+    item["rating"] = 7.5;
+    item["watched"] = (i % 2) == 0;
+    result["episodes"].push_back(item);
+  }
+  return result;
+}
+
+TEST(TestJSONStreamWriter, SAX)
+{
+  std::string output;
+  CJSONStringOutputStream stream(output);
+  {
+    CJSONStreamWriter writer(stream, true);
+    EXPECT_TRUE(writer.StartObject());
+    EXPECT_TRUE(writer.Key("id"));
+    EXPECT_TRUE(writer.Integer(1));
+    EXPECT_TRUE(writer.Key("result"));
+    EXPECT_TRUE(writer.StartArray());
+    EXPECT_TRUE(writer.String("a"));
+    EXPECT_TRUE(writer.Boolean(true));
+    EXPECT_TRUE(writer.Null());
+    EXPECT_TRUE(writer.EndArray());
+    EXPECT_TRUE(writer.EndObject());
+  }
+  EXPECT_STREQ("{\"id\":1,\"result\":[\"a\",true,null]}", output.c_str());
+}
+
+TEST(TestJSONStreamWriter, Chunks)
+{
+  CVariant value = BuildItems(2000);
+  std::string reference = CJSONVariantWriter::Write(value, true);
+
+  CChunkOutputStream stream;
+  CJSONStreamWriter writer(stream, true, 1024);
+  EXPECT_TRUE(writer.Value(value));
+  EXPECT_TRUE(writer.Flush());
+
+  EXPECT_GT(stream.m_chunks.size(), 1U);
+  for (size_t i = 0; i + 1 < stream.m_chunks.size(); i++)
+    EXPECT_GE(stream.m_chunks[i].size(), 1024U);
+  EXPECT_EQ(reference, stream.Joined());
+}
+
+TEST(TestJSONStreamWriter, Release)
+{
+  CVariant value = BuildItems(100);
+  std::string reference = CJSONVariantWriter::Write(value, true);
+
+  std::string output;
+  CJSONStringOutputStream stream(output);
+  CJSONStreamWriter writer(stream, true);
+  EXPECT_TRUE(writer.Value(value, true));
+  EXPECT_TRUE(writer.Flush());
+
+  EXPECT_EQ(reference, output);
+  EXPECT_TRUE(value.empty());
+}
+
+TEST(TestJSONStreamWriter, Abort)
+{
+  CVariant value = BuildItems(2000);
+
+  CChunkOutputStream stream(2);
+  CJSONStreamWriter writer(stream, true, 1024);
+  EXPECT_FALSE(writer.Value(value));
+  EXPECT_FALSE(writer.IsGood());
+  EXPECT_FALSE(writer.Null());
+  EXPECT_EQ(2U, stream.m_chunks.size());
+}
+
+TEST(TestJSONStreamWriter, Double)
+{
+  std::string output;
+  CJSONStringOutputStream stream(output);
+  CJSONStreamWriter writer(stream, true);
+  EXPECT_TRUE(writer.Double(0.5));
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_STREQ("0.5", output.c_str());
+}
+
+TEST(TestJSONStreamWriter, DoubleWholeNumber)
+{
+  std::string output;
+  CJSONStringOutputStream stream(output);
+  CJSONStreamWriter writer(stream, true);
+  EXPECT_TRUE(writer.StartArray());
+  EXPECT_TRUE(writer.Double(7.0));
+  EXPECT_TRUE(writer.Double(-2.0));
+  EXPECT_TRUE(writer.Double(1e300));
+  EXPECT_TRUE(writer.EndArray());
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_STREQ("[7.0,-2.0,1.0000000000000001e+300]", output.c_str());
+}
+
+TEST(TestJSONStreamWriter, DoubleNotFinite)
+{
+  std::string output;
+  CJSONStringOutputStream stream(output);
+  CJSONStreamWriter writer(stream, true);
+  double zero = 0.0;
+  EXPECT_TRUE(writer.StartArray());
+  EXPECT_TRUE(writer.Double(zero / zero));
+  EXPECT_TRUE(writer.Double(1.0 / zero));
+  EXPECT_TRUE(writer.EndArray());
+  EXPECT_TRUE(writer.Flush());
+  EXPECT_TRUE(writer.IsGood());
+  EXPECT_STREQ("[null,null]", output.c_str());
+}
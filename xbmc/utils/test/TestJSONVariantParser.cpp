@@ -18,10 +18,52 @@
  *
  */
 
+#include "utils/JSONSaxParser.h"
 #include "utils/JSONVariantParser.h"
+#include "filesystem/File.h"
+#include "threads/SystemClock.h"
+
+#include "test/TestUtils.h"
 
 #include "gtest/gtest.h"
 
+#define PARSE_BENCHMARK_ROUNDS 50
+
+class CCountingSaxHandler : public IJSONSaxHandler
+{
+public:
+  CCountingSaxHandler() : m_values(0), m_containers(0) { }
+
+  virtual bool Null() { m_values++; return true; }
+  virtual bool Boolean(bool value) { m_values++; return true; }
+  virtual bool Integer(int64_t value) { m_values++; return true; }
+  virtual bool Double(double value) { m_values++; return true; }
+  virtual bool String(const char *value, size_t length) { m_values++; return true; }
+  virtual bool StartObject() { return true; }
+  virtual bool Key(const char *key, size_t length) { return true; }
+  virtual bool EndObject(size_t members) { m_containers++; return true; }
+  virtual bool StartArray() { return true; }
+  virtual bool EndArray(size_t elements) { m_containers++; return true; }
+
+  int m_values;
+  int m_containers;
+};
+
+static std::string ReadReferenceFile(const char *path)
+{
+  std::string content;
+  XFILE::CFile file;
+  if (file.Open(XBMC_REF_FILE_PATH(path)))
+  {
+    char buffer[4096];
+    unsigned int read;
+    while ((read = file.Read(buffer, sizeof(buffer))) > 0)
+      content.append(buffer, read);
+    file.Close();
+  }
+  return content;
+}
+
 TEST(TestJSONVariantParser, Parse)
 {
   CVariant variant;
@@ -31,3 +73,100 @@ TEST(TestJSONVariantParser, Parse)
   variant = CJSONVariantParser::Parse(buf, sizeof(buf));
   EXPECT_TRUE(variant.isNull());
 }
+
+TEST(TestJSONVariantParser, Values)
+{
+  std::string json = "{ \"int\": -42, \"big\": 9007199254740993, \"double\": 0.5, \"bool\": true,"
+                     "  \"null\": null, \"array\": [1, \"two\", [], {}], \"string\": \"a\\\"b\\u00e9\\ud83d\\ude00\" }";
+  CVariant variant = CJSONVariantParser::Parse((const unsigned char *)json.c_str(), json.size());
+
+  ASSERT_TRUE(variant.isObject());
+  EXPECT_EQ(-42, variant["int"].asInteger());
+  EXPECT_EQ(9007199254740993LL, variant["big"].asInteger());
+  EXPECT_DOUBLE_EQ(0.5, variant["double"].asDouble());
+  EXPECT_TRUE(variant["bool"].asBoolean());
+  EXPECT_TRUE(variant["null"].isNull());
+  ASSERT_TRUE(variant["array"].isArray());
+  EXPECT_EQ(4U, variant["array"].size());
+  EXPECT_STREQ("two", variant["array"][1].asString().c_str());
+  EXPECT_TRUE(variant["array"][2].isArray());
+  EXPECT_TRUE(variant["array"][3].isObject());
+  EXPECT_STREQ("a\"b\xc3\xa9\xf0\x9f\x98\x80", variant["string"].asString().c_str());
+}
+
+TEST(TestJSONVariantParser, LongNumbers)
+{
+  // longer than any buffer on the stack
+  std::string big = "1" + std::string(29, '0') + "." + std::string(40, '0');
+  std::string half = "0.5" + std::string(70, '0');
+  std::string json = "[" + big + ", -" + big + ", " + half + "]";
+  CVariant variant = CJSONVariantParser::Parse((const unsigned char *)json.c_str(), json.size());
+
+  ASSERT_TRUE(variant.isArray());
+  ASSERT_EQ(3U, variant.size());
+  EXPECT_FLOAT_EQ(1e29f, variant[0].asFloat());
+  EXPECT_FLOAT_EQ(-1e29f, variant[1].asFloat());
+  EXPECT_FLOAT_EQ(0.5f, variant[2].asFloat());
+}
+
+TEST(TestJSONVariantParser, Invalid)
+{
+  const char *invalid[] = { "", "{", "[1,]", "{\"a\" 1}", "01", "\"\\x\"", "\"\xff\"", "tru", "-", "1.",
+                            "// comment\n1", "[1 /* comment */]", "1 // comment" };
+  for (unsigned int i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+  {
+    CCountingSaxHandler handler;
+    EXPECT_FALSE(CJSONSaxParser::Parse(invalid[i], strlen(invalid[i]), handler)) << invalid[i];
+  }
+}
+
+TEST(TestJSONVariantParser, SAX)
+{
+  std::string json = "[ { \"method\": \"Player.GetActivePlayers\", \"id\": 1 }, null, 2.5 ]";
+  CCountingSaxHandler handler;
+  EXPECT_TRUE(CJSONSaxParser::Parse(json.c_str(), json.size(), handler));
+  EXPECT_EQ(4, handler.m_values);
+  EXPECT_EQ(2, handler.m_containers);
+}
+
+TEST(TestJSONVariantParser, Throughput)
+{
+  const char *files[] = { "/xbmc/interfaces/json-rpc/methods.json", "/xbmc/interfaces/json-rpc/types.json" };
+  for (unsigned int f = 0; f < sizeof(files) / sizeof(files[0]); f++)
+  {
+    std::string json = ReadReferenceFile(files[f]);
+    ASSERT_FALSE(json.empty());
+
+    // the yajl based push parser, as used before
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    for (int i = 0; i < PARSE_BENCHMARK_ROUNDS; i++)
+    {
+      CSimpleParseCallback callback;
+      CJSONVariantParser parser(&callback);
+      parser.push_buffer((const unsigned char *)json.c_str(), json.size());
+    }
+    unsigned int yajl = XbmcThreads::SystemClockMillis() - start;
+
+    // in place tokenising into a CVariant tree
+    start = XbmcThreads::SystemClockMillis();
+    for (int i = 0; i < PARSE_BENCHMARK_ROUNDS; i++)
+    {
+      CVariant variant = CJSONVariantParser::Parse((const unsigned char *)json.c_str(), json.size());
+      EXPECT_TRUE(variant.isObject());
+    }
+    unsigned int tree = XbmcThreads::SystemClockMillis() - start;
+
+    // in place tokenising without building anything
+    start = XbmcThreads::SystemClockMillis();
+    for (int i = 0; i < PARSE_BENCHMARK_ROUNDS; i++)
+    {
+      CCountingSaxHandler handler;
+      EXPECT_TRUE(CJSONSaxParser::Parse(json.c_str(), json.size(), handler));
+    }
+    unsigned int sax = XbmcThreads::SystemClockMillis() - start;
+
+    double megabytes = (double)json.size() * PARSE_BENCHMARK_ROUNDS / (1024 * 1024);
+    printf("%s (%u bytes): yajl %.1f MB/s, tree %.1f MB/s, SAX %.1f MB/s\n", files[f], (unsigned int)json.size(),
+           megabytes * 1000 / (yajl ? yajl : 1), megabytes * 1000 / (tree ? tree : 1), megabytes * 1000 / (sax ? sax : 1));
+  }
+}
@@ -0,0 +1,181 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/JobManager.h"
+#include "threads/Atomics.h"
+#include "threads/Event.h"
+#include "threads/SystemClock.h"
+
+#include "gtest/gtest.h"
+
+/* Throughput tests for CJobManager. These queue large numbers of tiny jobs
+ * from several producer threads, the way a library scan floods the manager
+ * with texture cache and file state jobs, and check that every job runs and
+ * reports back exactly once. The timings are measured by the benchmarks.
+ */
+
+#define THROUGHPUT_JOBS      20000
+#define THROUGHPUT_PRODUCERS 4
+
+class CCountingJob : public CJob
+{
+public:
+  CCountingJob(volatile long *counter) : m_counter(counter) {}
+  virtual bool DoWork()
+  {
+    AtomicIncrement(m_counter);
+    return true;
+  }
+  virtual const char *GetType() const { return "countingjob"; }
+private:
+  volatile long *m_counter;
+};
+
+class CCountingCallback : public IJobCallback
+{
+public:
+  CCountingCallback(long expected) : m_completed(0), m_expected(expected) {}
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    if (AtomicIncrement(&m_completed) == m_expected)
+      m_done.Set();
+  }
+  bool WaitAll(unsigned int milliseconds)
+  {
+    if (!m_done.WaitMSec(milliseconds))
+      return false;
+    // the last callback may still be returning; the manager drops the job from
+    // its processing list only afterwards, so wait for that before going out of scope
+    while (CJobManager::GetInstance().IsProcessing("countingjob"))
+      XbmcThreads::ThreadSleep(1);
+    return true;
+  }
+
+  volatile long m_completed;
+private:
+  long   m_expected;
+  CEvent m_done;
+};
+
+class CJobProducer : public IRunnable
+{
+public:
+  CJobProducer(CCountingCallback &callback, volatile long *counter, int jobs)
+    : m_callback(callback), m_counter(counter), m_jobs(jobs) {}
+  virtual void Run()
+  {
+    for (int i = 0; i < m_jobs; i++)
+      CJobManager::GetInstance().AddJob(new CCountingJob(m_counter), &m_callback, CJob::PRIORITY(i % (CJob::PRIORITY_HIGH + 1)));
+  }
+private:
+  CCountingCallback &m_callback;
+  volatile long *m_counter;
+  int m_jobs;
+};
+
+class TestJobManagerThroughput : public testing::Test
+{
+protected:
+  TestJobManagerThroughput()
+  {
+    // the previous test shut the manager down with CancelJobs()
+    Restart();
+  }
+
+  ~TestJobManagerThroughput()
+  {
+    // stop the warm worker pool again
+    CJobManager::GetInstance().CancelJobs();
+  }
+
+  // the fixture is a friend of the manager, the tests themselves aren't
+  void Restart()
+  {
+    CJobManager::GetInstance().Restart();
+  }
+};
+
+TEST_F(TestJobManagerThroughput, SingleProducer)
+{
+  volatile long counter = 0;
+  CCountingCallback callback(THROUGHPUT_JOBS);
+
+  for (int i = 0; i < THROUGHPUT_JOBS; i++)
+    EXPECT_NE(0U, CJobManager::GetInstance().AddJob(new CCountingJob(&counter), &callback));
+  ASSERT_TRUE(callback.WaitAll(60000));
+
+  EXPECT_EQ(THROUGHPUT_JOBS, counter);
+  EXPECT_EQ(THROUGHPUT_JOBS, callback.m_completed);
+}
+
+TEST_F(TestJobManagerThroughput, MultipleProducers)
+{
+  volatile long counter = 0;
+  CCountingCallback callback(THROUGHPUT_JOBS);
+  CJobProducer producer(callback, &counter, THROUGHPUT_JOBS / THROUGHPUT_PRODUCERS);
+
+  CThread *threads[THROUGHPUT_PRODUCERS];
+  for (int i = 0; i < THROUGHPUT_PRODUCERS; i++)
+  {
+    threads[i] = new CThread(&producer, "JobProducer");
+    threads[i]->Create();
+  }
+  for (int i = 0; i < THROUGHPUT_PRODUCERS; i++)
+  {
+    threads[i]->WaitForThreadExit(60000);
+    delete threads[i];
+  }
+  ASSERT_TRUE(callback.WaitAll(60000));
+
+  EXPECT_EQ(THROUGHPUT_JOBS, counter);
+  EXPECT_EQ(THROUGHPUT_JOBS, callback.m_completed);
+}
+
+TEST_F(TestJobManagerThroughput, CancelledRejectsJobs)
+{
+  volatile long counter = 0;
+  CJobManager::GetInstance().CancelJobs();
+
+  CCountingJob *job = new CCountingJob(&counter);
+  EXPECT_EQ(0U, CJobManager::GetInstance().AddJob(job, NULL));
+  delete job;
+
+  Restart();
+  CCountingCallback callback(1);
+  EXPECT_NE(0U, CJobManager::GetInstance().AddJob(new CCountingJob(&counter), &callback));
+  EXPECT_TRUE(callback.WaitAll(10000));
+  EXPECT_EQ(1, counter);
+}
+
+TEST_F(TestJobManagerThroughput, PausedPriorityWaits)
+{
+  volatile long counter = 0;
+  CCountingCallback callback(100);
+
+  CJobManager::GetInstance().Pause(CJob::PRIORITY_LOW);
+  for (int i = 0; i < 100; i++)
+    CJobManager::GetInstance().AddJob(new CCountingJob(&counter), &callback, CJob::PRIORITY_LOW);
+  EXPECT_FALSE(callback.WaitAll(200));
+  EXPECT_EQ(0, counter);
+
+  CJobManager::GetInstance().UnPause(CJob::PRIORITY_LOW);
+  EXPECT_TRUE(callback.WaitAll(10000));
+  EXPECT_EQ(100, counter);
+}
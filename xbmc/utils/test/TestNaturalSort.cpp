@@ -0,0 +1,121 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/NaturalSort.h"
+#include "utils/StringUtils.h"
+
+#include <stdlib.h>
+
+#include "gtest/gtest.h"
+
+static int Sign(int64_t value)
+{
+  return value < 0 ? -1 : (value > 0 ? 1 : 0);
+}
+
+static int KeyCompare(const std::wstring &left, const std::wstring &right)
+{
+  CNaturalSortCollator collator;
+  return CNaturalSortKey(left).Compare(CNaturalSortKey(right), collator);
+}
+
+static void ExpectSameOrder(const std::wstring &left, const std::wstring &right)
+{
+  int expected = Sign(StringUtils::AlphaNumericCompare(left.c_str(), right.c_str()));
+  EXPECT_EQ(expected, Sign(KeyCompare(left, right))) << "comparing \"" << std::string(left.begin(), left.end())
+                                                     << "\" with \"" << std::string(right.begin(), right.end()) << "\"";
+}
+
+TEST(TestNaturalSort, Compare)
+{
+  EXPECT_EQ(0, KeyCompare(L"", L""));
+  EXPECT_GT(0, KeyCompare(L"", L"a"));
+  EXPECT_LT(0, KeyCompare(L"a", L""));
+  EXPECT_EQ(0, KeyCompare(L"Episode", L"episode"));
+  EXPECT_GT(0, KeyCompare(L"Episode 2", L"episode 10"));
+  EXPECT_GT(0, KeyCompare(L"a15", L"a1005"));
+  EXPECT_GT(0, KeyCompare(L"a1", L"a12"));
+  EXPECT_GT(0, KeyCompare(L"track 9.mp3", L"Track 10.mp3"));
+}
+
+TEST(TestNaturalSort, SameOrderAsAlphaNumericCompare)
+{
+  const wchar_t *labels[] = {
+    L"", L"a", L"A", L"b", L"a1", L"a01", L"a001", L"A1b", L"a12", L"a15", L"a1005", L"a2b3",
+    L"The Movie 7", L"the movie 07", L"The Movie 7 Part 2", L"The Movie 70",
+    L"1234567890123456", L"1234567890123457", L"123456789012345 6", L"12345678901234567890a",
+    L"12345678901234567890b", L"x12345678901234599999", L"x1234567890123459", L"0", L"00", L"a b", L"a-b"
+  };
+  const size_t count = sizeof(labels) / sizeof(labels[0]);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    for (size_t j = 0; j < count; j++)
+      ExpectSameOrder(labels[i], labels[j]);
+  }
+}
+
+TEST(TestNaturalSort, SameOrderAsAlphaNumericCompareRandom)
+{
+  // long common prefixes with digits around the point they differ
+  const wchar_t alphabet[] = L"aAbB0123456789 .";
+  srand(4711);
+  for (unsigned int i = 0; i < 2000; i++)
+  {
+    std::wstring prefix;
+    size_t length = rand() % 40;
+    for (size_t c = 0; c < length; c++)
+      prefix += alphabet[rand() % (sizeof(alphabet) / sizeof(wchar_t) - 1)];
+
+    std::wstring left(prefix), right(prefix);
+    size_t tail = rand() % 20;
+    for (size_t c = 0; c < tail; c++)
+    {
+      left += alphabet[rand() % (sizeof(alphabet) / sizeof(wchar_t) - 1)];
+      right += alphabet[rand() % (sizeof(alphabet) / sizeof(wchar_t) - 1)];
+    }
+    ExpectSameOrder(left, right);
+  }
+}
+
+TEST(TestNaturalSort, CommonPrefixLength)
+{
+  std::wstring left(100, L'x');
+  for (size_t length = 0; length < 40; length++)
+  {
+    for (size_t diff = 0; diff <= length; diff++)
+    {
+      std::wstring right(left);
+      if (diff < length)
+        right[diff] = L'y';
+      EXPECT_EQ(diff, CNaturalSortKey::CommonPrefixLength(left.c_str(), right.c_str(), length));
+    }
+  }
+}
+
+TEST(TestNaturalSort, EmbeddedNul)
+{
+  std::wstring label(L"abc");
+  label += L'\0';
+  label += L"def";
+  CNaturalSortKey key(label);
+  EXPECT_EQ(std::wstring(L"abc"), key.GetFolded());
+  EXPECT_EQ(0, KeyCompare(label, L"ABC"));
+}
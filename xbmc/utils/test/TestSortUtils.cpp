@@ -19,8 +19,11 @@
  */
 
 #include "utils/SortUtils.h"
+#include "utils/StringUtils.h"
 #include "utils/Variant.h"
 
+#include <algorithm>
+
 #include "gtest/gtest.h"
 
 TEST(TestSortUtils, Sort_SortBy)
@@ -131,3 +134,245 @@ TEST(TestSortUtils, GetFieldsForSorting)
   EXPECT_EQ(FieldTrackNumber, *it);
   EXPECT_EQ((unsigned int)4, fields.size());
 }
+
+static SortItem MakeLabelItem(const std::string &label, int id, bool folder = false)
+{
+  SortItem item;
+  item[FieldLabel] = label;
+  item[FieldId] = id;
+  item[FieldFolder] = folder;
+  return item;
+}
+
+TEST(TestSortUtils, Sort_NaturalOrder)
+{
+  SortItems items;
+  items.push_back(MakeLabelItem("Track 10", 0));
+  items.push_back(MakeLabelItem("track 2", 1));
+  items.push_back(MakeLabelItem("Track 1", 2));
+  items.push_back(MakeLabelItem("Folder", 3, true));
+
+  SortUtils::Sort(SortByLabel, SortOrderAscending, SortAttributeNone, items);
+
+  ASSERT_EQ((size_t)4, items.size());
+  EXPECT_STREQ("Folder", items.at(0)[FieldLabel].asString().c_str());
+  EXPECT_STREQ("Track 1", items.at(1)[FieldLabel].asString().c_str());
+  EXPECT_STREQ("track 2", items.at(2)[FieldLabel].asString().c_str());
+  EXPECT_STREQ("Track 10", items.at(3)[FieldLabel].asString().c_str());
+
+  // folders stay on top when sorting descending
+  SortUtils::Sort(SortByLabel, SortOrderDescending, SortAttributeNone, items);
+  EXPECT_STREQ("Folder", items.at(0)[FieldLabel].asString().c_str());
+  EXPECT_STREQ("Track 10", items.at(1)[FieldLabel].asString().c_str());
+  EXPECT_STREQ("Track 1", items.at(3)[FieldLabel].asString().c_str());
+}
+
+TEST(TestSortUtils, Sort_Stable)
+{
+  SortItems items;
+  for (int i = 0; i < 10; i++)
+    items.push_back(MakeLabelItem(i % 2 ? "odd" : "even", i));
+
+  SortUtils::Sort(SortByLabel, SortOrderAscending, SortAttributeNone, items);
+
+  for (int i = 0; i < 5; i++)
+  {
+    EXPECT_EQ(i * 2, items.at(i)[FieldId].asInteger());
+    EXPECT_EQ(i * 2 + 1, items.at(i + 5)[FieldId].asInteger());
+  }
+}
+
+TEST(TestSortUtils, Sort_Limits)
+{
+  SortItems items;
+  for (int i = 99; i >= 0; i--)
+    items.push_back(MakeLabelItem(StringUtils::Format("Item %d", i), i));
+
+  SortDescription desc;
+  desc.sortBy = SortByLabel;
+  desc.limitStart = 10;
+  desc.limitEnd = 20;
+  SortUtils::Sort(desc, items);
+
+  ASSERT_EQ((size_t)10, items.size());
+  for (int i = 0; i < 10; i++)
+    EXPECT_EQ(i + 10, items.at(i)[FieldId].asInteger());
+}
+
+/* Sorts enough items to be split over the job manager's workers */
+TEST(TestSortUtils, Sort_Large)
+{
+  const int count = 60000;
+  const int folders = count / 10;
+  SortItems items;
+  for (int i = 0; i < count; i++)
+  {
+    // spread the labels around so they aren't presorted, every label is used ten
+    // times and the first of each is a folder. The position is kept to check ties
+    int id = (i * 7919) % count;
+    items.push_back(MakeLabelItem(StringUtils::Format("Artist %d - Album", id % folders), id, id < folders));
+    items.back()[FieldTrackNumber] = i;
+  }
+
+  SortUtils::Sort(SortByLabel, SortOrderDescending, SortAttributeNone, items);
+
+  ASSERT_EQ((size_t)count, items.size());
+  for (int i = 0; i < folders; i++)
+    ASSERT_EQ(folders - 1 - i, items.at(i)[FieldId].asInteger());
+  for (int i = folders; i < count; i++)
+  {
+    ASSERT_FALSE(items.at(i)[FieldFolder].asBoolean());
+    int64_t label = items.at(i)[FieldId].asInteger() % folders;
+    if (i == folders)
+      ASSERT_EQ(folders - 1, label);
+    else
+    {
+      int64_t previous = items.at(i - 1)[FieldId].asInteger() % folders;
+      ASSERT_LE(label, previous);
+      if (label == previous)
+        ASSERT_LT(items.at(i - 1)[FieldTrackNumber].asInteger(), items.at(i)[FieldTrackNumber].asInteger());
+    }
+  }
+}
+
+TEST(TestSortUtils, Sort_Folders)
+{
+  SortItems items;
+  items.push_back(MakeLabelItem("b", 0));
+  items.push_back(MakeLabelItem("d", 1, true));
+  items.push_back(MakeLabelItem("a", 2));
+  items.push_back(MakeLabelItem("c", 3, true));
+  SortItem noFolder;
+  noFolder[FieldLabel] = "e";
+  noFolder[FieldId] = 4;
+  items.push_back(noFolder);
+
+  // folders first in either order, an item without FieldFolder is a file
+  const int ascending[] = { 3, 1, 2, 0, 4 };
+  SortUtils::Sort(SortByLabel, SortOrderAscending, SortAttributeNone, items);
+  for (int i = 0; i < 5; i++)
+    EXPECT_EQ(ascending[i], items.at(i)[FieldId].asInteger());
+
+  const int descending[] = { 1, 3, 4, 0, 2 };
+  SortUtils::Sort(SortByLabel, SortOrderDescending, SortAttributeNone, items);
+  for (int i = 0; i < 5; i++)
+    EXPECT_EQ(descending[i], items.at(i)[FieldId].asInteger());
+
+  const int ignored[] = { 2, 0, 3, 1, 4 };
+  SortUtils::Sort(SortByLabel, SortOrderAscending, SortAttributeIgnoreFolders, items);
+  for (int i = 0; i < 5; i++)
+    EXPECT_EQ(ignored[i], items.at(i)[FieldId].asInteger());
+}
+
+TEST(TestSortUtils, BuildOrderClause)
+{
+  SortDescription desc;
+  std::string order = "unchanged";
+  EXPECT_TRUE(SortUtils::BuildOrderClause(desc, MediaTypeSong, order));
+  EXPECT_TRUE(order.empty());
+
+  desc.sortBy = SortByTrackNumber;
+  EXPECT_TRUE(SortUtils::BuildOrderClause(desc, MediaTypeSong, order));
+  EXPECT_STREQ("CAST(songview.iTrack AS INTEGER), songview.idSong", order.c_str());
+
+  desc.sortBy = SortByDateAdded;
+  EXPECT_TRUE(SortUtils::BuildOrderClause(desc, MediaTypeMovie, order));
+  EXPECT_STREQ("movieview.dateAdded, movieview.idMovie", order.c_str());
+
+  // the id is part of the date added sort label, so it reverses too
+  desc.sortOrder = SortOrderDescending;
+  EXPECT_TRUE(SortUtils::BuildOrderClause(desc, MediaTypeMovie, order));
+  EXPECT_STREQ("movieview.dateAdded DESC, movieview.idMovie DESC", order.c_str());
+
+  // the id is the date added of songs, no need for a tie-break
+  EXPECT_TRUE(SortUtils::BuildOrderClause(desc, MediaTypeSong, order));
+  EXPECT_STREQ("songview.idSong DESC", order.c_str());
+
+  // other ties keep their original order
+  desc.sortBy = SortByTrackNumber;
+  EXPECT_TRUE(SortUtils::BuildOrderClause(desc, MediaTypeSong, order));
+  EXPECT_STREQ("CAST(songview.iTrack AS INTEGER) DESC, songview.idSong", order.c_str());
+
+  // labels are compared naturally, which SQL can't do
+  desc.sortBy = SortByTitle;
+  EXPECT_FALSE(SortUtils::BuildOrderClause(desc, MediaTypeSong, order));
+  desc.sortBy = SortByPlaycount;
+  EXPECT_FALSE(SortUtils::BuildOrderClause(desc, MediaTypeMovie, order));
+}
+
+/* Orders items the way the database does for a "<field>[ DESC], <id>[ DESC]"
+   clause */
+struct ClauseOrder
+{
+  ClauseOrder(Field field, const std::string &clause)
+    : m_field(field)
+  {
+    size_t split = clause.find(", ");
+    m_fieldDescending = StringUtils::EndsWith(clause.substr(0, split), " DESC");
+    m_idDescending = split != std::string::npos && StringUtils::EndsWith(clause, " DESC");
+  }
+
+  bool operator()(const SortItem &left, const SortItem &right) const
+  {
+    const CVariant &l = left.find(m_field)->second;
+    const CVariant &r = right.find(m_field)->second;
+    int cmp = l.isString() ? l.asString().compare(r.asString()) : (int)(l.asInteger() - r.asInteger());
+    if (cmp != 0)
+      return m_fieldDescending ? cmp > 0 : cmp < 0;
+    int64_t lid = left.find(FieldId)->second.asInteger();
+    int64_t rid = right.find(FieldId)->second.asInteger();
+    return m_idDescending ? lid > rid : lid < rid;
+  }
+
+  Field m_field;
+  bool m_fieldDescending;
+  bool m_idDescending;
+};
+
+static void CheckTiesMatchClause(SortBy sortBy, MediaType mediaType, Field field, CVariant (*value)(int))
+{
+  for (int order = SortOrderAscending; order <= SortOrderDescending; order++)
+  {
+    SortDescription desc;
+    desc.sortBy = sortBy;
+    desc.sortOrder = (SortOrder)order;
+    std::string clause;
+    ASSERT_TRUE(SortUtils::BuildOrderClause(desc, mediaType, clause));
+
+    // items come from the database in id order, with every value shared by three
+    SortItems items;
+    for (int i = 0; i < 12; i++)
+    {
+      SortItem item;
+      item[FieldId] = i;
+      item[field] = value(i % 4);
+      items.push_back(item);
+    }
+    SortItems expected = items;
+    std::sort(expected.begin(), expected.end(), ClauseOrder(field, clause));
+
+    SortUtils::Sort(desc, items);
+
+    ASSERT_EQ(expected.size(), items.size());
+    for (size_t i = 0; i < items.size(); i++)
+      EXPECT_EQ(expected[i][FieldId].asInteger(), items[i][FieldId].asInteger()) << clause << " at " << i;
+  }
+}
+
+static CVariant TrackValue(int i)
+{
+  static const int tracks[] = { 3, 1, 10, 2 };
+  return tracks[i];
+}
+
+static CVariant DateValue(int i)
+{
+  static const char *dates[] = { "2013-02-01 10:00:00", "2012-12-24 08:30:00", "2013-02-01 09:00:00", "2011-06-30 23:59:59" };
+  return dates[i];
+}
+
+TEST(TestSortUtils, BuildOrderClause_TiesMatchSort)
+{
+  CheckTiesMatchClause(SortByTrackNumber, MediaTypeSong, FieldTrackNumber, TrackValue);
+  CheckTiesMatchClause(SortByDateAdded, MediaTypeMovie, FieldDateAdded, DateValue);
+}
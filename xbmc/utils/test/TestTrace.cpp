@@ -0,0 +1,98 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/Trace.h"
+#include "utils/JSONVariantParser.h"
+#include "utils/StringUtils.h"
+#include "utils/Variant.h"
+#include "filesystem/File.h"
+
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+static CVariant ReadTrace(const std::string &path)
+{
+  XFILE::CFile file;
+  std::string content;
+  if (file.Open(path))
+  {
+    char buffer[4096];
+    unsigned int read;
+    while ((read = file.Read(buffer, sizeof(buffer))) > 0)
+      content.append(buffer, read);
+    file.Close();
+  }
+  return CJSONVariantParser::Parse((const unsigned char *)content.c_str(), content.size());
+}
+
+TEST(TestTrace, Dump)
+{
+  if (!CTrace::IsSupported())
+  {
+    EXPECT_FALSE(CTrace::Start());
+    EXPECT_FALSE(CTrace::IsEnabled());
+    return;
+  }
+
+  ASSERT_TRUE(CTrace::Start());
+  {
+    CTraceScope scope("test", "scope");
+  }
+  CTrace::Instant("test", "instant");
+  CTrace::Stop();
+  {
+    // not recorded once stopped
+    CTraceScope scope("test", "stopped");
+  }
+  std::string path;
+  EXPECT_TRUE(CTrace::Dump(path));
+  EXPECT_TRUE(StringUtils::StartsWith(path, "special://temp/xbmc-trace"));
+
+  CVariant trace = ReadTrace(path);
+  ASSERT_TRUE(trace["traceEvents"].isArray());
+
+  bool scope = false, instant = false, stopped = false;
+  for (CVariant::const_iterator_array it = trace["traceEvents"].begin_array(); it != trace["traceEvents"].end_array(); ++it)
+  {
+    if ((*it)["cat"].asString() != "test")
+      continue;
+
+    std::string name = (*it)["name"].asString();
+    if (name == "scope")
+    {
+      scope = true;
+      EXPECT_STREQ("X", (*it)["ph"].asString().c_str());
+      EXPECT_GE((*it)["dur"].asDouble(), 0.0);
+    }
+    else if (name == "instant")
+    {
+      instant = true;
+      EXPECT_STREQ("i", (*it)["ph"].asString().c_str());
+    }
+    else if (name == "stopped")
+      stopped = true;
+  }
+  EXPECT_TRUE(scope);
+  EXPECT_TRUE(instant);
+  EXPECT_FALSE(stopped);
+
+  EXPECT_TRUE(XFILE::CFile::Delete(path));
+}
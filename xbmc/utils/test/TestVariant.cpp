@@ -234,6 +234,29 @@ TEST(TestVariant, swap)
   a.swap(b);
   EXPECT_TRUE(b.isInteger());
   EXPECT_TRUE(a.isString());
+  EXPECT_STREQ("variant", a.c_str());
+
+  CVariant c("a string long enough not to fit any small string buffer");
+  a.swap(c);
+  EXPECT_STREQ("a string long enough not to fit any small string buffer", a.c_str());
+  EXPECT_STREQ("variant", c.c_str());
+
+  CVariant d(CVariant::VariantTypeObject);
+  d["key"] = "value";
+  d.swap(c);
+  EXPECT_STREQ("variant", d.c_str());
+  EXPECT_STREQ("value", c["key"].c_str());
+}
+
+TEST(TestVariant, push_back_swap)
+{
+  CVariant a, b;
+  b["key"] = "value";
+
+  a.push_back_swap(b);
+  EXPECT_TRUE(a.isArray());
+  EXPECT_TRUE(b.isNull());
+  EXPECT_STREQ("value", a[0]["key"].c_str());
 }
 
 TEST(TestVariant, interator_array)
@@ -348,3 +371,31 @@ TEST(TestVariant, isMember)
   EXPECT_TRUE(a.isMember("key1"));
   EXPECT_FALSE(a.isMember("key2"));
 }
+
+/* Builds a response shaped like VideoLibrary.GetMovies and copies it, the two
+ * operations that dominate large JSON-RPC responses.
+ */
+TEST(TestVariant, LargeResponse)
+{
+  const unsigned int items = 10000;
+
+  CVariant result;
+  for (unsigned int i = 0; i < items; i++)
+  {
+    CVariant movie;
+    movie["movieid"] = i;
+    movie["label"] = "The Movie Label";
+    movie["title"] = "A rather longer movie title";
+    movie["year"] = 2013;
+    movie["rating"] = 7.5;
+    movie["file"] = "smb://server/share/movies/The Movie Label (2013)/The Movie Label.mkv";
+    movie["genre"].push_back("Drama");
+    movie["genre"].push_back("Thriller");
+    result["movies"].push_back_swap(movie);
+  }
+
+  CVariant copy(result);
+
+  EXPECT_EQ(items, copy["movies"].size());
+  EXPECT_STREQ("Thriller", copy["movies"][items - 1]["genre"][1].c_str());
+}
@@ -22,17 +22,69 @@
 #include "utils/RegExp.h"
 #include "filesystem/File.h"
 #include "filesystem/SpecialProtocol.h"
+#include "threads/Atomics.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
 
 #include "test/TestUtils.h"
 
 #include "gtest/gtest.h"
 
+#define ASYNC_LOG_THREADS 4
+#define ASYNC_LOG_LINES   500
+
+class CLogProducer : public IRunnable
+{
+public:
+  CLogProducer(int lines) : m_lines(lines), m_next(0), m_worst(0) {}
+  virtual void Run()
+  {
+    unsigned int worst = 0;
+    for (int i = 0; i < m_lines; i++)
+    {
+      unsigned int start = XbmcThreads::SystemClockMillis();
+      // every line differs so none of them is folded into a repeat
+      CLog::Log(LOGDEBUG, "async log message %ld", AtomicIncrement(&m_next));
+      unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+      if (elapsed > worst)
+        worst = elapsed;
+    }
+    CSingleLock lock(m_section);
+    if (worst > m_worst)
+      m_worst = worst;
+  }
+  int m_lines;
+  volatile long m_next;
+  unsigned int m_worst;
+  CCriticalSection m_section;
+};
+
+static CStdString ReadLog(const CStdString &logfile)
+{
+  CStdString logstring;
+  char buf[100];
+  unsigned int bytesread;
+  XFILE::CFile file;
+
+  if (file.Open(logfile))
+  {
+    while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+    {
+      buf[bytesread] = '\0';
+      logstring.append(buf);
+    }
+    file.Close();
+  }
+  return logstring;
+}
+
 class Testlog : public testing::Test
 {
 protected:
   Testlog(){}
   ~Testlog()
   {
+    CLog::SetAsync(false);
     /* Reset globals used by CLog after each test. */
     g_log_globalsRef->m_file = NULL;
     g_log_globalsRef->m_repeatCount = 0;
@@ -146,3 +198,68 @@ TEST_F(Testlog, SetLogLevel)
   CLog::Close();
   EXPECT_TRUE(XFILE::CFile::Delete(logfile));
 }
+
+TEST_F(Testlog, Async)
+{
+  CStdString logfile, logstring;
+
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + "xbmc.log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/")));
+  CLog::SetAsync(true);
+  EXPECT_TRUE(CLog::IsAsync());
+
+  CLogProducer producer(ASYNC_LOG_LINES);
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  CThread *threads[ASYNC_LOG_THREADS];
+  for (int i = 0; i < ASYNC_LOG_THREADS; i++)
+  {
+    threads[i] = new CThread(&producer, "LogProducer");
+    threads[i]->Create();
+  }
+  for (int i = 0; i < ASYNC_LOG_THREADS; i++)
+  {
+    threads[i]->WaitForThreadExit(60000);
+    delete threads[i];
+  }
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+  printf("CLog %d threads: %d lines in %u ms, worst call %u ms\n", ASYNC_LOG_THREADS,
+         ASYNC_LOG_THREADS * ASYNC_LOG_LINES, elapsed, producer.m_worst);
+
+  // severe lines are on disk as soon as Log() returns
+  CLog::Log(LOGSEVERE, "severe async log message");
+  logstring = ReadLog(logfile);
+  EXPECT_NE(CStdString::npos, logstring.find("SEVERE: severe async log message"));
+
+  CLog::Close();
+  EXPECT_FALSE(CLog::IsAsync());
+
+  logstring = ReadLog(logfile);
+  size_t lines = 0;
+  for (size_t pos = logstring.find("async log message "); pos != CStdString::npos;
+       pos = logstring.find("async log message ", pos + 1))
+    lines++;
+  EXPECT_EQ((size_t)(ASYNC_LOG_THREADS * ASYNC_LOG_LINES), lines);
+  EXPECT_EQ(CStdString::npos, logstring.find("log lines dropped"));
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
+
+TEST_F(Testlog, FlushOnCrash)
+{
+  CStdString logfile, logstring;
+
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + "xbmc.log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/")));
+  CLog::SetAsync(true);
+
+  // debug lines don't wake the writer, they stay queued until flushed
+  for (int i = 0; i < 100; i++)
+    CLog::Log(LOGDEBUG, "queued log message %d", i);
+  CLog::FlushOnCrash();
+
+  logstring = ReadLog(logfile);
+  EXPECT_NE(CStdString::npos, logstring.find("queued log message 99"));
+
+  CLog::Close();
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
@@ -65,6 +65,10 @@ using namespace XFILE;
 using namespace VIDEO;
 using namespace ADDON;
 
+// actors column of the full-text search documents, %s is the item id
+#define MOVIESEARCH_ACTORS  "(SELECT group_concat(strActor, ' ') FROM actorlinkmovie JOIN actors ON actors.idActor=actorlinkmovie.idActor WHERE actorlinkmovie.idMovie=%s)"
+#define TVSHOWSEARCH_ACTORS "(SELECT group_concat(strActor, ' ') FROM actorlinktvshow JOIN actors ON actors.idActor=actorlinktvshow.idActor WHERE actorlinktvshow.idShow=%s)"
+
 //********************************************************************************************************************************
 CVideoDatabase::CVideoDatabase(void)
 {
@@ -354,6 +358,8 @@ bool CVideoDatabase::CreateTables()
                 "DELETE FROM tag WHERE idTag=old.idTag AND idTag NOT IN (SELECT DISTINCT idTag FROM taglinks); "
                 "END");
 
+    CreateSearchIndex();
+
     // we create views last to ensure all indexes are rolled in
     CreateViews();
   }
@@ -367,6 +373,99 @@ bool CVideoDatabase::CreateTables()
   return true;
 }
 
+void CVideoDatabase::CreateSearchIndex()
+{
+  // full-text tables are sqlite only, searches fall back to LIKE without them
+  if (!m_sqlite)
+    return;
+
+  try
+  {
+    // undone as a whole if anything fails, rather than leaving part of the tables and triggers
+    m_pDS->exec("SAVEPOINT searchindex");
+
+    CLog::Log(LOGINFO, "create search index");
+    m_pDS->exec("CREATE VIRTUAL TABLE moviesearch USING fts4(title, overview, actors, prefix=\"2,3\")");
+    m_pDS->exec("CREATE VIRTUAL TABLE tvshowsearch USING fts4(title, overview, actors, prefix=\"2,3\")");
+    m_pDS->exec("CREATE VIRTUAL TABLE episodesearch USING fts4(title, overview, prefix=\"2,3\")");
+
+    // the overview of a movie is its plot, outline and tagline
+    CStdString movieOverview = PrepareSQL("coalesce(new.c%02d, '') || ' ' || coalesce(new.c%02d, '') || ' ' || coalesce(new.c%02d, '')", VIDEODB_ID_PLOT, VIDEODB_ID_PLOTOUTLINE, VIDEODB_ID_TAGLINE);
+    CStdString movieActors = MOVIESEARCH_ACTORS;
+    CStdString tvshowActors = TVSHOWSEARCH_ACTORS;
+
+    // actors are refreshed once per item by UpdateSearchActors(), a trigger
+    // on the link tables would rebuild the document for every single actor
+    CLog::Log(LOGINFO, "create search index triggers");
+    m_pDS->exec(PrepareSQL("CREATE TRIGGER moviesearch_insert AFTER INSERT ON movie FOR EACH ROW BEGIN "
+                           "INSERT INTO moviesearch(docid, title, overview, actors) VALUES (new.idMovie, new.c%02d, ", VIDEODB_ID_TITLE) +
+                movieOverview + ", " + PrepareSQL(movieActors, "new.idMovie") + "); END");
+    m_pDS->exec(PrepareSQL("CREATE TRIGGER moviesearch_update AFTER UPDATE OF c%02d, c%02d, c%02d, c%02d ON movie FOR EACH ROW "
+                           "WHEN new.c%02d IS NOT old.c%02d OR new.c%02d IS NOT old.c%02d OR new.c%02d IS NOT old.c%02d OR new.c%02d IS NOT old.c%02d BEGIN "
+                           "UPDATE moviesearch SET title=new.c%02d, overview=",
+                           VIDEODB_ID_TITLE, VIDEODB_ID_PLOT, VIDEODB_ID_PLOTOUTLINE, VIDEODB_ID_TAGLINE,
+                           VIDEODB_ID_TITLE, VIDEODB_ID_TITLE, VIDEODB_ID_PLOT, VIDEODB_ID_PLOT,
+                           VIDEODB_ID_PLOTOUTLINE, VIDEODB_ID_PLOTOUTLINE, VIDEODB_ID_TAGLINE, VIDEODB_ID_TAGLINE, VIDEODB_ID_TITLE) +
+                movieOverview + " WHERE docid=new.idMovie; END");
+    m_pDS->exec("CREATE TRIGGER moviesearch_delete AFTER DELETE ON movie FOR EACH ROW BEGIN DELETE FROM moviesearch WHERE docid=old.idMovie; END");
+
+    m_pDS->exec(PrepareSQL("CREATE TRIGGER tvshowsearch_insert AFTER INSERT ON tvshow FOR EACH ROW BEGIN "
+                           "INSERT INTO tvshowsearch(docid, title, overview, actors) VALUES (new.idShow, new.c%02d, new.c%02d, ",
+                           VIDEODB_ID_TV_TITLE, VIDEODB_ID_TV_PLOT) + PrepareSQL(tvshowActors, "new.idShow") + "); END");
+    m_pDS->exec(PrepareSQL("CREATE TRIGGER tvshowsearch_update AFTER UPDATE OF c%02d, c%02d ON tvshow FOR EACH ROW "
+                           "WHEN new.c%02d IS NOT old.c%02d OR new.c%02d IS NOT old.c%02d BEGIN "
+                           "UPDATE tvshowsearch SET title=new.c%02d, overview=new.c%02d WHERE docid=new.idShow; END",
+                           VIDEODB_ID_TV_TITLE, VIDEODB_ID_TV_PLOT, VIDEODB_ID_TV_TITLE, VIDEODB_ID_TV_TITLE,
+                           VIDEODB_ID_TV_PLOT, VIDEODB_ID_TV_PLOT, VIDEODB_ID_TV_TITLE, VIDEODB_ID_TV_PLOT));
+    m_pDS->exec("CREATE TRIGGER tvshowsearch_delete AFTER DELETE ON tvshow FOR EACH ROW BEGIN DELETE FROM tvshowsearch WHERE docid=old.idShow; END");
+
+    m_pDS->exec(PrepareSQL("CREATE TRIGGER episodesearch_insert AFTER INSERT ON episode FOR EACH ROW BEGIN "
+                           "INSERT INTO episodesearch(docid, title, overview) VALUES (new.idEpisode, new.c%02d, new.c%02d); END",
+                           VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_PLOT));
+    m_pDS->exec(PrepareSQL("CREATE TRIGGER episodesearch_update AFTER UPDATE OF c%02d, c%02d ON episode FOR EACH ROW "
+                           "WHEN new.c%02d IS NOT old.c%02d OR new.c%02d IS NOT old.c%02d BEGIN "
+                           "UPDATE episodesearch SET title=new.c%02d, overview=new.c%02d WHERE docid=new.idEpisode; END",
+                           VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_PLOT, VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_TITLE,
+                           VIDEODB_ID_EPISODE_PLOT, VIDEODB_ID_EPISODE_PLOT, VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_PLOT));
+    m_pDS->exec("CREATE TRIGGER episodesearch_delete AFTER DELETE ON episode FOR EACH ROW BEGIN DELETE FROM episodesearch WHERE docid=old.idEpisode; END");
+
+    // index what's already in the library
+    CStdString overview = movieOverview;
+    overview.Replace("new.", "");
+    m_pDS->exec(PrepareSQL("INSERT INTO moviesearch(docid, title, overview, actors) SELECT idMovie, c%02d, ", VIDEODB_ID_TITLE) +
+                overview + ", " + PrepareSQL(movieActors, "movie.idMovie") + " FROM movie");
+    m_pDS->exec(PrepareSQL("INSERT INTO tvshowsearch(docid, title, overview, actors) SELECT idShow, c%02d, c%02d, ", VIDEODB_ID_TV_TITLE, VIDEODB_ID_TV_PLOT) +
+                PrepareSQL(tvshowActors, "tvshow.idShow") + " FROM tvshow");
+    m_pDS->exec(PrepareSQL("INSERT INTO episodesearch(docid, title, overview) SELECT idEpisode, c%02d, c%02d FROM episode", VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_PLOT));
+
+    m_pDS->exec("RELEASE searchindex");
+  }
+  catch (...)
+  {
+    CLog::Log(LOGWARNING, "%s - unable to create the search index, sqlite has no full-text search", __FUNCTION__);
+    try
+    {
+      m_pDS->exec("ROLLBACK TO searchindex");
+      m_pDS->exec("RELEASE searchindex");
+    }
+    catch (...)
+    {
+      CLog::Log(LOGERROR, "%s - unable to remove the partial search index", __FUNCTION__);
+    }
+  }
+}
+
+void CVideoDatabase::UpdateSearchActors(const CStdString &index, const CStdString &actors, int id)
+{
+  // the index is missing without sqlite or if it was built without full-text search
+  if (!m_sqlite || GetSingleValue(PrepareSQL("SELECT name FROM sqlite_master WHERE type='table' AND name='%s'", index.c_str()), m_pDS2).empty())
+    return;
+
+  CStdString strId;
+  strId.Format("%i", id);
+  m_pDS->exec(PrepareSQL("UPDATE %s SET actors=", index.c_str()) + PrepareSQL(actors, strId.c_str()) + PrepareSQL(" WHERE docid=%i", id));
+}
+
 void CVideoDatabase::CreateViews()
 {
   CLog::Log(LOGINFO, "create episodeview");
@@ -479,8 +578,10 @@ int CVideoDatabase::GetPathId(const CStdString& strPath)
 
     URIUtils::AddSlashAtEnd(strPath1);
 
-    strSQL=PrepareSQL("select idPath from path where strPath='%s'",strPath1.c_str());
-    m_pDS->query(strSQL.c_str());
+    strSQL = "select idPath from path where strPath=?";
+    query_params params;
+    params.push_back(strPath1);
+    m_pDS->query(strSQL, params);
     if (!m_pDS->eof())
       idPath = m_pDS->fv("path.idPath").get_asInt();
 
@@ -648,11 +749,16 @@ int CVideoDatabase::AddPath(const CStdString& strPath, const CStdString &strDate
     URIUtils::AddSlashAtEnd(strPath1);
 
     // only set dateadded if we got one
+    query_params params;
+    params.push_back(strPath1);
     if (!strDateAdded.empty())
-      strSQL=PrepareSQL("insert into path (idPath, strPath, strContent, strScraper, dateAdded) values (NULL,'%s','','', '%s')", strPath1.c_str(), strDateAdded.c_str());
+    {
+      strSQL = "insert into path (idPath, strPath, strContent, strScraper, dateAdded) values (NULL,?,'','',?)";
+      params.push_back(strDateAdded);
+    }
     else
-      strSQL=PrepareSQL("insert into path (idPath, strPath, strContent, strScraper) values (NULL,'%s','','')", strPath1.c_str());
-    m_pDS->exec(strSQL.c_str());
+      strSQL = "insert into path (idPath, strPath, strContent, strScraper) values (NULL,?,'','')";
+    m_pDS->exec(strSQL, params);
     idPath = (int)m_pDS->lastinsertid();
     return idPath;
   }
@@ -702,9 +808,12 @@ int CVideoDatabase::AddFile(const CStdString& strFileNameAndPath)
     if (idPath < 0)
       return -1;
 
-    CStdString strSQL=PrepareSQL("select idFile from files where strFileName='%s' and idPath=%i", strFileName.c_str(),idPath);
+    strSQL = "select idFile from files where strFileName=? and idPath=?";
+    query_params params;
+    params.push_back(strFileName);
+    params.push_back(idPath);
 
-    m_pDS->query(strSQL.c_str());
+    m_pDS->query(strSQL, params);
     if (m_pDS->num_rows() > 0)
     {
       idFile = m_pDS->fv("idFile").get_asInt() ;
@@ -713,8 +822,11 @@ int CVideoDatabase::AddFile(const CStdString& strFileNameAndPath)
     }
     m_pDS->close();
 
-    strSQL=PrepareSQL("insert into files (idFile, idPath, strFileName) values(NULL, %i, '%s')", idPath, strFileName.c_str());
-    m_pDS->exec(strSQL.c_str());
+    strSQL = "insert into files (idFile, idPath, strFileName) values(NULL, ?, ?)";
+    params.clear();
+    params.push_back(idPath);
+    params.push_back(strFileName);
+    m_pDS->exec(strSQL, params);
     idFile = (int)m_pDS->lastinsertid();
     return idFile;
   }
@@ -2010,6 +2122,7 @@ int CVideoDatabase::SetDetailsForMovie(const CStdString& strFilenameAndPath, con
       int idActor = AddActor(it->strName, it->thumbUrl.m_xml, it->thumb);
       AddActorToMovie(idMovie, idActor, it->strRole, order++);
     }
+    UpdateSearchActors("moviesearch", MOVIESEARCH_ACTORS, idMovie);
 
     // add set...
     int idSet = -1;
@@ -2117,6 +2230,7 @@ int CVideoDatabase::SetDetailsForTvShow(const CStdString& strPath, const CVideoI
       int idActor = AddActor(it->strName, it->thumbUrl.m_xml, it->thumb);
       AddActorToTvShow(idTvShow, idActor, it->strRole, order++);
     }
+    UpdateSearchActors("tvshowsearch", TVSHOWSEARCH_ACTORS, idTvShow);
 
     unsigned int i;
     for (i = 0; i < vecGenres.size(); ++i)
@@ -2378,33 +2492,47 @@ void CVideoDatabase::SetStreamDetailsForFileId(const CStreamDetails& details, in
   try
   {
     BeginTransaction();
-    m_pDS->exec(PrepareSQL("DELETE FROM streamdetails WHERE idFile = %i", idFile));
+    query_params params;
+    params.push_back(idFile);
+    m_pDS->exec("DELETE FROM streamdetails WHERE idFile = ?", params);
 
     for (int i=1; i<=details.GetVideoStreamCount(); i++)
     {
-      m_pDS->exec(PrepareSQL("INSERT INTO streamdetails "
+      params.clear();
+      params.push_back(idFile);
+      params.push_back((int)CStreamDetail::VIDEO);
+      params.push_back(details.GetVideoCodec(i));
+      // round like the %f the statement used to be formatted with, so the
+      // stored aspects stay the same
+      params.push_back(atof(StringUtils::Format("%f", details.GetVideoAspect(i)).c_str()));
+      params.push_back(details.GetVideoWidth(i));
+      params.push_back(details.GetVideoHeight(i));
+      params.push_back(details.GetVideoDuration(i));
+      m_pDS->exec("INSERT INTO streamdetails "
         "(idFile, iStreamType, strVideoCodec, fVideoAspect, iVideoWidth, iVideoHeight, iVideoDuration) "
-        "VALUES (%i,%i,'%s',%f,%i,%i,%i)",
-        idFile, (int)CStreamDetail::VIDEO,
-        details.GetVideoCodec(i).c_str(), details.GetVideoAspect(i),
-        details.GetVideoWidth(i), details.GetVideoHeight(i), details.GetVideoDuration(i)));
+        "VALUES (?,?,?,?,?,?,?)", params);
     }
     for (int i=1; i<=details.GetAudioStreamCount(); i++)
     {
-      m_pDS->exec(PrepareSQL("INSERT INTO streamdetails "
+      params.clear();
+      params.push_back(idFile);
+      params.push_back((int)CStreamDetail::AUDIO);
+      params.push_back(details.GetAudioCodec(i));
+      params.push_back(details.GetAudioChannels(i));
+      params.push_back(details.GetAudioLanguage(i));
+      m_pDS->exec("INSERT INTO streamdetails "
         "(idFile, iStreamType, strAudioCodec, iAudioChannels, strAudioLanguage) "
-        "VALUES (%i,%i,'%s',%i,'%s')",
-        idFile, (int)CStreamDetail::AUDIO,
-        details.GetAudioCodec(i).c_str(), details.GetAudioChannels(i),
-        details.GetAudioLanguage(i).c_str()));
+        "VALUES (?,?,?,?,?)", params);
     }
     for (int i=1; i<=details.GetSubtitleStreamCount(); i++)
     {
-      m_pDS->exec(PrepareSQL("INSERT INTO streamdetails "
+      params.clear();
+      params.push_back(idFile);
+      params.push_back((int)CStreamDetail::SUBTITLE);
+      params.push_back(details.GetSubtitleLanguage(i));
+      m_pDS->exec("INSERT INTO streamdetails "
         "(idFile, iStreamType, strSubtitleLanguage) "
-        "VALUES (%i,%i,'%s')",
-        idFile, (int)CStreamDetail::SUBTITLE,
-        details.GetSubtitleLanguage(i).c_str()));
+        "VALUES (?,?,?)", params);
     }
 
     // update the runtime information, if empty
@@ -4418,6 +4546,8 @@ bool CVideoDatabase::UpdateOldVersion(int iVersion)
     m_pDS->exec("CREATE INDEX ix_path ON path ( strPath(255) )");
     m_pDS->exec("CREATE INDEX ix_files ON files ( idPath, strFilename(255) )");
   }
+  if (iVersion < 76)
+    CreateSearchIndex();
   // always recreate the view after any table change
   CreateViews();
   return true;
@@ -4425,7 +4555,7 @@ bool CVideoDatabase::UpdateOldVersion(int iVersion)
 
 int CVideoDatabase::GetMinVersion() const
 {
-  return 75;
+  return 76;
 }
 
 bool CVideoDatabase::LookupByFolders(const CStdString &path, bool shows)
@@ -5997,6 +6127,25 @@ bool CVideoDatabase::GetMoviesNav(const CStdString& strBaseDir, CFileItemList& i
   return GetMoviesByWhere(videoUrl.ToString(), filter, items, sortDescription);
 }
 
+void CVideoDatabase::AddMovieItem(const dbiplus::sql_record* const record, const CVideoDbUrl &videoUrl, CFileItemList &items)
+{
+  CVideoInfoTag movie = GetDetailsForMovie(record);
+  if (CProfilesManager::Get().GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
+      g_passwordManager.bMasterUser                                   ||
+      g_passwordManager.IsDatabasePathUnlocked(movie.m_strPath, *CMediaSourceSettings::Get().GetSources("video")))
+  {
+    CFileItemPtr pItem(new CFileItem(movie));
+
+    CVideoDbUrl itemUrl = videoUrl;
+    CStdString path; path.Format("%ld", movie.m_iDbId);
+    itemUrl.AppendPath(path);
+    pItem->SetPath(itemUrl.ToString());
+
+    pItem->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED,movie.m_playCount > 0);
+    items.Add(pItem);
+  }
+}
+
 bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter &filter, CFileItemList& items, const SortDescription &sortDescription /* = SortDescription() */)
 {
   try
@@ -6017,13 +6166,24 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
     int total = -1;
 
     CStdString strSQL = "select %s from movieview ";
+
+    // Let the database sort when it orders like SortUtils would, the rows can
+    // then be converted one by one while stepping through them
+    std::string orderClause;
+    bool sortInSQL = extFilter.limit.empty() &&
+                     sorting.sortBy == sortDescription.sortBy &&
+                     sorting.sortOrder == sortDescription.sortOrder &&
+                    (sorting.sortBy == SortByNone || extFilter.order.empty()) &&
+                     SortUtils::BuildOrderClause(sorting, MediaTypeMovie, orderClause);
+    if (sortInSQL && !orderClause.empty())
+      extFilter.order = orderClause;
+
     CStdString strSQLExtra;
     if (!CDatabase::BuildSQL(strSQLExtra, extFilter, strSQLExtra))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
-    if (extFilter.limit.empty() &&
-        sorting.sortBy == SortByNone &&
+    // Apply the limiting directly here if the database does the sorting
+    if (sortInSQL &&
        (sorting.limitStart > 0 || sorting.limitEnd > 0))
     {
       total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
@@ -6032,6 +6192,29 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
+    if (sortInSQL)
+    {
+      unsigned int time = XbmcThreads::SystemClockMillis();
+      CReadDataset ds(*this);
+      if (!ds->query_cursor(strSQL))
+        return false;
+
+      int count = 0;
+      while (!ds->eof())
+      {
+        AddMovieItem(ds->get_sql_record(), videoUrl, items);
+        count++;
+        ds->next();
+      }
+      ds->close();
+      CLog::Log(LOGDEBUG, "%s took %d ms for %d items query: %s", __FUNCTION__, XbmcThreads::SystemClockMillis() - time, count, strSQL.c_str());
+
+      if (total < count)
+        total = count;
+      items.SetProperty("total", total);
+      return true;
+    }
+
     int iRowsFound = RunQuery(strSQL);
     if (iRowsFound <= 0)
       return iRowsFound == 0;
@@ -6053,23 +6236,7 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
     for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
     {
       unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
-
-      CVideoInfoTag movie = GetDetailsForMovie(record);
-      if (CProfilesManager::Get().GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
-          g_passwordManager.bMasterUser                                   ||
-          g_passwordManager.IsDatabasePathUnlocked(movie.m_strPath, *CMediaSourceSettings::Get().GetSources("video")))
-      {
-        CFileItemPtr pItem(new CFileItem(movie));
-
-        CVideoDbUrl itemUrl = videoUrl;
-        CStdString path; path.Format("%ld", movie.m_iDbId);
-        itemUrl.AppendPath(path);
-        pItem->SetPath(itemUrl.ToString());
-
-        pItem->SetOverlayImage(CGUIListItem::ICON_OVERLAY_UNWATCHED,movie.m_playCount > 0);
-        items.Add(pItem);
-      }
+      AddMovieItem(&data.at(targetRow), videoUrl, items);
     }
 
     // cleanup
@@ -6158,7 +6325,7 @@ bool CVideoDatabase::GetTvShowsByWhere(const CStdString& strBaseDir, const Filte
     for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
     {
       unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
+      const dbiplus::sql_record* const record = &data.at(targetRow);
       
       CVideoInfoTag movie = GetDetailsForTvShow(record, false);
       if ((CProfilesManager::Get().GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
@@ -6479,7 +6646,7 @@ bool CVideoDatabase::GetEpisodesByWhere(const CStdString& strBaseDir, const Filt
     for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
     {
       unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
+      const dbiplus::sql_record* const record = &data.at(targetRow);
 
       CVideoInfoTag movie = GetDetailsForEpisode(record);
       if (CProfilesManager::Get().GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
@@ -7340,7 +7507,7 @@ bool CVideoDatabase::GetMusicVideosByWhere(const CStdString &baseDir, const Filt
     for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
     {
       unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
+      const dbiplus::sql_record* const record = &data.at(targetRow);
       
       CVideoInfoTag musicvideo = GetDetailsForMusicVideo(record);
       if (!checkLocks || CProfilesManager::Get().GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE || g_passwordManager.bMasterUser ||
@@ -7492,7 +7659,15 @@ void CVideoDatabase::GetMoviesByName(const CStdString& strSearch, CFileItemList&
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
-    if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
+    CStdString hits = GetFullTextHits("moviesearch", strSearch, "title");
+    if (!hits.empty())
+    {
+      if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
+        strSQL = PrepareSQL("select movie.idMovie,movie.c%02d,path.strPath, movie.idSet from ", VIDEODB_ID_TITLE) + hits + " join movie on movie.idMovie=hits.docid join files on files.idFile=movie.idFile join path on path.idPath=files.idPath order by hits.score desc";
+      else
+        strSQL = PrepareSQL("select movie.idMovie,movie.c%02d, movie.idSet from ", VIDEODB_ID_TITLE) + hits + " join movie on movie.idMovie=hits.docid order by hits.score desc";
+    }
+    else if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
       strSQL = PrepareSQL("select movie.idMovie,movie.c%02d,path.strPath, movie.idSet from movie,files,path where files.idFile=movie.idFile and files.idPath=path.idPath and movie.c%02d like '%%%s%%'",VIDEODB_ID_TITLE,VIDEODB_ID_TITLE,strSearch.c_str());
     else
       strSQL = PrepareSQL("select movie.idMovie,movie.c%02d, movie.idSet from movie where movie.c%02d like '%%%s%%'",VIDEODB_ID_TITLE,VIDEODB_ID_TITLE,strSearch.c_str());
@@ -7537,7 +7712,15 @@ void CVideoDatabase::GetTvShowsByName(const CStdString& strSearch, CFileItemList
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
-    if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
+    CStdString hits = GetFullTextHits("tvshowsearch", strSearch, "title");
+    if (!hits.empty())
+    {
+      if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
+        strSQL = PrepareSQL("select tvshow.idShow,tvshow.c%02d,path.strPath from ", VIDEODB_ID_TV_TITLE) + hits + " join tvshow on tvshow.idShow=hits.docid join tvshowlinkpath on tvshowlinkpath.idShow=tvshow.idShow join path on path.idPath=tvshowlinkpath.idPath order by hits.score desc";
+      else
+        strSQL = PrepareSQL("select tvshow.idShow,tvshow.c%02d from ", VIDEODB_ID_TV_TITLE) + hits + " join tvshow on tvshow.idShow=hits.docid order by hits.score desc";
+    }
+    else if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
       strSQL = PrepareSQL("select tvshow.idShow,tvshow.c%02d,path.strPath from tvshow,path,tvshowlinkpath where tvshowlinkpath.idPath=path.idPath and tvshowlinkpath.idShow=tvshow.idShow and tvshow.c%02d like '%%%s%%'",VIDEODB_ID_TV_TITLE,VIDEODB_ID_TV_TITLE,strSearch.c_str());
     else
       strSQL = PrepareSQL("select tvshow.idShow,tvshow.c%02d from tvshow where tvshow.c%02d like '%%%s%%'",VIDEODB_ID_TV_TITLE,VIDEODB_ID_TV_TITLE,strSearch.c_str());
@@ -7579,7 +7762,15 @@ void CVideoDatabase::GetEpisodesByName(const CStdString& strSearch, CFileItemLis
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
-    if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
+    CStdString hits = GetFullTextHits("episodesearch", strSearch, "title");
+    if (!hits.empty())
+    {
+      if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
+        strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d,path.strPath from ", VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_SEASON, VIDEODB_ID_TV_TITLE) + hits + " join episode on episode.idEpisode=hits.docid join files on files.idFile=episode.idFile join path on path.idPath=files.idPath join tvshow on tvshow.idShow=episode.idShow order by hits.score desc";
+      else
+        strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d from ", VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_SEASON, VIDEODB_ID_TV_TITLE) + hits + " join episode on episode.idEpisode=hits.docid join tvshow on tvshow.idShow=episode.idShow order by hits.score desc";
+    }
+    else if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
       strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d,path.strPath from episode,files,path,tvshow where files.idFile=episode.idFile and episode.idShow=tvshow.idShow and files.idPath=path.idPath and episode.c%02d like '%%%s%%'",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,VIDEODB_ID_EPISODE_TITLE,strSearch.c_str());
     else
       strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d from episode,tvshow where tvshow.idShow=episode.idShow and episode.c%02d like '%%%s%%'",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,VIDEODB_ID_EPISODE_TITLE,strSearch.c_str());
@@ -7670,7 +7861,15 @@ void CVideoDatabase::GetEpisodesByPlot(const CStdString& strSearch, CFileItemLis
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
-    if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
+    CStdString hits = GetFullTextHits("episodesearch", strSearch, "overview");
+    if (!hits.empty())
+    {
+      if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
+        strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d,path.strPath from ", VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_SEASON, VIDEODB_ID_TV_TITLE) + hits + " join episode on episode.idEpisode=hits.docid join files on files.idFile=episode.idFile join path on path.idPath=files.idPath join tvshow on tvshow.idShow=episode.idShow order by hits.score desc";
+      else
+        strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d from ", VIDEODB_ID_EPISODE_TITLE, VIDEODB_ID_EPISODE_SEASON, VIDEODB_ID_TV_TITLE) + hits + " join episode on episode.idEpisode=hits.docid join tvshow on tvshow.idShow=episode.idShow order by hits.score desc";
+    }
+    else if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
       strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d,path.strPath from episode,files,path,tvshow where files.idFile=episode.idFile and files.idPath=path.idPath and tvshow.idShow=episode.idShow and episode.c%02d like '%%%s%%'",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,VIDEODB_ID_EPISODE_PLOT,strSearch.c_str());
     else
       strSQL = PrepareSQL("select episode.idEpisode,episode.c%02d,episode.c%02d,episode.idShow,tvshow.c%02d from episode,tvshow where tvshow.idShow=episode.idShow and episode.c%02d like '%%%s%%'",VIDEODB_ID_EPISODE_TITLE,VIDEODB_ID_EPISODE_SEASON,VIDEODB_ID_TV_TITLE,VIDEODB_ID_EPISODE_PLOT,strSearch.c_str());
@@ -7709,7 +7908,15 @@ void CVideoDatabase::GetMoviesByPlot(const CStdString& strSearch, CFileItemList&
     if (NULL == m_pDB.get()) return;
     if (NULL == m_pDS.get()) return;
 
-    if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
+    CStdString hits = GetFullTextHits("moviesearch", strSearch, "overview");
+    if (!hits.empty())
+    {
+      if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
+        strSQL = PrepareSQL("select movie.idMovie, movie.c%02d, path.strPath from ", VIDEODB_ID_TITLE) + hits + " join movie on movie.idMovie=hits.docid join files on files.idFile=movie.idFile join path on path.idPath=files.idPath order by hits.score desc";
+      else
+        strSQL = PrepareSQL("select movie.idMovie, movie.c%02d from ", VIDEODB_ID_TITLE) + hits + " join movie on movie.idMovie=hits.docid order by hits.score desc";
+    }
+    else if (CProfilesManager::Get().GetMasterProfile().getLockMode() != LOCK_MODE_EVERYONE && !g_passwordManager.bMasterUser)
       strSQL = PrepareSQL("select movie.idMovie, movie.c%02d, path.strPath from movie,files,path where files.idFile=movie.idFile and files.idPath=path.idPath and (movie.c%02d like '%%%s%%' or movie.c%02d like '%%%s%%' or movie.c%02d like '%%%s%%')",VIDEODB_ID_TITLE,VIDEODB_ID_PLOT,strSearch.c_str(),VIDEODB_ID_PLOTOUTLINE,strSearch.c_str(),VIDEODB_ID_TAGLINE,strSearch.c_str());
     else
       strSQL = PrepareSQL("select movie.idMovie, movie.c%02d from movie where (movie.c%02d like '%%%s%%' or movie.c%02d like '%%%s%%' or movie.c%02d like '%%%s%%')",VIDEODB_ID_TITLE,VIDEODB_ID_PLOT,strSearch.c_str(),VIDEODB_ID_PLOTOUTLINE,strSearch.c_str(),VIDEODB_ID_TAGLINE,strSearch.c_str());
@@ -9644,6 +9851,22 @@ bool CVideoDatabase::GetFilter(CDbUrl &videoUrl, Filter &filter, SortDescription
   else
     return false;
 
+  option = options.find("search");
+  if (option != options.end() &&
+     (itemType == "movies" || itemType == "tvshows" || itemType == "episodes"))
+  {
+    std::string media = itemType.substr(0, itemType.size() - 1);
+    std::string id = itemType == "movies" ? "idMovie" : (itemType == "tvshows" ? "idShow" : "idEpisode");
+    std::string hits = GetFullTextHits(media + "search", option->second.asString(), "", itemType == "episodes" ? "4, 1" : "4, 1, 2");
+    if (!hits.empty())
+    {
+      filter.AppendJoin("JOIN " + hits + " ON hits.docid = " + media + "view." + id);
+      filter.AppendOrder("hits.score DESC");
+    }
+    else // the title is c00 for all of them
+      filter.AppendWhere(PrepareSQL("%sview.c%02d like '%%%s%%'", media.c_str(), VIDEODB_ID_TITLE, option->second.asString().c_str()));
+  }
+
   option = options.find("xsp");
   if (option != options.end())
   {
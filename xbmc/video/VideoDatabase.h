@@ -36,8 +36,7 @@ class CGUIDialogProgressBarHandle;
 
 namespace dbiplus
 {
-  class field_value;
-  typedef std::vector<field_value> sql_record;
+  class sql_record;
 }
 
 #ifndef my_offsetof
@@ -762,6 +761,8 @@ protected:
   CVideoInfoTag GetDetailsByTypeAndId(VIDEODB_CONTENT_TYPE type, int id);
   CVideoInfoTag GetDetailsForMovie(std::auto_ptr<dbiplus::Dataset> &pDS, bool getDetails = false);
   CVideoInfoTag GetDetailsForMovie(const dbiplus::sql_record* const record, bool getDetails = false);
+  /*! \brief Add a movieview row to a listing, unless its path is locked */
+  void AddMovieItem(const dbiplus::sql_record* const record, const CVideoDbUrl &videoUrl, CFileItemList &items);
   CVideoInfoTag GetDetailsForTvShow(std::auto_ptr<dbiplus::Dataset> &pDS, bool getDetails = false);
   CVideoInfoTag GetDetailsForTvShow(const dbiplus::sql_record* const record, bool getDetails = false);
   CVideoInfoTag GetDetailsForEpisode(std::auto_ptr<dbiplus::Dataset> &pDS, bool getDetails = false);
@@ -785,6 +786,19 @@ private:
    */
   virtual void CreateViews();
 
+  /*! \brief Create the full-text index used to search movies, tvshows and episodes
+   and the triggers keeping it up to date. Does nothing if sqlite has no full-text search.
+   */
+  void CreateSearchIndex();
+
+  /*! \brief Rebuild the actors of an item's full-text search document
+   Called once the cast of an item has been written.
+   \param index the search index, moviesearch or tvshowsearch
+   \param actors subquery selecting the actors, with a %s for the item id
+   \param id the id of the movie or tv show
+   */
+  void UpdateSearchActors(const CStdString &index, const CStdString &actors, int id);
+
   /*! \brief Run a query on the main dataset and return the number of rows
    If no rows are found we close the dataset and return 0.
    \param sql the sql query to run
@@ -23,6 +23,7 @@
 #include "VideoInfoScanner.h"
 #include "addons/AddonManager.h"
 #include "filesystem/DirectoryCache.h"
+#include "filesystem/DirectoryWalker.h"
 #include "Util.h"
 #include "NfoFile.h"
 #include "utils/RegExp.h"
@@ -220,6 +221,44 @@ namespace VIDEO
 
   bool CVideoInfoScanner::DoScan(const CStdString& strDirectory)
   {
+    // the walker lists the folders below while we scrape the current one
+    CDirectoryWalker walker(g_advancedSettings.m_videoExtensions);
+    if (!walker.Walk(strDirectory, *this))
+      m_bStop = true;
+    m_fastHashes.clear();
+    return !m_bStop;
+  }
+
+  bool CVideoInfoScanner::NeedsListing(const CStdString& strDirectory)
+  {
+    bool foundDirectly = false;
+    SScanSettings settings;
+    ScraperPtr info = m_database.GetScraperForPath(strDirectory, settings, foundDirectly);
+    CONTENT_TYPE content = info ? info->Content() : CONTENT_NONE;
+
+    CStdStringArray regexps = content == CONTENT_TVSHOWS ? g_advancedSettings.m_tvshowExcludeFromScanRegExps
+                                                         : g_advancedSettings.m_moviesExcludeFromScanRegExps;
+    if (CUtil::ExcludeFileOrFolder(strDirectory, regexps))
+      return false;
+
+    if (content == CONTENT_NONE || (!m_scanAll && settings.noupdate))
+      return false;
+
+    if (content == CONTENT_TVSHOWS)
+      return foundDirectly && !settings.parent_name_root;
+
+    // a matching fast hash means OnDirectory() won't look at the folder, nor below it
+    CStdString fastHash = GetFastHash(strDirectory);
+    CStdString dbHash;
+    m_fastHashes[strDirectory] = fastHash;
+    return !m_database.GetPathHash(strDirectory, dbHash) || fastHash.IsEmpty() || fastHash != dbHash;
+  }
+
+  DIRECTORY_WALK CVideoInfoScanner::OnDirectory(const CStdString& strDirectory, CFileItemList& listing)
+  {
+    if (m_bStop)
+      return WALK_STOP;
+
     if (m_handle)
     {
       m_handle->SetText(g_localizeStrings.Get(20415));
@@ -248,11 +287,11 @@ namespace VIDEO
                                                          : g_advancedSettings.m_moviesExcludeFromScanRegExps;
 
     if (CUtil::ExcludeFileOrFolder(strDirectory, regexps))
-      return true;
+      return WALK_SKIP;
 
     bool ignoreFolder = !m_scanAll && settings.noupdate;
     if (content == CONTENT_NONE || ignoreFolder)
-      return true;
+      return WALK_SKIP;
 
     CStdString hash, dbHash;
     if (content == CONTENT_MOVIES ||content == CONTENT_MUSICVIDEOS)
@@ -263,7 +302,15 @@ namespace VIDEO
         m_handle->SetTitle(StringUtils::Format(g_localizeStrings.Get(str), info->Name().c_str()));
       }
 
-      CStdString fastHash = GetFastHash(strDirectory);
+      CStdString fastHash;
+      map<CStdString, CStdString>::iterator cached = m_fastHashes.find(strDirectory);
+      if (cached != m_fastHashes.end())
+      {
+        fastHash = cached->second;
+        m_fastHashes.erase(cached);
+      }
+      else
+        fastHash = GetFastHash(strDirectory);
       if (m_database.GetPathHash(strDirectory, dbHash) && !fastHash.IsEmpty() && fastHash == dbHash)
       { // fast hashes match - no need to process anything
         CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' due to no change (fasthash)", strDirectory.c_str());
@@ -272,7 +319,7 @@ namespace VIDEO
       }
       if (!bSkip)
       { // need to fetch the folder
-        CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
+        items.Assign(listing);
         items.Stack();
         // compute hash
         GetPathHash(items, hash);
@@ -308,7 +355,7 @@ namespace VIDEO
 
       if (foundDirectly && !settings.parent_name_root)
       {
-        CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
+        items.Assign(listing);
         items.SetPath(strDirectory);
         GetPathHash(items, hash);
         bSkip = true;
@@ -355,24 +402,13 @@ namespace VIDEO
     if (m_handle)
       OnDirectoryScanned(strDirectory);
 
-    for (int i = 0; i < items.Size(); ++i)
-    {
-      CFileItemPtr pItem = items[i];
-
-      if (m_bStop)
-        break;
+    if (m_bStop)
+      return WALK_STOP;
 
-      // if we have a directory item (non-playlist) we then recurse into that folder
-      // do not recurse for tv shows - we have already looked recursively for episodes
-      if (pItem->m_bIsFolder && !pItem->IsParentFolder() && !pItem->IsPlayList() && settings.recurse > 0 && content != CONTENT_TVSHOWS)
-      {
-        if (!DoScan(pItem->GetPath()))
-        {
-          m_bStop = true;
-        }
-      }
-    }
-    return !m_bStop;
+    // if we have a directory item (non-playlist) the walker then recurses into that folder
+    // do not recurse for tv shows - we have already looked recursively for episodes
+    listing.Assign(items);
+    return settings.recurse > 0 && content != CONTENT_TVSHOWS ? WALK_RECURSE : WALK_SKIP;
   }
 
   bool CVideoInfoScanner::RetrieveVideoInfo(CFileItemList& items, bool bDirNames, CONTENT_TYPE content, bool useLocal, CScraperUrl* pURL, bool fetchEpisodes, CGUIDialogProgress* pDlgProgress)
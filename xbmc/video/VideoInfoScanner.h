@@ -22,6 +22,7 @@
 #include "VideoDatabase.h"
 #include "addons/Scraper.h"
 #include "NfoFile.h"
+#include "filesystem/DirectoryWalker.h"
 
 class CRegExp;
 class CFileItem;
@@ -48,7 +49,7 @@ namespace VIDEO
                   INFO_NOT_FOUND,
                   INFO_ADDED };
 
-  class CVideoInfoScanner : CThread
+  class CVideoInfoScanner : CThread, public XFILE::IDirectoryWalkerCallback
   {
   public:
     CVideoInfoScanner();
@@ -124,6 +125,20 @@ namespace VIDEO
     virtual void Process();
     bool DoScan(const CStdString& strDirectory);
 
+    /*! \brief Scan a directory found by DoScan()
+     \param strDirectory the directory.
+     \param listing its items, replaced by the items whose folders should be scanned next.
+     \sa XFILE::IDirectoryWalkerCallback
+     */
+    virtual XFILE::DIRECTORY_WALK OnDirectory(const CStdString& strDirectory, CFileItemList& listing);
+
+    /*! \brief Whether OnDirectory() needs the listing of a directory
+     Excluded, ignored and unchanged (matching fast hash) directories aren't listed.
+     \sa XFILE::IDirectoryWalkerCallback
+     */
+    virtual bool NeedsListing(const CStdString& strDirectory);
+    virtual bool IsStopped() { return m_bStop; }
+
     INFO_RET RetrieveInfoForTvShow(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, bool fetchEpisodes, CGUIDialogProgress* pDlgProgress);
     INFO_RET RetrieveInfoForMovie(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, CGUIDialogProgress* pDlgProgress);
     INFO_RET RetrieveInfoForMusicVideo(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, CGUIDialogProgress* pDlgProgress);
@@ -235,6 +250,7 @@ namespace VIDEO
     CStdString m_strStartDir;
     CVideoDatabase m_database;
     std::set<CStdString> m_pathsToScan;
+    std::map<CStdString, CStdString> m_fastHashes; ///< fast hashes taken by NeedsListing(), used by OnDirectory()
     std::set<CStdString> m_pathsToCount;
     std::set<int> m_pathsToClean;
     CNfoFile m_nfoReader;
@@ -43,6 +43,7 @@
 #include "settings/Settings.h"
 #include "guilib/GUISelectButtonControl.h"
 #include "FileItem.h"
+#include "filesystem/FileStats.h"
 #include "video/VideoReferenceClock.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/CPUInfo.h"
@@ -58,6 +59,8 @@
 #include "cores/IPlayer.h"
 
 #include <stdio.h>
+#include <map>
+#include <vector>
 #include <algorithm>
 #if defined(TARGET_DARWIN)
 #include "linux/LinuxResourceCounter.h"
@@ -88,6 +91,45 @@ static CLinuxResourceCounter m_resourceCounter;
 
 static color_t color[8] = { 0xFFFFFF00, 0xFFFFFFFF, 0xFF0099FF, 0xFF00FF00, 0xFFCCFF00, 0xFF00FFFF, 0xFFE5E5E5, 0xFFC0C0C0 };
 
+/*! \brief One line with the reads of the busiest protocol and the state of the file caches */
+static CStdString GetFileStatsInfo()
+{
+  std::map<std::string, XFILE::SFileStatsCounters> counters;
+  XFILE::CFileStats::GetCounters(counters);
+
+  std::map<std::string, XFILE::SFileStatsCounters>::const_iterator busiest = counters.end();
+  for (std::map<std::string, XFILE::SFileStatsCounters>::const_iterator it = counters.begin(); it != counters.end(); ++it)
+  {
+    if (it->first != "filecache" && (busiest == counters.end() || it->second.bytesRead > busiest->second.bytesRead))
+      busiest = it;
+  }
+
+  CStdString info = "F(";
+  if (busiest != counters.end())
+  {
+    const XFILE::SFileStatsCounters &stats = busiest->second;
+    CStdString protocol;
+    protocol.Format(" %s reads:%"PRIu64" %.1fMB seeks:%"PRIu64" p50:%uus p99:%uus"
+                   , busiest->first.c_str()
+                   , stats.calls[XFILE::FILESTATS_READ]
+                   , stats.bytesRead / 1048576.0
+                   , stats.calls[XFILE::FILESTATS_SEEK]
+                   , XFILE::CFileStats::GetPercentile(stats.latency[XFILE::FILESTATS_READ], 0.5f)
+                   , XFILE::CFileStats::GetPercentile(stats.latency[XFILE::FILESTATS_READ], 0.99f));
+    info += protocol;
+  }
+
+  std::vector<XFILE::SFileCacheStats> caches;
+  XFILE::CFileStats::GetCaches(caches);
+  for (std::vector<XFILE::SFileCacheStats>::const_iterator it = caches.begin(); it != caches.end(); ++it)
+  {
+    CStdString cache;
+    cache.Format(" cache:%.1fMB underruns:%u", it->status.forward / 1048576.0, it->status.underruns);
+    info += cache;
+  }
+  return info + " )";
+}
+
 CGUIWindowFullScreen::CGUIWindowFullScreen(void)
     : CGUIWindow(WINDOW_FULLSCREEN_VIDEO, "VideoFullScreen.xml")
 {
@@ -621,6 +663,9 @@ void CGUIWindowFullScreen::FrameMove()
                          , g_infoManager.GetFPS()
                          , strCores.c_str(), strClock.c_str() );
 
+      if (g_advancedSettings.m_showFileStats)
+        strGeneralFPS += "\n" + GetFileStatsInfo();
+
       CGUIMessage msg(GUI_MSG_LABEL_SET, GetID(), LABEL_ROW3);
       msg.SetLabel(strGeneralFPS);
       OnMessage(msg);
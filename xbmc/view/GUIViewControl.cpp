@@ -137,6 +137,16 @@ void CGUIViewControl::SetItems(CFileItemList &items)
   UpdateView();
 }
 
+void CGUIViewControl::AppendItems(const CFileItemList &items)
+{
+  if (m_currentView < 0 || m_currentView >= (int)m_visibleViews.size() || !m_fileItems)
+    return;
+
+  // other views get the whole list from m_fileItems once they're shown
+  CGUIMessage msg(GUI_MSG_LABEL_APPEND, m_parentWindow, m_visibleViews[m_currentView]->GetID(), 0, 0, (CFileItemList *)&items);
+  g_windowManager.SendMessage(msg, m_parentWindow);
+}
+
 void CGUIViewControl::UpdateContents(const CGUIControl *control, int currentItem)
 {
   if (!control || !m_fileItems) return;
@@ -41,6 +41,10 @@ public:
   void SetCurrentView(int viewMode, bool bRefresh = false);
 
   void SetItems(CFileItemList &items);
+  /*! \brief Show items appended to the list last passed to SetItems() in the current view
+   \param items the appended items, already part of the list passed to SetItems()
+   */
+  void AppendItems(const CFileItemList &items);
 
   void SetSelectedItem(int item);
   void SetSelectedItem(const CStdString &itemPath);
@@ -39,6 +39,8 @@
 // Minidump creation function
 LONG WINAPI CreateMiniDump( EXCEPTION_POINTERS* pEp )
 {
+  // get the lines still queued for the asynchronous log writer out first
+  CLog::FlushOnCrash();
   win32_exception::write_stacktrace(pEp);
   win32_exception::write_minidump(pEp);
   return pEp->ExceptionRecord->ExceptionCode;;
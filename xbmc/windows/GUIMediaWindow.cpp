@@ -47,6 +47,8 @@
 #include "addons/GUIDialogAddonSettings.h"
 #include "dialogs/GUIDialogYesNo.h"
 #include "guilib/GUIWindowManager.h"
+#include "guilib/GraphicContext.h"
+#include "threads/SingleLock.h"
 #include "dialogs/GUIDialogOK.h"
 #include "playlists/PlayList.h"
 #include "storage/MediaManager.h"
@@ -96,6 +98,7 @@ CGUIMediaWindow::CGUIMediaWindow(int id, const char *xmlFile)
   m_iLastControl = -1;
   m_iSelectedItem = -1;
   m_canFilterAdvanced = false;
+  m_previewItems = NULL;
 
   m_guiState.reset(CGUIViewState::GetViewState(GetID(), *m_vecItems));
 }
@@ -568,6 +571,26 @@ void CGUIMediaWindow::UpdateButtons()
   SET_CONTROL_LABEL2(CONTROL_BTN_FILTER, GetProperty("filter").asString());
 }
 
+bool CGUIMediaWindow::OnDirectoryItems(const CFileItemList &items)
+{
+  if (!m_previewItems)
+    return true;
+
+  // controls are read by the render thread
+  CSingleLock lock(g_graphicsContext);
+
+  // m_vecItems keeps the current directory until the fetch succeeds,
+  // only the first batch replaces it in the view, later ones are appended
+  bool first = m_previewItems->IsEmpty();
+  m_previewItems->SetPath(items.GetPath());
+  m_previewItems->Append(items);
+  if (first)
+    m_viewControl.SetItems(*m_previewItems);
+  else
+    m_viewControl.AppendItems(items);
+  return true;
+}
+
 void CGUIMediaWindow::ClearFileItems()
 {
   m_viewControl.Clear();
@@ -767,8 +790,17 @@ bool CGUIMediaWindow::Update(const CStdString &strDirectory, bool updateFilterPa
     directory = RemoveParameterFromPath(directory, "filter");
   }
 
+  // show the items as they arrive, the sorted list replaces them below
   CFileItemList items;
-  if (!GetDirectory(directory, items))
+  CFileItemList preview;
+  m_previewItems = &preview;
+  m_rootDir.SetCallback(this);
+  bool result = GetDirectory(directory, items);
+  m_rootDir.SetCallback(NULL);
+  m_previewItems = NULL;
+  if (!preview.IsEmpty())
+    m_viewControl.SetItems(*m_vecItems);
+  if (!result)
   {
     CLog::Log(LOGERROR,"CGUIMediaWindow::GetDirectory(%s) failed", strDirectory.c_str());
     // Try to return to the previous directory, if not the same
@@ -31,7 +31,7 @@
 class CFileItemList;
 
 // base class for all media windows
-class CGUIMediaWindow : public CGUIWindow
+class CGUIMediaWindow : public CGUIWindow, public XFILE::IDirectoryCallback
 {
 public:
   CGUIMediaWindow(int id, const char *xmlFile);
@@ -52,6 +52,11 @@ public:
   virtual bool CanFilterAdvanced() { return m_canFilterAdvanced; }
   virtual bool IsFiltered();
 
+  /*! \brief Show the items of the directory being fetched in Update() before the fetch completes
+   \sa XFILE::IDirectoryCallback
+   */
+  virtual bool OnDirectoryItems(const CFileItemList &items);
+
 protected:
   virtual void LoadAdditionalTags(TiXmlElement *root);
   CGUIControl *GetFirstFocusableControl(int id);
@@ -185,4 +190,9 @@ protected:
    \sa Update
    */
   CStdString m_strFilterPath;
+
+  /*! \brief Items shown by OnDirectoryItems() while Update() fetches the directory,
+   NULL when no fetch is in progress.
+   */
+  CFileItemList* m_previewItems;
 };